@@ -70,6 +70,11 @@ REPOSITORY_LOCATIONS = dict(
         strip_prefix = "protobuf-3.5.0",
         urls = ["https://github.com/google/protobuf/archive/v3.5.0.tar.gz"],
     ),
+    com_googlesource_code_re2 = dict(
+        sha256 = "b0382aa7369f373a0148218f2df5a6afd6bfa884ce4da2dfb576b979989e615e",
+        strip_prefix = "re2-2019-09-01",
+        urls = ["https://github.com/google/re2/archive/2019-09-01.tar.gz"],
+    ),
     envoy_api = dict(
         commit = "0811371f1738a2e5f0cb594b500e9db3b5bd8af8",
         remote = "https://github.com/envoyproxy/data-plane-api",
@@ -77,6 +77,16 @@ public:
   virtual std::string format(const Http::HeaderMap& request_headers,
                              const Http::HeaderMap& response_headers,
                              const RequestInfo::RequestInfo& request_info) const PURE;
+
+  /**
+   * Append the formatted value to a string. This allows a caller to reuse the same string for
+   * every log line rather than allocating a new one.
+   * @param output supplies the string to append to.
+   */
+  virtual void formatTo(const Http::HeaderMap& request_headers,
+                        const Http::HeaderMap& response_headers,
+                        const RequestInfo::RequestInfo& request_info,
+                        std::string& output) const PURE;
 };
 
 typedef std::unique_ptr<Formatter> FormatterPtr;
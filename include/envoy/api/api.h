@@ -27,11 +27,10 @@ public:
    * Create/open a local file that supports async appending.
    * @param path supplies the file path.
    * @param dispatcher supplies the dispatcher uses for async flushing.
-   * @param lock supplies the lock to use for cross thread appends.
+   * @param stats_store supplies the store for the filesystem stats.
    */
   virtual Filesystem::FileSharedPtr createFile(const std::string& path,
                                                Event::Dispatcher& dispatcher,
-                                               Thread::BasicLockable& lock,
                                                Stats::Store& stats_store) PURE;
 
   /**
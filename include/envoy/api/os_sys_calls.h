@@ -3,6 +3,7 @@
 #include <sys/mman.h>   // for mode_t
 #include <sys/socket.h> // for sockaddr
 #include <sys/stat.h>
+#include <sys/uio.h> // for iovec
 
 #include <memory>
 #include <string>
@@ -33,6 +34,16 @@ public:
    */
   virtual ssize_t write(int fd, const void* buffer, size_t num_bytes) PURE;
 
+  /**
+   * @see writev (man 2 writev)
+   */
+  virtual ssize_t writev(int fd, const iovec* iovec, int num_iovec) PURE;
+
+  /**
+   * @see flock (man 2 flock)
+   */
+  virtual int flock(int fd, int operation) PURE;
+
   /**
    * Release all resources allocated for fd.
    * @return zero on success, -1 returned otherwise.
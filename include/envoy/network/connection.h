@@ -216,6 +216,20 @@ public:
    * @return boolean telling if the connection is currently above the high watermark.
    */
   virtual bool aboveHighWatermark() const PURE;
+
+  /**
+   * Move all further data read from this connection straight to the socket of another connection
+   * inside the kernel, without copying it through user space. The data bypasses the read filters
+   * of this connection and the write filters of the destination, so nothing else may need to see
+   * or write it. The destination's buffer limit, the byte stats of both connections and the bytes
+   * sent callbacks of the destination still apply. Data already written to the destination is
+   * sent first.
+   * @param destination supplies the connection to send the data to.
+   * @return bool whether data is now spliced. It is not if either connection transforms its data
+   *         (e.g. TLS), is not open, has read data buffered or is already splicing, or if the
+   *         platform does not support splicing. In that case nothing has changed.
+   */
+  virtual bool spliceTo(Connection& destination) PURE;
 };
 
 typedef std::unique_ptr<Connection> ConnectionPtr;
@@ -58,6 +58,13 @@ public:
    */
   virtual ListenSocket& socket() PURE;
 
+  /**
+   * @param worker_index supplies the index of a worker.
+   * @return ListenSocket& the socket the worker accepts connections on. Unless the listener has a
+   *         SO_REUSEPORT socket per worker, this is socket() for every worker.
+   */
+  virtual ListenSocket& workerSocket(uint32_t worker_index) PURE;
+
   /**
    * @return Ssl::ServerContext* the default SSL context.
    */
@@ -94,6 +94,12 @@ public:
    */
   virtual bool canFlushClose() PURE;
 
+  /**
+   * @return bool whether the socket reads and writes data on the fd unmodified, so that the
+   *         connection may move data to and from the fd without calling doRead() and doWrite().
+   */
+  virtual bool canSplice() const PURE;
+
   /**
    * Closes the transport socket.
    * @param event supplies the connection event that is closing the socket.
@@ -13,6 +13,7 @@
 #include "envoy/http/codec.h"
 #include "envoy/http/codes.h"
 #include "envoy/http/header_map.h"
+#include "envoy/runtime/runtime.h"
 #include "envoy/tracing/http_tracer.h"
 #include "envoy/upstream/resource_manager.h"
 
@@ -177,9 +178,9 @@ public:
    * @return the runtime key that will be used to determine whether an individual request should
    *         be shadowed. The lack of a key means that all requests will be shadowed. If a key is
    *         present it will be used to drive random selection in the range 0-10000 for 0.01%
-   *         increments.
+   *         increments. The key is interned when the route is configured.
    */
-  virtual const std::string& runtimeKey() const PURE;
+  virtual const Runtime::Key& runtimeKey() const PURE;
 };
 
 /**
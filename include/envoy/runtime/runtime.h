@@ -32,6 +32,54 @@ public:
 
 typedef std::unique_ptr<RandomGenerator> RandomGeneratorPtr;
 
+/**
+ * A runtime key, which may have been interned with the runtime implementation. Snapshots resolve an
+ * interned key once and then find it by index rather than by a hash of the key name. Keys should
+ * be interned once, when the component that looks them up is configured. An interned key keeps its
+ * index reserved until the last copy of it is destroyed, after which the index may be given to
+ * another key, with a new generation.
+ */
+class Key {
+public:
+  /**
+   * A key that is not interned. Snapshots look it up by name.
+   * @param name supplies the key name.
+   */
+  explicit Key(const std::string& name) : index_(0), generation_(0), name_(name) {}
+
+  /**
+   * @param index supplies the dense index assigned to the key.
+   * @param generation supplies the non-zero generation of the index assignment.
+   * @param name supplies the key name.
+   * @param registration supplies an object that keeps the index reserved while it is referenced.
+   */
+  Key(uint32_t index, uint64_t generation, const std::string& name,
+      std::shared_ptr<const void> registration)
+      : index_(index), generation_(generation), name_(name), registration_(registration) {}
+
+  /**
+   * @return uint32_t the dense index assigned to the key when it was interned.
+   */
+  uint32_t index() const { return index_; }
+
+  /**
+   * @return uint64_t the generation of the index assignment, which differs from that of any other
+   *         key that was assigned the same index. 0 if the key is not interned.
+   */
+  uint64_t generation() const { return generation_; }
+
+  /**
+   * @return const std::string& the key name.
+   */
+  const std::string& name() const { return name_; }
+
+private:
+  uint32_t index_;
+  uint64_t generation_;
+  std::string name_;
+  std::shared_ptr<const void> registration_;
+};
+
 /**
  * A snapshot of runtime data.
  */
@@ -98,6 +146,15 @@ public:
   virtual bool featureEnabled(const std::string& key, uint64_t default_value, uint64_t random_value,
                               uint16_t num_buckets) const PURE;
 
+  /**
+   * Variants of featureEnabled() above which look up an interned key.
+   */
+  virtual bool featureEnabled(const Key& key, uint64_t default_value) const PURE;
+  virtual bool featureEnabled(const Key& key, uint64_t default_value,
+                              uint64_t random_value) const PURE;
+  virtual bool featureEnabled(const Key& key, uint64_t default_value, uint64_t random_value,
+                              uint16_t num_buckets) const PURE;
+
   /**
    * Fetch raw runtime data based on key.
    * @param key supplies the key to fetch.
@@ -114,6 +171,11 @@ public:
    */
   virtual uint64_t getInteger(const std::string& key, uint64_t default_value) const PURE;
 
+  /**
+   * Variant of getInteger() above which looks up an interned key.
+   */
+  virtual uint64_t getInteger(const Key& key, uint64_t default_value) const PURE;
+
   /**
    * Fetch the raw runtime entries map. The map data is safe only for the lifetime of the Snapshot.
    * @return const std::unordered_map<std::string, const Entry>& the raw map of loaded values.
@@ -30,6 +30,16 @@ public:
   virtual Network::ListenSocketSharedPtr
   createListenSocket(Network::Address::InstanceConstSharedPtr address, bool bind_to_port) PURE;
 
+  /**
+   * Creates a bound SO_REUSEPORT socket for one worker of a listener that has a socket per worker.
+   * @param address supplies the socket's address.
+   * @param worker_index supplies the index of the worker that will accept on the socket.
+   * @return Network::ListenSocketSharedPtr an initialized and bound socket.
+   */
+  virtual Network::ListenSocketSharedPtr
+  createReusePortListenSocket(Network::Address::InstanceConstSharedPtr address,
+                              uint32_t worker_index) PURE;
+
   /**
    * Creates a list of filter factories.
    * @param filters supplies the proto configuration.
@@ -112,6 +112,12 @@ public:
    */
   virtual std::chrono::milliseconds fileFlushIntervalMsec() PURE;
 
+  /**
+   * @return bool whether all files are flushed from a single shared thread rather than from a
+   *         thread per file.
+   */
+  virtual bool fileFlushSharedThread() PURE;
+
   /**
    * @return const std::string& the server's cluster.
    */
@@ -151,6 +151,73 @@ public:
 
 typedef std::shared_ptr<Histogram> HistogramSharedPtr;
 
+/**
+ * Summary of the samples recorded by a histogram over some period.
+ */
+class HistogramStatistics {
+public:
+  virtual ~HistogramStatistics() {}
+
+  /**
+   * @return std::string a human readable summary of the computed quantiles.
+   */
+  virtual std::string summary() const PURE;
+
+  /**
+   * @return the quantiles, between 0 and 1, that are computed. Parallel to computedQuantiles().
+   */
+  virtual const std::vector<double>& supportedQuantiles() const PURE;
+
+  /**
+   * @return the value at each of supportedQuantiles(). Values are NaN if no samples were recorded.
+   */
+  virtual const std::vector<double>& computedQuantiles() const PURE;
+
+  /**
+   * @return the number of samples recorded.
+   */
+  virtual uint64_t sampleCount() const PURE;
+
+  /**
+   * @return the sum of all samples recorded.
+   */
+  virtual uint64_t sampleSum() const PURE;
+};
+
+/**
+ * A histogram that aggregates the samples recorded on all threads. Samples are recorded without
+ * locking into per thread histograms and periodically merged into the parent by merge(), which
+ * makes them available as the statistics of the last interval and of the lifetime of the
+ * histogram.
+ */
+class ParentHistogram : public virtual Histogram {
+public:
+  virtual ~ParentHistogram() {}
+
+  /**
+   * Merge the samples recorded on all threads since the last call. Only called from the main
+   * thread.
+   */
+  virtual void merge() PURE;
+
+  /**
+   * @return true if a sample has ever been merged into the histogram.
+   */
+  virtual bool used() const PURE;
+
+  /**
+   * @return the statistics of the samples merged by the last call to merge().
+   */
+  virtual const HistogramStatistics& intervalStatistics() const PURE;
+
+  /**
+   * @return the statistics of all samples merged so far.
+   */
+  virtual const HistogramStatistics& cumulativeStatistics() const PURE;
+};
+
+typedef std::shared_ptr<ParentHistogram> ParentHistogramSharedPtr;
+
 /**
  * A sink for stats. Each sink is responsible for writing stats to a backing store.
  */
@@ -159,8 +226,8 @@ public:
   virtual ~Sink() {}
 
   /**
-   * This will be called before a sequence of flushCounter() and flushGauge() calls. Sinks can
-   * choose to optimize writing if desired with a paired endFlush() call.
+   * This will be called before a sequence of flushCounter(), flushGauge() and flushHistogram()
+   * calls. Sinks can choose to optimize writing if desired with a paired endFlush() call.
    */
   virtual void beginFlush() PURE;
 
@@ -175,8 +242,14 @@ public:
   virtual void flushGauge(const Gauge& gauge, uint64_t value) PURE;
 
   /**
-   * This will be called after beginFlush(), some number of flushCounter(), and some number of
-   * flushGauge(). Sinks can use this to optimize writing if desired.
+   * Flush the merged statistics of a histogram.
+   */
+  virtual void flushHistogram(const ParentHistogram& histogram) PURE;
+
+  /**
+   * This will be called after beginFlush(), some number of flushCounter(), some number of
+   * flushGauge() and some number of flushHistogram(). Sinks can use this to optimize writing if
+   * desired.
    */
   virtual void endFlush() PURE;
 
@@ -242,6 +315,11 @@ public:
    * @return a list of all known gauges.
    */
   virtual std::list<GaugeSharedPtr> gauges() const PURE;
+
+  /**
+   * @return a list of all known histograms that aggregate their samples.
+   */
+  virtual std::list<ParentHistogramSharedPtr> histograms() const PURE;
 };
 
 typedef std::unique_ptr<Store> StorePtr;
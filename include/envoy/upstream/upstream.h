@@ -159,6 +159,27 @@ public:
    */
   virtual const std::vector<std::vector<HostSharedPtr>>& healthyHostsPerLocality() const PURE;
 
+  /**
+   * @return HostVectorConstSharedPtr the immutable list behind hosts(), which can be shared with
+   *         other threads rather than copied.
+   */
+  virtual HostVectorConstSharedPtr hostsPtr() const PURE;
+
+  /**
+   * @return HostVectorConstSharedPtr the immutable list behind healthyHosts().
+   */
+  virtual HostVectorConstSharedPtr healthyHostsPtr() const PURE;
+
+  /**
+   * @return HostListsConstSharedPtr the immutable lists behind hostsPerLocality().
+   */
+  virtual HostListsConstSharedPtr hostsPerLocalityPtr() const PURE;
+
+  /**
+   * @return HostListsConstSharedPtr the immutable lists behind healthyHostsPerLocality().
+   */
+  virtual HostListsConstSharedPtr healthyHostsPerLocalityPtr() const PURE;
+
   /**
    * Updates the hosts in a given host set.
    *
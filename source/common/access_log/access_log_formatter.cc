@@ -1,7 +1,9 @@
 #include "common/access_log/access_log_formatter.h"
 
+#include <chrono>
 #include <cstdint>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "common/common/assert.h"
@@ -48,21 +50,295 @@ AccessLogFormatUtils::protocolToString(const Optional<Http::Protocol>& protocol)
   NOT_REACHED;
 }
 
-FormatterImpl::FormatterImpl(const std::string& format) {
-  formatters_ = AccessLogFormatParser::parse(format);
+FormatterPtr AccessLogFormatUtils::defaultBinaryAccessLogFormatter() {
+  return FormatterPtr{new BinaryFormatterImpl(DEFAULT_FORMAT)};
 }
 
+namespace {
+
+void appendInteger(uint64_t value, std::string& output) {
+  char buffer[StringUtil::MIN_ITOA_OUT_LEN];
+  output.append(buffer, StringUtil::itoa(buffer, sizeof(buffer), value));
+}
+
+void appendMilliseconds(const Optional<std::chrono::microseconds>& duration,
+                        std::string& output) {
+  if (duration.valid()) {
+    appendInteger(
+        std::chrono::duration_cast<std::chrono::milliseconds>(duration.value()).count(),
+        output);
+  } else {
+    output += UnspecifiedValueString;
+  }
+}
+
+void appendHeader(const Http::HeaderMap& headers, const Http::LowerCaseString& main_header,
+                  const Http::LowerCaseString& alternative_header,
+                  const Optional<size_t>& max_length, std::string& output) {
+  const Http::HeaderEntry* header = headers.get(main_header);
+
+  if (!header && !alternative_header.get().empty()) {
+    header = headers.get(alternative_header);
+  }
+
+  const char* value = UnspecifiedValueString.c_str();
+  size_t length = UnspecifiedValueString.size();
+  if (header) {
+    value = header->value().c_str();
+    length = header->value().size();
+  }
+
+  if (max_length.valid() && length > max_length.value()) {
+    length = max_length.value();
+  }
+
+  output.append(value, length);
+}
+
+void writeLittleEndian(uint64_t value, size_t num_bytes, std::string& output, size_t position) {
+  for (size_t i = 0; i < num_bytes; i++) {
+    output[position + i] = static_cast<char>(value >> (8 * i));
+  }
+}
+
+uint64_t readLittleEndian(const std::string& data, size_t num_bytes, size_t position) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < num_bytes; i++) {
+    value |= static_cast<uint64_t>(static_cast<uint8_t>(data[position + i])) << (8 * i);
+  }
+  return value;
+}
+
+} // namespace
+
+FormatInstruction::FormatInstruction(Op op, const std::string& text)
+    : op_(op), text_(text), main_header_(""), alternative_header_("") {}
+
+FormatInstruction FormatInstruction::literal(const std::string& text) {
+  return FormatInstruction(Op::Literal, text);
+}
+
+FormatInstruction FormatInstruction::requestHeader(const std::string& command,
+                                                   const std::string& main_header,
+                                                   const std::string& alternative_header,
+                                                   const Optional<size_t>& max_length) {
+  FormatInstruction instruction(Op::RequestHeader, command);
+  instruction.main_header_ = Http::LowerCaseString(main_header);
+  instruction.alternative_header_ = Http::LowerCaseString(alternative_header);
+  instruction.max_length_ = max_length;
+  return instruction;
+}
+
+FormatInstruction FormatInstruction::responseHeader(const std::string& command,
+                                                    const std::string& main_header,
+                                                    const std::string& alternative_header,
+                                                    const Optional<size_t>& max_length) {
+  FormatInstruction instruction =
+      requestHeader(command, main_header, alternative_header, max_length);
+  instruction.op_ = Op::ResponseHeader;
+  return instruction;
+}
+
+FormatInstruction FormatInstruction::requestInfo(const std::string& field_name) {
+  static const std::unordered_map<std::string, Op> ops = {
+      {"START_TIME", Op::StartTime},
+      {"REQUEST_DURATION", Op::RequestDuration},
+      {"RESPONSE_DURATION", Op::ResponseDuration},
+      {"BYTES_RECEIVED", Op::BytesReceived},
+      {"PROTOCOL", Op::Protocol},
+      {"RESPONSE_CODE", Op::ResponseCode},
+      {"BYTES_SENT", Op::BytesSent},
+      {"DURATION", Op::Duration},
+      {"RESPONSE_FLAGS", Op::ResponseFlags},
+      {"UPSTREAM_HOST", Op::UpstreamHost},
+      {"UPSTREAM_CLUSTER", Op::UpstreamCluster},
+      {"UPSTREAM_LOCAL_ADDRESS", Op::UpstreamLocalAddress},
+      {"DOWNSTREAM_LOCAL_ADDRESS", Op::DownstreamLocalAddress},
+      {"DOWNSTREAM_REMOTE_ADDRESS", Op::DownstreamRemoteAddress},
+      // DEPRECATED: "DOWNSTREAM_ADDRESS" will be removed post 1.6.0.
+      {"DOWNSTREAM_ADDRESS", Op::DownstreamRemoteAddressWithoutPort},
+      {"DOWNSTREAM_REMOTE_ADDRESS_WITHOUT_PORT", Op::DownstreamRemoteAddressWithoutPort},
+  };
+
+  const auto op = ops.find(field_name);
+  if (op == ops.end()) {
+    throw EnvoyException(fmt::format("Not supported field in RequestInfo: {}", field_name));
+  }
+  return FormatInstruction(op->second, field_name);
+}
+
+void FormatInstruction::append(const Http::HeaderMap& request_headers,
+                               const Http::HeaderMap& response_headers,
+                               const RequestInfo::RequestInfo& request_info,
+                               std::string& output) const {
+  switch (op_) {
+  case Op::Literal:
+    output += text_;
+    break;
+  case Op::RequestHeader:
+    appendHeader(request_headers, main_header_, alternative_header_, max_length_, output);
+    break;
+  case Op::ResponseHeader:
+    appendHeader(response_headers, main_header_, alternative_header_, max_length_, output);
+    break;
+  case Op::StartTime:
+    output += AccessLogDateTimeFormatter::fromTime(request_info.startTime());
+    break;
+  case Op::RequestDuration:
+    appendMilliseconds(request_info.requestReceivedDuration(), output);
+    break;
+  case Op::ResponseDuration:
+    appendMilliseconds(request_info.responseReceivedDuration(), output);
+    break;
+  case Op::BytesReceived:
+    appendInteger(request_info.bytesReceived(), output);
+    break;
+  case Op::Protocol:
+    output += AccessLogFormatUtils::protocolToString(request_info.protocol());
+    break;
+  case Op::ResponseCode:
+    if (request_info.responseCode().valid()) {
+      appendInteger(request_info.responseCode().value(), output);
+    } else {
+      output += '0';
+    }
+    break;
+  case Op::BytesSent:
+    appendInteger(request_info.bytesSent(), output);
+    break;
+  case Op::Duration:
+    appendInteger(
+        std::chrono::duration_cast<std::chrono::milliseconds>(request_info.duration()).count(),
+        output);
+    break;
+  case Op::ResponseFlags:
+    output += RequestInfo::ResponseFlagUtils::toShortString(request_info);
+    break;
+  case Op::UpstreamHost:
+    if (request_info.upstreamHost()) {
+      output += request_info.upstreamHost()->address()->asString();
+    } else {
+      output += UnspecifiedValueString;
+    }
+    break;
+  case Op::UpstreamCluster:
+    if (request_info.upstreamHost() && !request_info.upstreamHost()->cluster().name().empty()) {
+      output += request_info.upstreamHost()->cluster().name();
+    } else {
+      output += UnspecifiedValueString;
+    }
+    break;
+  case Op::UpstreamLocalAddress:
+    if (request_info.upstreamLocalAddress() != nullptr) {
+      output += request_info.upstreamLocalAddress()->asString();
+    } else {
+      output += UnspecifiedValueString;
+    }
+    break;
+  case Op::DownstreamLocalAddress:
+    output += request_info.downstreamLocalAddress()->asString();
+    break;
+  case Op::DownstreamRemoteAddress:
+    output += request_info.downstreamRemoteAddress()->asString();
+    break;
+  case Op::DownstreamRemoteAddressWithoutPort:
+    output += RequestInfo::Utility::formatDownstreamAddressNoPort(
+        *request_info.downstreamRemoteAddress());
+    break;
+  }
+}
+
+FormatterImpl::FormatterImpl(const std::string& format)
+    : instructions_(AccessLogFormatParser::compile(format)) {}
+
 std::string FormatterImpl::format(const Http::HeaderMap& request_headers,
                                   const Http::HeaderMap& response_headers,
                                   const RequestInfo::RequestInfo& request_info) const {
   std::string log_line;
   log_line.reserve(256);
+  formatTo(request_headers, response_headers, request_info, log_line);
+  return log_line;
+}
 
-  for (const FormatterPtr& formatter : formatters_) {
-    log_line += formatter->format(request_headers, response_headers, request_info);
+void FormatterImpl::formatTo(const Http::HeaderMap& request_headers,
+                             const Http::HeaderMap& response_headers,
+                             const RequestInfo::RequestInfo& request_info,
+                             std::string& output) const {
+  for (const FormatInstruction& instruction : instructions_) {
+    instruction.append(request_headers, response_headers, request_info, output);
   }
+}
 
-  return log_line;
+BinaryFormatterImpl::BinaryFormatterImpl(const std::string& format) {
+  for (FormatInstruction& instruction : AccessLogFormatParser::compile(format)) {
+    if (instruction.op() != FormatInstruction::Op::Literal) {
+      field_names_.push_back(instruction.text());
+      instructions_.emplace_back(std::move(instruction));
+    }
+  }
+}
+
+std::string BinaryFormatterImpl::format(const Http::HeaderMap& request_headers,
+                                        const Http::HeaderMap& response_headers,
+                                        const RequestInfo::RequestInfo& request_info) const {
+  std::string record;
+  formatTo(request_headers, response_headers, request_info, record);
+  return record;
+}
+
+void BinaryFormatterImpl::formatTo(const Http::HeaderMap& request_headers,
+                                   const Http::HeaderMap& response_headers,
+                                   const RequestInfo::RequestInfo& request_info,
+                                   std::string& output) const {
+  // Each length is only known once its value has been appended, so space for it is reserved up
+  // front and filled in afterwards.
+  const size_t record_start = output.size();
+  output.append(sizeof(uint32_t), '\0');
+  for (const FormatInstruction& instruction : instructions_) {
+    const size_t field_start = output.size();
+    output.append(sizeof(uint16_t), '\0');
+    instruction.append(request_headers, response_headers, request_info, output);
+
+    size_t field_length = output.size() - field_start - sizeof(uint16_t);
+    if (field_length > MAX_FIELD_LENGTH) {
+      field_length = MAX_FIELD_LENGTH;
+      output.resize(field_start + sizeof(uint16_t) + field_length);
+    }
+    writeLittleEndian(field_length, sizeof(uint16_t), output, field_start);
+  }
+  writeLittleEndian(output.size() - record_start - sizeof(uint32_t), sizeof(uint32_t), output,
+                    record_start);
+}
+
+std::vector<std::vector<std::string>> BinaryFormatterImpl::decode(const std::string& data) {
+  std::vector<std::vector<std::string>> records;
+  size_t position = 0;
+  while (position < data.size()) {
+    if (data.size() - position < sizeof(uint32_t)) {
+      throw EnvoyException("Truncated binary access log record header");
+    }
+    const uint64_t record_length = readLittleEndian(data, sizeof(uint32_t), position);
+    position += sizeof(uint32_t);
+    if (data.size() - position < record_length) {
+      throw EnvoyException("Truncated binary access log record");
+    }
+
+    const size_t record_end = position + record_length;
+    records.emplace_back();
+    while (position < record_end) {
+      if (record_end - position < sizeof(uint16_t)) {
+        throw EnvoyException("Truncated binary access log field header");
+      }
+      const uint64_t field_length = readLittleEndian(data, sizeof(uint16_t), position);
+      position += sizeof(uint16_t);
+      if (record_end - position < field_length) {
+        throw EnvoyException("Truncated binary access log field");
+      }
+      records.back().emplace_back(data, position, field_length);
+      position += field_length;
+    }
+  }
+  return records;
 }
 
 void AccessLogFormatParser::parseCommand(const std::string& token, const size_t start,
@@ -104,13 +380,42 @@ void AccessLogFormatParser::parseCommand(const std::string& token, const size_t
 }
 
 std::vector<FormatterPtr> AccessLogFormatParser::parse(const std::string& format) {
-  std::string current_token;
   std::vector<FormatterPtr> formatters;
 
+  for (const FormatInstruction& instruction : compile(format)) {
+    switch (instruction.op()) {
+    case FormatInstruction::Op::Literal:
+      formatters.emplace_back(FormatterPtr{new PlainStringFormatter(instruction.text())});
+      break;
+    case FormatInstruction::Op::RequestHeader:
+      formatters.emplace_back(FormatterPtr(
+          new RequestHeaderFormatter(instruction.mainHeader().get(),
+                                     instruction.alternativeHeader().get(),
+                                     instruction.maxLength())));
+      break;
+    case FormatInstruction::Op::ResponseHeader:
+      formatters.emplace_back(FormatterPtr(
+          new ResponseHeaderFormatter(instruction.mainHeader().get(),
+                                      instruction.alternativeHeader().get(),
+                                      instruction.maxLength())));
+      break;
+    default:
+      formatters.emplace_back(FormatterPtr(new RequestInfoFormatter(instruction.text())));
+      break;
+    }
+  }
+
+  return formatters;
+}
+
+std::vector<FormatInstruction> AccessLogFormatParser::compile(const std::string& format) {
+  std::string current_token;
+  std::vector<FormatInstruction> instructions;
+
   for (size_t pos = 0; pos < format.length(); ++pos) {
     if (format[pos] == '%') {
       if (!current_token.empty()) {
-        formatters.emplace_back(FormatterPtr{new PlainStringFormatter(current_token)});
+        instructions.emplace_back(FormatInstruction::literal(current_token));
         current_token = "";
       }
 
@@ -129,8 +434,8 @@ std::vector<FormatterPtr> AccessLogFormatParser::parse(const std::string& format
 
         parseCommand(token, start, main_header, alternative_header, max_length);
 
-        formatters.emplace_back(
-            FormatterPtr(new RequestHeaderFormatter(main_header, alternative_header, max_length)));
+        instructions.emplace_back(
+            FormatInstruction::requestHeader(token, main_header, alternative_header, max_length));
       } else if (token.find("RESP(") == 0) {
         std::string main_header, alternative_header;
         Optional<size_t> max_length;
@@ -138,10 +443,10 @@ std::vector<FormatterPtr> AccessLogFormatParser::parse(const std::string& format
 
         parseCommand(token, start, main_header, alternative_header, max_length);
 
-        formatters.emplace_back(
-            FormatterPtr(new ResponseHeaderFormatter(main_header, alternative_header, max_length)));
+        instructions.emplace_back(
+            FormatInstruction::responseHeader(token, main_header, alternative_header, max_length));
       } else {
-        formatters.emplace_back(FormatterPtr(new RequestInfoFormatter(token)));
+        instructions.emplace_back(FormatInstruction::requestInfo(token));
       }
 
       pos = command_end_position;
@@ -151,110 +456,28 @@ std::vector<FormatterPtr> AccessLogFormatParser::parse(const std::string& format
   }
 
   if (!current_token.empty()) {
-    formatters.emplace_back(FormatterPtr{new PlainStringFormatter(current_token)});
+    instructions.emplace_back(FormatInstruction::literal(current_token));
   }
 
-  return formatters;
+  return instructions;
 }
 
-RequestInfoFormatter::RequestInfoFormatter(const std::string& field_name) {
-  if (field_name == "START_TIME") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      return AccessLogDateTimeFormatter::fromTime(request_info.startTime());
-    };
-  } else if (field_name == "REQUEST_DURATION") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      Optional<std::chrono::microseconds> duration = request_info.requestReceivedDuration();
-      if (duration.valid()) {
-        return std::to_string(
-            std::chrono::duration_cast<std::chrono::milliseconds>(duration.value()).count());
-      } else {
-        return UnspecifiedValueString;
-      }
-    };
-  } else if (field_name == "RESPONSE_DURATION") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      Optional<std::chrono::microseconds> duration = request_info.responseReceivedDuration();
-      if (duration.valid()) {
-        return std::to_string(
-            std::chrono::duration_cast<std::chrono::milliseconds>(duration.value()).count());
-      } else {
-        return UnspecifiedValueString;
-      }
-    };
-  } else if (field_name == "BYTES_RECEIVED") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      return std::to_string(request_info.bytesReceived());
-    };
-  } else if (field_name == "PROTOCOL") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      return AccessLogFormatUtils::protocolToString(request_info.protocol());
-    };
-  } else if (field_name == "RESPONSE_CODE") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      return request_info.responseCode().valid()
-                 ? std::to_string(request_info.responseCode().value())
-                 : "0";
-    };
-  } else if (field_name == "BYTES_SENT") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      return std::to_string(request_info.bytesSent());
-    };
-  } else if (field_name == "DURATION") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      return std::to_string(
-          std::chrono::duration_cast<std::chrono::milliseconds>(request_info.duration()).count());
-    };
-  } else if (field_name == "RESPONSE_FLAGS") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      return RequestInfo::ResponseFlagUtils::toShortString(request_info);
-    };
-  } else if (field_name == "UPSTREAM_HOST") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      if (request_info.upstreamHost()) {
-        return request_info.upstreamHost()->address()->asString();
-      } else {
-        return UnspecifiedValueString;
-      }
-    };
-  } else if (field_name == "UPSTREAM_CLUSTER") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      std::string upstream_cluster_name;
-      if (nullptr != request_info.upstreamHost()) {
-        upstream_cluster_name = request_info.upstreamHost()->cluster().name();
-      }
+RequestInfoFormatter::RequestInfoFormatter(const std::string& field_name)
+    : instruction_(FormatInstruction::requestInfo(field_name)) {}
 
-      return upstream_cluster_name.empty() ? UnspecifiedValueString : upstream_cluster_name;
-    };
-  } else if (field_name == "UPSTREAM_LOCAL_ADDRESS") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      return request_info.upstreamLocalAddress() != nullptr
-                 ? request_info.upstreamLocalAddress()->asString()
-                 : UnspecifiedValueString;
-    };
-  } else if (field_name == "DOWNSTREAM_LOCAL_ADDRESS") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      return request_info.downstreamLocalAddress()->asString();
-    };
-  } else if (field_name == "DOWNSTREAM_REMOTE_ADDRESS") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      return request_info.downstreamRemoteAddress()->asString();
-    };
-  } else if (field_name == "DOWNSTREAM_ADDRESS" ||
-             field_name == "DOWNSTREAM_REMOTE_ADDRESS_WITHOUT_PORT") {
-    // DEPRECATED: "DOWNSTREAM_ADDRESS" will be removed post 1.6.0.
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      return RequestInfo::Utility::formatDownstreamAddressNoPort(
-          *request_info.downstreamRemoteAddress());
-    };
-  } else {
-    throw EnvoyException(fmt::format("Not supported field in RequestInfo: {}", field_name));
-  }
+std::string RequestInfoFormatter::format(const Http::HeaderMap& request_headers,
+                                         const Http::HeaderMap& response_headers,
+                                         const RequestInfo::RequestInfo& request_info) const {
+  std::string value;
+  formatTo(request_headers, response_headers, request_info, value);
+  return value;
 }
 
-std::string RequestInfoFormatter::format(const Http::HeaderMap&, const Http::HeaderMap&,
-                                         const RequestInfo::RequestInfo& request_info) const {
-  return field_extractor_(request_info);
+void RequestInfoFormatter::formatTo(const Http::HeaderMap& request_headers,
+                                    const Http::HeaderMap& response_headers,
+                                    const RequestInfo::RequestInfo& request_info,
+                                    std::string& output) const {
+  instruction_.append(request_headers, response_headers, request_info, output);
 }
 
 PlainStringFormatter::PlainStringFormatter(const std::string& str) : str_(str) {}
@@ -264,30 +487,24 @@ std::string PlainStringFormatter::format(const Http::HeaderMap&, const Http::Hea
   return str_;
 }
 
+void PlainStringFormatter::formatTo(const Http::HeaderMap&, const Http::HeaderMap&,
+                                    const RequestInfo::RequestInfo&, std::string& output) const {
+  output += str_;
+}
+
 HeaderFormatter::HeaderFormatter(const std::string& main_header,
                                  const std::string& alternative_header,
                                  const Optional<size_t>& max_length)
     : main_header_(main_header), alternative_header_(alternative_header), max_length_(max_length) {}
 
 std::string HeaderFormatter::format(const Http::HeaderMap& headers) const {
-  const Http::HeaderEntry* header = headers.get(main_header_);
-
-  if (!header && !alternative_header_.get().empty()) {
-    header = headers.get(alternative_header_);
-  }
-
-  std::string header_value_string;
-  if (!header) {
-    header_value_string = UnspecifiedValueString;
-  } else {
-    header_value_string = header->value().c_str();
-  }
-
-  if (max_length_.valid() && header_value_string.length() > max_length_.value()) {
-    return header_value_string.substr(0, max_length_.value());
-  }
+  std::string value;
+  formatTo(headers, value);
+  return value;
+}
 
-  return header_value_string;
+void HeaderFormatter::formatTo(const Http::HeaderMap& headers, std::string& output) const {
+  appendHeader(headers, main_header_, alternative_header_, max_length_, output);
 }
 
 ResponseHeaderFormatter::ResponseHeaderFormatter(const std::string& main_header,
@@ -301,6 +518,13 @@ std::string ResponseHeaderFormatter::format(const Http::HeaderMap&,
   return HeaderFormatter::format(response_headers);
 }
 
+void ResponseHeaderFormatter::formatTo(const Http::HeaderMap&,
+                                       const Http::HeaderMap& response_headers,
+                                       const RequestInfo::RequestInfo&,
+                                       std::string& output) const {
+  HeaderFormatter::formatTo(response_headers, output);
+}
+
 RequestHeaderFormatter::RequestHeaderFormatter(const std::string& main_header,
                                                const std::string& alternative_header,
                                                const Optional<size_t>& max_length)
@@ -312,5 +536,11 @@ std::string RequestHeaderFormatter::format(const Http::HeaderMap& request_header
   return HeaderFormatter::format(request_headers);
 }
 
+void RequestHeaderFormatter::formatTo(const Http::HeaderMap& request_headers,
+                                      const Http::HeaderMap&, const RequestInfo::RequestInfo&,
+                                      std::string& output) const {
+  HeaderFormatter::formatTo(request_headers, output);
+}
+
 } // namespace AccessLog
 } // namespace Envoy
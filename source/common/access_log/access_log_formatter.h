@@ -1,6 +1,6 @@
 #pragma once
 
-#include <functional>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -10,6 +10,74 @@
 namespace Envoy {
 namespace AccessLog {
 
+/**
+ * A single step of a compiled access log format. A format string is compiled once into a flat
+ * list of instructions, each of which appends its value straight into the log line without
+ * building a temporary string.
+ */
+class FormatInstruction {
+public:
+  enum class Op {
+    Literal,
+    RequestHeader,
+    ResponseHeader,
+    StartTime,
+    RequestDuration,
+    ResponseDuration,
+    BytesReceived,
+    Protocol,
+    ResponseCode,
+    BytesSent,
+    Duration,
+    ResponseFlags,
+    UpstreamHost,
+    UpstreamCluster,
+    UpstreamLocalAddress,
+    DownstreamLocalAddress,
+    DownstreamRemoteAddress,
+    DownstreamRemoteAddressWithoutPort,
+  };
+
+  static FormatInstruction literal(const std::string& text);
+  static FormatInstruction requestHeader(const std::string& command,
+                                         const std::string& main_header,
+                                         const std::string& alternative_header,
+                                         const Optional<size_t>& max_length);
+  static FormatInstruction responseHeader(const std::string& command,
+                                          const std::string& main_header,
+                                          const std::string& alternative_header,
+                                          const Optional<size_t>& max_length);
+
+  /**
+   * @throw EnvoyException if field_name is not a supported RequestInfo field.
+   */
+  static FormatInstruction requestInfo(const std::string& field_name);
+
+  Op op() const { return op_; }
+
+  /**
+   * @return const std::string& the text of a literal, or otherwise the command that the
+   *         instruction was compiled from, e.g. "REQ(:METHOD)".
+   */
+  const std::string& text() const { return text_; }
+
+  const Http::LowerCaseString& mainHeader() const { return main_header_; }
+  const Http::LowerCaseString& alternativeHeader() const { return alternative_header_; }
+  const Optional<size_t>& maxLength() const { return max_length_; }
+
+  void append(const Http::HeaderMap& request_headers, const Http::HeaderMap& response_headers,
+              const RequestInfo::RequestInfo& request_info, std::string& output) const;
+
+private:
+  FormatInstruction(Op op, const std::string& text);
+
+  Op op_;
+  std::string text_;
+  Http::LowerCaseString main_header_;
+  Http::LowerCaseString alternative_header_;
+  Optional<size_t> max_length_;
+};
+
 /**
  * Access log format parser.
  */
@@ -17,6 +85,12 @@ class AccessLogFormatParser {
 public:
   static std::vector<FormatterPtr> parse(const std::string& format);
 
+  /**
+   * Compile a format string into the instructions that produce it.
+   * @throw EnvoyException if the format is invalid.
+   */
+  static std::vector<FormatInstruction> compile(const std::string& format);
+
 private:
   static void parseCommand(const std::string& token, const size_t start, std::string& main_header,
                            std::string& alternative_header, Optional<size_t>& max_length);
@@ -28,6 +102,7 @@ private:
 class AccessLogFormatUtils {
 public:
   static FormatterPtr defaultAccessLogFormatter();
+  static FormatterPtr defaultBinaryAccessLogFormatter();
   static const std::string& protocolToString(const Optional<Http::Protocol>& protocol);
 
 private:
@@ -37,7 +112,8 @@ private:
 };
 
 /**
- * Composite formatter implementation.
+ * Composite formatter implementation. The format is compiled once, and each log line is produced
+ * by running the compiled instructions in order.
  */
 class FormatterImpl : public Formatter {
 public:
@@ -47,9 +123,54 @@ public:
   std::string format(const Http::HeaderMap& request_headers,
                      const Http::HeaderMap& response_headers,
                      const RequestInfo::RequestInfo& request_info) const override;
+  void formatTo(const Http::HeaderMap& request_headers, const Http::HeaderMap& response_headers,
+                const RequestInfo::RequestInfo& request_info, std::string& output) const override;
 
 private:
-  std::vector<FormatterPtr> formatters_;
+  std::vector<FormatInstruction> instructions_;
+};
+
+/**
+ * Formatter that writes each log line as a length-prefixed binary record, to be decoded offline
+ * rather than read as text. Literal text in the format is dropped, and each command becomes one
+ * field of the record, in format order. All integers are little endian:
+ *
+ *   record := uint32 length of the fields, field*
+ *   field  := uint16 length of the value, value
+ *
+ * Values are the same as in text access logs (e.g. "-" for a missing header) and are truncated
+ * to 65535 bytes.
+ */
+class BinaryFormatterImpl : public Formatter {
+public:
+  BinaryFormatterImpl(const std::string& format);
+
+  /**
+   * @return const std::vector<std::string>& the commands of the format, e.g. "REQ(:METHOD)",
+   *         which name the fields of every record.
+   */
+  const std::vector<std::string>& fieldNames() const { return field_names_; }
+
+  /**
+   * Decode a sequence of records.
+   * @param data supplies the records, e.g. the contents of a binary access log file.
+   * @return the field values of each record.
+   * @throw EnvoyException if data ends in the middle of a record.
+   */
+  static std::vector<std::vector<std::string>> decode(const std::string& data);
+
+  // Formatter::format
+  std::string format(const Http::HeaderMap& request_headers,
+                     const Http::HeaderMap& response_headers,
+                     const RequestInfo::RequestInfo& request_info) const override;
+  void formatTo(const Http::HeaderMap& request_headers, const Http::HeaderMap& response_headers,
+                const RequestInfo::RequestInfo& request_info, std::string& output) const override;
+
+private:
+  static const size_t MAX_FIELD_LENGTH = UINT16_MAX;
+
+  std::vector<FormatInstruction> instructions_;
+  std::vector<std::string> field_names_;
 };
 
 /**
@@ -63,6 +184,8 @@ public:
   // Formatter::format
   std::string format(const Http::HeaderMap&, const Http::HeaderMap&,
                      const RequestInfo::RequestInfo&) const override;
+  void formatTo(const Http::HeaderMap&, const Http::HeaderMap&, const RequestInfo::RequestInfo&,
+                std::string& output) const override;
 
 private:
   std::string str_;
@@ -74,6 +197,7 @@ public:
                   const Optional<size_t>& max_length);
 
   std::string format(const Http::HeaderMap& headers) const;
+  void formatTo(const Http::HeaderMap& headers, std::string& output) const;
 
 private:
   Http::LowerCaseString main_header_;
@@ -92,6 +216,8 @@ public:
   // Formatter::format
   std::string format(const Http::HeaderMap& request_headers, const Http::HeaderMap&,
                      const RequestInfo::RequestInfo&) const override;
+  void formatTo(const Http::HeaderMap& request_headers, const Http::HeaderMap&,
+                const RequestInfo::RequestInfo&, std::string& output) const override;
 };
 
 /**
@@ -105,6 +231,8 @@ public:
   // Formatter::format
   std::string format(const Http::HeaderMap&, const Http::HeaderMap& response_headers,
                      const RequestInfo::RequestInfo&) const override;
+  void formatTo(const Http::HeaderMap&, const Http::HeaderMap& response_headers,
+                const RequestInfo::RequestInfo&, std::string& output) const override;
 };
 
 /**
@@ -115,11 +243,14 @@ public:
   RequestInfoFormatter(const std::string& field_name);
 
   // Formatter::format
-  std::string format(const Http::HeaderMap&, const Http::HeaderMap&,
+  std::string format(const Http::HeaderMap& request_headers,
+                     const Http::HeaderMap& response_headers,
                      const RequestInfo::RequestInfo& request_info) const override;
+  void formatTo(const Http::HeaderMap& request_headers, const Http::HeaderMap& response_headers,
+                const RequestInfo::RequestInfo& request_info, std::string& output) const override;
 
 private:
-  std::function<std::string(const RequestInfo::RequestInfo&)> field_extractor_;
+  FormatInstruction instruction_;
 };
 
 } // namespace AccessLog
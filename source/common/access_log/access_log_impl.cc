@@ -190,7 +190,12 @@ void FileAccessLog::log(const Http::HeaderMap* request_headers,
     }
   }
 
-  log_file_->write(formatter_->format(*request_headers, *response_headers, request_info));
+  // The line is built in a string owned by the worker thread, which keeps its capacity from one
+  // log line to the next, so formatting does not allocate once it has grown to the line size.
+  static thread_local std::string log_line;
+  log_line.clear();
+  formatter_->formatTo(*request_headers, *response_headers, request_info, log_line);
+  log_file_->write(log_line);
 }
 
 } // namespace AccessLog
@@ -11,9 +11,8 @@ namespace AccessLog {
 
 class AccessLogManagerImpl : public AccessLogManager {
 public:
-  AccessLogManagerImpl(Api::Api& api, Event::Dispatcher& dispatcher, Thread::BasicLockable& lock,
-                       Stats::Store& stats_store)
-      : api_(api), dispatcher_(dispatcher), lock_(lock), stats_store_(stats_store) {}
+  AccessLogManagerImpl(Api::Api& api, Event::Dispatcher& dispatcher, Stats::Store& stats_store)
+      : api_(api), dispatcher_(dispatcher), stats_store_(stats_store) {}
 
   // AccessLog::AccessLogManager
   void reopen() override;
@@ -22,7 +21,6 @@ public:
 private:
   Api::Api& api_;
   Event::Dispatcher& dispatcher_;
-  Thread::BasicLockable& lock_;
   Stats::Store& stats_store_;
   std::unordered_map<std::string, Filesystem::FileSharedPtr> access_logs_;
 };
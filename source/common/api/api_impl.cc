@@ -4,7 +4,6 @@
 #include <string>
 
 #include "common/event/dispatcher_impl.h"
-#include "common/filesystem/filesystem_impl.h"
 
 namespace Envoy {
 namespace Api {
@@ -13,13 +12,17 @@ Event::DispatcherPtr Impl::allocateDispatcher() {
   return Event::DispatcherPtr{new Event::DispatcherImpl()};
 }
 
-Impl::Impl(std::chrono::milliseconds file_flush_interval_msec)
-    : file_flush_interval_msec_(file_flush_interval_msec) {}
+Impl::Impl(std::chrono::milliseconds file_flush_interval_msec, bool file_flush_shared_thread)
+    : file_flush_interval_msec_(file_flush_interval_msec),
+      file_flush_shared_thread_(file_flush_shared_thread) {}
 
 Filesystem::FileSharedPtr Impl::createFile(const std::string& path, Event::Dispatcher& dispatcher,
-                                           Thread::BasicLockable& lock, Stats::Store& stats_store) {
-  return std::make_shared<Filesystem::FileImpl>(path, dispatcher, lock, stats_store,
-                                                file_flush_interval_msec_);
+                                           Stats::Store& stats_store) {
+  if (file_flush_shared_thread_ && shared_flush_thread_ == nullptr) {
+    shared_flush_thread_ = std::make_shared<Filesystem::SharedFlushThread>();
+  }
+  return std::make_shared<Filesystem::FileImpl>(path, dispatcher, stats_store,
+                                                file_flush_interval_msec_, shared_flush_thread_);
 }
 
 bool Impl::fileExists(const std::string& path) { return Filesystem::fileExists(path); }
@@ -6,6 +6,8 @@
 #include "envoy/api/api.h"
 #include "envoy/filesystem/filesystem.h"
 
+#include "common/filesystem/filesystem_impl.h"
+
 namespace Envoy {
 namespace Api {
 
@@ -14,18 +16,20 @@ namespace Api {
  */
 class Impl : public Api::Api {
 public:
-  Impl(std::chrono::milliseconds file_flush_interval_msec);
+  Impl(std::chrono::milliseconds file_flush_interval_msec, bool file_flush_shared_thread = false);
 
   // Api::Api
   Event::DispatcherPtr allocateDispatcher() override;
   Filesystem::FileSharedPtr createFile(const std::string& path, Event::Dispatcher& dispatcher,
-                                       Thread::BasicLockable& lock,
                                        Stats::Store& stats_store) override;
   bool fileExists(const std::string& path) override;
   std::string fileReadToEnd(const std::string& path) override;
 
 private:
   std::chrono::milliseconds file_flush_interval_msec_;
+  const bool file_flush_shared_thread_;
+  // Created along with the first file when all files are flushed from a single thread.
+  Filesystem::SharedFlushThreadSharedPtr shared_flush_thread_;
 };
 
 } // namespace Api
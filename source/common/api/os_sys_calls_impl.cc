@@ -1,6 +1,7 @@
 #include "common/api/os_sys_calls_impl.h"
 
 #include <fcntl.h>
+#include <sys/file.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -21,6 +22,12 @@ ssize_t OsSysCallsImpl::write(int fd, const void* buffer, size_t num_bytes) {
   return ::write(fd, buffer, num_bytes);
 }
 
+ssize_t OsSysCallsImpl::writev(int fd, const iovec* iovec, int num_iovec) {
+  return ::writev(fd, iovec, num_iovec);
+}
+
+int OsSysCallsImpl::flock(int fd, int operation) { return ::flock(fd, operation); }
+
 int OsSysCallsImpl::shmOpen(const char* name, int oflag, mode_t mode) {
   return ::shm_open(name, oflag, mode);
 }
@@ -10,10 +10,13 @@ namespace Envoy {
 class HashUtil {
 public:
   /**
-   * Return 64-bit hash with seed of 0 from the xxHash algorithm.
+   * Return 64-bit hash from the xxHash algorithm.
    * See https://github.com/Cyan4973/xxHash for details.
+   * @param seed supplies the seed. Hashes of the same input with different seeds are independent.
    */
-  static uint64_t xxHash64(absl::string_view input) { return XXH64(input.data(), input.size(), 0); }
+  static uint64_t xxHash64(absl::string_view input, uint64_t seed = 0) {
+    return XXH64(input.data(), input.size(), seed);
+  }
 };
 
 } // namespace Envoy
@@ -0,0 +1,80 @@
+#include "common/common/regex_set.h"
+
+#include <algorithm>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/common/macros.h"
+
+namespace Envoy {
+
+namespace {
+
+// RE2's own default memory budget, which is sized for a single expression.
+const int64_t BASE_MAX_MEM = 8 << 20;
+// The DFA of a set tracks all of its expressions at once, so it needs more states than that of a
+// single expression. Most of the budget is left to the DFA's state cache.
+const int64_t MAX_MEM_PER_PATTERN = 1 << 20;
+const int64_t MAX_MEM_LIMIT = 1 << 30;
+
+re2::RE2::Options regexSetOptions(size_t num_patterns) {
+  re2::RE2::Options options;
+  // std::regex operates on bytes, so do not interpret paths as UTF-8.
+  options.set_encoding(re2::RE2::Options::EncodingLatin1);
+  options.set_log_errors(false);
+  options.set_max_mem(std::min<int64_t>(BASE_MAX_MEM + num_patterns * MAX_MEM_PER_PATTERN,
+                                        MAX_MEM_LIMIT));
+  return options;
+}
+
+} // namespace
+
+RegexSet::RegexSet() : set_(new re2::RE2::Set(regexSetOptions(0), re2::RE2::ANCHOR_BOTH)) {}
+
+int RegexSet::add(const std::string& pattern) {
+  ASSERT(!compiled_);
+  const int index = set_->Add(pattern, nullptr);
+  if (index >= 0) {
+    ASSERT(static_cast<size_t>(index) == patterns_.size());
+    patterns_.push_back(pattern);
+  }
+  return index;
+}
+
+void RegexSet::compile() {
+  ASSERT(!compiled_);
+  // The memory budget of a set is fixed when it is created, so rebuild it now that the number of
+  // expressions is known.
+  if (!patterns_.empty()) {
+    set_.reset(new re2::RE2::Set(regexSetOptions(patterns_.size()), re2::RE2::ANCHOR_BOTH));
+    for (const std::string& pattern : patterns_) {
+      const int index = set_->Add(pattern, nullptr);
+      ASSERT(index >= 0);
+      UNREFERENCED_PARAMETER(index);
+    }
+  }
+  if (!set_->Compile()) {
+    throw EnvoyException("unable to compile regex set: out of memory");
+  }
+  compiled_ = true;
+}
+
+bool RegexSet::match(absl::string_view input, std::vector<int>& matches) const {
+  ASSERT(compiled_);
+  matches.clear();
+  if (patterns_.empty()) {
+    return true;
+  }
+  // Match() also returns false when nothing matched, so only the error tells a failure apart.
+  re2::RE2::Set::ErrorInfo error;
+  if (!set_->Match(re2::StringPiece(input.data(), input.size()), &matches, &error) &&
+      error.kind != re2::RE2::Set::kNoError) {
+    matches.clear();
+    return false;
+  }
+  std::sort(matches.begin(), matches.end());
+  return true;
+}
+
+} // namespace Envoy
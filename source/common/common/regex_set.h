@@ -0,0 +1,60 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/common/non_copyable.h"
+
+#include "absl/strings/string_view.h"
+#include "re2/set.h"
+
+namespace Envoy {
+
+/**
+ * A set of regular expressions that are compiled together into a single RE2 automaton, so that
+ * an input can be tested against every expression in one linear-time pass. Each expression must
+ * match the whole input, which mirrors std::regex_match().
+ */
+class RegexSet : NonCopyable {
+public:
+  RegexSet();
+
+  /**
+   * Add an expression to the set. Expressions that RE2 cannot compile (for example those using
+   * backreferences or lookahead) are rejected so that the caller can fall back to std::regex.
+   * @param pattern supplies the expression to add.
+   * @return int the index that match() reports for the expression, or -1 if it was rejected.
+   */
+  int add(const std::string& pattern);
+
+  /**
+   * Compile the set. Must be called once after all expressions have been added and before
+   * match() is called. The memory RE2 may use is scaled to the number of expressions.
+   */
+  void compile();
+
+  /**
+   * @return true if no expression has been added to the set.
+   */
+  bool empty() const { return patterns_.empty(); }
+
+  /**
+   * Match an input against all expressions in the set.
+   * @param input supplies the string to match.
+   * @param matches is filled with the indices of all matching expressions in ascending order.
+   * @return bool false if RE2 failed to match the input, e.g. because its DFA ran out of memory.
+   *         matches is then empty and the caller must match each expression on its own.
+   */
+  bool match(absl::string_view input, std::vector<int>& matches) const;
+
+private:
+  std::unique_ptr<re2::RE2::Set> set_;
+  // The expressions accepted by add(), kept to rebuild set_ in compile().
+  std::vector<std::string> patterns_;
+  bool compiled_{};
+};
+
+typedef std::unique_ptr<RegexSet> RegexSetPtr;
+
+} // namespace Envoy
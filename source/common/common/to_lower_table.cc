@@ -1,6 +1,37 @@
 #include "common/common/to_lower_table.h"
 
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace Envoy {
+namespace {
+
+// Lower case 8 bytes at once. For each byte, adding to its low 7 bits sets the high bit exactly
+// when the byte is at least 'A' or above 'Z' respectively, so the bytes in 'A'..'Z' are those where
+// the two sums differ and the byte itself is ASCII. Their case bit is then set.
+uint64_t toLowerCase8(uint64_t word) {
+  constexpr uint64_t ones = 0x0101010101010101ULL;
+  const uint64_t low_bits = word & (0x7f * ones);
+  const uint64_t at_least_a = low_bits + (0x80 - 'A') * ones;
+  const uint64_t above_z = low_bits + (0x7f - 'Z') * ones;
+  return word | (((at_least_a ^ above_z) & ~word & (0x80 * ones)) >> 2);
+}
+
+#ifdef __SSE2__
+// Lower case 16 bytes at once. The compares are signed, so bytes with the high bit set are never
+// in 'A'..'Z'.
+__m128i toLowerCase16(__m128i chars) {
+  const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('A' - 1)),
+                                      _mm_cmplt_epi8(chars, _mm_set1_epi8('Z' + 1)));
+  return _mm_or_si128(chars, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+#endif
+
+} // namespace
+
 ToLowerTable::ToLowerTable() {
   for (size_t c = 0; c < 256; c++) {
     table_[c] = c;
@@ -11,6 +42,42 @@ ToLowerTable::ToLowerTable() {
 }
 
 void ToLowerTable::toLowerCase(char* buffer, uint32_t size) const {
+  // Lengths that aren't a multiple of the word size finish with a word that overlaps the previous
+  // one, which is harmless as lower casing is idempotent. The last word is loaded before the
+  // previous one is stored, so that the load isn't stalled behind the overlapping store.
+#ifdef __SSE2__
+  if (size >= sizeof(__m128i)) {
+    __m128i* last = reinterpret_cast<__m128i*>(buffer + size - sizeof(__m128i));
+    const __m128i last_chars = _mm_loadu_si128(last);
+    for (size_t i = 0; i + sizeof(__m128i) < size; i += sizeof(__m128i)) {
+      __m128i* chunk = reinterpret_cast<__m128i*>(buffer + i);
+      _mm_storeu_si128(chunk, toLowerCase16(_mm_loadu_si128(chunk)));
+    }
+    _mm_storeu_si128(last, toLowerCase16(last_chars));
+    return;
+  }
+#endif
+  if (size >= sizeof(uint64_t)) {
+    uint64_t first;
+    uint64_t last;
+    memcpy(&first, buffer, sizeof(first));
+    memcpy(&last, buffer + size - sizeof(last), sizeof(last));
+    first = toLowerCase8(first);
+    last = toLowerCase8(last);
+    memcpy(buffer, &first, sizeof(first));
+    memcpy(buffer + size - sizeof(last), &last, sizeof(last));
+    if (size > 2 * sizeof(uint64_t)) {
+      // Without SSE2, the words in between.
+      for (size_t i = sizeof(uint64_t); i + sizeof(uint64_t) < size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, buffer + i, sizeof(word));
+        word = toLowerCase8(word);
+        memcpy(buffer + i, &word, sizeof(word));
+      }
+    }
+    return;
+  }
+
   for (size_t i = 0; i < size; i++) {
     buffer[i] = table_[static_cast<uint8_t>(buffer[i])];
   }
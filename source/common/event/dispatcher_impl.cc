@@ -1,9 +1,15 @@
 #include "common/event/dispatcher_impl.h"
 
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
 #include <chrono>
 #include <cstdint>
 #include <functional>
-#include <mutex>
 #include <string>
 #include <vector>
 
@@ -11,6 +17,8 @@
 #include "envoy/network/listener.h"
 
 #include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/common/macros.h"
 #include "common/event/file_event_impl.h"
 #include "common/event/signal_impl.h"
 #include "common/event/timer_impl.h"
@@ -34,12 +42,32 @@ DispatcherImpl::DispatcherImpl()
 DispatcherImpl::DispatcherImpl(Buffer::WatermarkFactoryPtr&& factory)
     : buffer_factory_(std::move(factory)), base_(event_base_new()),
       deferred_delete_timer_(createTimer([this]() -> void { clearDeferredDeleteList(); })),
-      post_timer_(createTimer([this]() -> void { runPostCallbacks(); })),
       current_to_delete_(&to_delete_1_) {
   RELEASE_ASSERT(Libevent::Global::initialized());
+#ifdef __linux__
+  post_read_fd_ = post_write_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  RELEASE_ASSERT(post_read_fd_ != -1);
+#else
+  int fds[2];
+  RELEASE_ASSERT(pipe(fds) == 0);
+  post_read_fd_ = fds[0];
+  post_write_fd_ = fds[1];
+  for (int fd : fds) {
+    RELEASE_ASSERT(fcntl(fd, F_SETFL, O_NONBLOCK) != -1);
+    RELEASE_ASSERT(fcntl(fd, F_SETFD, FD_CLOEXEC) != -1);
+  }
+#endif
+  post_event_ = createFileEvent(post_read_fd_, [this](uint32_t) -> void { runPostCallbacks(); },
+                                FileTriggerType::Level, FileReadyType::Read);
 }
 
-DispatcherImpl::~DispatcherImpl() {}
+DispatcherImpl::~DispatcherImpl() {
+  post_event_.reset();
+  close(post_read_fd_);
+  if (post_write_fd_ != post_read_fd_) {
+    close(post_write_fd_);
+  }
+}
 
 void DispatcherImpl::clearDeferredDeleteList() {
   ASSERT(isThreadSafe());
@@ -141,16 +169,17 @@ SignalEventPtr DispatcherImpl::listenForSignal(int signal_num, SignalCb cb) {
 }
 
 void DispatcherImpl::post(std::function<void()> callback) {
-  bool do_post;
-  {
-    std::unique_lock<std::mutex> lock(post_lock_);
-    do_post = post_callbacks_.empty();
-    post_callbacks_.push_back(callback);
+  if (post_queue_.push(std::move(callback))) {
+    wakeUp();
   }
+}
 
-  if (do_post) {
-    post_timer_->enableTimer(std::chrono::milliseconds(0));
-  }
+void DispatcherImpl::wakeUp() {
+  const uint64_t value = 1;
+  // Fails with EAGAIN only if the wakeup is already pending, so the failure can be ignored.
+  const ssize_t rc = write(post_write_fd_, &value, sizeof(value));
+  ASSERT(rc == sizeof(value) || errno == EAGAIN);
+  UNREFERENCED_PARAMETER(rc);
 }
 
 void DispatcherImpl::run(RunType type) {
@@ -166,15 +195,12 @@ void DispatcherImpl::run(RunType type) {
 }
 
 void DispatcherImpl::runPostCallbacks() {
-  std::unique_lock<std::mutex> lock(post_lock_);
-  while (!post_callbacks_.empty()) {
-    std::function<void()> callback = post_callbacks_.front();
-    post_callbacks_.pop_front();
-
-    lock.unlock();
-    callback();
-    lock.lock();
+  // Consume the wakeup before taking the queue. A callback posted after the queue is taken finds
+  // it empty and wakes the loop again, which would be lost if the wakeup were consumed after.
+  uint64_t value;
+  while (read(post_read_fd_, &value, sizeof(value)) > 0) {
   }
+  post_queue_.runAll();
 }
 
 } // namespace Event
@@ -2,17 +2,17 @@
 
 #include <cstdint>
 #include <functional>
-#include <list>
-#include <mutex>
 #include <vector>
 
 #include "envoy/event/deferred_deletable.h"
 #include "envoy/event/dispatcher.h"
+#include "envoy/event/file_event.h"
 #include "envoy/network/connection_handler.h"
 
 #include "common/common/logger.h"
 #include "common/common/thread.h"
 #include "common/event/libevent.h"
+#include "common/event/post_queue.h"
 
 namespace Envoy {
 namespace Event {
@@ -60,6 +60,7 @@ public:
 
 private:
   void runPostCallbacks();
+  void wakeUp();
 #ifndef NDEBUG
   // Validate that an operation is thread safe, i.e. it's invoked on the same thread that the
   // dispatcher run loop is executing on. We allow run_tid_ == 0 for tests where we don't invoke
@@ -73,12 +74,15 @@ private:
   Buffer::WatermarkFactoryPtr buffer_factory_;
   Libevent::BasePtr base_;
   TimerPtr deferred_delete_timer_;
-  TimerPtr post_timer_;
+  // The post queue wakes the event loop by making post_read_fd_ readable through post_write_fd_.
+  // This is a single eventfd where available.
+  int post_read_fd_;
+  int post_write_fd_;
+  FileEventPtr post_event_;
   std::vector<DeferredDeletablePtr> to_delete_1_;
   std::vector<DeferredDeletablePtr> to_delete_2_;
   std::vector<DeferredDeletablePtr>* current_to_delete_;
-  std::mutex post_lock_;
-  std::list<std::function<void()>> post_callbacks_;
+  PostQueue post_queue_;
   bool deferred_deleting_{};
 };
 
@@ -0,0 +1,94 @@
+#include "common/event/post_queue.h"
+
+#include <cstdint>
+#include <functional>
+
+namespace Envoy {
+namespace Event {
+
+PostQueue::~PostQueue() {
+  deleteNodes(head_.load(std::memory_order_acquire));
+  deleteNodes(free_.load(std::memory_order_acquire));
+}
+
+void PostQueue::deleteNodes(Node* node) {
+  while (node != nullptr) {
+    Node* next = node->next_;
+    delete node;
+    node = next;
+  }
+}
+
+PostQueue::NodeCache::~NodeCache() { deleteNodes(nodes_); }
+
+PostQueue::Node* PostQueue::NodeCache::take(PostQueue& queue) {
+  if (nodes_ == nullptr) {
+    // As with the queue itself, the free list is only ever taken whole, so a node is never popped
+    // while another producer holds it as the expected head and there is no ABA problem.
+    nodes_ = queue.free_.exchange(nullptr, std::memory_order_acquire);
+    if (nodes_ == nullptr) {
+      return new Node();
+    }
+  }
+  Node* node = nodes_;
+  nodes_ = node->next_;
+  return node;
+}
+
+bool PostQueue::push(std::function<void()> callback) {
+  static thread_local NodeCache cache;
+  Node* node = cache.take(*this);
+  node->callback_ = std::move(callback);
+  Node* head = head_.load(std::memory_order_relaxed);
+  // The node belongs to the consumer as soon as it is published, so only the local copy of the
+  // previous head may be used afterwards.
+  do {
+    node->next_ = head;
+  } while (!head_.compare_exchange_weak(head, node, std::memory_order_release,
+                                        std::memory_order_relaxed));
+  return head == nullptr;
+}
+
+uint64_t PostQueue::runAll() {
+  // The consumer only ever takes the whole stack, so a node is never popped while a producer
+  // still holds it as the expected head and there is no ABA problem.
+  Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+
+  // The stack is newest first, so reverse it to run the callbacks in the order they were posted.
+  Node* reversed = nullptr;
+  while (node != nullptr) {
+    Node* next = node->next_;
+    node->next_ = reversed;
+    reversed = node;
+    node = next;
+  }
+
+  uint64_t count = 0;
+  Node* done = nullptr;
+  Node* done_tail = nullptr;
+  while (reversed != nullptr) {
+    Node* next = reversed->next_;
+    reversed->callback_();
+    // Release what the callback holds now rather than when its node is reused.
+    reversed->callback_ = nullptr;
+    reversed->next_ = done;
+    if (done == nullptr) {
+      done_tail = reversed;
+    }
+    done = reversed;
+    reversed = next;
+    count++;
+  }
+
+  if (done != nullptr) {
+    Node* free = free_.load(std::memory_order_relaxed);
+    do {
+      done_tail->next_ = free;
+    } while (!free_.compare_exchange_weak(free, done, std::memory_order_release,
+                                          std::memory_order_relaxed));
+  }
+  return count;
+}
+
+} // namespace Event
+} // namespace Envoy
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+
+namespace Envoy {
+namespace Event {
+
+/**
+ * Lock free multi producer, single consumer queue of posted callbacks. Producers push onto an
+ * atomic stack, and the consumer takes the whole stack at once and runs it in the order the
+ * callbacks were pushed. Neither side ever blocks the other. The consumer returns the nodes of the
+ * callbacks it ran to a free list, from which producers take them back, so that pushes only
+ * allocate while the number of callbacks in flight grows.
+ */
+class PostQueue {
+public:
+  ~PostQueue();
+
+  /**
+   * Push a callback. Thread safe.
+   * @param callback supplies the callback to push.
+   * @return bool whether the queue was empty, in which case the consumer must be woken up to run
+   *         the callback. Callbacks pushed to a non-empty queue are run by the same wakeup.
+   */
+  bool push(std::function<void()> callback);
+
+  /**
+   * Run all callbacks pushed so far, in the order they were pushed. Callbacks pushed by the
+   * callbacks themselves are left for the next call. Must only be called by the consumer.
+   * @return uint64_t the number of callbacks run.
+   */
+  uint64_t runAll();
+
+private:
+  struct Node {
+    std::function<void()> callback_;
+    Node* next_{};
+  };
+
+  /**
+   * The nodes that a producer thread took from the free list of a queue. The thread uses them for
+   * its next pushes to any queue, and deletes those left when it exits.
+   */
+  class NodeCache {
+  public:
+    ~NodeCache();
+
+    /**
+     * @return Node* a node from the cache, after refilling it from the free list of queue if it is
+     *         empty, or a new node if that is empty too.
+     */
+    Node* take(PostQueue& queue);
+
+  private:
+    Node* nodes_{};
+  };
+
+  static void deleteNodes(Node* node);
+
+  std::atomic<Node*> head_{nullptr};
+  // Nodes whose callbacks have run. Only the consumer pushes onto it, and producers only ever take
+  // all of it at once.
+  std::atomic<Node*> free_{nullptr};
+};
+
+} // namespace Event
+} // namespace Envoy
@@ -1,7 +1,11 @@
 #include "common/filesystem/filesystem_impl.h"
 
 #include <dirent.h>
+#include <sys/file.h>
+#include <sys/uio.h>
 
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
 #include <cstdint>
 #include <fstream>
@@ -53,12 +57,67 @@ std::string fileReadToEnd(const std::string& path) {
   return file_string.str();
 }
 
+SharedFlushThread::SharedFlushThread()
+    : thread_(new Thread::Thread([this]() -> void { threadFunc(); })) {}
+
+SharedFlushThread::~SharedFlushThread() {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    ASSERT(queue_.empty());
+    exit_ = true;
+    event_.notify_all();
+  }
+
+  thread_->join();
+}
+
+void SharedFlushThread::schedule(FileImpl& file) {
+  std::lock_guard<std::mutex> lock(lock_);
+  if (std::find(queue_.begin(), queue_.end(), &file) == queue_.end()) {
+    queue_.push_back(&file);
+    event_.notify_all();
+  }
+}
+
+void SharedFlushThread::cancel(FileImpl& file) {
+  std::unique_lock<std::mutex> lock(lock_);
+  queue_.remove(&file);
+  while (flushing_ == &file) {
+    event_.wait(lock);
+  }
+}
+
+void SharedFlushThread::threadFunc() {
+  std::unique_lock<std::mutex> lock(lock_);
+  while (true) {
+    while (queue_.empty() && !exit_) {
+      event_.wait(lock);
+    }
+
+    if (exit_) {
+      return;
+    }
+
+    // Flush every queued file before waiting again. The lock is released while a file is being
+    // flushed so that other files can be queued in the meantime.
+    FileImpl* file = queue_.front();
+    queue_.pop_front();
+    flushing_ = file;
+    lock.unlock();
+    file->flushBuffered();
+    lock.lock();
+    flushing_ = nullptr;
+    event_.notify_all();
+  }
+}
+
 FileImpl::FileImpl(const std::string& path, Event::Dispatcher& dispatcher,
-                   Thread::BasicLockable& lock, Stats::Store& stats_store,
-                   std::chrono::milliseconds flush_interval_msec)
-    : path_(path), file_lock_(lock), flush_timer_(dispatcher.createTimer([this]() -> void {
+                   Stats::Store& stats_store, std::chrono::milliseconds flush_interval_msec,
+                   SharedFlushThreadSharedPtr shared_flush_thread)
+    : path_(path), shared_flush_thread_(shared_flush_thread),
+      flush_timer_(dispatcher.createTimer([this]() -> void {
         stats_.flushed_by_timer_.inc();
-        flush_event_.notify_one();
+        notifyFlush();
         flush_timer_->enableTimer(flush_interval_msec_);
       })),
       os_sys_calls_(Api::OsSysCallsSingleton::get()), flush_interval_msec_(flush_interval_msec),
@@ -89,6 +148,10 @@ FileImpl::~FileImpl() {
     flush_thread_->join();
   }
 
+  if (shared_flush_thread_ != nullptr) {
+    shared_flush_thread_->cancel(*this);
+  }
+
   // Flush any remaining data. If file was not opened for some reason, skip flushing part.
   if (fd_ != -1) {
     if (flush_buffer_.length() > 0) {
@@ -107,30 +170,48 @@ void FileImpl::doWrite(Buffer::Instance& buffer) {
   // We must do the actual writes to disk under lock, so that we don't intermix chunks from
   // different FileImpl pointing to the same underlying file. This can happen either via hot
   // restart or if calling code opens the same underlying file into a different FileImpl in the
-  // same process.
-  // TODO PERF: Currently, we use a single cross process lock to serialize all disk writes. This
-  //            will never block network workers, but does mean that only a single flush thread can
-  //            actually flush to disk. In the future it would be nice if we did away with the cross
-  //            process lock or had multiple locks.
-  {
-    std::lock_guard<Thread::BasicLockable> lock(file_lock_);
-    for (Buffer::RawSlice& slice : slices) {
-      ssize_t rc = os_sys_calls_.write(fd_, slice.mem_, slice.len_);
-      ASSERT(rc == static_cast<ssize_t>(slice.len_));
-      UNREFERENCED_PARAMETER(rc);
-      stats_.write_completed_.inc();
+  // same process. flock() locks only the file itself, so flush threads of different files never
+  // wait on each other. The slices are written with as few writev() calls as possible.
+  lockFile(LOCK_EX);
+  for (uint64_t first = 0; first < num_slices; first += MAX_SLICES_PER_WRITE) {
+    const uint64_t num_iovecs =
+        num_slices - first < MAX_SLICES_PER_WRITE ? num_slices - first : MAX_SLICES_PER_WRITE;
+    iovec iovecs[MAX_SLICES_PER_WRITE];
+    uint64_t num_bytes = 0;
+    for (uint64_t i = 0; i < num_iovecs; i++) {
+      iovecs[i].iov_base = slices[first + i].mem_;
+      iovecs[i].iov_len = slices[first + i].len_;
+      num_bytes += slices[first + i].len_;
     }
+
+    ssize_t rc = os_sys_calls_.writev(fd_, iovecs, static_cast<int>(num_iovecs));
+    ASSERT(rc == static_cast<ssize_t>(num_bytes));
+    UNREFERENCED_PARAMETER(rc);
+    UNREFERENCED_PARAMETER(num_bytes);
+    stats_.write_completed_.add(num_iovecs);
   }
+  lockFile(LOCK_UN);
 
   stats_.write_total_buffered_.sub(buffer.length());
   buffer.drain(buffer.length());
 }
 
+void FileImpl::lockFile(int operation) {
+  int rc;
+  do {
+    rc = os_sys_calls_.flock(fd_, operation);
+  } while (rc == -1 && errno == EINTR);
+
+  // The data is written even if the file couldn't be locked, since losing log lines is worse than
+  // the chance of them being interleaved with another writer's.
+  if (rc == -1) {
+    stats_.lock_failed_.inc();
+  }
+}
+
 void FileImpl::flushThreadFunc() {
 
   while (true) {
-    std::unique_lock<std::mutex> flush_lock;
-
     {
       std::unique_lock<std::mutex> write_lock(write_lock_);
 
@@ -143,30 +224,52 @@ void FileImpl::flushThreadFunc() {
       if (flush_thread_exit_) {
         return;
       }
+    }
 
-      flush_lock = std::unique_lock<std::mutex>(flush_lock_);
-      ASSERT(flush_buffer_.length() > 0);
-      about_to_write_buffer_.move(flush_buffer_);
-      ASSERT(flush_buffer_.length() == 0);
+    flushBuffered();
+  }
+}
+
+void FileImpl::flushBuffered() {
+  std::unique_lock<std::mutex> flush_lock;
+
+  {
+    std::unique_lock<std::mutex> write_lock(write_lock_);
+
+    // Another flush may have emptied the buffer since this flush was requested.
+    if (flush_buffer_.length() == 0) {
+      return;
     }
 
-    // if we failed to open file before (-1 == fd_), then simply ignore
-    if (fd_ != -1) {
-      try {
-        if (reopen_file_) {
-          reopen_file_ = false;
-          os_sys_calls_.close(fd_);
-          open();
-        }
-
-        doWrite(about_to_write_buffer_);
-      } catch (const EnvoyException&) {
-        stats_.reopen_failed_.inc();
+    flush_lock = std::unique_lock<std::mutex>(flush_lock_);
+    about_to_write_buffer_.move(flush_buffer_);
+    ASSERT(flush_buffer_.length() == 0);
+  }
+
+  // if we failed to open file before (-1 == fd_), then simply ignore
+  if (fd_ != -1) {
+    try {
+      if (reopen_file_) {
+        reopen_file_ = false;
+        os_sys_calls_.close(fd_);
+        open();
       }
+
+      doWrite(about_to_write_buffer_);
+    } catch (const EnvoyException&) {
+      stats_.reopen_failed_.inc();
     }
   }
 }
 
+void FileImpl::notifyFlush() {
+  if (shared_flush_thread_ != nullptr) {
+    shared_flush_thread_->schedule(*this);
+  } else {
+    flush_event_.notify_one();
+  }
+}
+
 void FileImpl::flush() {
   std::unique_lock<std::mutex> flush_buffer_lock;
 
@@ -194,7 +297,7 @@ void FileImpl::flush() {
 void FileImpl::write(const std::string& data) {
   std::lock_guard<std::mutex> lock(write_lock_);
 
-  if (flush_thread_ == nullptr) {
+  if (!flush_structures_created_) {
     createFlushStructures();
   }
 
@@ -202,13 +305,16 @@ void FileImpl::write(const std::string& data) {
   stats_.write_total_buffered_.add(data.length());
   flush_buffer_.add(data);
   if (flush_buffer_.length() > MIN_FLUSH_SIZE) {
-    flush_event_.notify_one();
+    notifyFlush();
   }
 }
 
 void FileImpl::createFlushStructures() {
-  flush_thread_.reset(new Thread::Thread([this]() -> void { flushThreadFunc(); }));
+  if (shared_flush_thread_ == nullptr) {
+    flush_thread_.reset(new Thread::Thread([this]() -> void { flushThreadFunc(); }));
+  }
   flush_timer_->enableTimer(flush_interval_msec_);
+  flush_structures_created_ = true;
 }
 
 } // namespace Filesystem
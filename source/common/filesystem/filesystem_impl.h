@@ -4,6 +4,8 @@
 #include <chrono>
 #include <condition_variable>
 #include <cstdint>
+#include <list>
+#include <memory>
 #include <mutex>
 #include <string>
 
@@ -22,6 +24,7 @@ namespace Envoy {
   COUNTER(write_completed)                                                                         \
   COUNTER(flushed_by_timer)                                                                        \
   COUNTER(reopen_failed)                                                                           \
+  COUNTER(lock_failed)                                                                             \
   GAUGE  (write_total_buffered)
 // clang-format on
 
@@ -47,17 +50,57 @@ bool directoryExists(const std::string& path);
  */
 std::string fileReadToEnd(const std::string& path);
 
+class FileImpl;
+
+/**
+ * A single thread that flushes many FileImpl. Files are queued when they have enough data
+ * buffered or when their flush timer fires, and every wake up of the thread writes out all files
+ * queued so far. This bounds the number of flush threads when there are many access log files.
+ */
+class SharedFlushThread {
+public:
+  SharedFlushThread();
+  ~SharedFlushThread();
+
+  /**
+   * Queue a file to be flushed, unless it is already queued.
+   */
+  void schedule(FileImpl& file);
+
+  /**
+   * Remove a file from the queue. If the file is currently being flushed, this blocks until the
+   * flush is complete. Must be called before the file is destroyed.
+   */
+  void cancel(FileImpl& file);
+
+private:
+  void threadFunc();
+
+  std::mutex lock_;
+  std::condition_variable_any event_;
+  std::list<FileImpl*> queue_;
+  FileImpl* flushing_{};
+  bool exit_{};
+  Thread::ThreadPtr thread_;
+};
+
+typedef std::shared_ptr<SharedFlushThread> SharedFlushThreadSharedPtr;
+
 /**
  * This is a file implementation geared for writing out access logs. It turn out that in certain
  * cases even if a standard file is opened with O_NONBLOCK, the kernel can still block when writing.
- * This implementation uses a flush thread per file, with the idea there there aren't that many
- * files. If this turns out to be a good implementation we can potentially have a single flush
- * thread that flushes all files, but we will start with this.
+ * By default this implementation uses a flush thread per file, with the idea there there aren't
+ * that many files. Alternatively, many files can share a single SharedFlushThread.
  */
 class FileImpl : public File {
 public:
-  FileImpl(const std::string& path, Event::Dispatcher& dispatcher, Thread::BasicLockable& lock,
-           Stats::Store& stats_store, std::chrono::milliseconds flush_interval_msec);
+  /**
+   * @param shared_flush_thread supplies the thread to flush this file from. If nullptr, the file
+   *        starts its own flush thread on the first write.
+   */
+  FileImpl(const std::string& path, Event::Dispatcher& dispatcher, Stats::Store& stats_store,
+           std::chrono::milliseconds flush_interval_msec,
+           SharedFlushThreadSharedPtr shared_flush_thread = nullptr);
   ~FileImpl();
 
   // Filesystem::File
@@ -76,12 +119,20 @@ public:
 
 private:
   void doWrite(Buffer::Instance& buffer);
+  /**
+   * flock() fd_ with operation, retrying if interrupted. Failures are counted in lock_failed.
+   */
+  void lockFile(int operation);
   void flushThreadFunc();
+  void flushBuffered();
+  void notifyFlush();
   void open();
   void createFlushStructures();
 
   // Minimum size before the flush thread will be told to flush.
   static const uint64_t MIN_FLUSH_SIZE = 1024 * 64;
+  // Maximum number of buffer slices written by a single writev() call.
+  static const uint64_t MAX_SLICES_PER_WRITE = 256;
 
   int fd_;
   std::string path_;
@@ -89,11 +140,10 @@ private:
   // These locks are always acquired in the following order if multiple locks are held:
   //    1) write_lock_
   //    2) flush_lock_
-  //    3) file_lock_
-  Thread::BasicLockable& file_lock_; // This lock is used only by the flush thread when writing
-                                     // to disk. This is used to make sure that file blocks do
-                                     // not get interleaved by multiple processes writing to
-                                     // the same file during hot-restart.
+  // Writes to disk are additionally done while holding an exclusive flock() on fd_, so that file
+  // blocks do not get interleaved by multiple processes writing to the same file during
+  // hot-restart, or by multiple FileImpl writing to the same file in one process. Unlike a single
+  // lock shared by all files, this only serializes writers of the same file.
   std::mutex flush_lock_;            // This lock is used to prevent simulataneous flushes from
                                      // the flush thread and a syncronous flush. This protects
                                      // concurrent access to the about_to_write_buffer_, fd_,
@@ -103,6 +153,8 @@ private:
                                      // multiple threads to write to the same file at relatively
                                      // high performance. It is always local to the process.
   Thread::ThreadPtr flush_thread_;
+  SharedFlushThreadSharedPtr shared_flush_thread_;
+  bool flush_structures_created_{};
   std::condition_variable_any flush_event_;
   std::atomic<bool> flush_thread_exit_{};
   std::atomic<bool> reopen_file_{};
@@ -120,6 +172,8 @@ private:
                                                         // matter if it reached the MIN_FLUSH_SIZE
                                                         // or not.
   FileSystemStats stats_;
+
+  friend class SharedFlushThread;
 };
 
 } // namespace Filesystem
@@ -1,7 +1,10 @@
 #include "common/filter/tcp_proxy.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "envoy/buffer/buffer.h"
 #include "envoy/event/dispatcher.h"
@@ -50,7 +53,8 @@ TcpProxyConfig::TcpProxyConfig(const envoy::api::v2::filter::network::TcpProxy&
                                Server::Configuration::FactoryContext& context)
     : max_connect_attempts_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_connect_attempts, 1)),
       upstream_drain_manager_slot_(context.threadLocal().allocateSlot()),
-      shared_config_(std::make_shared<SharedConfig>(config, context)) {
+      shared_config_(std::make_shared<SharedConfig>(config, context)), runtime_(context.runtime()),
+      splice_runtime_key_(fmt::format("tcp.{}.splice_enabled", config.stat_prefix())) {
 
   upstream_drain_manager_slot_->set([](Event::Dispatcher&) {
     return ThreadLocal::ThreadLocalObjectSharedPtr(new TcpProxyUpstreamDrainManager());
@@ -73,21 +77,62 @@ TcpProxyConfig::TcpProxyConfig(const envoy::api::v2::filter::network::TcpProxy&
     routes_.emplace_back(default_route);
   }
 
+  std::vector<std::pair<std::string, std::vector<Network::Address::CidrRange>>> destination_ips;
+  std::vector<std::pair<std::string, std::vector<Network::Address::CidrRange>>> source_ips;
+  for (uint32_t i = 0; i < routes_.size(); i++) {
+    destination_ips.emplace_back(std::to_string(i), routes_[i].destination_ips_.ranges());
+    source_ips.emplace_back(std::to_string(i), routes_[i].source_ips_.ranges());
+    if (routes_[i].destination_ips_.empty()) {
+      any_destination_routes_.push_back(i);
+    }
+  }
+  destination_ips_trie_.reset(new Network::LcTrie::LcTrie(destination_ips));
+  source_ips_trie_.reset(new Network::LcTrie::LcTrie(source_ips));
+
   for (const envoy::api::v2::filter::accesslog::AccessLog& log_config : config.access_log()) {
     access_logs_.emplace_back(AccessLog::AccessLogFactory::fromProto(log_config, context));
   }
 }
 
 const std::string& TcpProxyConfig::getRouteFromEntries(Network::Connection& connection) {
-  for (const TcpProxyConfig::Route& route : routes_) {
+  // Both candidate lists are sorted, so merging them visits the routes that pass the destination
+  // IP check in configuration order.
+  const std::vector<uint32_t>& destination_matches =
+      destination_ips_trie_->getTagIndexes(*connection.localAddress());
+  auto destination_it = destination_matches.begin();
+  auto any_destination_it = any_destination_routes_.begin();
+  // Only looked up once a candidate route has source IPs.
+  const std::vector<uint32_t>* source_matches = nullptr;
+  std::vector<uint32_t>::const_iterator source_it;
+
+  while (true) {
+    uint32_t index;
+    if (destination_it != destination_matches.end() &&
+        (any_destination_it == any_destination_routes_.end() ||
+         *destination_it < *any_destination_it)) {
+      index = *destination_it++;
+    } else if (any_destination_it != any_destination_routes_.end()) {
+      index = *any_destination_it++;
+    } else {
+      break;
+    }
+    const TcpProxyConfig::Route& route = routes_[index];
+
     if (!route.source_port_ranges_.empty() &&
         !Network::Utility::portInRangeList(*connection.remoteAddress(),
                                            route.source_port_ranges_)) {
       continue;
     }
 
-    if (!route.source_ips_.empty() && !route.source_ips_.contains(*connection.remoteAddress())) {
-      continue;
+    if (!route.source_ips_.empty()) {
+      if (source_matches == nullptr) {
+        source_matches = &source_ips_trie_->getTagIndexes(*connection.remoteAddress());
+        source_it = source_matches->begin();
+      }
+      source_it = std::lower_bound(source_it, source_matches->end(), index);
+      if (source_it == source_matches->end() || *source_it != index) {
+        continue;
+      }
     }
 
     if (!route.destination_port_ranges_.empty() &&
@@ -96,11 +141,6 @@ const std::string& TcpProxyConfig::getRouteFromEntries(Network::Connection& conn
       continue;
     }
 
-    if (!route.destination_ips_.empty() &&
-        !route.destination_ips_.contains(*connection.localAddress())) {
-      continue;
-    }
-
     // if we made it past all checks, the route matches
     return route.cluster_name_;
   }
@@ -113,6 +153,10 @@ TcpProxyUpstreamDrainManager& TcpProxyConfig::drainManager() {
   return upstream_drain_manager_slot_->getTyped<TcpProxyUpstreamDrainManager>();
 }
 
+bool TcpProxyConfig::spliceEnabled() {
+  return runtime_.snapshot().featureEnabled(splice_runtime_key_, 0);
+}
+
 // TODO(ggreenway): refactor this and websocket code so that config_ is always non-null.
 TcpProxy::TcpProxy(TcpProxyConfigSharedPtr config, Upstream::ClusterManager& cluster_manager)
     : config_(config), cluster_manager_(cluster_manager), downstream_callbacks_(*this),
@@ -270,6 +314,13 @@ void TcpProxy::UpstreamCallbacks::onBytesSent() {
   }
 }
 
+void TcpProxy::UpstreamCallbacks::onSplicedBytesSent(uint64_t bytes) {
+  // Once draining, the session has already been logged.
+  if (parent_ != nullptr) {
+    parent_->request_info_.bytes_received_ += bytes;
+  }
+}
+
 void TcpProxy::UpstreamCallbacks::onIdleTimeout() {
   if (drainer_ == nullptr) {
     parent_->onIdleTimeout();
@@ -452,6 +503,10 @@ void TcpProxy::onUpstreamEvent(Network::ConnectionEvent event) {
         Upstream::Outlier::Result::SUCCESS);
     onConnectionSuccess();
 
+    if (config_ != nullptr && config_->spliceEnabled()) {
+      spliceConnections();
+    }
+
     if (config_ != nullptr && config_->idleTimeout().valid()) {
       // The idle_timer_ can be moved to a TcpProxyDrainer, so related callbacks call into
       // the UpstreamCallbacks, which has the same lifetime as the timer, and can dispatch
@@ -469,6 +524,29 @@ void TcpProxy::onUpstreamEvent(Network::ConnectionEvent event) {
   }
 }
 
+void TcpProxy::spliceConnections() {
+  // Spliced data no longer passes through onData() and onUpstreamData(), so it is counted as it is
+  // sent instead. The upstream connection can outlive this filter, hence the UpstreamCallbacks.
+  // The idle timer is reset by the bytes sent callbacks in either case. Each direction falls back
+  // to passing through the filter if it cannot be spliced.
+  Network::Connection& downstream = read_callbacks_->connection();
+  bool spliced = false;
+  if (downstream.spliceTo(*upstream_connection_)) {
+    upstream_connection_->addBytesSentCallback([upstream_callbacks = upstream_callbacks_](
+        uint64_t bytes) { upstream_callbacks->onSplicedBytesSent(bytes); });
+    spliced = true;
+  }
+  if (upstream_connection_->spliceTo(downstream)) {
+    downstream.addBytesSentCallback([this](uint64_t bytes) { request_info_.bytes_sent_ += bytes; });
+    spliced = true;
+  }
+
+  if (spliced) {
+    ENVOY_CONN_LOG(debug, "splicing to upstream connection", downstream);
+    config_->stats().downstream_cx_splice_total_.inc();
+  }
+}
+
 void TcpProxy::onIdleTimeout() {
   config_->stats().idle_timeout_.inc();
   closeUpstreamConnection();
@@ -10,6 +10,7 @@
 #include "envoy/event/timer.h"
 #include "envoy/network/connection.h"
 #include "envoy/network/filter.h"
+#include "envoy/runtime/runtime.h"
 #include "envoy/server/filter_config.h"
 #include "envoy/stats/stats_macros.h"
 #include "envoy/stats/timespan.h"
@@ -19,6 +20,7 @@
 #include "common/common/logger.h"
 #include "common/network/cidr_range.h"
 #include "common/network/filter_impl.h"
+#include "common/network/lc_trie.h"
 #include "common/network/utility.h"
 #include "common/request_info/request_info_impl.h"
 
@@ -38,6 +40,7 @@ namespace Filter {
   GAUGE  (downstream_cx_tx_bytes_buffered)                                                         \
   COUNTER(downstream_cx_total)                                                                     \
   COUNTER(downstream_cx_no_route)                                                                  \
+  COUNTER(downstream_cx_splice_total)                                                              \
   COUNTER(downstream_flow_control_paused_reading_total)                                            \
   COUNTER(downstream_flow_control_resumed_reading_total)                                           \
   COUNTER(idle_timeout)                                                                            \
@@ -91,7 +94,9 @@ public:
 
   /**
    * Find out which cluster an upstream connection should be opened to based on the
-   * parameters of a downstream connection.
+   * parameters of a downstream connection. Routes are matched in configuration order, and the
+   * first match wins. The IP lists of all routes are indexed in tries, so only the routes that
+   * contain the destination IP, or have no destination IPs, are considered.
    * @param connection supplies the parameters of the downstream connection for
    * which the proxy needs to open the corresponding upstream.
    * @return the cluster name to be used for the upstream connection.
@@ -106,6 +111,14 @@ public:
   TcpProxyUpstreamDrainManager& drainManager();
   SharedConfigSharedPtr sharedConfig() { return shared_config_; }
 
+  /**
+   * @return bool whether a new session should splice data between the downstream and upstream
+   *         connections inside the kernel, rather than passing it through the filter. This is
+   *         opt-in through the tcp.<stat_prefix>.splice_enabled runtime key, as data that is
+   *         spliced is not seen by any read filters ahead of the tcp proxy.
+   */
+  bool spliceEnabled();
+
 private:
   struct Route {
     Route(const envoy::api::v2::filter::network::TcpProxy::DeprecatedV1::TCPRoute& config);
@@ -118,10 +131,18 @@ private:
   };
 
   std::vector<Route> routes_;
+  // Tries of the destination and source IP lists of all routes. Tag i holds the ranges of
+  // routes_[i], so the tag indexes of a lookup are the matching routes, in order.
+  std::unique_ptr<Network::LcTrie::LcTrie> destination_ips_trie_;
+  std::unique_ptr<Network::LcTrie::LcTrie> source_ips_trie_;
+  // Indexes into routes_ of the routes without destination IPs, which match any destination.
+  std::vector<uint32_t> any_destination_routes_;
   std::vector<AccessLog::InstanceSharedPtr> access_logs_;
   const uint32_t max_connect_attempts_;
   ThreadLocal::SlotPtr upstream_drain_manager_slot_;
   SharedConfigSharedPtr shared_config_;
+  Runtime::Loader& runtime_;
+  const std::string splice_runtime_key_;
 };
 
 typedef std::shared_ptr<TcpProxyConfig> TcpProxyConfigSharedPtr;
@@ -168,6 +189,7 @@ public:
     Network::FilterStatus onData(Buffer::Instance& data) override;
 
     void onBytesSent();
+    void onSplicedBytesSent(uint64_t bytes);
     void onIdleTimeout();
     void drain(TcpProxyDrainer& drainer);
 
@@ -225,6 +247,7 @@ protected:
   void onIdleTimeout();
   void resetIdleTimer();
   void disableIdleTimer();
+  void spliceConnections();
 
   TcpProxyConfigSharedPtr config_;
   Upstream::ClusterManager& cluster_manager_;
@@ -28,6 +28,7 @@
 #include "common/http/date_provider.h"
 #include "common/http/user_agent.h"
 #include "common/http/websocket/ws_handler_impl.h"
+#include "common/memory/slab.h"
 #include "common/request_info/request_info_impl.h"
 #include "common/tracing/http_tracer_impl.h"
 
@@ -326,9 +327,10 @@ private:
   struct ActiveStream;
 
   /**
-   * Base class wrapper for both stream encoder and decoder filters.
+   * Base class wrapper for both stream encoder and decoder filters. Like streams, the wrappers are
+   * created and destroyed for every request, so they are allocated from the worker's slab.
    */
-  struct ActiveStreamFilterBase : public virtual StreamFilterCallbacks {
+  struct ActiveStreamFilterBase : public virtual StreamFilterCallbacks, Memory::SlabAllocated {
     ActiveStreamFilterBase(ActiveStream& parent, bool dual_filter)
         : parent_(parent), headers_continued_(false), stopped_(false), dual_filter_(dual_filter) {}
 
@@ -467,9 +469,11 @@ private:
 
   /**
    * Wraps a single active stream on the connection. These are either full request/response pairs
-   * or pushes.
+   * or pushes. Streams are allocated from the worker's slab, which takes them back when they are
+   * deferred deleted.
    */
   struct ActiveStream : LinkedObject<ActiveStream>,
+                        Memory::SlabAllocated,
                         public Event::DeferredDeletable,
                         public StreamCallbacks,
                         public StreamDecoder,
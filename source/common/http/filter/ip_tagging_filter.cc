@@ -1,15 +1,82 @@
 #include "common/http/filter/ip_tagging_filter.h"
 
+#include "envoy/common/exception.h"
+
+#include "common/common/empty_string.h"
+#include "common/http/headers.h"
+
+#include "fmt/format.h"
+
 namespace Envoy {
 namespace Http {
 
+IpTaggingFilterConfig::IpTaggingFilterConfig(const Json::Object& json_config,
+                                             const std::string& stat_prefix, Stats::Scope& scope)
+    : Json::Validator(json_config, Json::Schema::IP_TAGGING_HTTP_FILTER_SCHEMA),
+      request_type_(stringToType(json_config.getString("request_type", "both"))),
+      trie_(new Network::LcTrie::LcTrie(parseTags(json_config))),
+      stats_{ALL_IP_TAGGING_FILTER_STATS(POOL_COUNTER_PREFIX(scope, stat_prefix + "ip_tagging."))} {}
+
+std::vector<std::pair<std::string, std::vector<Network::Address::CidrRange>>>
+IpTaggingFilterConfig::parseTags(const Json::Object& json_config) {
+  std::vector<std::pair<std::string, std::vector<Network::Address::CidrRange>>> tag_data;
+  for (const Json::ObjectSharedPtr& ip_tag : json_config.getObjectArray("ip_tags", true)) {
+    std::vector<Network::Address::CidrRange> ranges;
+    for (const std::string& entry : ip_tag->getStringArray("ip_list")) {
+      // A bare address is a single host. The length is clamped to 32 for IPv4 addresses.
+      const Network::Address::CidrRange range =
+          entry.find('/') == std::string::npos ? Network::Address::CidrRange::create(entry, 128)
+                                               : Network::Address::CidrRange::create(entry);
+      if (!range.isValid()) {
+        throw EnvoyException(
+            fmt::format("invalid ip/mask combo '{}' (format is <ip>/<# mask bits>)", entry));
+      }
+      ranges.push_back(range);
+    }
+    tag_data.emplace_back(ip_tag->getString("ip_tag_name"), std::move(ranges));
+  }
+  return tag_data;
+}
+
 IpTaggingFilter::IpTaggingFilter(IpTaggingFilterConfigSharedPtr config) : config_(config) {}
 
 IpTaggingFilter::~IpTaggingFilter() {}
 
 void IpTaggingFilter::onDestroy() {}
 
-FilterHeadersStatus IpTaggingFilter::decodeHeaders(HeaderMap&, bool) {
+FilterHeadersStatus IpTaggingFilter::decodeHeaders(HeaderMap& headers, bool) {
+  const bool is_internal_request =
+      headers.EnvoyInternalRequest() &&
+      (headers.EnvoyInternalRequest()->value() ==
+       Headers::get().EnvoyInternalRequestValues.True.c_str());
+
+  // Only tags added by trusted hops are kept, so that an external client cannot claim tags of its
+  // own.
+  if (!is_internal_request) {
+    headers.removeEnvoyIpTags();
+  }
+
+  if ((is_internal_request && config_->requestType() == FilterRequestType::External) ||
+      (!is_internal_request && config_->requestType() == FilterRequestType::Internal)) {
+    return FilterHeadersStatus::Continue;
+  }
+
+  config_->stats().total_.inc();
+  const Network::Address::InstanceConstSharedPtr& remote_address =
+      callbacks_->requestInfo().downstreamRemoteAddress();
+  const std::string& tags =
+      remote_address != nullptr ? config_->trie().getTags(*remote_address) : EMPTY_STRING;
+  if (tags.empty()) {
+    config_->stats().no_hit_.inc();
+    return FilterHeadersStatus::Continue;
+  }
+
+  config_->stats().hit_.inc();
+  HeaderString& value = headers.insertEnvoyIpTags().value();
+  if (!value.empty()) {
+    value.append(",", 1);
+  }
+  value.append(tags.c_str(), tags.size());
   return FilterHeadersStatus::Continue;
 }
 
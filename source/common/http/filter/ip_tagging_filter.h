@@ -7,10 +7,12 @@
 
 #include "envoy/http/filter.h"
 #include "envoy/json/json_object.h"
+#include "envoy/stats/stats_macros.h"
 
 #include "common/common/assert.h"
 #include "common/json/config_schemas.h"
 #include "common/json/json_validator.h"
+#include "common/network/lc_trie.h"
 
 namespace Envoy {
 namespace Http {
@@ -21,15 +23,34 @@ namespace Http {
 enum class FilterRequestType { Internal, External, Both };
 
 /**
- * Configuration for the ip tagging filter.
+ * All stats for the ip tagging filter. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_IP_TAGGING_FILTER_STATS(COUNTER)                                                       \
+  COUNTER(total)                                                                                   \
+  COUNTER(hit)                                                                                     \
+  COUNTER(no_hit)
+// clang-format on
+
+/**
+ * Wrapper struct for ip tagging filter stats. @see stats_macros.h
+ */
+struct IpTaggingFilterStats {
+  ALL_IP_TAGGING_FILTER_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Configuration for the ip tagging filter. The configured ranges are compiled once into an
+ * LC-trie so that tagging a request does not depend on the number of ranges.
  */
 class IpTaggingFilterConfig : Json::Validator {
 public:
-  IpTaggingFilterConfig(const Json::Object& json_config)
-      : Json::Validator(json_config, Json::Schema::IP_TAGGING_HTTP_FILTER_SCHEMA),
-        request_type_(stringToType(json_config.getString("request_type", "both"))) {}
+  IpTaggingFilterConfig(const Json::Object& json_config, const std::string& stat_prefix,
+                        Stats::Scope& scope);
 
   FilterRequestType requestType() const { return request_type_; }
+  const Network::LcTrie::LcTrie& trie() const { return *trie_; }
+  IpTaggingFilterStats& stats() { return stats_; }
 
 private:
   static FilterRequestType stringToType(const std::string& request_type) {
@@ -43,7 +64,12 @@ private:
     }
   }
 
+  static std::vector<std::pair<std::string, std::vector<Network::Address::CidrRange>>>
+  parseTags(const Json::Object& json_config);
+
   const FilterRequestType request_type_;
+  std::unique_ptr<const Network::LcTrie::LcTrie> trie_;
+  IpTaggingFilterStats stats_;
 };
 
 typedef std::shared_ptr<IpTaggingFilterConfig> IpTaggingFilterConfigSharedPtr;
@@ -1,11 +1,15 @@
 #include "common/http/header_map_impl.h"
 
+#include <algorithm>
 #include <cstdint>
-#include <list>
+#include <cstring>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
+#include "common/common/hash.h"
 #include "common/common/utility.h"
 #include "common/singleton/const_singleton.h"
 
@@ -255,9 +259,80 @@ HeaderMapImpl::StaticLookupTable::find(const char* key) const {
   return current->cb_;
 }
 
+constexpr uint32_t HeaderMapImpl::EntryStorage::MIN_CHUNK_CAPACITY;
+constexpr uint32_t HeaderMapImpl::MIN_INDEX_CAPACITY;
+
+HeaderMapImpl::EntryStorage::EntryStorage(EntryStorage&& rhs) noexcept
+    : last_chunk_(rhs.last_chunk_), unused_(rhs.unused_), free_slots_(rhs.free_slots_) {
+  rhs.last_chunk_ = nullptr;
+  rhs.unused_ = 0;
+  rhs.free_slots_ = nullptr;
+}
+
+HeaderMapImpl::EntryStorage::~EntryStorage() { freeChunks(); }
+
+HeaderMapImpl::EntryStorage& HeaderMapImpl::EntryStorage::operator=(EntryStorage&& rhs) noexcept {
+  if (this != &rhs) {
+    freeChunks();
+    last_chunk_ = rhs.last_chunk_;
+    unused_ = rhs.unused_;
+    free_slots_ = rhs.free_slots_;
+    rhs.last_chunk_ = nullptr;
+    rhs.unused_ = 0;
+    rhs.free_slots_ = nullptr;
+  }
+  return *this;
+}
+
+void HeaderMapImpl::EntryStorage::freeChunks() {
+  while (last_chunk_ != nullptr) {
+    Chunk* previous = last_chunk_->previous_;
+    Memory::Slab::free(last_chunk_, chunkBytes(last_chunk_->capacity_));
+    last_chunk_ = previous;
+  }
+  unused_ = 0;
+  free_slots_ = nullptr;
+}
+
+void HeaderMapImpl::EntryStorage::destroy(HeaderEntryImpl* entry) {
+  entry->~HeaderEntryImpl();
+  Slot* slot = reinterpret_cast<Slot*>(entry);
+  slot->next_free_ = free_slots_;
+  free_slots_ = slot;
+}
+
+void HeaderMapImpl::EntryStorage::reserve(uint32_t size) {
+  if (unused_ < size) {
+    addChunk(std::max(size, MIN_CHUNK_CAPACITY));
+  }
+}
+
+void* HeaderMapImpl::EntryStorage::allocate() {
+  if (free_slots_ != nullptr) {
+    Slot* slot = free_slots_;
+    free_slots_ = slot->next_free_;
+    return slot;
+  }
+
+  if (unused_ == 0) {
+    addChunk(last_chunk_ == nullptr ? MIN_CHUNK_CAPACITY : last_chunk_->capacity_ * 2);
+  }
+  return &last_chunk_->slots()[last_chunk_->capacity_ - unused_--];
+}
+
+void HeaderMapImpl::EntryStorage::addChunk(uint32_t capacity) {
+  // Any slots left in the previous chunk stay unused until the map is destroyed.
+  Chunk* chunk = static_cast<Chunk*>(Memory::Slab::allocate(chunkBytes(capacity)));
+  chunk->previous_ = last_chunk_;
+  chunk->capacity_ = capacity;
+  last_chunk_ = chunk;
+  unused_ = capacity;
+}
+
 HeaderMapImpl::HeaderMapImpl() { memset(&inline_headers_, 0, sizeof(inline_headers_)); }
 
 HeaderMapImpl::HeaderMapImpl(const HeaderMap& rhs) : HeaderMapImpl() {
+  storage_.reserve(rhs.size());
   rhs.iterate(
       [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
         // TODO(mattklein123) PERF: Avoid copying here is not necessary.
@@ -273,6 +348,12 @@ HeaderMapImpl::HeaderMapImpl(const HeaderMap& rhs) : HeaderMapImpl() {
       this);
 }
 
+// The copy rebuilds the entries, the O(1) header pointers and the index from rhs' headers.
+HeaderMapImpl::HeaderMapImpl(const HeaderMapImpl& rhs)
+    : HeaderMapImpl(static_cast<const HeaderMap&>(rhs)) {}
+
+HeaderMapImpl::HeaderMapImpl(HeaderMapImpl&& rhs) noexcept : HeaderMapImpl() { moveFrom(rhs); }
+
 HeaderMapImpl::HeaderMapImpl(
     const std::initializer_list<std::pair<LowerCaseString, std::string>>& values)
     : HeaderMapImpl() {
@@ -285,12 +366,61 @@ HeaderMapImpl::HeaderMapImpl(
   }
 }
 
+HeaderMapImpl::~HeaderMapImpl() { destroyEntries(); }
+
+HeaderMapImpl& HeaderMapImpl::operator=(const HeaderMapImpl& rhs) {
+  if (this != &rhs) {
+    *this = HeaderMapImpl(rhs);
+  }
+  return *this;
+}
+
+HeaderMapImpl& HeaderMapImpl::operator=(HeaderMapImpl&& rhs) noexcept {
+  if (this != &rhs) {
+    destroyEntries();
+    moveFrom(rhs);
+  }
+  return *this;
+}
+
+void HeaderMapImpl::destroyEntries() {
+  // The storage frees the chunks without looking at their slots, so entries are destroyed here.
+  HeaderEntryImpl* entry = head_;
+  while (entry != nullptr) {
+    HeaderEntryImpl* next = entry->next_;
+    entry->~HeaderEntryImpl();
+    entry = next;
+  }
+  head_ = nullptr;
+  tail_ = nullptr;
+  size_ = 0;
+}
+
+void HeaderMapImpl::moveFrom(HeaderMapImpl& rhs) {
+  // Entries never move within their chunks, so the O(1) header pointers, the links and the index
+  // stay valid when the chunks change hands.
+  inline_headers_ = rhs.inline_headers_;
+  storage_ = std::move(rhs.storage_);
+  head_ = rhs.head_;
+  tail_ = rhs.tail_;
+  size_ = rhs.size_;
+  index_ = std::move(rhs.index_);
+  indexed_ = rhs.indexed_;
+
+  memset(&rhs.inline_headers_, 0, sizeof(rhs.inline_headers_));
+  rhs.head_ = nullptr;
+  rhs.tail_ = nullptr;
+  rhs.size_ = 0;
+  rhs.index_.clear();
+  rhs.indexed_ = 0;
+}
+
 bool HeaderMapImpl::operator==(const HeaderMapImpl& rhs) const {
   if (size() != rhs.size()) {
     return false;
   }
 
-  for (auto i = headers_.begin(), j = rhs.headers_.begin(); i != headers_.end(); ++i, ++j) {
+  for (const HeaderEntryImpl *i = head_, *j = rhs.head_; i != nullptr; i = i->next_, j = j->next_) {
     if (i->key() != j->key().c_str() || i->value() != j->value().c_str()) {
       return false;
     }
@@ -311,9 +441,9 @@ void HeaderMapImpl::insertByKey(HeaderString&& key, HeaderString&& value) {
     StaticLookupResponse ref_lookup_response = cb(*this);
     maybeCreateInline(ref_lookup_response.entry_, *ref_lookup_response.key_, std::move(value));
   } else {
-    std::list<HeaderEntryImpl>::iterator i =
-        headers_.emplace(headers_.end(), std::move(key), std::move(value));
-    i->entry_ = i;
+    HeaderEntryImpl* entry = storage_.create(std::move(key), std::move(value));
+    appendEntry(*entry);
+    indexInsert(*entry);
   }
 }
 
@@ -321,6 +451,26 @@ void HeaderMapImpl::addViaMove(HeaderString&& key, HeaderString&& value) {
   insertByKey(std::move(key), std::move(value));
 }
 
+void HeaderMapImpl::addViaCopy(const char* key, uint32_t key_size, const char* value,
+                               uint32_t value_size) {
+  ASSERT(key[key_size] == 0);
+  StaticLookupEntry::EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key);
+  if (cb) {
+    // As in insertByKey(), a repeated O(1) header is dropped.
+    StaticLookupResponse ref_lookup_response = cb(*this);
+    if (*ref_lookup_response.entry_ == nullptr) {
+      maybeCreateInline(ref_lookup_response.entry_, *ref_lookup_response.key_)
+          .value_.setCopy(value, value_size);
+    }
+  } else {
+    HeaderEntryImpl* entry = storage_.create();
+    entry->key_.setCopy(key, key_size);
+    entry->value_.setCopy(value, value_size);
+    appendEntry(*entry);
+    indexInsert(*entry);
+  }
+}
+
 void HeaderMapImpl::addReference(const LowerCaseString& key, const std::string& value) {
   HeaderString ref_key(key);
   HeaderString ref_value(value);
@@ -381,35 +531,37 @@ void HeaderMapImpl::setReferenceKey(const LowerCaseString& key, const std::strin
 
 uint64_t HeaderMapImpl::byteSize() const {
   uint64_t byte_size = 0;
-  for (const HeaderEntryImpl& header : headers_) {
-    byte_size += header.key().size();
-    byte_size += header.value().size();
+  for (const HeaderEntryImpl* header = head_; header != nullptr; header = header->next_) {
+    byte_size += header->key().size();
+    byte_size += header->value().size();
   }
 
   return byte_size;
 }
 
 const HeaderEntry* HeaderMapImpl::get(const LowerCaseString& key) const {
-  for (const HeaderEntryImpl& header : headers_) {
-    if (header.key() == key.get().c_str()) {
-      return &header;
-    }
+  StaticLookupEntry::EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.get().c_str());
+  if (cb) {
+    // See lookup() for why the const_cast is needed. The legacy host header is looked up through
+    // the trie too, but is stored as :authority, which get() does not consider a match.
+    StaticLookupResponse ref_lookup_response = cb(const_cast<HeaderMapImpl&>(*this));
+    return *ref_lookup_response.key_ == key ? *ref_lookup_response.entry_ : nullptr;
   }
 
-  return nullptr;
+  return indexFind(key);
 }
 
 void HeaderMapImpl::iterate(ConstIterateCb cb, void* context) const {
-  for (const HeaderEntryImpl& header : headers_) {
-    if (cb(header, context) == HeaderMap::Iterate::Break) {
+  for (const HeaderEntryImpl* header = head_; header != nullptr; header = header->next_) {
+    if (cb(*header, context) == HeaderMap::Iterate::Break) {
       break;
     }
   }
 }
 
 void HeaderMapImpl::iterateReverse(ConstIterateCb cb, void* context) const {
-  for (auto it = headers_.rbegin(); it != headers_.rend(); it++) {
-    if (cb(*it, context) == HeaderMap::Iterate::Break) {
+  for (const HeaderEntryImpl* header = tail_; header != nullptr; header = header->prev_) {
+    if (cb(*header, context) == HeaderMap::Iterate::Break) {
       break;
     }
   }
@@ -444,13 +596,7 @@ void HeaderMapImpl::remove(const LowerCaseString& key) {
     StaticLookupResponse ref_lookup_response = cb(*this);
     removeInline(ref_lookup_response.entry_);
   } else {
-    for (auto i = headers_.begin(); i != headers_.end();) {
-      if (i->key() == key.get().c_str()) {
-        i = headers_.erase(i);
-      } else {
-        ++i;
-      }
-    }
+    indexRemoveAll(key);
   }
 }
 
@@ -460,9 +606,8 @@ HeaderMapImpl::HeaderEntryImpl& HeaderMapImpl::maybeCreateInline(HeaderEntryImpl
     return **entry;
   }
 
-  std::list<HeaderEntryImpl>::iterator i = headers_.emplace(headers_.end(), key);
-  i->entry_ = i;
-  *entry = &(*i);
+  *entry = storage_.create(key);
+  appendEntry(**entry);
   return **entry;
 }
 
@@ -474,9 +619,8 @@ HeaderMapImpl::HeaderEntryImpl& HeaderMapImpl::maybeCreateInline(HeaderEntryImpl
     return **entry;
   }
 
-  std::list<HeaderEntryImpl>::iterator i = headers_.emplace(headers_.end(), key, std::move(value));
-  i->entry_ = i;
-  *entry = &(*i);
+  *entry = storage_.create(key, std::move(value));
+  appendEntry(**entry);
   return **entry;
 }
 
@@ -487,7 +631,151 @@ void HeaderMapImpl::removeInline(HeaderEntryImpl** ptr_to_entry) {
 
   HeaderEntryImpl* entry = *ptr_to_entry;
   *ptr_to_entry = nullptr;
-  headers_.erase(entry->entry_);
+  removeEntry(*entry);
+}
+
+void HeaderMapImpl::appendEntry(HeaderEntryImpl& entry) {
+  entry.prev_ = tail_;
+  if (tail_ != nullptr) {
+    tail_->next_ = &entry;
+  } else {
+    head_ = &entry;
+  }
+  tail_ = &entry;
+  size_++;
+}
+
+void HeaderMapImpl::removeEntry(HeaderEntryImpl& entry) {
+  if (entry.prev_ != nullptr) {
+    entry.prev_->next_ = entry.next_;
+  } else {
+    head_ = entry.next_;
+  }
+  if (entry.next_ != nullptr) {
+    entry.next_->prev_ = entry.prev_;
+  } else {
+    tail_ = entry.prev_;
+  }
+  size_--;
+  storage_.destroy(&entry);
+}
+
+namespace {
+
+bool keyEquals(const HeaderString& key, const char* other, size_t other_size) {
+  return key.size() == other_size && memcmp(key.c_str(), other, other_size) == 0;
+}
+
+} // namespace
+
+uint32_t HeaderMapImpl::hashKey(const char* key, size_t size) {
+  return HashUtil::xxHash64(absl::string_view(key, size));
+}
+
+void HeaderMapImpl::indexInsert(HeaderEntryImpl& entry) {
+  if ((indexed_ + 1) * 2 > index_.size()) {
+    indexReserve(indexed_ + 1);
+  }
+
+  const uint32_t hash = hashKey(entry.key_.c_str(), entry.key_.size());
+  const size_t mask = index_.size() - 1;
+  for (size_t i = hash & mask;; i = (i + 1) & mask) {
+    IndexSlot& slot = index_[i];
+    if (slot.entry_ == nullptr) {
+      slot = {&entry, hash};
+      indexed_++;
+      return;
+    }
+
+    if (slot.hash_ == hash && keyEquals(slot.entry_->key_, entry.key_.c_str(), entry.key_.size())) {
+      // Entries with the same key are chained in insertion order.
+      HeaderEntryImpl* last = slot.entry_;
+      while (last->next_same_key_ != nullptr) {
+        last = last->next_same_key_;
+      }
+      last->next_same_key_ = &entry;
+      return;
+    }
+  }
+}
+
+HeaderMapImpl::HeaderEntryImpl* HeaderMapImpl::indexFind(const LowerCaseString& key) const {
+  if (index_.empty()) {
+    return nullptr;
+  }
+
+  const uint32_t hash = hashKey(key.get().c_str(), key.get().size());
+  const size_t mask = index_.size() - 1;
+  for (size_t i = hash & mask; index_[i].entry_ != nullptr; i = (i + 1) & mask) {
+    if (index_[i].hash_ == hash &&
+        keyEquals(index_[i].entry_->key_, key.get().c_str(), key.get().size())) {
+      return index_[i].entry_;
+    }
+  }
+
+  return nullptr;
+}
+
+void HeaderMapImpl::indexRemoveAll(const LowerCaseString& key) {
+  if (index_.empty()) {
+    return;
+  }
+
+  const uint32_t hash = hashKey(key.get().c_str(), key.get().size());
+  const size_t mask = index_.size() - 1;
+  size_t hole = hash & mask;
+  for (; index_[hole].entry_ != nullptr; hole = (hole + 1) & mask) {
+    if (index_[hole].hash_ == hash &&
+        keyEquals(index_[hole].entry_->key_, key.get().c_str(), key.get().size())) {
+      break;
+    }
+  }
+  HeaderEntryImpl* entry = index_[hole].entry_;
+  if (entry == nullptr) {
+    return;
+  }
+
+  while (entry != nullptr) {
+    HeaderEntryImpl* next = entry->next_same_key_;
+    removeEntry(*entry);
+    entry = next;
+  }
+
+  // Fill the hole by moving back any later slot in the probe sequence that may be moved to it
+  // without passing the slot that its hash selects, so that no tombstones are needed.
+  for (size_t i = (hole + 1) & mask; index_[i].entry_ != nullptr; i = (i + 1) & mask) {
+    const size_t home = index_[i].hash_ & mask;
+    if (((i - home) & mask) >= ((i - hole) & mask)) {
+      index_[hole] = index_[i];
+      hole = i;
+    }
+  }
+  index_[hole].entry_ = nullptr;
+  indexed_--;
+}
+
+void HeaderMapImpl::indexReserve(uint32_t size) {
+  size_t capacity = MIN_INDEX_CAPACITY;
+  while (capacity < size * 2) {
+    capacity *= 2;
+  }
+  if (capacity <= index_.size()) {
+    return;
+  }
+
+  std::vector<IndexSlot> old_index(capacity, IndexSlot{nullptr, 0});
+  old_index.swap(index_);
+  const size_t mask = capacity - 1;
+  for (const IndexSlot& old_slot : old_index) {
+    if (old_slot.entry_ == nullptr) {
+      continue;
+    }
+    size_t i = old_slot.hash_ & mask;
+    while (index_[i].entry_ != nullptr) {
+      i = (i + 1) & mask;
+    }
+    index_[i] = old_slot;
+  }
 }
 
 } // namespace Http
@@ -2,14 +2,18 @@
 
 #include <array>
 #include <cstdint>
-#include <list>
 #include <memory>
+#include <new>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "envoy/http/header_map.h"
 
 #include "common/common/non_copyable.h"
 #include "common/http/headers.h"
+#include "common/memory/slab.h"
 
 namespace Envoy {
 namespace Http {
@@ -33,13 +37,24 @@ public:
  * headers are added to the map, we do a hash lookup to see if it's one of the O(1) headers.
  * If it is, we store a reference to it that can be accessed later directly. Most high performance
  * paths use O(1) direct access. In general, we try to copy as little as possible and allocate as
- * little as possible in any of the paths.
+ * little as possible in any of the paths. Maps themselves are allocated with Memory::Slab, as every
+ * request creates several of them.
+ *
+ * Entries live in a few contiguous chunks rather than in a node per header, and are linked in
+ * insertion order. Headers that aren't O(1) headers are found through an open addressed hash
+ * index rather than by scanning all headers.
  */
-class HeaderMapImpl : public HeaderMap {
+class HeaderMapImpl : public HeaderMap, public Memory::SlabAllocated {
 public:
   HeaderMapImpl();
   HeaderMapImpl(const std::initializer_list<std::pair<LowerCaseString, std::string>>& values);
   HeaderMapImpl(const HeaderMap& rhs);
+  HeaderMapImpl(const HeaderMapImpl& rhs);
+  HeaderMapImpl(HeaderMapImpl&& rhs) noexcept;
+  ~HeaderMapImpl();
+
+  HeaderMapImpl& operator=(const HeaderMapImpl& rhs);
+  HeaderMapImpl& operator=(HeaderMapImpl&& rhs) noexcept;
 
   /**
    * Add a header via full move. This is the expected high performance paths for codecs populating
@@ -47,6 +62,17 @@ public:
    */
   void addViaMove(HeaderString&& key, HeaderString&& value);
 
+  /**
+   * Add a header by copying the key and value straight into the map's entry. This is the expected
+   * high performance path for codecs whose parser owns the bytes of each header, as the value is
+   * copied once and the key of an O(1) header isn't copied at all.
+   * @param key supplies the lower case key, which must be null terminated.
+   * @param key_size supplies the size of the key, not including the null terminator.
+   * @param value supplies the value.
+   * @param value_size supplies the size of the value.
+   */
+  void addViaCopy(const char* key, uint32_t key_size, const char* value, uint32_t value_size);
+
   /**
    * For testing. Equality is based on equality of the backing list. This is an exact match
    * comparison (order matters).
@@ -68,10 +94,11 @@ public:
   void iterateReverse(ConstIterateCb cb, void* context) const override;
   Lookup lookup(const LowerCaseString& key, const HeaderEntry** entry) const override;
   void remove(const LowerCaseString& key) override;
-  size_t size() const override { return headers_.size(); }
+  size_t size() const override { return size_; }
 
 protected:
   struct HeaderEntryImpl : public HeaderEntry, NonCopyable {
+    HeaderEntryImpl() {}
     HeaderEntryImpl(const LowerCaseString& key);
     HeaderEntryImpl(const LowerCaseString& key, HeaderString&& value);
     HeaderEntryImpl(HeaderString&& key, HeaderString&& value);
@@ -87,7 +114,81 @@ protected:
 
     HeaderString key_;
     HeaderString value_;
-    std::list<HeaderEntryImpl>::iterator entry_;
+    // Neighbours in insertion order.
+    HeaderEntryImpl* prev_{};
+    HeaderEntryImpl* next_{};
+    // The next entry with the same key, if the entry is in the hash index.
+    HeaderEntryImpl* next_same_key_{};
+  };
+
+  /**
+   * Storage for entries in chunks that double in size. Chunks never move, so entries keep their
+   * addresses, and the slots of destroyed entries are reused.
+   */
+  class EntryStorage : NonCopyable {
+  public:
+    EntryStorage() {}
+    EntryStorage(EntryStorage&& rhs) noexcept;
+    ~EntryStorage();
+
+    /**
+     * Take the chunks of rhs, which is left empty. Any entries in this storage must have been
+     * destroyed.
+     */
+    EntryStorage& operator=(EntryStorage&& rhs) noexcept;
+
+    /**
+     * Construct an entry in a free slot.
+     */
+    template <class... Args> HeaderEntryImpl* create(Args&&... args) {
+      return new (allocate()) HeaderEntryImpl(std::forward<Args>(args)...);
+    }
+
+    /**
+     * Destroy an entry, freeing its slot.
+     */
+    void destroy(HeaderEntryImpl* entry);
+
+    /**
+     * Make room for at least size more entries without adding another chunk.
+     */
+    void reserve(uint32_t size);
+
+  private:
+    union Slot {
+      Slot* next_free_;
+      std::aligned_storage<sizeof(HeaderEntryImpl), alignof(HeaderEntryImpl)>::type entry_;
+    };
+
+    // Chunks are allocated with Memory::Slab, and their slots follow the chunk header.
+    struct Chunk {
+      Slot* slots() { return reinterpret_cast<Slot*>(this + 1); }
+
+      Chunk* previous_;
+      uint32_t capacity_;
+    };
+    static_assert(sizeof(Chunk) % alignof(Slot) == 0, "chunk header misaligns slots");
+
+    static size_t chunkBytes(uint32_t capacity) { return sizeof(Chunk) + capacity * sizeof(Slot); }
+    void* allocate();
+    void freeChunks();
+    void addChunk(uint32_t capacity);
+
+    static constexpr uint32_t MIN_CHUNK_CAPACITY = 4;
+
+    Chunk* last_chunk_{};
+    // Slots at the end of the last chunk that have never been used.
+    uint32_t unused_{};
+    Slot* free_slots_{};
+  };
+
+  /**
+   * A slot of the hash index, which points to the first entry with a key. The low bits of the hash
+   * select the first slot to probe, and the full hash is kept to skip most key compares.
+   */
+  struct IndexSlot {
+    HeaderEntryImpl* entry_;
+    uint32_t hash_;
   };
 
   struct StaticLookupResponse {
@@ -118,14 +219,32 @@ protected:
     ALL_INLINE_HEADERS(DEFINE_INLINE_HEADER_STRUCT)
   };
 
+  void destroyEntries();
+  void moveFrom(HeaderMapImpl& rhs);
   void insertByKey(HeaderString&& key, HeaderString&& value);
   HeaderEntryImpl& maybeCreateInline(HeaderEntryImpl** entry, const LowerCaseString& key);
   HeaderEntryImpl& maybeCreateInline(HeaderEntryImpl** entry, const LowerCaseString& key,
                                      HeaderString&& value);
   void removeInline(HeaderEntryImpl** entry);
+  void appendEntry(HeaderEntryImpl& entry);
+  void removeEntry(HeaderEntryImpl& entry);
+  static uint32_t hashKey(const char* key, size_t size);
+  void indexInsert(HeaderEntryImpl& entry);
+  HeaderEntryImpl* indexFind(const LowerCaseString& key) const;
+  void indexRemoveAll(const LowerCaseString& key);
+  void indexReserve(uint32_t size);
+
+  static constexpr uint32_t MIN_INDEX_CAPACITY = 16;
 
   AllInlineHeaders inline_headers_;
-  std::list<HeaderEntryImpl> headers_;
+  EntryStorage storage_;
+  HeaderEntryImpl* head_{};
+  HeaderEntryImpl* tail_{};
+  uint32_t size_{};
+  // Open addressed with linear probing, and kept at most half full. Empty until the first header
+  // that isn't an O(1) header is added.
+  std::vector<IndexSlot> index_;
+  uint32_t indexed_{};
 
   ALL_INLINE_HEADERS(DEFINE_INLINE_HEADER_FUNCS)
 };
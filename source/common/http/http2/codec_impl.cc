@@ -1,6 +1,7 @@
 #include "common/http/http2/codec_impl.h"
 
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <vector>
 
@@ -75,11 +76,15 @@ static void insertHeader(std::vector<nghttp2_nv>& headers, const HeaderEntry& he
                      header.value().size(), flags});
 }
 
-void ConnectionImpl::StreamImpl::buildHeaders(std::vector<nghttp2_nv>& final_headers,
-                                              const HeaderMap& headers) {
+const std::vector<nghttp2_nv>& ConnectionImpl::buildHeaders(const HeaderMap& headers) {
+  // nghttp2 copies the header list when a frame is submitted, so the same vector is reused for
+  // every frame that the connection encodes rather than allocating one per frame.
+  std::vector<nghttp2_nv>& final_headers = final_headers_;
+  final_headers.clear();
+  final_headers.reserve(headers.size());
+
   // nghttp2 requires that all ':' headers come before all other headers. To avoid making higher
   // layers understand that we do two passes here to build the final header list to encode.
-  final_headers.reserve(headers.size());
   headers.iterate(
       [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
         std::vector<nghttp2_nv>* final_headers = static_cast<std::vector<nghttp2_nv>*>(context);
@@ -99,11 +104,12 @@ void ConnectionImpl::StreamImpl::buildHeaders(std::vector<nghttp2_nv>& final_hea
         return HeaderMap::Iterate::Continue;
       },
       &final_headers);
+
+  return final_headers;
 }
 
 void ConnectionImpl::StreamImpl::encodeHeaders(const HeaderMap& headers, bool end_stream) {
-  std::vector<nghttp2_nv> final_headers;
-  buildHeaders(final_headers, headers);
+  const std::vector<nghttp2_nv>& final_headers = parent_.buildHeaders(headers);
 
   nghttp2_data_provider provider;
   if (!end_stream) {
@@ -178,15 +184,21 @@ void ConnectionImpl::StreamImpl::pendingSendBufferLowWatermark() {
   runLowWatermarkCallbacks();
 }
 
-void ConnectionImpl::StreamImpl::saveHeader(HeaderString&& name, HeaderString&& value) {
-  if (!Utility::reconstituteCrumbledCookies(name, value, cookies_)) {
-    headers_->addViaMove(std::move(name), std::move(value));
+void ConnectionImpl::StreamImpl::saveHeader(const char* name, uint32_t name_length,
+                                            const char* value, uint32_t value_length) {
+  const LowerCaseString& cookie = Headers::get().Cookie;
+  if (name_length == cookie.get().size() && memcmp(name, cookie.get().c_str(), name_length) == 0) {
+    HeaderString key(cookie);
+    HeaderString cookie_value;
+    cookie_value.setCopy(value, value_length);
+    Utility::reconstituteCrumbledCookies(key, cookie_value, cookies_);
+  } else {
+    headers_->addViaCopy(name, name_length, value, value_length);
   }
 }
 
 void ConnectionImpl::StreamImpl::submitTrailers(const HeaderMap& trailers) {
-  std::vector<nghttp2_nv> final_headers;
-  buildHeaders(final_headers, trailers);
+  const std::vector<nghttp2_nv>& final_headers = parent_.buildHeaders(trailers);
   int rc =
       nghttp2_submit_trailer(parent_.session_, stream_id_, &final_headers[0], final_headers.size());
   ASSERT(rc == 0);
@@ -380,8 +392,7 @@ int ConnectionImpl::onFrameReceived(const nghttp2_frame* frame) {
                                                 Headers::get().ExpectValues._100Continue.c_str())) {
       // Deal with expect: 100-continue here since higher layers are never going to do anything
       // other than say to continue so that we can respond before request complete if necessary.
-      std::vector<nghttp2_nv> final_headers;
-      StreamImpl::buildHeaders(final_headers, *CONTINUE_HEADER);
+      const std::vector<nghttp2_nv>& final_headers = buildHeaders(*CONTINUE_HEADER);
       int rc = nghttp2_submit_headers(session_, 0, stream->stream_id_, nullptr, &final_headers[0],
                                       final_headers.size(), nullptr);
       ASSERT(rc == 0);
@@ -534,8 +545,8 @@ int ConnectionImpl::onStreamClose(int32_t stream_id, uint32_t error_code) {
   return 0;
 }
 
-int ConnectionImpl::saveHeader(const nghttp2_frame* frame, HeaderString&& name,
-                               HeaderString&& value) {
+int ConnectionImpl::saveHeader(const nghttp2_frame* frame, const char* name,
+                               uint32_t name_length, const char* value, uint32_t value_length) {
   StreamImpl* stream = getStream(frame->hd.stream_id);
   if (!stream) {
     // We have seen 1 or 2 crashes where we get a headers callback but there is no associated
@@ -548,7 +559,7 @@ int ConnectionImpl::saveHeader(const nghttp2_frame* frame, HeaderString&& name,
     return 0;
   }
 
-  stream->saveHeader(std::move(name), std::move(value));
+  stream->saveHeader(name, name_length, value, value_length);
   if (stream->headers_->byteSize() > StreamImpl::MAX_HEADER_SIZE) {
     // This will cause the library to reset/close the stream.
     stats_.header_overflow_.inc();
@@ -681,14 +692,11 @@ ConnectionImpl::Http2Callbacks::Http2Callbacks() {
       callbacks_,
       [](nghttp2_session*, const nghttp2_frame* frame, const uint8_t* raw_name, size_t name_length,
          const uint8_t* raw_value, size_t value_length, uint8_t, void* user_data) -> int {
-
-        // TODO PERF: Can reference count here to avoid copies.
-        HeaderString name;
-        name.setCopy(reinterpret_cast<const char*>(raw_name), name_length);
-        HeaderString value;
-        value.setCopy(reinterpret_cast<const char*>(raw_value), value_length);
-        return static_cast<ConnectionImpl*>(user_data)->onHeader(frame, std::move(name),
-                                                                 std::move(value));
+        // nghttp2 null terminates both the name and the value. The header map copies them straight
+        // into its entry.
+        return static_cast<ConnectionImpl*>(user_data)->onHeader(
+            frame, reinterpret_cast<const char*>(raw_name), name_length,
+            reinterpret_cast<const char*>(raw_value), value_length);
       });
 
   nghttp2_session_callbacks_set_on_data_chunk_recv_callback(
@@ -778,12 +786,13 @@ int ClientConnectionImpl::onBeginHeaders(const nghttp2_frame* frame) {
   return 0;
 }
 
-int ClientConnectionImpl::onHeader(const nghttp2_frame* frame, HeaderString&& name,
-                                   HeaderString&& value) {
+int ClientConnectionImpl::onHeader(const nghttp2_frame* frame, const char* name,
+                                   uint32_t name_length, const char* value,
+                                   uint32_t value_length) {
   // The client code explicitly does not currently suport push promise.
   ASSERT(frame->hd.type == NGHTTP2_HEADERS);
   ASSERT(frame->headers.cat == NGHTTP2_HCAT_RESPONSE || frame->headers.cat == NGHTTP2_HCAT_HEADERS);
-  return saveHeader(frame, std::move(name), std::move(value));
+  return saveHeader(frame, name, name_length, value, value_length);
 }
 
 ServerConnectionImpl::ServerConnectionImpl(Network::Connection& connection,
@@ -820,12 +829,13 @@ int ServerConnectionImpl::onBeginHeaders(const nghttp2_frame* frame) {
   return 0;
 }
 
-int ServerConnectionImpl::onHeader(const nghttp2_frame* frame, HeaderString&& name,
-                                   HeaderString&& value) {
+int ServerConnectionImpl::onHeader(const nghttp2_frame* frame, const char* name,
+                                   uint32_t name_length, const char* value,
+                                   uint32_t value_length) {
   // For a server connection, we should never get push promise frames.
   ASSERT(frame->hd.type == NGHTTP2_HEADERS);
   ASSERT(frame->headers.cat == NGHTTP2_HCAT_REQUEST || frame->headers.cat == NGHTTP2_HCAT_HEADERS);
-  return saveHeader(frame, std::move(name), std::move(value));
+  return saveHeader(frame, name, name_length, value, value_length);
 }
 
 } // namespace Http2
@@ -140,8 +140,8 @@ protected:
     ssize_t onDataSourceRead(uint64_t length, uint32_t* data_flags);
     int onDataSourceSend(const uint8_t* framehd, size_t length);
     void resetStreamWorker(StreamResetReason reason);
-    static void buildHeaders(std::vector<nghttp2_nv>& final_headers, const HeaderMap& headers);
-    void saveHeader(HeaderString&& name, HeaderString&& value);
+    void saveHeader(const char* name, uint32_t name_length, const char* value,
+                    uint32_t value_length);
     virtual void submitHeaders(const std::vector<nghttp2_nv>& final_headers,
                                nghttp2_data_provider* provider) PURE;
     void submitTrailers(const HeaderMap& trailers);
@@ -229,7 +229,13 @@ protected:
 
   ConnectionImpl* base() { return this; }
   StreamImpl* getStream(int32_t stream_id);
-  int saveHeader(const nghttp2_frame* frame, HeaderString&& name, HeaderString&& value);
+  /**
+   * Build the header list to submit to nghttp2 for a header map. The list points into the map, and
+   * is only valid until the next call.
+   */
+  const std::vector<nghttp2_nv>& buildHeaders(const HeaderMap& headers);
+  int saveHeader(const nghttp2_frame* frame, const char* name, uint32_t name_length,
+                 const char* value, uint32_t value_length);
   void sendPendingFrames();
   void sendSettings(const Http2Settings& http2_settings, bool disable_push);
 
@@ -248,13 +254,16 @@ private:
   int onData(int32_t stream_id, const uint8_t* data, size_t len);
   int onFrameReceived(const nghttp2_frame* frame);
   int onFrameSend(const nghttp2_frame* frame);
-  virtual int onHeader(const nghttp2_frame* frame, HeaderString&& name, HeaderString&& value) PURE;
+  virtual int onHeader(const nghttp2_frame* frame, const char* name, uint32_t name_length,
+                       const char* value, uint32_t value_length) PURE;
   int onInvalidFrame(int error_code);
   ssize_t onSend(const uint8_t* data, size_t length);
   int onStreamClose(int32_t stream_id, uint32_t error_code);
 
   static const std::unique_ptr<const Http::HeaderMap> CONTINUE_HEADER;
 
+  std::vector<nghttp2_nv> final_headers_;
+
   bool dispatching_ : 1;
   bool raised_goaway_ : 1;
   bool pending_deferred_reset_ : 1;
@@ -275,7 +284,8 @@ private:
   // ConnectionImpl
   ConnectionCallbacks& callbacks() override { return callbacks_; }
   int onBeginHeaders(const nghttp2_frame* frame) override;
-  int onHeader(const nghttp2_frame* frame, HeaderString&& name, HeaderString&& value) override;
+  int onHeader(const nghttp2_frame* frame, const char* name, uint32_t name_length,
+               const char* value, uint32_t value_length) override;
 
   Http::ConnectionCallbacks& callbacks_;
 };
@@ -292,7 +302,8 @@ private:
   // ConnectionImpl
   ConnectionCallbacks& callbacks() override { return callbacks_; }
   int onBeginHeaders(const nghttp2_frame* frame) override;
-  int onHeader(const nghttp2_frame* frame, HeaderString&& name, HeaderString&& value) override;
+  int onHeader(const nghttp2_frame* frame, const char* name, uint32_t name_length,
+               const char* value, uint32_t value_length) override;
 
   ServerConnectionCallbacks& callbacks_;
 };
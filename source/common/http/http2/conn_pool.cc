@@ -1,6 +1,8 @@
 #include "common/http/http2/conn_pool.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <vector>
 
 #include "envoy/event/dispatcher.h"
 #include "envoy/event/timer.h"
@@ -8,23 +10,30 @@
 
 #include "common/http/http2/codec_impl.h"
 #include "common/network/utility.h"
+#include "common/runtime/key_registry.h"
 #include "common/upstream/upstream_impl.h"
 
 namespace Envoy {
 namespace Http {
 namespace Http2 {
 
+static const Runtime::Key RuntimeMaxConnectionsPerHost =
+    Runtime::KeyRegistry::intern("upstream.http2.max_connections_per_host");
+static const Runtime::Key RuntimeConnectionStreamThreshold =
+    Runtime::KeyRegistry::intern("upstream.http2.connection_stream_threshold");
+
 ConnPoolImpl::ConnPoolImpl(Event::Dispatcher& dispatcher, Upstream::HostConstSharedPtr host,
                            Upstream::ResourcePriority priority)
     : dispatcher_(dispatcher), host_(host), priority_(priority) {}
 
 ConnPoolImpl::~ConnPoolImpl() {
-  if (primary_client_) {
-    primary_client_->client_->close();
+  // Closing a client removes it from its list.
+  while (!active_clients_.empty()) {
+    active_clients_.front()->client_->close();
   }
 
-  if (draining_client_) {
-    draining_client_->client_->close();
+  while (!draining_clients_.empty()) {
+    draining_clients_.front()->client_->close();
   }
 
   // Make sure all clients are destroyed before we are destroyed.
@@ -32,8 +41,8 @@ ConnPoolImpl::~ConnPoolImpl() {
 }
 
 void ConnPoolImpl::ConnPoolImpl::drainConnections() {
-  if (primary_client_ != nullptr) {
-    movePrimaryClientToDraining();
+  while (!active_clients_.empty()) {
+    moveClientToDraining(*active_clients_.front());
   }
 }
 
@@ -47,22 +56,22 @@ void ConnPoolImpl::checkForDrained() {
     return;
   }
 
-  bool drained = true;
-  if (primary_client_) {
-    if (primary_client_->client_->numActiveRequests() == 0) {
-      primary_client_->client_->close();
-      ASSERT(!primary_client_);
-    } else {
-      drained = false;
+  // Close the idle clients. The others are drained once their streams finish.
+  std::vector<ActiveClient*> idle_clients;
+  for (const ActiveClientPtr& client : active_clients_) {
+    if (client->client_->numActiveRequests() == 0) {
+      idle_clients.push_back(client.get());
     }
   }
-
-  ASSERT(!draining_client_ || (draining_client_->client_->numActiveRequests() > 0));
-  if (draining_client_ && draining_client_->client_->numActiveRequests() > 0) {
-    drained = false;
+  for (ActiveClient* client : idle_clients) {
+    client->client_->close();
   }
 
-  if (drained) {
+  ASSERT(std::all_of(draining_clients_.begin(), draining_clients_.end(),
+                     [](const ActiveClientPtr& client) -> bool {
+                       return client->client_->numActiveRequests() > 0;
+                     }));
+  if (active_clients_.empty() && draining_clients_.empty()) {
     ENVOY_LOG(debug, "invoking drained callbacks");
     for (const DrainedCb& cb : drained_callbacks_) {
       cb();
@@ -70,38 +79,62 @@ void ConnPoolImpl::checkForDrained() {
   }
 }
 
-ConnectionPool::Cancellable* ConnPoolImpl::newStream(Http::StreamDecoder& response_decoder,
-                                                     ConnectionPool::Callbacks& callbacks) {
-  ASSERT(drained_callbacks_.empty());
-
+ConnPoolImpl::ActiveClient& ConnPoolImpl::chooseClient() {
   // First see if we need to handle max streams rollover.
   uint64_t max_streams = host_->cluster().maxRequestsPerConnection();
   if (max_streams == 0) {
     max_streams = maxTotalStreams();
   }
 
-  if (primary_client_ && primary_client_->total_streams_ >= max_streams) {
-    movePrimaryClientToDraining();
+  // Prefer a client that isn't busy, and then the one with the fewest active streams.
+  const uint32_t stream_threshold = clientStreamThreshold();
+  ActiveClient* least_loaded = nullptr;
+  bool least_loaded_busy = false;
+  for (auto it = active_clients_.begin(); it != active_clients_.end();) {
+    ActiveClient& client = **it++;
+    if (client.total_streams_ >= max_streams) {
+      moveClientToDraining(client);
+      continue;
+    }
+
+    const bool busy = client.busy(stream_threshold);
+    if (least_loaded == nullptr || (!busy && least_loaded_busy) ||
+        (busy == least_loaded_busy &&
+         client.client_->numActiveRequests() < least_loaded->client_->numActiveRequests())) {
+      least_loaded = &client;
+      least_loaded_busy = busy;
+    }
   }
 
-  if (!primary_client_) {
-    primary_client_.reset(new ActiveClient(*this));
+  if (least_loaded == nullptr ||
+      (least_loaded_busy && active_clients_.size() < std::max(1U, maxActiveClients()))) {
+    ActiveClientPtr client(new ActiveClient(*this));
+    client->moveIntoListBack(std::move(client), active_clients_);
+    return *active_clients_.back();
   }
 
+  return *least_loaded;
+}
+
+ConnectionPool::Cancellable* ConnPoolImpl::newStream(Http::StreamDecoder& response_decoder,
+                                                     ConnectionPool::Callbacks& callbacks) {
+  ASSERT(drained_callbacks_.empty());
+
+  ActiveClient& client = chooseClient();
   if (!host_->cluster().resourceManager(priority_).requests().canCreate()) {
     ENVOY_LOG(debug, "max requests overflow");
     callbacks.onPoolFailure(ConnectionPool::PoolFailureReason::Overflow, nullptr);
     host_->cluster().stats().upstream_rq_pending_overflow_.inc();
   } else {
-    ENVOY_CONN_LOG(debug, "creating stream", *primary_client_->client_);
-    primary_client_->total_streams_++;
+    ENVOY_CONN_LOG(debug, "creating stream", *client.client_);
+    client.total_streams_++;
     host_->stats().rq_total_.inc();
     host_->stats().rq_active_.inc();
     host_->cluster().stats().upstream_rq_total_.inc();
     host_->cluster().stats().upstream_rq_active_.inc();
     host_->cluster().resourceManager(priority_).requests().inc();
-    callbacks.onPoolReady(primary_client_->client_->newStream(response_decoder),
-                          primary_client_->real_host_description_);
+    callbacks.onPoolReady(client.client_->newStream(response_decoder),
+                          client.real_host_description_);
   }
 
   return nullptr;
@@ -120,12 +153,12 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
       }
     }
 
-    if (&client == primary_client_.get()) {
-      ENVOY_CONN_LOG(debug, "destroying primary client", *client.client_);
-      dispatcher_.deferredDelete(std::move(primary_client_));
+    if (!client.draining_) {
+      ENVOY_CONN_LOG(debug, "destroying active client", *client.client_);
+      dispatcher_.deferredDelete(client.removeFromList(active_clients_));
     } else {
       ENVOY_CONN_LOG(debug, "destroying draining client", *client.client_);
-      dispatcher_.deferredDelete(std::move(draining_client_));
+      dispatcher_.deferredDelete(client.removeFromList(draining_clients_));
     }
 
     if (client.connect_timer_) {
@@ -139,7 +172,7 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
   }
 
   if (event == Network::ConnectionEvent::Connected) {
-    conn_connect_ms_->complete();
+    client.conn_connect_ms_->complete();
   }
 
   if (client.connect_timer_) {
@@ -148,25 +181,16 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
   }
 }
 
-void ConnPoolImpl::movePrimaryClientToDraining() {
-  ENVOY_CONN_LOG(debug, "moving primary to draining", *primary_client_->client_);
-  if (draining_client_) {
-    // This should pretty much never happen, but is possible if we start draining and then get
-    // a goaway for example. In this case just kill the current draining connection. It's not
-    // worth keeping a list.
-    draining_client_->client_->close();
-  }
-
-  ASSERT(!draining_client_);
-  if (primary_client_->client_->numActiveRequests() == 0) {
-    // If we are making a new connection and the primary does not have any active requests just
-    // close it now.
-    primary_client_->client_->close();
+void ConnPoolImpl::moveClientToDraining(ActiveClient& client) {
+  ENVOY_CONN_LOG(debug, "moving to draining", *client.client_);
+  ASSERT(!client.draining_);
+  if (client.client_->numActiveRequests() == 0) {
+    // If the client does not have any active requests just close it now.
+    client.client_->close();
   } else {
-    draining_client_ = std::move(primary_client_);
+    client.draining_ = true;
+    client.moveBetweenLists(active_clients_, draining_clients_);
   }
-
-  ASSERT(!primary_client_);
 }
 
 void ConnPoolImpl::onConnectTimeout(ActiveClient& client) {
@@ -178,8 +202,8 @@ void ConnPoolImpl::onConnectTimeout(ActiveClient& client) {
 void ConnPoolImpl::onGoAway(ActiveClient& client) {
   ENVOY_CONN_LOG(debug, "remote goaway", *client.client_);
   host_->cluster().stats().upstream_cx_close_notify_.inc();
-  if (&client == primary_client_.get()) {
-    movePrimaryClientToDraining();
+  if (!client.draining_) {
+    moveClientToDraining(client);
   }
 }
 
@@ -189,7 +213,7 @@ void ConnPoolImpl::onStreamDestroy(ActiveClient& client) {
   host_->stats().rq_active_.dec();
   host_->cluster().stats().upstream_rq_active_.dec();
   host_->cluster().resourceManager(priority_).requests().dec();
-  if (&client == draining_client_.get() && client.client_->numActiveRequests() == 0) {
+  if (client.draining_ && client.client_->numActiveRequests() == 0) {
     // Close out the draining client if we no long have active requests.
     client.client_->close();
   }
@@ -218,7 +242,7 @@ ConnPoolImpl::ActiveClient::ActiveClient(ConnPoolImpl& parent)
     : parent_(parent),
       connect_timer_(parent_.dispatcher_.createTimer([this]() -> void { onConnectTimeout(); })) {
 
-  parent_.conn_connect_ms_.reset(
+  conn_connect_ms_.reset(
       new Stats::Timespan(parent_.host_->cluster().stats().upstream_cx_connect_ms_));
   Upstream::Host::CreateConnectionData data = parent_.host_->createConnection(parent_.dispatcher_);
   real_host_description_ = data.host_description_;
@@ -256,6 +280,14 @@ CodecClientPtr ProdConnPoolImpl::createCodecClient(Upstream::Host::CreateConnect
 
 uint32_t ProdConnPoolImpl::maxTotalStreams() { return MAX_STREAMS; }
 
+uint32_t ProdConnPoolImpl::maxActiveClients() {
+  return runtime_.snapshot().getInteger(RuntimeMaxConnectionsPerHost, 1);
+}
+
+uint32_t ProdConnPoolImpl::clientStreamThreshold() {
+  return runtime_.snapshot().getInteger(RuntimeConnectionStreamThreshold, 0);
+}
+
 } // namespace Http2
 } // namespace Http
 } // namespace Envoy
@@ -7,9 +7,11 @@
 #include "envoy/event/timer.h"
 #include "envoy/http/conn_pool.h"
 #include "envoy/network/connection.h"
+#include "envoy/runtime/runtime.h"
 #include "envoy/stats/timespan.h"
 #include "envoy/upstream/upstream.h"
 
+#include "common/common/linked_object.h"
 #include "common/http/codec_client.h"
 
 namespace Envoy {
@@ -18,8 +20,11 @@ namespace Http2 {
 
 /**
  * Implementation of a "connection pool" for HTTP/2. This mainly handles stats as well as
- * shifting to a new connection if we reach max streams on the primary. This is a base class
- * used for both the prod implementation as well as the testing one.
+ * shifting to a new connection if we reach max streams on a connection. Up to maxActiveClients()
+ * connections take new streams at once. Each new stream goes to the one with the fewest active
+ * streams, and another connection is added when that one is busy, i.e. it has
+ * clientStreamThreshold() active streams or its write buffer is above its high watermark. This is
+ * a base class used for both the prod implementation as well as the testing one.
  */
 class ConnPoolImpl : Logger::Loggable<Logger::Id::pool>, public ConnectionPool::Instance {
 public:
@@ -35,7 +40,8 @@ public:
                                          ConnectionPool::Callbacks& callbacks) override;
 
 protected:
-  struct ActiveClient : public Network::ConnectionCallbacks,
+  struct ActiveClient : public LinkedObject<ActiveClient>,
+                        public Network::ConnectionCallbacks,
                         public CodecClientCallbacks,
                         public Event::DeferredDeletable,
                         public Http::ConnectionCallbacks {
@@ -44,12 +50,22 @@ protected:
 
     void onConnectTimeout() { parent_.onConnectTimeout(*this); }
 
+    /**
+     * @param stream_threshold supplies the number of active streams at which a client is busy, or
+     *        0 for none.
+     * @return bool whether the client is busy, and another should take new streams if allowed.
+     */
+    bool busy(uint32_t stream_threshold) {
+      return above_high_watermark_ ||
+             (stream_threshold > 0 && client_->numActiveRequests() >= stream_threshold);
+    }
+
     // Network::ConnectionCallbacks
     void onEvent(Network::ConnectionEvent event) override {
       parent_.onConnectionEvent(*this, event);
     }
-    void onAboveWriteBufferHighWatermark() override {}
-    void onBelowWriteBufferLowWatermark() override {}
+    void onAboveWriteBufferHighWatermark() override { above_high_watermark_ = true; }
+    void onBelowWriteBufferLowWatermark() override { above_high_watermark_ = false; }
 
     // CodecClientCallbacks
     void onStreamDestroy() override { parent_.onStreamDestroy(*this); }
@@ -65,27 +81,44 @@ protected:
     Upstream::HostDescriptionConstSharedPtr real_host_description_;
     uint64_t total_streams_{};
     Event::TimerPtr connect_timer_;
+    Stats::TimespanPtr conn_connect_ms_;
     Stats::TimespanPtr conn_length_;
     bool closed_with_active_rq_{};
+    bool above_high_watermark_{};
+    bool draining_{};
   };
 
   typedef std::unique_ptr<ActiveClient> ActiveClientPtr;
 
   void checkForDrained();
+  ActiveClient& chooseClient();
   virtual CodecClientPtr createCodecClient(Upstream::Host::CreateConnectionData& data) PURE;
   virtual uint32_t maxTotalStreams() PURE;
-  void movePrimaryClientToDraining();
+
+  /**
+   * @return uint32_t the most connections that take new streams at once. At least 1.
+   */
+  virtual uint32_t maxActiveClients() PURE;
+
+  /**
+   * @return uint32_t the number of active streams at which a connection is busy, or 0 if only the
+   *         write buffer watermark counts.
+   */
+  virtual uint32_t clientStreamThreshold() PURE;
+
+  void moveClientToDraining(ActiveClient& client);
   void onConnectionEvent(ActiveClient& client, Network::ConnectionEvent event);
   void onConnectTimeout(ActiveClient& client);
   void onGoAway(ActiveClient& client);
   void onStreamDestroy(ActiveClient& client);
   void onStreamReset(ActiveClient& client, Http::StreamResetReason reason);
 
-  Stats::TimespanPtr conn_connect_ms_;
   Event::Dispatcher& dispatcher_;
   Upstream::HostConstSharedPtr host_;
-  ActiveClientPtr primary_client_;
-  ActiveClientPtr draining_client_;
+  // Connections that take new streams.
+  std::list<ActiveClientPtr> active_clients_;
+  // Connections that finish their streams and are then closed.
+  std::list<ActiveClientPtr> draining_clients_;
   std::list<DrainedCb> drained_callbacks_;
   Upstream::ResourcePriority priority_;
 };
@@ -95,11 +128,17 @@ protected:
  */
 class ProdConnPoolImpl : public ConnPoolImpl {
 public:
-  using ConnPoolImpl::ConnPoolImpl;
+  ProdConnPoolImpl(Event::Dispatcher& dispatcher, Upstream::HostConstSharedPtr host,
+                   Upstream::ResourcePriority priority, Runtime::Loader& runtime)
+      : ConnPoolImpl(dispatcher, host, priority), runtime_(runtime) {}
 
 private:
   CodecClientPtr createCodecClient(Upstream::Host::CreateConnectionData& data) override;
   uint32_t maxTotalStreams() override;
+  uint32_t maxActiveClients() override;
+  uint32_t clientStreamThreshold() override;
+
+  Runtime::Loader& runtime_;
 
   // All streams are 2^31. Client streams are half that, minus stream 0. Just to be on the safe
   // side we do 2^29.
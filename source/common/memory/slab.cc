@@ -0,0 +1,205 @@
+#include "common/memory/slab.h"
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <new>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Memory {
+
+constexpr size_t Slab::BLOCK_SIZE_ALIGNMENT;
+constexpr size_t Slab::MAX_BLOCK_SIZE;
+constexpr uint32_t Slab::MAX_CACHED_BLOCKS;
+
+namespace {
+
+constexpr size_t NUM_FREE_LISTS = Slab::MAX_BLOCK_SIZE / Slab::BLOCK_SIZE_ALIGNMENT;
+
+/**
+ * Allocation counts of a thread. Only the thread itself writes them, so they are updated with a
+ * plain load and store rather than an atomic increment.
+ */
+struct ThreadCounts {
+  void increment(std::atomic<uint64_t>& count) {
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  std::atomic<uint64_t> allocations_{};
+  std::atomic<uint64_t> heap_allocations_{};
+};
+
+/**
+ * The allocation counts of all live threads, and the totals of the threads that have exited.
+ */
+class CountsRegistry {
+public:
+  void add(const ThreadCounts& counts) {
+    std::unique_lock<std::mutex> lock(lock_);
+    counts_.push_back(&counts);
+  }
+
+  void remove(const ThreadCounts& counts) {
+    std::unique_lock<std::mutex> lock(lock_);
+    exited_allocations_ += counts.allocations_.load(std::memory_order_relaxed);
+    exited_heap_allocations_ += counts.heap_allocations_.load(std::memory_order_relaxed);
+    counts_.remove(&counts);
+  }
+
+  uint64_t total(std::atomic<uint64_t> ThreadCounts::*count, uint64_t exited) {
+    uint64_t total = exited;
+    for (const ThreadCounts* counts : counts_) {
+      total += (counts->*count).load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+  uint64_t allocations() {
+    std::unique_lock<std::mutex> lock(lock_);
+    return total(&ThreadCounts::allocations_, exited_allocations_);
+  }
+
+  uint64_t heapAllocations() {
+    std::unique_lock<std::mutex> lock(lock_);
+    return total(&ThreadCounts::heap_allocations_, exited_heap_allocations_);
+  }
+
+private:
+  std::mutex lock_;
+  std::list<const ThreadCounts*> counts_;
+  uint64_t exited_allocations_{};
+  uint64_t exited_heap_allocations_{};
+};
+
+// Never destroyed, as threads may exit during static destruction.
+CountsRegistry& countsRegistry() {
+  static CountsRegistry* registry = new CountsRegistry();
+  return *registry;
+}
+
+/**
+ * The free lists of a thread. Freed blocks are linked through their first bytes.
+ */
+class ThreadCache {
+public:
+  ThreadCache() { countsRegistry().add(counts_); }
+
+  ~ThreadCache() {
+    for (FreeBlock* head : free_lists_) {
+      while (head != nullptr) {
+        FreeBlock* next = head->next_;
+        ::operator delete(head);
+        head = next;
+      }
+    }
+    countsRegistry().remove(counts_);
+    destroyed_ = true;
+  }
+
+  static ThreadCache* get() {
+    // Blocks may still be freed by thread local destructors that run after the cache's.
+    if (destroyed_) {
+      return nullptr;
+    }
+    static thread_local ThreadCache cache;
+    return &cache;
+  }
+
+  void* allocate(size_t size) {
+    counts_.increment(counts_.allocations_);
+    if (size > Slab::MAX_BLOCK_SIZE) {
+      counts_.increment(counts_.heap_allocations_);
+      return ::operator new(size);
+    }
+
+    const size_t index = freeListIndex(size);
+    FreeBlock* block = free_lists_[index];
+    if (block == nullptr) {
+      counts_.increment(counts_.heap_allocations_);
+      return ::operator new(blockSize(size));
+    }
+    free_lists_[index] = block->next_;
+    free_list_lengths_[index]--;
+    return block;
+  }
+
+  void free(void* block, size_t size) {
+    if (size > Slab::MAX_BLOCK_SIZE) {
+      ::operator delete(block);
+      return;
+    }
+
+    const size_t index = freeListIndex(size);
+    if (free_list_lengths_[index] == Slab::MAX_CACHED_BLOCKS) {
+      ::operator delete(block);
+      return;
+    }
+    FreeBlock* free_block = static_cast<FreeBlock*>(block);
+    free_block->next_ = free_lists_[index];
+    free_lists_[index] = free_block;
+    free_list_lengths_[index]++;
+  }
+
+  /**
+   * @return size_t the size of the blocks that allocations of size bytes get, which is the size of
+   *         their free list's blocks up to MAX_BLOCK_SIZE.
+   */
+  static size_t blockSize(size_t size) {
+    if (size > Slab::MAX_BLOCK_SIZE) {
+      return size;
+    }
+    return (freeListIndex(size) + 1) * Slab::BLOCK_SIZE_ALIGNMENT;
+  }
+
+private:
+  struct FreeBlock {
+    FreeBlock* next_;
+  };
+
+  static size_t freeListIndex(size_t size) {
+    ASSERT(size > 0 && size <= Slab::MAX_BLOCK_SIZE);
+    return (size - 1) / Slab::BLOCK_SIZE_ALIGNMENT;
+  }
+
+  static thread_local bool destroyed_;
+
+  FreeBlock* free_lists_[NUM_FREE_LISTS]{};
+  uint32_t free_list_lengths_[NUM_FREE_LISTS]{};
+  ThreadCounts counts_;
+};
+
+thread_local bool ThreadCache::destroyed_ = false;
+
+} // namespace
+
+void* Slab::allocate(size_t size) {
+  ThreadCache* cache = ThreadCache::get();
+  if (cache == nullptr) {
+    // The block may be freed onto another thread's free list, so it is rounded up as the cache
+    // would round it.
+    return ::operator new(ThreadCache::blockSize(size));
+  }
+  return cache->allocate(size);
+}
+
+void Slab::free(void* block, size_t size) {
+  if (block == nullptr) {
+    return;
+  }
+  ThreadCache* cache = ThreadCache::get();
+  if (cache == nullptr) {
+    ::operator delete(block);
+    return;
+  }
+  cache->free(block, size);
+}
+
+uint64_t Slab::totalAllocations() { return countsRegistry().allocations(); }
+
+uint64_t Slab::totalHeapAllocations() { return countsRegistry().heapAllocations(); }
+
+} // namespace Memory
+} // namespace Envoy
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Envoy {
+namespace Memory {
+
+/**
+ * Per thread caches of fixed size memory blocks, for objects that are created and destroyed at a
+ * high rate on the workers, such as the per stream state of the HTTP connection manager. Block
+ * sizes are rounded up to a multiple of BLOCK_SIZE_ALIGNMENT. A freed block goes onto the freeing
+ * thread's free list for its size, which holds up to MAX_CACHED_BLOCKS blocks, and the next
+ * allocation of that size on the thread takes it back off. Only allocations that the free lists
+ * can't serve go to the heap.
+ */
+class Slab {
+public:
+  static constexpr size_t BLOCK_SIZE_ALIGNMENT = 32;
+  static constexpr size_t MAX_BLOCK_SIZE = 4096;
+  static constexpr uint32_t MAX_CACHED_BLOCKS = 256;
+
+  /**
+   * @param size supplies the size of the block in bytes.
+   * @return void* a block of at least size bytes. Sizes above MAX_BLOCK_SIZE come from the heap.
+   */
+  static void* allocate(size_t size);
+
+  /**
+   * Free a block returned by allocate().
+   * @param block supplies the block.
+   * @param size supplies the size that the block was allocated with.
+   */
+  static void free(void* block, size_t size);
+
+  /**
+   * @return uint64_t the number of blocks allocated by all threads.
+   */
+  static uint64_t totalAllocations();
+
+  /**
+   * @return uint64_t the number of blocks allocated by all threads that the free lists couldn't
+   *         serve, and so came from the heap.
+   */
+  static uint64_t totalHeapAllocations();
+};
+
+/**
+ * Mixin that allocates objects of a class, and of the classes derived from it, with Slab. Objects
+ * of derived classes must only be deleted through a pointer to a base with a virtual destructor,
+ * so that the size of the block is known.
+ */
+class SlabAllocated {
+public:
+  static void* operator new(size_t size) { return Slab::allocate(size); }
+  static void operator delete(void* block, size_t size) { Slab::free(block, size); }
+};
+
+} // namespace Memory
+} // namespace Envoy
@@ -135,7 +135,7 @@ void ConnectionImpl::close(ConnectionCloseType type) {
     return;
   }
 
-  uint64_t data_to_write = write_buffer_->length();
+  uint64_t data_to_write = write_buffer_->length() + splicePipeLength();
   ENVOY_CONN_LOG(debug, "closing data_to_write={} type={}", *this, data_to_write, enumToInt(type));
   if (data_to_write == 0 || type == ConnectionCloseType::NoFlush ||
       !transport_socket_->canFlushClose()) {
@@ -173,6 +173,17 @@ void ConnectionImpl::closeSocket(ConnectionEvent close_type) {
   ENVOY_CONN_LOG(debug, "closing socket: {}", *this, static_cast<uint32_t>(close_type));
   transport_socket_->closeSocket(close_type);
 
+  // Detach from any splice so that the other connection stops using this one. Data still in the
+  // pipe of an inbound splice is dropped along with the write buffer.
+  if (outbound_splice_ != nullptr) {
+    outbound_splice_->source_ = nullptr;
+    outbound_splice_.reset();
+  }
+  if (inbound_splice_ != nullptr) {
+    inbound_splice_->destination_ = nullptr;
+    inbound_splice_.reset();
+  }
+
   // Drain input and output buffers.
   updateReadBufferStats(0, 0);
   updateWriteBufferStats(0, 0);
@@ -276,8 +287,9 @@ void ConnectionImpl::readDisable(bool disable) {
     file_event_->setEnabled(Event::FileReadyType::Read | Event::FileReadyType::Write);
     // If the connection has data buffered there's no guarantee there's also data in the kernel
     // which will kick off the filter chain. Instead fake an event to make sure the buffered data
-    // gets processed regardless.
-    if (read_buffer_.length() > 0) {
+    // gets processed regardless. The same goes for a splice, which may have stopped reading from
+    // the kernel when its pipe filled up.
+    if (read_buffer_.length() > 0 || outbound_splice_ != nullptr) {
       file_event_->activate(Event::FileReadyType::Read);
     }
   }
@@ -330,6 +342,34 @@ void ConnectionImpl::write(Buffer::Instance& data) {
   }
 }
 
+bool ConnectionImpl::spliceTo(Connection& destination) {
+  ConnectionImpl* destination_impl = dynamic_cast<ConnectionImpl*>(&destination);
+  if (destination_impl == nullptr || destination_impl == this || outbound_splice_ != nullptr ||
+      destination_impl->inbound_splice_ != nullptr || state() != State::Open ||
+      destination_impl->state() != State::Open || connecting_ || destination_impl->connecting_ ||
+      read_buffer_.length() > 0 || !transport_socket_->canSplice() ||
+      !destination_impl->transport_socket_->canSplice()) {
+    return false;
+  }
+
+  // The pipe takes the place of the destination's write buffer, so it is sized to the same limit.
+  // Once it is full the source stops reading, as it would on a high watermark.
+  SplicePipePtr pipe = SplicePipe::create(destination_impl->bufferLimit());
+  if (pipe == nullptr) {
+    return false;
+  }
+
+  ENVOY_CONN_LOG(debug, "splicing to connection {}", *this, destination_impl->id());
+  outbound_splice_.reset(new Splice{this, destination_impl, std::move(pipe)});
+  destination_impl->inbound_splice_ = outbound_splice_;
+
+  // Data that arrived while nothing was reading will not raise another edge triggered event.
+  if (read_enabled_) {
+    file_event_->activate(Event::FileReadyType::Read);
+  }
+  return true;
+}
+
 void ConnectionImpl::setBufferLimits(uint32_t limit) {
   read_buffer_limit_ = limit;
 
@@ -419,6 +459,16 @@ void ConnectionImpl::onReadReady() {
 
   ASSERT(!connecting_);
 
+  if (outbound_splice_ != nullptr) {
+    if (outbound_splice_->destination_ != nullptr) {
+      onSpliceReadReady();
+      return;
+    }
+    // The destination is gone. Whatever is still read goes to the read filters, which deal with
+    // the closed destination as they would have without splicing.
+    outbound_splice_.reset();
+  }
+
   IoResult result = transport_socket_->doRead(read_buffer_);
   uint64_t new_buffer_size = read_buffer_.length();
   updateReadBufferStats(result.bytes_processed_, new_buffer_size);
@@ -435,6 +485,51 @@ void ConnectionImpl::onReadReady() {
   }
 }
 
+void ConnectionImpl::onSpliceReadReady() {
+  // Either connection may be closed by the callbacks raised while writing, so hold on to the
+  // splice rather than going through outbound_splice_.
+  std::shared_ptr<Splice> splice = outbound_splice_;
+  PostIoAction action = PostIoAction::KeepOpen;
+  uint64_t bytes_read = 0;
+  while (!splice->pipe_->full()) {
+    const int64_t rc = splice->pipe_->fill(fd_);
+    ENVOY_CONN_LOG(trace, "splice read returns: {}", *this, rc);
+    if (rc == 0) {
+      action = PostIoAction::Close;
+      break;
+    } else if (rc == -1) {
+      ENVOY_CONN_LOG(trace, "splice read error: {}", *this, errno);
+      if (errno != EAGAIN) {
+        action = PostIoAction::Close;
+      }
+      break;
+    }
+
+    bytes_read += rc;
+    // Write the data out right away so that the pipe rarely fills up.
+    splice->destination_->onWriteReady();
+    if (fd_ == -1) {
+      return;
+    }
+    if (splice->destination_ == nullptr) {
+      break;
+    }
+    // Yield to other connections once a buffer limit worth of data was moved, as doRead() does.
+    if (read_buffer_limit_ > 0 && bytes_read >= read_buffer_limit_) {
+      setReadBufferReady();
+      break;
+    }
+  }
+
+  // Spliced data is accounted for in the destination's write buffer stats while in the pipe.
+  updateReadBufferStats(bytes_read, 0);
+
+  if (action == PostIoAction::Close) {
+    ENVOY_CONN_LOG(debug, "remote close", *this);
+    closeSocket(ConnectionEvent::RemoteClose);
+  }
+}
+
 void ConnectionImpl::onWriteReady() {
   ENVOY_CONN_LOG(trace, "write ready", *this);
 
@@ -462,7 +557,14 @@ void ConnectionImpl::onWriteReady() {
   }
 
   IoResult result = transport_socket_->doWrite(*write_buffer_);
-  uint64_t new_buffer_size = write_buffer_->length();
+  // Spliced data goes out after anything written to the connection before splicing started.
+  if (inbound_splice_ != nullptr && result.action_ == PostIoAction::KeepOpen &&
+      write_buffer_->length() == 0) {
+    const IoResult splice_result = doSpliceWrite();
+    result.action_ = splice_result.action_;
+    result.bytes_processed_ += splice_result.bytes_processed_;
+  }
+  uint64_t new_buffer_size = write_buffer_->length() + splicePipeLength();
   updateWriteBufferStats(result.bytes_processed_, new_buffer_size);
 
   if (result.action_ == PostIoAction::Close) {
@@ -485,6 +587,36 @@ void ConnectionImpl::onWriteReady() {
   }
 }
 
+IoResult ConnectionImpl::doSpliceWrite() {
+  SplicePipe& pipe = *inbound_splice_->pipe_;
+  const bool was_full = pipe.full();
+  PostIoAction action = PostIoAction::KeepOpen;
+  uint64_t bytes_written = 0;
+  while (pipe.length() > 0) {
+    const int64_t rc = pipe.drain(fd_);
+    ENVOY_CONN_LOG(trace, "splice write returns: {}", *this, rc);
+    if (rc == -1) {
+      ENVOY_CONN_LOG(trace, "splice write error: {}", *this, errno);
+      if (errno != EAGAIN) {
+        action = PostIoAction::Close;
+      }
+      break;
+    }
+    bytes_written += rc;
+  }
+
+  // The source stops reading when the pipe is full, or when splice() runs out of pipe buffers
+  // before that, so restart it whenever the drain made room. A source that stopped because its
+  // socket had no data just finds none again.
+  ConnectionImpl* source = inbound_splice_->source_;
+  if ((was_full || pipe.fillBlocked()) && bytes_written > 0 && source != nullptr &&
+      source->read_enabled_) {
+    source->file_event_->activate(Event::FileReadyType::Read);
+  }
+
+  return {action, bytes_written};
+}
+
 void ConnectionImpl::doConnect() {
   ENVOY_CONN_LOG(debug, "connecting to {}", *this, remote_address_->asString());
   int rc = remote_address_->connect(fd_);
@@ -15,6 +15,7 @@
 #include "common/common/logger.h"
 #include "common/event/libevent.h"
 #include "common/network/filter_manager_impl.h"
+#include "common/network/splice_pipe.h"
 #include "common/ssl/ssl_socket.h"
 
 namespace Envoy {
@@ -90,6 +91,7 @@ public:
   uint32_t bufferLimit() const override { return read_buffer_limit_; }
   bool usingOriginalDst() const override { return using_original_dst_; }
   bool aboveHighWatermark() const override { return above_high_watermark_; }
+  bool spliceTo(Connection& destination) override;
 
   // Network::BufferSource
   Buffer::Instance& getReadBuffer() override { return read_buffer_; }
@@ -128,10 +130,26 @@ protected:
   uint32_t read_buffer_limit_ = 0;
 
 private:
+  /**
+   * State shared by the source and the destination of a splice. The pipe holds the data read from
+   * the source that the destination has not written yet. Each connection clears its pointer when
+   * its socket is closed.
+   */
+  struct Splice {
+    ConnectionImpl* source_;
+    ConnectionImpl* destination_;
+    SplicePipePtr pipe_;
+  };
+
   void onFileEvent(uint32_t events);
   void onRead(uint64_t read_buffer_size);
   void onReadReady();
+  void onSpliceReadReady();
   void onWriteReady();
+  IoResult doSpliceWrite();
+  uint64_t splicePipeLength() const {
+    return inbound_splice_ != nullptr ? inbound_splice_->pipe_->length() : 0;
+  }
   void updateReadBufferStats(uint64_t num_read, uint64_t new_size);
   void updateWriteBufferStats(uint64_t num_written, uint64_t new_size);
 
@@ -159,6 +177,10 @@ private:
   // readDisabled(true) this allows the connection to only resume reads when readDisabled(false)
   // has been called N times.
   uint32_t read_disable_count_{0};
+  // Set when data read from this connection is spliced to another connection.
+  std::shared_ptr<Splice> outbound_splice_;
+  // Set when data read from another connection is spliced to this one.
+  std::shared_ptr<Splice> inbound_splice_;
 };
 
 /**
@@ -0,0 +1,319 @@
+#include "common/network/lc_trie.h"
+
+#include <arpa/inet.h>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/utility.h"
+
+#include "fmt/format.h"
+
+namespace Envoy {
+namespace Network {
+namespace LcTrie {
+
+constexpr uint32_t LcTrie::NO_ANCESTOR;
+constexpr uint32_t LcTrie::MAX_BRANCH;
+
+template <class IpType> constexpr uint32_t LcTrie::LcTrieInternal<IpType>::address_bits;
+
+LcTrie::LcTrie(const std::vector<std::pair<std::string, std::vector<Address::CidrRange>>>& tag_data,
+               double fill_factor, uint32_t root_branching_factor) {
+  if (fill_factor <= 0 || fill_factor > 1) {
+    throw EnvoyException(fmt::format("invalid LC-trie fill factor {}", fill_factor));
+  }
+
+  // Group the tags of identical ranges. The maps also sort the ranges by (address, length), which
+  // places every range directly before the ranges it encloses.
+  std::map<std::pair<uint32_t, uint32_t>, std::vector<uint32_t>> ipv4_ranges;
+  std::map<std::pair<Ipv6Bits, uint32_t>, std::vector<uint32_t>> ipv6_ranges;
+  for (const auto& tag : tag_data) {
+    const uint32_t tag_index = tag_names_.size();
+    tag_names_.push_back(tag.first);
+    for (const Address::CidrRange& range : tag.second) {
+      ASSERT(range.isValid());
+      const uint32_t length = range.length();
+      if (range.ip()->version() == Address::IpVersion::v4) {
+        ipv4_ranges[{toBits(*range.ip()->ipv4()), length}].push_back(tag_index);
+      } else {
+        ipv6_ranges[{toBits(*range.ip()->ipv6()), length}].push_back(tag_index);
+      }
+    }
+  }
+
+  TagSetIndex index;
+  internTagSet({}, index);
+  ipv4_trie_ = buildTrie(ipv4_ranges, index, fill_factor, root_branching_factor);
+  ipv6_trie_ = buildTrie(ipv6_ranges, index, fill_factor, root_branching_factor);
+}
+
+uint32_t LcTrie::lookup(const Address::Instance& ip_address) const {
+  if (ip_address.type() != Address::Type::Ip) {
+    return 0;
+  }
+
+  const Address::Ip& ip = *ip_address.ip();
+  if (ip.version() == Address::IpVersion::v4) {
+    return ipv4_trie_->lookup(toBits(*ip.ipv4()));
+  } else {
+    return ipv6_trie_->lookup(toBits(*ip.ipv6()));
+  }
+}
+
+uint32_t LcTrie::toBits(const Address::Ipv4& address) { return ntohl(address.address()); }
+
+LcTrie::Ipv6Bits LcTrie::toBits(const Address::Ipv6& address) {
+  const std::array<uint8_t, 16> bytes = address.address();
+  Ipv6Bits bits = 0;
+  for (uint8_t byte : bytes) {
+    bits = (bits << 8) | byte;
+  }
+  return bits;
+}
+
+uint32_t LcTrie::internTagSet(const std::vector<uint32_t>& tags, TagSetIndex& index) {
+  auto it = index.find(tags);
+  if (it != index.end()) {
+    return it->second;
+  }
+
+  std::vector<std::string> names;
+  for (uint32_t tag : tags) {
+    names.push_back(tag_names_[tag]);
+  }
+  const uint32_t tag_set = tag_sets_.size();
+  tag_sets_.push_back(StringUtil::join(names, ","));
+  tag_set_indexes_.push_back(tags);
+  index.emplace(tags, tag_set);
+  return tag_set;
+}
+
+template <class IpType>
+std::unique_ptr<LcTrie::LcTrieInternal<IpType>>
+LcTrie::buildTrie(const std::map<std::pair<IpType, uint32_t>, std::vector<uint32_t>>& ranges,
+                  TagSetIndex& index, double fill_factor, uint32_t root_branching_factor) {
+  std::vector<IpPrefix<IpType>> prefixes;
+  prefixes.reserve(ranges.size());
+  // The full (own + enclosing) tag set of each prefix on the stack.
+  std::vector<std::vector<uint32_t>> tag_sets;
+  // Indexes into prefixes of the chain of ranges enclosing the current one.
+  std::vector<uint32_t> enclosing;
+
+  for (const auto& range : ranges) {
+    IpPrefix<IpType> prefix(range.first.first, range.first.second, 0);
+    while (!enclosing.empty() && !prefixes[enclosing.back()].contains(prefix.address_)) {
+      enclosing.pop_back();
+    }
+
+    std::vector<uint32_t> tags = range.second;
+    if (!enclosing.empty()) {
+      prefix.ancestor_ = enclosing.back();
+      const std::vector<uint32_t>& parent_tags = tag_sets[prefix.ancestor_];
+      tags.insert(tags.end(), parent_tags.begin(), parent_tags.end());
+    }
+    std::sort(tags.begin(), tags.end());
+    tags.erase(std::unique(tags.begin(), tags.end()), tags.end());
+
+    prefix.tag_set_ = internTagSet(tags, index);
+    enclosing.push_back(prefixes.size());
+    prefixes.push_back(prefix);
+    tag_sets.emplace_back(std::move(tags));
+  }
+
+  return std::unique_ptr<LcTrieInternal<IpType>>(
+      new LcTrieInternal<IpType>(prefixes, fill_factor, root_branching_factor));
+}
+
+template <class IpType>
+LcTrie::LcTrieInternal<IpType>::LcTrieInternal(const std::vector<IpPrefix<IpType>>& prefixes,
+                                               double fill_factor, uint32_t root_branching_factor)
+    : fill_factor_(fill_factor) {
+  // Since the input is sorted, a prefix encloses another prefix iff it encloses its successor.
+  std::vector<uint32_t> nested_index(prefixes.size(), NO_ANCESTOR);
+  for (uint32_t i = 0; i < prefixes.size(); i++) {
+    if (i + 1 < prefixes.size() && prefixes[i].contains(prefixes[i + 1].address_) &&
+        prefixes[i].length_ < prefixes[i + 1].length_) {
+      nested_index[i] = nested_prefixes_.size();
+      nested_prefixes_.push_back(prefixes[i]);
+    } else {
+      base_.push_back(prefixes[i]);
+    }
+  }
+
+  // Enclosing prefixes always precede the prefixes they enclose, so have already been assigned.
+  for (IpPrefix<IpType>& prefix : nested_prefixes_) {
+    if (prefix.ancestor_ != NO_ANCESTOR) {
+      prefix.ancestor_ = nested_index[prefix.ancestor_];
+    }
+  }
+  for (IpPrefix<IpType>& prefix : base_) {
+    if (prefix.ancestor_ != NO_ANCESTOR) {
+      prefix.ancestor_ = nested_index[prefix.ancestor_];
+    }
+  }
+
+  base_size_ = base_.size();
+  if (base_size_ == 0) {
+    return;
+  }
+
+  trie_.push_back(TrieNode());
+  buildRecursive(0, 0, base_size_, 0, root_branching_factor);
+}
+
+template <class IpType>
+uint32_t LcTrie::LcTrieInternal<IpType>::commonPrefixLength(const IpType& a, const IpType& b) {
+  const IpType difference = a ^ b;
+  uint32_t length = 0;
+  while (length < address_bits && ((difference << length) >> (address_bits - 1)) == 0) {
+    length++;
+  }
+  return length;
+}
+
+template <class IpType>
+uint32_t LcTrie::LcTrieInternal<IpType>::computeBranch(uint32_t first, uint32_t n,
+                                                       uint32_t position) const {
+  // The entries differ at bit 'position', so branching on a single bit always fills the node.
+  uint32_t branch = 1;
+  while (branch < MAX_BRANCH && position + branch < address_bits &&
+         (1ULL << (branch + 1)) <= n / fill_factor_) {
+    uint32_t distinct = 1;
+    uint32_t previous = extractBits(position, branch + 1, base_[first].address_);
+    for (uint32_t i = first + 1; i < first + n; i++) {
+      const uint32_t current = extractBits(position, branch + 1, base_[i].address_);
+      if (current != previous) {
+        distinct++;
+        previous = current;
+      }
+    }
+    if (distinct < fill_factor_ * (1ULL << (branch + 1))) {
+      break;
+    }
+    branch++;
+  }
+  return branch;
+}
+
+template <class IpType>
+void LcTrie::LcTrieInternal<IpType>::buildRecursive(uint32_t node, uint32_t first, uint32_t n,
+                                                    uint32_t position, uint32_t branch_override) {
+  if (n == 1) {
+    trie_[node] = {0, 0, first};
+    return;
+  }
+
+  // The input is sorted, so the first and last entries share the shortest common prefix.
+  const uint32_t common = commonPrefixLength(base_[first].address_, base_[first + n - 1].address_);
+  ASSERT(common >= position && common < address_bits);
+  const uint32_t skip = common - position;
+  position = common;
+
+  const uint32_t branch =
+      branch_override != 0 ? std::min({branch_override, MAX_BRANCH, address_bits - position})
+                           : computeBranch(first, n, position);
+  const uint32_t children = trie_.size();
+  trie_[node] = {static_cast<uint8_t>(branch), static_cast<uint8_t>(skip), children};
+  trie_.resize(children + (1U << branch));
+
+  // Bits [0, position) shared by every entry below this node.
+  const IpType node_prefix =
+      position == 0
+          ? IpType(0)
+          : (base_[first].address_ >> (address_bits - position)) << (address_bits - position);
+  const uint32_t slot_length = position + branch;
+
+  uint32_t next = first;
+  for (uint32_t slot = 0; slot < (1U << branch); slot++) {
+    uint32_t count = 0;
+    while (next + count < first + n &&
+           extractBits(position, branch, base_[next + count].address_) == slot) {
+      count++;
+    }
+
+    if (count == 0) {
+      const IpType slot_address = node_prefix | (IpType(slot) << (address_bits - slot_length));
+      trie_[children + slot] = {0, 0, emptySlotLeaf(slot_address, slot_length, next)};
+    } else {
+      buildRecursive(children + slot, next, count, slot_length, 0);
+      next += count;
+    }
+  }
+  ASSERT(next == first + n);
+}
+
+template <class IpType>
+uint32_t LcTrie::LcTrieInternal<IpType>::emptySlotLeaf(const IpType& slot_address,
+                                                       uint32_t slot_length, uint32_t next) {
+  // Any configured range covering an empty slot is either the closest leaf before the slot, or
+  // encloses the closest leaf on one side of it (ranges are contiguous in sorted order).
+  const IpPrefix<IpType> slot(slot_address, slot_length, 0);
+  auto covers = [&slot](const IpPrefix<IpType>& prefix) -> bool {
+    return prefix.length_ <= slot.length_ && prefix.contains(slot.address_);
+  };
+
+  if (next > 0 && covers(base_[next - 1])) {
+    return next - 1;
+  }
+
+  uint32_t best = NO_ANCESTOR;
+  for (uint32_t neighbor : {next - 1, next}) {
+    if (neighbor >= base_size_) {
+      continue;
+    }
+    for (uint32_t i = base_[neighbor].ancestor_; i != NO_ANCESTOR;
+         i = nested_prefixes_[i].ancestor_) {
+      if (covers(nested_prefixes_[i])) {
+        if (best == NO_ANCESTOR || nested_prefixes_[i].length_ > nested_prefixes_[best].length_) {
+          best = i;
+        }
+        break;
+      }
+    }
+  }
+
+  if (best != NO_ANCESTOR) {
+    base_.push_back(nested_prefixes_[best]);
+    return base_.size() - 1;
+  }
+
+  if (no_match_leaf_ == NO_ANCESTOR) {
+    no_match_leaf_ = base_.size();
+    base_.push_back(IpPrefix<IpType>());
+  }
+  return no_match_leaf_;
+}
+
+template <class IpType>
+uint32_t LcTrie::LcTrieInternal<IpType>::lookup(const IpType& address) const {
+  if (trie_.empty()) {
+    return 0;
+  }
+
+  uint32_t position = trie_[0].skip_;
+  uint32_t branch = trie_[0].branch_;
+  uint32_t child = trie_[0].address_;
+  while (branch != 0) {
+    const TrieNode& node = trie_[child + extractBits(position, branch, address)];
+    position += branch + node.skip_;
+    branch = node.branch_;
+    child = node.address_;
+  }
+
+  // The skipped bits were never compared, so the leaf may still not contain the address. The
+  // longest matching range is then one of the leaf's enclosing ranges.
+  const IpPrefix<IpType>& leaf = base_[child];
+  if (leaf.contains(address)) {
+    return leaf.tag_set_;
+  }
+  for (uint32_t i = leaf.ancestor_; i != NO_ANCESTOR; i = nested_prefixes_[i].ancestor_) {
+    if (nested_prefixes_[i].contains(address)) {
+      return nested_prefixes_[i].tag_set_;
+    }
+  }
+  return 0;
+}
+
+} // namespace LcTrie
+} // namespace Network
+} // namespace Envoy
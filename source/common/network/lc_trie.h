@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "envoy/network/address.h"
+
+#include "common/common/assert.h"
+#include "common/common/non_copyable.h"
+#include "common/network/cidr_range.h"
+
+namespace Envoy {
+namespace Network {
+namespace LcTrie {
+
+/**
+ * Level-compressed trie (see Nilsson & Karlsson, "IP-address lookup using LC-tries", IEEE JSAC
+ * 1999) mapping CIDR ranges to tags. Each input range may carry any number of tags, and ranges
+ * may be nested. A lookup returns the tags of every configured range that contains the address,
+ * pre-joined into a single comma separated string at construction time, so that a lookup does no
+ * allocation and costs O(depth of the trie) + O(nesting depth of the matching prefixes).
+ *
+ * The trie is immutable once built and can be shared between threads.
+ */
+class LcTrie : NonCopyable {
+public:
+  /**
+   * @param tag_data supplies a list of (tag, ranges) pairs. Tags are emitted in the order given
+   *        here.
+   * @param fill_factor supplies the fraction of a trie node's children that must be populated for
+   *        the node to branch on one more bit. Lower values yield a shallower trie at the cost of
+   *        memory. Must be in the range (0, 1].
+   * @param root_branching_factor supplies a fixed number of bits for the root node to branch on,
+   *        or 0 to compute it from fill_factor like any other node.
+   */
+  LcTrie(const std::vector<std::pair<std::string, std::vector<Address::CidrRange>>>& tag_data,
+         double fill_factor = 0.5, uint32_t root_branching_factor = 0);
+
+  /**
+   * @return the comma separated tags of all ranges containing ip_address, or an empty string if
+   *         no range matches or the address is not an IP address. The reference is valid for the
+   *         lifetime of the trie.
+   */
+  const std::string& getTags(const Address::Instance& ip_address) const {
+    return tag_sets_[lookup(ip_address)];
+  }
+
+  /**
+   * @return the indexes into tag_data of the tags of all ranges containing ip_address, in
+   *         ascending order. Empty if no range matches or the address is not an IP address. The
+   *         reference is valid for the lifetime of the trie.
+   */
+  const std::vector<uint32_t>& getTagIndexes(const Address::Instance& ip_address) const {
+    return tag_set_indexes_[lookup(ip_address)];
+  }
+
+private:
+  typedef unsigned __int128 Ipv6Bits;
+
+  /**
+   * A single prefix of W bits, stored left aligned in IpType.
+   */
+  template <class IpType> struct IpPrefix {
+    IpPrefix() {}
+    IpPrefix(const IpType& address, uint32_t length, uint32_t tag_set)
+        : address_(address), length_(length), tag_set_(tag_set) {}
+
+    bool contains(const IpType& address) const {
+      return length_ == 0 || ((address ^ address_) >> (sizeof(IpType) * 8 - length_)) == 0;
+    }
+
+    IpType address_{};
+    uint32_t length_{};
+    // Index into LcTrie::tag_sets_. 0 is the empty tag set.
+    uint32_t tag_set_{};
+    // Index of the longest strictly enclosing prefix in the owning LcTrieInternal's
+    // nested_prefixes_, or NO_ANCESTOR.
+    uint32_t ancestor_{NO_ANCESTOR};
+  };
+
+  /**
+   * A trie node. Leaves have branch_ == 0 and address_ indexing the base vector; internal nodes
+   * have 2^branch_ consecutive children starting at address_ in the node vector.
+   */
+  struct TrieNode {
+    uint8_t branch_;
+    uint8_t skip_;
+    uint32_t address_;
+  };
+
+  template <class IpType> class LcTrieInternal {
+  public:
+    /**
+     * @param prefixes supplies the configured prefixes sorted by (address, length), each with
+     *        ancestor_ set to the index of its longest enclosing prefix in the same vector.
+     */
+    LcTrieInternal(const std::vector<IpPrefix<IpType>>& prefixes, double fill_factor,
+                   uint32_t root_branching_factor);
+
+    /**
+     * @return the tag set index of the longest prefix containing address, or 0 if none.
+     */
+    uint32_t lookup(const IpType& address) const;
+
+  private:
+    static constexpr uint32_t address_bits = sizeof(IpType) * 8;
+
+    static uint32_t extractBits(uint32_t position, uint32_t count, const IpType& address) {
+      ASSERT(count > 0 && position + count <= address_bits);
+      return static_cast<uint32_t>((address << position) >> (address_bits - count));
+    }
+
+    static uint32_t commonPrefixLength(const IpType& a, const IpType& b);
+
+    uint32_t computeBranch(uint32_t first, uint32_t n, uint32_t position) const;
+    void buildRecursive(uint32_t node, uint32_t first, uint32_t n, uint32_t position,
+                        uint32_t branch_override);
+    uint32_t emptySlotLeaf(const IpType& slot_address, uint32_t slot_length, uint32_t next);
+
+    const double fill_factor_;
+    // Number of real (non synthetic) entries at the front of base_.
+    uint32_t base_size_{};
+    // Index in base_ of the synthetic entry which never yields tags, or NO_ANCESTOR.
+    uint32_t no_match_leaf_{NO_ANCESTOR};
+    // Prefixes which are not a prefix of any other configured range. These are the trie leaves.
+    std::vector<IpPrefix<IpType>> base_;
+    // Prefixes which enclose at least one other configured range. Reached only through the
+    // ancestor_ links of base_ entries.
+    std::vector<IpPrefix<IpType>> nested_prefixes_;
+    std::vector<TrieNode> trie_;
+  };
+
+  static constexpr uint32_t NO_ANCESTOR = UINT32_MAX;
+  // Upper bound on the number of bits a single node branches on, i.e. 2^MAX_BRANCH children.
+  static constexpr uint32_t MAX_BRANCH = 20;
+
+  /**
+   * @return the index of the tag set of the longest range containing ip_address, or 0 if none.
+   */
+  uint32_t lookup(const Address::Instance& ip_address) const;
+
+  static uint32_t toBits(const Address::Ipv4& address);
+  static Ipv6Bits toBits(const Address::Ipv6& address);
+
+  typedef std::map<std::vector<uint32_t>, uint32_t> TagSetIndex;
+
+  /**
+   * Interns a sorted set of tag indexes as a joined string. @return its index in tag_sets_.
+   */
+  uint32_t internTagSet(const std::vector<uint32_t>& tags, TagSetIndex& index);
+
+  /**
+   * Resolves range nesting and builds the trie for one address family.
+   */
+  template <class IpType>
+  std::unique_ptr<LcTrieInternal<IpType>>
+  buildTrie(const std::map<std::pair<IpType, uint32_t>, std::vector<uint32_t>>& ranges,
+            TagSetIndex& index, double fill_factor, uint32_t root_branching_factor);
+
+  std::vector<std::string> tag_names_;
+  // Index 0 is always the empty set.
+  std::vector<std::string> tag_sets_;
+  // The tag indexes of each entry in tag_sets_.
+  std::vector<std::vector<uint32_t>> tag_set_indexes_;
+  std::unique_ptr<LcTrieInternal<uint32_t>> ipv4_trie_;
+  std::unique_ptr<LcTrieInternal<Ipv6Bits>> ipv6_trie_;
+};
+
+} // namespace LcTrie
+} // namespace Network
+} // namespace Envoy
@@ -40,6 +40,11 @@ protected:
 class TcpListenSocket : public ListenSocketImpl {
 public:
   TcpListenSocket(Address::InstanceConstSharedPtr address, bool bind_to_port);
+  /**
+   * @param reuse_port supplies whether to set SO_REUSEPORT before binding, so that several
+   *        sockets can bind to the same address and the kernel spreads connections among them.
+   */
+  TcpListenSocket(Address::InstanceConstSharedPtr address, bool bind_to_port, bool reuse_port);
   TcpListenSocket(int fd, Address::InstanceConstSharedPtr address);
 };
 
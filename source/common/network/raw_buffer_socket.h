@@ -14,6 +14,7 @@ public:
   void setTransportSocketCallbacks(TransportSocketCallbacks& callbacks) override;
   std::string protocol() const override;
   bool canFlushClose() override { return true; }
+  bool canSplice() const override { return true; }
   void closeSocket(Network::ConnectionEvent) override {}
   void onConnected() override;
   IoResult doRead(Buffer::Instance& buffer) override;
@@ -0,0 +1,74 @@
+#include "common/network/splice_pipe.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Network {
+
+SplicePipe::SplicePipe(int read_fd, int write_fd, uint64_t capacity)
+    : read_fd_(read_fd), write_fd_(write_fd), capacity_(capacity) {}
+
+SplicePipe::~SplicePipe() {
+  ::close(read_fd_);
+  ::close(write_fd_);
+}
+
+#ifdef __linux__
+SplicePipePtr SplicePipe::create(uint32_t capacity) {
+  int fds[2];
+  if (::pipe2(fds, O_NONBLOCK | O_CLOEXEC) != 0) {
+    return nullptr;
+  }
+
+  // Growing the pipe past the system wide maximum fails for unprivileged processes, in which case
+  // the pipe keeps whatever capacity it already has.
+  if (capacity > 0) {
+    ::fcntl(fds[1], F_SETPIPE_SZ, capacity);
+  }
+  const int actual_capacity = ::fcntl(fds[1], F_GETPIPE_SZ);
+  if (actual_capacity <= 0) {
+    ::close(fds[0]);
+    ::close(fds[1]);
+    return nullptr;
+  }
+
+  return SplicePipePtr{new SplicePipe(fds[0], fds[1], actual_capacity)};
+}
+
+int64_t SplicePipe::fill(int fd) {
+  ASSERT(!full());
+  const ssize_t rc = ::splice(fd, nullptr, write_fd_, nullptr, capacity_ - length_,
+                              SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  if (rc > 0) {
+    length_ += rc;
+  }
+  fill_blocked_ = rc == -1 && errno == EAGAIN;
+  return rc;
+}
+
+int64_t SplicePipe::drain(int fd) {
+  ASSERT(length_ > 0);
+  const ssize_t rc =
+      ::splice(read_fd_, nullptr, fd, nullptr, length_, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  if (rc > 0) {
+    ASSERT(static_cast<uint64_t>(rc) <= length_);
+    length_ -= rc;
+  }
+  return rc;
+}
+#else
+SplicePipePtr SplicePipe::create(uint32_t) { return nullptr; }
+
+int64_t SplicePipe::fill(int) { NOT_REACHED; }
+
+int64_t SplicePipe::drain(int) { NOT_REACHED; }
+#endif
+
+} // namespace Network
+} // namespace Envoy
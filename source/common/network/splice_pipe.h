@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+namespace Envoy {
+namespace Network {
+
+class SplicePipe;
+typedef std::unique_ptr<SplicePipe> SplicePipePtr;
+
+/**
+ * A non-blocking pipe used to move data from one socket to another with splice(2), without
+ * copying it through user space. The pipe is the only buffer between the two sockets, so its
+ * capacity bounds the amount of data in flight.
+ */
+class SplicePipe {
+public:
+  ~SplicePipe();
+
+  /**
+   * @param capacity supplies the requested capacity of the pipe in bytes. The kernel rounds it up
+   *        to whole pages and caps it at the system wide maximum. 0 keeps the default capacity.
+   * @return SplicePipePtr a new pipe, or nullptr if splice(2) is not supported on this platform
+   *         or the pipe could not be created.
+   */
+  static SplicePipePtr create(uint32_t capacity);
+
+  /**
+   * Move data from fd into the pipe, up to the free space in the pipe.
+   * @param fd supplies the socket to read from.
+   * @return int64_t the number of bytes moved, 0 if the peer closed the socket, or -1 with errno
+   *         set on error, as with read(2).
+   */
+  int64_t fill(int fd);
+
+  /**
+   * Move data from the pipe to fd.
+   * @param fd supplies the socket to write to.
+   * @return int64_t the number of bytes moved, or -1 with errno set on error, as with write(2).
+   */
+  int64_t drain(int fd);
+
+  /**
+   * @return uint64_t the number of bytes currently in the pipe.
+   */
+  uint64_t length() const { return length_; }
+
+  /**
+   * @return bool whether the pipe has no room for more data.
+   */
+  bool full() const { return length_ >= capacity_; }
+
+  /**
+   * @return bool whether the last fill() found no data to move, or no room for it. The kernel
+   *         holds each segment of data in a buffer of its own and a pipe only has a buffer per
+   *         page of its capacity, so fill() can run out of buffers long before the pipe is full()
+   *         when data arrives in many small segments. Only a drain() makes room again then.
+   */
+  bool fillBlocked() const { return fill_blocked_; }
+
+private:
+  SplicePipe(int read_fd, int write_fd, uint64_t capacity);
+
+  const int read_fd_;
+  const int write_fd_;
+  const uint64_t capacity_;
+  uint64_t length_{};
+  bool fill_blocked_{};
+};
+
+} // namespace Network
+} // namespace Envoy
@@ -26,6 +26,7 @@
 #include "common/protobuf/utility.h"
 #include "common/router/retry_state_impl.h"
 
+#include "absl/strings/string_view.h"
 #include "fmt/format.h"
 
 namespace Envoy {
@@ -61,13 +62,21 @@ CorsPolicyImpl::CorsPolicyImpl(const envoy::api::v2::CorsPolicy& config) {
   enabled_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, enabled, true);
 }
 
-ShadowPolicyImpl::ShadowPolicyImpl(const envoy::api::v2::RouteAction& config) {
+ShadowPolicyImpl::ShadowPolicyImpl(const envoy::api::v2::RouteAction& config)
+    : runtime_key_(loadRuntimeKey(config)) {
   if (!config.has_request_mirror_policy()) {
     return;
   }
 
   cluster_ = config.request_mirror_policy().cluster();
-  runtime_key_ = config.request_mirror_policy().runtime_key();
+}
+
+Runtime::Key ShadowPolicyImpl::loadRuntimeKey(const envoy::api::v2::RouteAction& config) {
+  const std::string& runtime_key = config.request_mirror_policy().runtime_key();
+  if (runtime_key.empty()) {
+    return Runtime::Key(EMPTY_STRING);
+  }
+  return Runtime::KeyRegistry::intern(runtime_key);
 }
 
 class HeaderHashMethod : public HashPolicyImpl::HashMethod {
@@ -331,6 +340,14 @@ bool RouteEntryImplBase::matchRoute(const Http::HeaderMap& headers, uint64_t ran
   return matches;
 }
 
+RouteConstSharedPtr RouteEntryImplBase::matchesExceptPath(const Http::HeaderMap& headers,
+                                                          uint64_t random_value) const {
+  if (matchRoute(headers, random_value)) {
+    return clusterEntry(headers, random_value);
+  }
+  return nullptr;
+}
+
 const std::string& RouteEntryImplBase::clusterName() const { return cluster_name_; }
 
 void RouteEntryImplBase::finalizeRequestHeaders(
@@ -357,10 +374,8 @@ Optional<RouteEntryImplBase::RuntimeData>
 RouteEntryImplBase::loadRuntimeData(const envoy::api::v2::RouteMatch& route_match) {
   Optional<RuntimeData> runtime;
   if (route_match.has_runtime()) {
-    RuntimeData data;
-    data.key_ = route_match.runtime().runtime_key();
-    data.default_ = route_match.runtime().default_value();
-    runtime.value(data);
+    runtime.value({Runtime::KeyRegistry::intern(route_match.runtime().runtime_key()),
+                   route_match.runtime().default_value()});
   }
 
   return runtime;
@@ -582,7 +597,8 @@ RegexRouteEntryImpl::RegexRouteEntryImpl(const VirtualHostImpl& vhost,
                                          const envoy::api::v2::Route& route,
                                          Runtime::Loader& loader)
     : RouteEntryImplBase(vhost, route, loader),
-      regex_(RegexUtil::parseRegex(route.match().regex().c_str())) {}
+      regex_(RegexUtil::parseRegex(route.match().regex().c_str())),
+      regex_str_(route.match().regex()) {}
 
 void RegexRouteEntryImpl::finalizeRequestHeaders(
     Http::HeaderMap& headers, const RequestInfo::RequestInfo& request_info) const {
@@ -635,14 +651,24 @@ VirtualHostImpl::VirtualHostImpl(const envoy::api::v2::VirtualHost& virtual_host
     const bool has_path = route.match().path_specifier_case() == envoy::api::v2::RouteMatch::kPath;
     const bool has_regex =
         route.match().path_specifier_case() == envoy::api::v2::RouteMatch::kRegex;
+    const uint32_t position = routes_.size();
     if (has_prefix) {
-      routes_.emplace_back(new PrefixRouteEntryImpl(*this, route, runtime));
+      std::shared_ptr<const PrefixRouteEntryImpl> prefix_route =
+          std::make_shared<PrefixRouteEntryImpl>(*this, route, runtime);
+      route_index_.addPrefix(prefix_route->prefix(), prefix_route->caseSensitive(), position);
+      routes_.push_back(prefix_route);
     } else if (has_path) {
-      routes_.emplace_back(new PathRouteEntryImpl(*this, route, runtime));
+      std::shared_ptr<const PathRouteEntryImpl> path_route =
+          std::make_shared<PathRouteEntryImpl>(*this, route, runtime);
+      route_index_.addPath(path_route->path(), path_route->caseSensitive(), position);
+      routes_.push_back(path_route);
     } else {
       ASSERT(has_regex);
       UNREFERENCED_PARAMETER(has_regex);
-      routes_.emplace_back(new RegexRouteEntryImpl(*this, route, runtime));
+      std::shared_ptr<const RegexRouteEntryImpl> regex_route =
+          std::make_shared<RegexRouteEntryImpl>(*this, route, runtime);
+      route_index_.addRegex(regex_route->regexString(), position);
+      routes_.push_back(regex_route);
     }
 
     if (validate_clusters) {
@@ -656,10 +682,22 @@ VirtualHostImpl::VirtualHostImpl(const envoy::api::v2::VirtualHost& virtual_host
     }
   }
 
+  route_index_.compile();
+
   for (const auto& virtual_cluster : virtual_host.virtual_clusters()) {
     virtual_clusters_.push_back(VirtualClusterEntry(virtual_cluster));
   }
 
+  std::vector<const std::string*> virtual_cluster_patterns;
+  for (const VirtualClusterEntry& entry : virtual_clusters_) {
+    virtual_cluster_patterns.push_back(&entry.pattern_string_);
+  }
+  std::vector<int> virtual_cluster_set_indices;
+  virtual_cluster_set_ = buildRegexSet(virtual_cluster_patterns, virtual_cluster_set_indices);
+  for (size_t i = 0; i < virtual_clusters_.size(); i++) {
+    virtual_clusters_[i].set_index_ = virtual_cluster_set_indices[i];
+  }
+
   if (virtual_host.has_cors()) {
     cors_policy_.reset(new CorsPolicyImpl(virtual_host.cors()));
   }
@@ -671,11 +709,26 @@ VirtualHostImpl::VirtualClusterEntry::VirtualClusterEntry(
     method_ = envoy::api::v2::RequestMethod_Name(virtual_cluster.method());
   }
 
-  const std::string pattern = virtual_cluster.pattern();
-  pattern_ = RegexUtil::parseRegex(pattern);
+  pattern_string_ = virtual_cluster.pattern();
+  pattern_ = RegexUtil::parseRegex(pattern_string_);
   name_ = virtual_cluster.name();
 }
 
+RegexSetPtr VirtualHostImpl::buildRegexSet(const std::vector<const std::string*>& patterns,
+                                           std::vector<int>& set_indices) {
+  RegexSetPtr set(new RegexSet());
+  set_indices.clear();
+  for (const std::string* pattern : patterns) {
+    set_indices.push_back(pattern != nullptr ? set->add(*pattern) : -1);
+  }
+
+  if (set->empty()) {
+    return nullptr;
+  }
+  set->compile();
+  return set;
+}
+
 const VirtualHostImpl* RouteMatcher::findWildcardVirtualHost(const std::string& host) const {
   // We do a longest wildcard suffix match against the host that's passed in.
   // (e.g. foo-bar.baz.com should match *-bar.baz.com before matching *.baz.com)
@@ -732,9 +785,24 @@ RouteConstSharedPtr VirtualHostImpl::getRouteFromEntries(const Http::HeaderMap&
     return SSL_REDIRECT_ROUTE;
   }
 
-  // Check for a route that matches the request.
-  for (const RouteEntryImplBaseConstSharedPtr& route : routes_) {
-    RouteConstSharedPtr route_entry = route->matches(headers, random_value);
+  // Only the candidate routes returned by the index can match the path. They are checked in
+  // configuration order so that the first matching route wins. The candidates vector is kept per
+  // thread so that lookups don't allocate. Matching a route never looks up another route, so the
+  // vector isn't reused while it is being iterated.
+  static thread_local std::vector<uint32_t> candidates;
+  const Http::HeaderString& path = headers.Path()->value();
+  const bool index_matched =
+      route_index_.find(absl::string_view(path.c_str(), path.size()), candidates);
+  if (!index_matched) {
+    // RE2 gave up on the path, so every regex route is a candidate and is matched on its own.
+    global_route_config_.stats().regex_set_fallback_.inc();
+  }
+
+  for (uint32_t position : candidates) {
+    const RouteEntryImplBase& route = *routes_[position];
+    RouteConstSharedPtr route_entry = index_matched && route_index_.pathMatched(position)
+                                          ? route.matchesExceptPath(headers, random_value)
+                                          : route.matches(headers, random_value);
     if (nullptr != route_entry) {
       return route_entry;
     }
@@ -782,11 +850,40 @@ const std::shared_ptr<const SslRedirectRoute> VirtualHostImpl::SSL_REDIRECT_ROUT
 
 const VirtualCluster*
 VirtualHostImpl::virtualClusterFromEntries(const Http::HeaderMap& headers) const {
+  // Kept per thread like the candidates of getRouteFromEntries(), so that matching doesn't
+  // allocate.
+  static thread_local std::vector<int> set_matches;
+  set_matches.clear();
+  bool set_matched = true;
+  if (virtual_cluster_set_ != nullptr) {
+    const Http::HeaderString& path = headers.Path()->value();
+    set_matched =
+        virtual_cluster_set_->match(absl::string_view(path.c_str(), path.size()), set_matches);
+    if (!set_matched) {
+      // RE2 gave up on the path, so every virtual cluster is matched with its own regex.
+      global_route_config_.stats().regex_set_fallback_.inc();
+    }
+  }
+  auto next_set_match = set_matches.begin();
+
   for (const VirtualClusterEntry& entry : virtual_clusters_) {
     bool method_matches =
         !entry.method_.valid() || headers.Method()->value().c_str() == entry.method_.value();
+    if (!method_matches) {
+      continue;
+    }
+
+    bool pattern_matches;
+    if (entry.set_index_ < 0 || !set_matched) {
+      pattern_matches = std::regex_match(headers.Path()->value().c_str(), entry.pattern_);
+    } else {
+      while (next_set_match != set_matches.end() && *next_set_match < entry.set_index_) {
+        next_set_match++;
+      }
+      pattern_matches = next_set_match != set_matches.end() && *next_set_match == entry.set_index_;
+    }
 
-    if (method_matches && std::regex_match(headers.Path()->value().c_str(), entry.pattern_)) {
+    if (pattern_matches) {
       return &entry;
     }
   }
@@ -799,7 +896,9 @@ VirtualHostImpl::virtualClusterFromEntries(const Http::HeaderMap& headers) const
 }
 
 ConfigImpl::ConfigImpl(const envoy::api::v2::RouteConfiguration& config, Runtime::Loader& runtime,
-                       Upstream::ClusterManager& cm, bool validate_clusters_default) {
+                       Upstream::ClusterManager& cm, Stats::Scope& scope,
+                       bool validate_clusters_default)
+    : stats_{ALL_ROUTE_CONFIG_STATS(POOL_COUNTER(scope))} {
   route_matcher_.reset(new RouteMatcher(
       config, *this, runtime, cm,
       PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, validate_clusters, validate_clusters_default)));
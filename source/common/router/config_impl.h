@@ -13,12 +13,17 @@
 #include "envoy/common/optional.h"
 #include "envoy/router/router.h"
 #include "envoy/runtime/runtime.h"
+#include "envoy/stats/stats.h"
+#include "envoy/stats/stats_macros.h"
 #include "envoy/upstream/cluster_manager.h"
 
+#include "common/common/regex_set.h"
 #include "common/router/config_utility.h"
 #include "common/router/header_formatter.h"
 #include "common/router/header_parser.h"
+#include "common/router/route_index.h"
 #include "common/router/router_ratelimit.h"
+#include "common/runtime/key_registry.h"
 
 #include "api/rds.pb.h"
 
@@ -125,8 +130,11 @@ private:
     const std::string& name() const override { return name_; }
 
     std::regex pattern_;
+    std::string pattern_string_;
     Optional<std::string> method_;
     std::string name_;
+    // Index of pattern_ in virtual_cluster_set_, or -1 if RE2 could not compile it.
+    int set_index_{-1};
   };
 
   struct CatchAllVirtualCluster : public VirtualCluster {
@@ -136,12 +144,23 @@ private:
     std::string name_{"other"};
   };
 
+  /**
+   * @return RegexSetPtr a compiled set holding every expression that RE2 accepts, or nullptr if
+   *         it accepts none of them. set_indices is filled with the index of each expression in
+   *         the set, or -1 for expressions that must still be matched with std::regex.
+   */
+  static RegexSetPtr buildRegexSet(const std::vector<const std::string*>& patterns,
+                                   std::vector<int>& set_indices);
+
   static const CatchAllVirtualCluster VIRTUAL_CLUSTER_CATCH_ALL;
   static const std::shared_ptr<const SslRedirectRoute> SSL_REDIRECT_ROUTE;
 
   const std::string name_;
   std::vector<RouteEntryImplBaseConstSharedPtr> routes_;
+  // Index over the path matchers of routes_, by position.
+  RouteIndex route_index_;
   std::vector<VirtualClusterEntry> virtual_clusters_;
+  RegexSetPtr virtual_cluster_set_;
   SslRequirements ssl_requirements_;
   const RateLimitPolicyImpl rate_limit_policy_;
   std::unique_ptr<const CorsPolicyImpl> cors_policy_;
@@ -180,11 +199,13 @@ public:
 
   // Router::ShadowPolicy
   const std::string& cluster() const override { return cluster_; }
-  const std::string& runtimeKey() const override { return runtime_key_; }
+  const Runtime::Key& runtimeKey() const override { return runtime_key_; }
 
 private:
+  static Runtime::Key loadRuntimeKey(const envoy::api::v2::RouteAction& config);
+
   std::string cluster_;
-  std::string runtime_key_;
+  const Runtime::Key runtime_key_;
 };
 
 /**
@@ -295,8 +316,15 @@ public:
 
   bool isRedirect() const { return !host_redirect_.empty() || !path_redirect_.empty(); }
   bool isDirectResponse() const { return direct_response_code_.valid(); }
+  bool caseSensitive() const { return case_sensitive_; }
 
   bool matchRoute(const Http::HeaderMap& headers, uint64_t random_value) const;
+  /**
+   * Match the request on everything except its path. Used when the owning virtual host has
+   * already matched the path through its RegexSet.
+   */
+  RouteConstSharedPtr matchesExceptPath(const Http::HeaderMap& headers,
+                                        uint64_t random_value) const;
   void validateClusters(Upstream::ClusterManager& cm) const;
 
   // Router::RouteEntry
@@ -353,7 +381,7 @@ protected:
 
 private:
   struct RuntimeData {
-    std::string key_{};
+    Runtime::Key key_{""};
     uint64_t default_{};
   };
 
@@ -425,8 +453,8 @@ private:
     WeightedClusterEntry(const RouteEntryImplBase* parent, const std::string runtime_key,
                          Runtime::Loader& loader, const std::string& name, uint64_t weight,
                          MetadataMatchCriteriaImplConstPtr cluster_metadata_match_criteria)
-        : DynamicRouteEntry(parent, name), runtime_key_(runtime_key), loader_(loader),
-          cluster_weight_(weight),
+        : DynamicRouteEntry(parent, name), runtime_key_(Runtime::KeyRegistry::intern(runtime_key)),
+          loader_(loader), cluster_weight_(weight),
           cluster_metadata_match_criteria_(std::move(cluster_metadata_match_criteria)) {}
 
     uint64_t clusterWeight() const {
@@ -443,7 +471,7 @@ private:
     static const uint64_t MAX_CLUSTER_WEIGHT;
 
   private:
-    const std::string runtime_key_;
+    const Runtime::Key runtime_key_;
     Runtime::Loader& loader_;
     const uint64_t cluster_weight_;
     MetadataMatchCriteriaImplConstPtr cluster_metadata_match_criteria_;
@@ -509,6 +537,8 @@ public:
   // Router::Matchable
   RouteConstSharedPtr matches(const Http::HeaderMap& headers, uint64_t random_value) const override;
 
+  const std::string& prefix() const { return prefix_; }
+
 private:
   const std::string prefix_;
 };
@@ -528,6 +558,8 @@ public:
   // Router::Matchable
   RouteConstSharedPtr matches(const Http::HeaderMap& headers, uint64_t random_value) const override;
 
+  const std::string& path() const { return path_; }
+
 private:
   const std::string path_;
 };
@@ -547,8 +579,11 @@ public:
   // Router::Matchable
   RouteConstSharedPtr matches(const Http::HeaderMap& headers, uint64_t random_value) const override;
 
+  const std::string& regexString() const { return regex_str_; }
+
 private:
   const std::regex regex_;
+  const std::string regex_str_;
 };
 
 /**
@@ -576,22 +611,39 @@ private:
   // comparison with a fixed cost of about 25ns. For unordered_map, the empty map costs about 65ns
   // and climbs to about 110ns once there are any entries.
   //
-  // The break-even is 4 entries.
+  // The break-even is 4 entries. BM_WildcardSuffixLengths in
+  // test/common/router/config_impl_speed_test.cc measures this.
   std::map<int64_t, std::unordered_map<std::string, VirtualHostSharedPtr>, std::greater<int64_t>>
       wildcard_virtual_host_suffixes_;
   VirtualHostSharedPtr default_virtual_host_;
 };
 
+/**
+ * All route configuration stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_ROUTE_CONFIG_STATS(COUNTER)                                                            \
+  COUNTER(regex_set_fallback)
+// clang-format on
+
+/**
+ * Struct definition for all route configuration stats. @see stats_macros.h
+ */
+struct RouteConfigStats {
+  ALL_ROUTE_CONFIG_STATS(GENERATE_COUNTER_STRUCT)
+};
+
 /**
  * Implementation of Config that reads from a proto file.
  */
 class ConfigImpl : public Config {
 public:
   ConfigImpl(const envoy::api::v2::RouteConfiguration& config, Runtime::Loader& runtime,
-             Upstream::ClusterManager& cm, bool validate_clusters_default);
+             Upstream::ClusterManager& cm, Stats::Scope& scope, bool validate_clusters_default);
 
   const HeaderParser& requestHeaderParser() const { return *request_headers_parser_; };
   const HeaderParser& responseHeaderParser() const { return *response_headers_parser_; };
+  RouteConfigStats& stats() const { return stats_; }
 
   // Router::Config
   RouteConstSharedPtr route(const Http::HeaderMap& headers, uint64_t random_value) const override {
@@ -603,6 +655,8 @@ public:
   }
 
 private:
+  // Counted while routing requests, through the const Router::Config interface.
+  mutable RouteConfigStats stats_;
   std::unique_ptr<RouteMatcher> route_matcher_;
   std::list<Http::LowerCaseString> internal_only_headers_;
   HeaderParserPtr request_headers_parser_;
@@ -26,7 +26,7 @@ RouteConfigProviderSharedPtr RouteConfigProviderUtil::create(
   switch (config.route_specifier_case()) {
   case envoy::api::v2::filter::network::HttpConnectionManager::kRouteConfig:
     return RouteConfigProviderSharedPtr{
-        new StaticRouteConfigProviderImpl(config.route_config(), runtime, cm)};
+        new StaticRouteConfigProviderImpl(config.route_config(), runtime, cm, scope, stat_prefix)};
   case envoy::api::v2::filter::network::HttpConnectionManager::kRds:
     return route_config_provider_manager.getRouteConfigProvider(config.rds(), cm, scope,
                                                                 stat_prefix, init_manager);
@@ -37,8 +37,9 @@ RouteConfigProviderSharedPtr RouteConfigProviderUtil::create(
 
 StaticRouteConfigProviderImpl::StaticRouteConfigProviderImpl(
     const envoy::api::v2::RouteConfiguration& config, Runtime::Loader& runtime,
-    Upstream::ClusterManager& cm)
-    : config_(new ConfigImpl(config, runtime, cm, true)) {}
+    Upstream::ClusterManager& cm, Stats::Scope& scope, const std::string& stat_prefix)
+    : scope_(scope.createScope(stat_prefix + "route_config.")),
+      config_(new ConfigImpl(config, runtime, cm, *scope_, true)) {}
 
 // TODO(htuch): If support for multiple clusters is added per #1170 cluster_name_
 // initialization needs to be fixed.
@@ -114,7 +115,7 @@ void RdsRouteConfigProviderImpl::onConfigUpdate(const ResourceVector& resources)
   }
   const uint64_t new_hash = MessageUtil::hash(route_config);
   if (new_hash != last_config_hash_ || !initialized_) {
-    ConfigConstSharedPtr new_config(new ConfigImpl(route_config, runtime_, cm_, false));
+    ConfigConstSharedPtr new_config(new ConfigImpl(route_config, runtime_, cm_, *scope_, false));
     initialized_ = true;
     last_config_hash_ = new_hash;
     stats_.config_reload_.inc();
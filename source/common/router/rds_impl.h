@@ -46,13 +46,15 @@ public:
 class StaticRouteConfigProviderImpl : public RouteConfigProvider {
 public:
   StaticRouteConfigProviderImpl(const envoy::api::v2::RouteConfiguration& config,
-                                Runtime::Loader& runtime, Upstream::ClusterManager& cm);
+                                Runtime::Loader& runtime, Upstream::ClusterManager& cm,
+                                Stats::Scope& scope, const std::string& stat_prefix);
 
   // Router::RouteConfigProvider
   Router::ConfigConstSharedPtr config() override { return config_; }
   const std::string versionInfo() const override { CONSTRUCT_ON_FIRST_USE(std::string, "static"); }
 
 private:
+  Stats::ScopePtr scope_;
   ConfigConstSharedPtr config_;
 };
 
@@ -11,6 +11,7 @@
 #include "common/http/codes.h"
 #include "common/http/headers.h"
 #include "common/http/utility.h"
+#include "common/runtime/key_registry.h"
 
 namespace Envoy {
 namespace Router {
@@ -25,6 +26,10 @@ const uint32_t RetryPolicy::RETRY_ON_GRPC_CANCELLED;
 const uint32_t RetryPolicy::RETRY_ON_GRPC_DEADLINE_EXCEEDED;
 const uint32_t RetryPolicy::RETRY_ON_GRPC_RESOURCE_EXHAUSTED;
 
+static const Runtime::Key RuntimeBaseRetryBackoffMs =
+    Runtime::KeyRegistry::intern("upstream.base_retry_backoff_ms");
+static const Runtime::Key RuntimeUseRetry = Runtime::KeyRegistry::intern("upstream.use_retry");
+
 RetryStatePtr RetryStateImpl::create(const RetryPolicy& route_policy,
                                      Http::HeaderMap& request_headers,
                                      const Upstream::ClusterInfo& cluster, Runtime::Loader& runtime,
@@ -78,7 +83,7 @@ void RetryStateImpl::enableBackoffTimer() {
   // We use a fully jittered exponential backoff algorithm.
   current_retry_++;
   uint32_t multiplier = (1 << current_retry_) - 1;
-  uint64_t base = runtime_.snapshot().getInteger("upstream.base_retry_backoff_ms", 25);
+  uint64_t base = runtime_.snapshot().getInteger(RuntimeBaseRetryBackoffMs, 25);
   uint64_t timeout = random_.random() % (base * multiplier);
 
   if (!retry_timer_) {
@@ -154,7 +159,7 @@ RetryStatus RetryStateImpl::shouldRetry(const Http::HeaderMap* response_headers,
     return RetryStatus::NoOverflow;
   }
 
-  if (!runtime_.snapshot().featureEnabled("upstream.use_retry", 100)) {
+  if (!runtime_.snapshot().featureEnabled(RuntimeUseRetry, 100)) {
     return RetryStatus::No;
   }
 
@@ -0,0 +1,195 @@
+#include "common/router/route_index.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+
+#include "absl/strings/ascii.h"
+
+namespace Envoy {
+namespace Router {
+
+namespace {
+
+const uint32_t NO_CHILD = UINT32_MAX;
+
+bool firstByteLess(const std::string& label, char c) {
+  return static_cast<unsigned char>(label[0]) < static_cast<unsigned char>(c);
+}
+
+// Compare the bytes of path at offset against a label, which path must be long enough to hold.
+bool labelMatches(const std::string& label, absl::string_view path, size_t offset,
+                  bool ignore_case) {
+  if (!ignore_case) {
+    return path.compare(offset, label.size(), label) == 0;
+  }
+  for (size_t i = 0; i < label.size(); i++) {
+    if (absl::ascii_tolower(path[offset + i]) != label[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+PathRadixTree::PathRadixTree() : nodes_(1) {}
+
+void PathRadixTree::addPrefix(const std::string& prefix, uint32_t position) {
+  nodes_[insert(prefix)].prefix_positions_.push_back(position);
+  empty_ = false;
+}
+
+void PathRadixTree::addPath(const std::string& path, uint32_t position) {
+  nodes_[insert(path)].path_positions_.push_back(position);
+  empty_ = false;
+}
+
+uint32_t PathRadixTree::findChild(const Node& node, char c) const {
+  const auto it = std::lower_bound(
+      node.children_.begin(), node.children_.end(), c,
+      [this](uint32_t child, char value) { return firstByteLess(nodes_[child].label_, value); });
+  if (it == node.children_.end() || nodes_[*it].label_[0] != c) {
+    return NO_CHILD;
+  }
+  return *it;
+}
+
+uint32_t PathRadixTree::insert(const std::string& key) {
+  uint32_t node = 0;
+  size_t depth = 0;
+  while (depth < key.size()) {
+    const uint32_t child = findChild(nodes_[node], key[depth]);
+    if (child == NO_CHILD) {
+      // No edge shares a first byte with the rest of the key, so it becomes a new leaf.
+      const uint32_t leaf = nodes_.size();
+      nodes_.emplace_back();
+      nodes_[leaf].label_ = key.substr(depth);
+      std::vector<uint32_t>& children = nodes_[node].children_;
+      children.insert(std::lower_bound(children.begin(), children.end(), key[depth],
+                                       [this](uint32_t sibling, char value) {
+                                         return firstByteLess(nodes_[sibling].label_, value);
+                                       }),
+                      leaf);
+      return leaf;
+    }
+
+    const std::string& label = nodes_[child].label_;
+    size_t common = 1;
+    while (common < label.size() && depth + common < key.size() &&
+           label[common] == key[depth + common]) {
+      common++;
+    }
+
+    if (common < label.size()) {
+      // The key ends or diverges inside the edge, so split the edge at the divergence point. The
+      // new node has the same first byte as the child it replaces, so the order of the parent's
+      // children is unchanged.
+      const uint32_t middle = nodes_.size();
+      nodes_.emplace_back();
+      nodes_[middle].label_ = nodes_[child].label_.substr(0, common);
+      nodes_[middle].children_.push_back(child);
+      nodes_[child].label_ = nodes_[child].label_.substr(common);
+      std::replace(nodes_[node].children_.begin(), nodes_[node].children_.end(), child, middle);
+      node = middle;
+    } else {
+      node = child;
+    }
+    depth += common;
+  }
+  return node;
+}
+
+void PathRadixTree::find(absl::string_view path, size_t path_length, bool ignore_case,
+                         std::vector<uint32_t>& positions) const {
+  ASSERT(path_length <= path.size());
+  uint32_t node = 0;
+  size_t depth = 0;
+  while (true) {
+    const Node& current = nodes_[node];
+    positions.insert(positions.end(), current.prefix_positions_.begin(),
+                     current.prefix_positions_.end());
+    if (depth == path_length) {
+      positions.insert(positions.end(), current.path_positions_.begin(),
+                       current.path_positions_.end());
+    }
+    if (depth == path.size()) {
+      return;
+    }
+
+    const uint32_t child =
+        findChild(current, ignore_case ? absl::ascii_tolower(path[depth]) : path[depth]);
+    if (child == NO_CHILD) {
+      return;
+    }
+    const std::string& label = nodes_[child].label_;
+    if (path.size() - depth < label.size() || !labelMatches(label, path, depth, ignore_case)) {
+      return;
+    }
+    depth += label.size();
+    node = child;
+  }
+}
+
+void RouteIndex::addPrefix(const std::string& prefix, bool case_sensitive, uint32_t position) {
+  if (case_sensitive) {
+    case_sensitive_tree_.addPrefix(prefix, position);
+  } else {
+    case_insensitive_tree_.addPrefix(absl::AsciiStrToLower(prefix), position);
+  }
+  path_matched_.resize(position + 1);
+  path_matched_[position] = true;
+}
+
+void RouteIndex::addPath(const std::string& path, bool case_sensitive, uint32_t position) {
+  if (case_sensitive) {
+    case_sensitive_tree_.addPath(path, position);
+  } else {
+    case_insensitive_tree_.addPath(absl::AsciiStrToLower(path), position);
+  }
+  path_matched_.resize(position + 1);
+  path_matched_[position] = true;
+}
+
+void RouteIndex::addRegex(const std::string& regex, uint32_t position) {
+  path_matched_.resize(position + 1);
+  if (regex_set_.add(regex) >= 0) {
+    regex_positions_.push_back(position);
+    path_matched_[position] = true;
+  } else {
+    unindexed_positions_.push_back(position);
+  }
+}
+
+void RouteIndex::compile() { regex_set_.compile(); }
+
+bool RouteIndex::find(absl::string_view path, std::vector<uint32_t>& positions) const {
+  positions.assign(unindexed_positions_.begin(), unindexed_positions_.end());
+
+  const size_t path_length = std::min(path.find('?'), path.size());
+  case_sensitive_tree_.find(path, path_length, false, positions);
+  if (!case_insensitive_tree_.empty()) {
+    case_insensitive_tree_.find(path, path_length, true, positions);
+  }
+
+  bool regex_matched = true;
+  if (!regex_set_.empty()) {
+    // RE2 reports the matches in a vector, which is kept per thread so that it is only allocated
+    // by the first lookups on each thread.
+    static thread_local std::vector<int> regex_matches;
+    regex_matched = regex_set_.match(path.substr(0, path_length), regex_matches);
+    if (regex_matched) {
+      for (int index : regex_matches) {
+        positions.push_back(regex_positions_[index]);
+      }
+    } else {
+      positions.insert(positions.end(), regex_positions_.begin(), regex_positions_.end());
+    }
+  }
+
+  std::sort(positions.begin(), positions.end());
+  return regex_matched;
+}
+
+} // namespace Router
+} // namespace Envoy
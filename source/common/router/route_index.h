@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/common/regex_set.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * Radix tree of path prefixes and exact paths. Each key maps to the positions of the routes that
+ * were configured with it.
+ */
+class PathRadixTree {
+public:
+  PathRadixTree();
+
+  /**
+   * Add a route that matches all paths starting with prefix.
+   */
+  void addPrefix(const std::string& prefix, uint32_t position);
+
+  /**
+   * Add a route that matches path exactly, ignoring the query string of the request.
+   */
+  void addPath(const std::string& path, uint32_t position);
+
+  /**
+   * @return true if no route has been added to the tree.
+   */
+  bool empty() const { return empty_; }
+
+  /**
+   * Append the positions of all routes whose key matches a request path. The positions are
+   * appended in no particular order.
+   * @param path supplies the full request path, including any query string.
+   * @param path_length supplies the length of path without the query string.
+   * @param ignore_case supplies whether path is compared as if it were lower cased, in which case
+   *        all keys must have been added in lower case.
+   * @param positions supplies the vector to append to.
+   */
+  void find(absl::string_view path, size_t path_length, bool ignore_case,
+            std::vector<uint32_t>& positions) const;
+
+private:
+  struct Node {
+    // The label of the edge from the parent to this node. Empty for the root.
+    std::string label_;
+    // Indices into nodes_ of the children of this node, ordered by the first byte of their label.
+    std::vector<uint32_t> children_;
+    std::vector<uint32_t> prefix_positions_;
+    std::vector<uint32_t> path_positions_;
+  };
+
+  uint32_t insert(const std::string& key);
+  uint32_t findChild(const Node& node, char c) const;
+
+  // All nodes of the tree, with the root at index 0. Nodes are stored contiguously rather than
+  // individually allocated to keep lookups cache friendly.
+  std::vector<Node> nodes_;
+  bool empty_{true};
+};
+
+/**
+ * Index over the routes of a virtual host, used to find the routes whose path matcher accepts a
+ * request without comparing the path against every route. Prefix and exact path routes are kept
+ * in radix trees and regex routes in a RegexSet. Regex routes that RE2 cannot compile are never
+ * ruled out by the index and are always returned as candidates.
+ */
+class RouteIndex {
+public:
+  void addPrefix(const std::string& prefix, bool case_sensitive, uint32_t position);
+  void addPath(const std::string& path, bool case_sensitive, uint32_t position);
+  void addRegex(const std::string& regex, uint32_t position);
+
+  /**
+   * Compile the index. Must be called once after all routes have been added.
+   */
+  void compile();
+
+  /**
+   * Find the candidate routes for a request path. This does not allocate once positions has grown
+   * to the number of candidates, so callers should reuse it across requests.
+   * @param path supplies the full request path, including any query string.
+   * @param positions is filled with the positions of the candidate routes in ascending order.
+   * @return bool false if the regex routes could not be matched through the RegexSet, in which
+   *         case all of them are returned as candidates and pathMatched() must be ignored.
+   */
+  bool find(absl::string_view path, std::vector<uint32_t>& positions) const;
+
+  /**
+   * @return true if the index has matched the path of the route at position whenever find()
+   *         returns it as a candidate and true, in which case only the remaining route constraints
+   *         (headers, query parameters, runtime) need to be checked.
+   */
+  bool pathMatched(uint32_t position) const { return path_matched_[position]; }
+
+private:
+  PathRadixTree case_sensitive_tree_;
+  // Keys are lower cased, and the request path is compared as if it were.
+  PathRadixTree case_insensitive_tree_;
+  RegexSet regex_set_;
+  // Route position for each index of regex_set_.
+  std::vector<uint32_t> regex_positions_;
+  // Routes that must always be checked in full.
+  std::vector<uint32_t> unindexed_positions_;
+  std::vector<bool> path_matched_;
+};
+
+} // namespace Router
+} // namespace Envoy
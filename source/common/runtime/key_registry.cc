@@ -0,0 +1,91 @@
+#include "common/runtime/key_registry.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Envoy {
+namespace Runtime {
+
+namespace {
+
+struct KeyRegistryState {
+  struct Slot {
+    std::string name_;
+    uint64_t generation_{};
+    uint32_t references_{};
+  };
+
+  std::mutex lock_;
+  std::unordered_map<std::string, uint32_t> indexes_;
+  std::vector<Slot> slots_;
+  std::vector<uint32_t> free_indexes_;
+  uint64_t next_generation_{1};
+};
+
+KeyRegistryState& state() {
+  // Leaked so that keys may be interned and released during static destruction.
+  static KeyRegistryState* state = new KeyRegistryState();
+  return *state;
+}
+
+/**
+ * Held by every copy of a key returned by one call to KeyRegistry::intern(), and releases the
+ * reference that the call took on the key's index when the last copy is destroyed.
+ */
+class Registration {
+public:
+  Registration(uint32_t index) : index_(index) {}
+
+  ~Registration() {
+    KeyRegistryState& registry = state();
+    std::unique_lock<std::mutex> lock(registry.lock_);
+    KeyRegistryState::Slot& slot = registry.slots_[index_];
+    if (--slot.references_ == 0) {
+      registry.indexes_.erase(slot.name_);
+      slot.name_.clear();
+      registry.free_indexes_.push_back(index_);
+    }
+  }
+
+private:
+  const uint32_t index_;
+};
+
+} // namespace
+
+Key KeyRegistry::intern(const std::string& name) {
+  KeyRegistryState& registry = state();
+  std::unique_lock<std::mutex> lock(registry.lock_);
+  auto it = registry.indexes_.find(name);
+  if (it == registry.indexes_.end()) {
+    uint32_t index;
+    if (!registry.free_indexes_.empty()) {
+      index = registry.free_indexes_.back();
+      registry.free_indexes_.pop_back();
+    } else {
+      index = registry.slots_.size();
+      registry.slots_.emplace_back();
+    }
+
+    KeyRegistryState::Slot& slot = registry.slots_[index];
+    slot.name_ = name;
+    slot.generation_ = registry.next_generation_++;
+    it = registry.indexes_.emplace(name, index).first;
+  }
+
+  KeyRegistryState::Slot& slot = registry.slots_[it->second];
+  slot.references_++;
+  return Key(it->second, slot.generation_, name, std::make_shared<Registration>(it->second));
+}
+
+uint32_t KeyRegistry::size() {
+  KeyRegistryState& registry = state();
+  std::unique_lock<std::mutex> lock(registry.lock_);
+  return registry.indexes_.size();
+}
+
+} // namespace Runtime
+} // namespace Envoy
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "envoy/runtime/runtime.h"
+
+namespace Envoy {
+namespace Runtime {
+
+/**
+ * Process wide registry of interned runtime keys. Each distinct key name is assigned a dense index,
+ * which snapshots use to resolve interned keys into an array. The index of a name is released when
+ * no key interned with the name is left, and is then reused for the next new name, so the registry
+ * only grows with the number of keys in use, e.g. as clusters and routes are added and removed.
+ * Thread safe.
+ */
+class KeyRegistry {
+public:
+  /**
+   * Intern a runtime key. Interning a name that is still in use returns a key with the same index
+   * and generation.
+   * @param name supplies the key name.
+   * @return Key the interned key.
+   */
+  static Key intern(const std::string& name);
+
+  /**
+   * @return uint32_t the number of distinct key names that are currently interned.
+   */
+  static uint32_t size();
+};
+
+} // namespace Runtime
+} // namespace Envoy
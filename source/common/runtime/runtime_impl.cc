@@ -3,10 +3,12 @@
 #include <fcntl.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <random>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "envoy/event/dispatcher.h"
 #include "envoy/stats/stats.h"
@@ -22,6 +24,34 @@
 namespace Envoy {
 namespace Runtime {
 
+namespace {
+
+uint64_t integerValue(const Snapshot::Entry* entry, uint64_t default_value) {
+  if (entry == nullptr || !entry->uint_value_.valid()) {
+    return default_value;
+  }
+  return entry->uint_value_.value();
+}
+
+bool percentEnabled(uint64_t percent, RandomGenerator& generator) {
+  // Avoid PNRG if we know we don't need it.
+  uint64_t cutoff = std::min(percent, static_cast<uint64_t>(100));
+  if (cutoff == 0) {
+    return false;
+  } else if (cutoff == 100) {
+    return true;
+  } else {
+    return generator.random() % 100 < cutoff;
+  }
+}
+
+bool bucketEnabled(uint64_t enabled_buckets, uint64_t random_value, uint16_t num_buckets) {
+  return random_value % static_cast<uint64_t>(num_buckets) <
+         std::min(enabled_buckets, static_cast<uint64_t>(num_buckets));
+}
+
+} // namespace
+
 const size_t RandomGeneratorImpl::UUID_LENGTH = 36;
 
 uint64_t RandomGeneratorImpl::random() {
@@ -170,22 +200,32 @@ SnapshotImpl::SnapshotImpl(const std::string& root_path, const std::string& over
   stats.num_keys_.set(values_.size());
 }
 
-const std::string& SnapshotImpl::get(const std::string& key) const {
+const Snapshot::Entry* SnapshotImpl::find(const std::string& key) const {
   auto entry = values_.find(key);
-  if (entry == values_.end()) {
-    return EMPTY_STRING;
-  } else {
-    return entry->second.string_value_;
-  }
+  return entry == values_.end() ? nullptr : &entry->second;
+}
+
+bool SnapshotImpl::featureEnabled(const std::string& key, uint64_t default_value) const {
+  return percentEnabled(getInteger(key, default_value), generator_);
+}
+
+bool SnapshotImpl::featureEnabled(const std::string& key, uint64_t default_value,
+                                  uint64_t random_value) const {
+  return featureEnabled(key, default_value, random_value, 100);
+}
+
+bool SnapshotImpl::featureEnabled(const std::string& key, uint64_t default_value,
+                                  uint64_t random_value, uint16_t num_buckets) const {
+  return bucketEnabled(getInteger(key, default_value), random_value, num_buckets);
+}
+
+const std::string& SnapshotImpl::get(const std::string& key) const {
+  const Entry* entry = find(key);
+  return entry == nullptr ? EMPTY_STRING : entry->string_value_;
 }
 
 uint64_t SnapshotImpl::getInteger(const std::string& key, uint64_t default_value) const {
-  auto entry = values_.find(key);
-  if (entry == values_.end() || !entry->second.uint_value_.valid()) {
-    return default_value;
-  } else {
-    return entry->second.uint_value_.value();
-  }
+  return integerValue(find(key), default_value);
 }
 
 const std::unordered_map<std::string, const Snapshot::Entry>& SnapshotImpl::getAll() const {
@@ -261,6 +301,36 @@ void SnapshotImpl::walkDirectory(const std::string& path, const std::string& pre
   }
 }
 
+bool ThreadLocalSnapshotImpl::featureEnabled(const Key& key, uint64_t default_value) const {
+  return percentEnabled(getInteger(key, default_value), generator_);
+}
+
+bool ThreadLocalSnapshotImpl::featureEnabled(const Key& key, uint64_t default_value,
+                                             uint64_t random_value, uint16_t num_buckets) const {
+  return bucketEnabled(getInteger(key, default_value), random_value, num_buckets);
+}
+
+uint64_t ThreadLocalSnapshotImpl::getInteger(const Key& key, uint64_t default_value) const {
+  return integerValue(find(key), default_value);
+}
+
+const Snapshot::Entry* ThreadLocalSnapshotImpl::find(const Key& key) const {
+  // A key that was not interned with the registry can only be found by name.
+  if (key.generation() == 0) {
+    return snapshot_->find(key.name());
+  }
+
+  if (key.index() >= keys_.size()) {
+    keys_.resize(key.index() + 1);
+  }
+  ResolvedKey& resolved = keys_[key.index()];
+  if (resolved.generation_ != key.generation()) {
+    resolved.generation_ = key.generation();
+    resolved.entry_ = snapshot_->find(key.name());
+  }
+  return resolved.entry_;
+}
+
 LoaderImpl::LoaderImpl(Event::Dispatcher& dispatcher, ThreadLocal::SlotAllocator& tls,
                        const std::string& root_symlink_path, const std::string& subdir,
                        const std::string& override_dir, Stats::Store& store,
@@ -285,9 +355,10 @@ RuntimeStats LoaderImpl::generateStats(Stats::Store& store) {
 void LoaderImpl::onSymlinkSwap() {
   current_snapshot_.reset(
       new SnapshotImpl(root_path_, override_path_, stats_, generator_, *os_sys_calls_));
-  ThreadLocal::ThreadLocalObjectSharedPtr ptr_copy = current_snapshot_;
-  tls_->set([ptr_copy](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
-    return ptr_copy;
+  std::shared_ptr<const SnapshotImpl> ptr_copy = current_snapshot_;
+  RandomGenerator& generator = generator_;
+  tls_->set([ptr_copy, &generator](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ThreadLocalSnapshotImpl>(ptr_copy, generator);
   });
 }
 
@@ -6,6 +6,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "envoy/api/os_sys_calls.h"
 #include "envoy/common/exception.h"
@@ -57,39 +58,39 @@ struct RuntimeStats {
 /**
  * Implementation of Snapshot that reads from disk.
  */
-class SnapshotImpl : public Snapshot,
-                     public ThreadLocal::ThreadLocalObject,
-                     Logger::Loggable<Logger::Id::runtime> {
+class SnapshotImpl : public Snapshot, Logger::Loggable<Logger::Id::runtime> {
 public:
   SnapshotImpl(const std::string& root_path, const std::string& override_path, RuntimeStats& stats,
                RandomGenerator& generator, Api::OsSysCalls& os_sys_calls);
 
+  /**
+   * @param key supplies the key to find.
+   * @return const Entry* the entry for the key, or nullptr if the key does not exist.
+   */
+  const Entry* find(const std::string& key) const;
+
   // Runtime::Snapshot
+  bool featureEnabled(const std::string& key, uint64_t default_value) const override;
+  bool featureEnabled(const std::string& key, uint64_t default_value,
+                      uint64_t random_value) const override;
   bool featureEnabled(const std::string& key, uint64_t default_value, uint64_t random_value,
-                      uint16_t num_buckets) const override {
-    return random_value % static_cast<uint64_t>(num_buckets) <
-           std::min(getInteger(key, default_value), static_cast<uint64_t>(num_buckets));
-  }
-
-  bool featureEnabled(const std::string& key, uint64_t default_value) const override {
-    // Avoid PNRG if we know we don't need it.
-    uint64_t cutoff = std::min(getInteger(key, default_value), static_cast<uint64_t>(100));
-    if (cutoff == 0) {
-      return false;
-    } else if (cutoff == 100) {
-      return true;
-    } else {
-      return generator_.random() % 100 < cutoff;
-    }
+                      uint16_t num_buckets) const override;
+  bool featureEnabled(const Key& key, uint64_t default_value) const override {
+    return featureEnabled(key.name(), default_value);
   }
-
-  bool featureEnabled(const std::string& key, uint64_t default_value,
+  bool featureEnabled(const Key& key, uint64_t default_value,
                       uint64_t random_value) const override {
-    return featureEnabled(key, default_value, random_value, 100);
+    return featureEnabled(key.name(), default_value, random_value);
+  }
+  bool featureEnabled(const Key& key, uint64_t default_value, uint64_t random_value,
+                      uint16_t num_buckets) const override {
+    return featureEnabled(key.name(), default_value, random_value, num_buckets);
   }
-
   const std::string& get(const std::string& key) const override;
   uint64_t getInteger(const std::string&, uint64_t default_value) const override;
+  uint64_t getInteger(const Key& key, uint64_t default_value) const override {
+    return getInteger(key.name(), default_value);
+  }
   const std::unordered_map<std::string, const Snapshot::Entry>& getAll() const override;
 
 private:
@@ -113,6 +114,59 @@ private:
   Api::OsSysCalls& os_sys_calls_;
 };
 
+/**
+ * Per thread view of a SnapshotImpl, which is shared by all threads. The first lookup of an
+ * interned key on the thread finds its entry by name and keeps it in a dense array at the key's
+ * index, so later lookups only index the array. An entry is found again if the index has since
+ * been given to another key, which has a different generation.
+ */
+class ThreadLocalSnapshotImpl : public Snapshot, public ThreadLocal::ThreadLocalObject {
+public:
+  ThreadLocalSnapshotImpl(std::shared_ptr<const SnapshotImpl> snapshot, RandomGenerator& generator)
+      : snapshot_(snapshot), generator_(generator) {}
+
+  // Runtime::Snapshot
+  bool featureEnabled(const std::string& key, uint64_t default_value) const override {
+    return snapshot_->featureEnabled(key, default_value);
+  }
+  bool featureEnabled(const std::string& key, uint64_t default_value,
+                      uint64_t random_value) const override {
+    return snapshot_->featureEnabled(key, default_value, random_value);
+  }
+  bool featureEnabled(const std::string& key, uint64_t default_value, uint64_t random_value,
+                      uint16_t num_buckets) const override {
+    return snapshot_->featureEnabled(key, default_value, random_value, num_buckets);
+  }
+  bool featureEnabled(const Key& key, uint64_t default_value) const override;
+  bool featureEnabled(const Key& key, uint64_t default_value,
+                      uint64_t random_value) const override {
+    return featureEnabled(key, default_value, random_value, 100);
+  }
+  bool featureEnabled(const Key& key, uint64_t default_value, uint64_t random_value,
+                      uint16_t num_buckets) const override;
+  const std::string& get(const std::string& key) const override { return snapshot_->get(key); }
+  uint64_t getInteger(const std::string& key, uint64_t default_value) const override {
+    return snapshot_->getInteger(key, default_value);
+  }
+  uint64_t getInteger(const Key& key, uint64_t default_value) const override;
+  const std::unordered_map<std::string, const Snapshot::Entry>& getAll() const override {
+    return snapshot_->getAll();
+  }
+
+private:
+  struct ResolvedKey {
+    uint64_t generation_{};
+    const Entry* entry_{};
+  };
+
+  const Entry* find(const Key& key) const;
+
+  const std::shared_ptr<const SnapshotImpl> snapshot_;
+  RandomGenerator& generator_;
+  // Only accessed on the owning thread, which is the only thread that sees this object.
+  mutable std::vector<ResolvedKey> keys_;
+};
+
 /**
  * Implementation of Loader that watches a symlink for swapping and loads a specified subdirectory
  * from disk. A single snapshot is shared among all threads and referenced by shared_ptr such that
@@ -179,12 +233,30 @@ private:
       return featureEnabled(key, default_value, random_value, 100);
     }
 
+    bool featureEnabled(const Key& key, uint64_t default_value) const override {
+      return featureEnabled(key.name(), default_value);
+    }
+
+    bool featureEnabled(const Key& key, uint64_t default_value,
+                        uint64_t random_value) const override {
+      return featureEnabled(key.name(), default_value, random_value);
+    }
+
+    bool featureEnabled(const Key& key, uint64_t default_value, uint64_t random_value,
+                        uint16_t num_buckets) const override {
+      return featureEnabled(key.name(), default_value, random_value, num_buckets);
+    }
+
     const std::string& get(const std::string&) const override { return EMPTY_STRING; }
 
     uint64_t getInteger(const std::string&, uint64_t default_value) const override {
       return default_value;
     }
 
+    uint64_t getInteger(const Key&, uint64_t default_value) const override {
+      return default_value;
+    }
+
     const std::unordered_map<std::string, const Snapshot::Entry>& getAll() const override {
       return values_;
     }
@@ -1,6 +1,7 @@
 #include "common/ssl/context_impl.h"
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <string>
 #include <vector>
@@ -10,6 +11,7 @@
 
 #include "common/common/assert.h"
 #include "common/common/hex.h"
+#include "common/ssl/session_cache.h"
 
 #include "fmt/format.h"
 #include "openssl/hmac.h"
@@ -19,6 +21,15 @@
 namespace Envoy {
 namespace Ssl {
 
+namespace {
+
+uint64_t nextSessionCacheKey() {
+  static std::atomic<uint64_t> next_key{};
+  return next_key++;
+}
+
+} // namespace
+
 int ContextImpl::sslContextIndex() {
   CONSTRUCT_ON_FIRST_USE(int, []() -> int {
     int ssl_context_index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
@@ -318,6 +329,8 @@ bool ContextImpl::verifyCertificateHash(X509* cert, const std::vector<uint8_t>&
   return computed_hash == expected_hash;
 }
 
+Runtime::Loader& ContextImpl::runtime() { return parent_.runtime(); }
+
 SslStats ContextImpl::generateStats(Stats::Scope& store) {
   std::string prefix("ssl.");
   return {ALL_SSL_STATS(POOL_COUNTER_PREFIX(store, prefix), POOL_GAUGE_PREFIX(store, prefix),
@@ -390,7 +403,7 @@ bssl::UniquePtr<X509> ContextImpl::loadCert(const std::string& cert_file) {
 
 ClientContextImpl::ClientContextImpl(ContextManagerImpl& parent, Stats::Scope& scope,
                                      const ClientContextConfig& config)
-    : ContextImpl(parent, scope, config) {
+    : ContextImpl(parent, scope, config), session_cache_key_(nextSessionCacheKey()) {
   if (!parsed_alpn_protocols_.empty()) {
     int rc = SSL_CTX_set_alpn_protos(ctx_.get(), &parsed_alpn_protocols_[0],
                                      parsed_alpn_protocols_.size());
@@ -399,6 +412,20 @@ ClientContextImpl::ClientContextImpl(ContextManagerImpl& parent, Stats::Scope& s
   }
 
   server_name_indication_ = config.serverNameIndication();
+
+  // Keep the sessions of upstream connections in the session cache of the thread that made them,
+  // so that later connections of the thread resume them with their session ID or ticket.
+  SSL_CTX_set_session_cache_mode(ctx_.get(), SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL);
+  SSL_CTX_sess_set_new_cb(ctx_.get(), newSessionCallback);
+}
+
+int ClientContextImpl::newSessionCallback(SSL* ssl, SSL_SESSION* session) {
+  ClientContextImpl* context_impl = static_cast<ClientContextImpl*>(
+      static_cast<ContextImpl*>(SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), sslContextIndex())));
+  ClientSessionCache::threadLocal().set(context_impl->session_cache_key_,
+                                        bssl::UniquePtr<SSL_SESSION>(session));
+  // The cache now owns the session.
+  return 1;
 }
 
 bssl::UniquePtr<SSL> ClientContextImpl::newSsl() const {
@@ -410,6 +437,16 @@ bssl::UniquePtr<SSL> ClientContextImpl::newSsl() const {
     UNREFERENCED_PARAMETER(rc);
   }
 
+  SSL_SESSION* session = ClientSessionCache::threadLocal().get(session_cache_key_);
+  if (session != nullptr) {
+    stats_.session_cache_hit_.inc();
+    int rc = SSL_set_session(ssl_con.get(), session);
+    RELEASE_ASSERT(rc == 1);
+    UNREFERENCED_PARAMETER(rc);
+  } else {
+    stats_.session_cache_miss_.inc();
+  }
+
   return ssl_con;
 }
 
@@ -471,6 +508,15 @@ ServerContextImpl::ServerContextImpl(ContextManagerImpl& parent, const std::stri
     }
   }
 
+  // Hand the signatures of the handshakes to the offload pool, if there is one, so that they don't
+  // stall the workers.
+  if (!config.privateKey().empty()) {
+    private_key_offload_pool_ = parent.privateKeyOffloadPool();
+    if (private_key_offload_pool_ != nullptr) {
+      SSL_CTX_set_private_key_method(ctx_.get(), &PrivateKeyOffloadPool::method());
+    }
+  }
+
   parsed_alt_alpn_protocols_ = parseAlpnProtocols(config.altAlpnProtocols());
 
   if (!parsed_alpn_protocols_.empty()) {
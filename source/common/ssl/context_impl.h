@@ -11,6 +11,7 @@
 
 #include "common/ssl/context_impl.h"
 #include "common/ssl/context_manager_impl.h"
+#include "common/ssl/private_key_offload.h"
 
 #include "openssl/ssl.h"
 
@@ -26,12 +27,16 @@ namespace Ssl {
   COUNTER(connection_error)                                                                        \
   COUNTER(handshake)                                                                               \
   COUNTER(session_reused)                                                                          \
+  COUNTER(session_cache_hit)                                                                       \
+  COUNTER(session_cache_miss)                                                                      \
   COUNTER(no_certificate)                                                                          \
   COUNTER(fail_no_sni_match)                                                                       \
   COUNTER(fail_verify_no_cert)                                                                     \
   COUNTER(fail_verify_error)                                                                       \
   COUNTER(fail_verify_san)                                                                         \
-  COUNTER(fail_verify_cert_hash)
+  COUNTER(fail_verify_cert_hash)                                                                   \
+  GAUGE(private_key_operations_pending)                                                            \
+  HISTOGRAM(private_key_operation_ms)
 // clang-format on
 
 /**
@@ -70,6 +75,17 @@ public:
 
   SslStats& stats() { return stats_; }
 
+  /**
+   * @return PrivateKeyOffloadPool* the pool that does the private key operations of the context's
+   *         connections, or nullptr if they are done inline.
+   */
+  PrivateKeyOffloadPool* privateKeyOffloadPool() const { return private_key_offload_pool_; }
+
+  /**
+   * @return Runtime::Loader& the runtime that the context's connections read their settings from.
+   */
+  Runtime::Loader& runtime();
+
   // Ssl::Context
   size_t daysUntilFirstCertExpires() const override;
   std::string getCaCertInformation() const override;
@@ -121,6 +137,7 @@ protected:
   const uint16_t min_protocol_version_;
   const uint16_t max_protocol_version_;
   const std::string ecdh_curves_;
+  PrivateKeyOffloadPool* private_key_offload_pool_{};
 };
 
 class ClientContextImpl : public ContextImpl, public ClientContext {
@@ -132,6 +149,11 @@ public:
   bssl::UniquePtr<SSL> newSsl() const override;
 
 private:
+  static int newSessionCallback(SSL* ssl, SSL_SESSION* session);
+
+  // Identifies the sessions of the context in the per thread session caches. Unlike the address of
+  // the context, it is never reused by a later context.
+  const uint64_t session_cache_key_;
   std::string server_name_indication_;
 };
 
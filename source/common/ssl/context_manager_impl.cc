@@ -1,7 +1,11 @@
 #include "common/ssl/context_manager_impl.h"
 
+#include <algorithm>
 #include <functional>
+#include <memory>
 #include <shared_mutex>
+#include <string>
+#include <thread>
 
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
@@ -10,6 +14,57 @@
 namespace Envoy {
 namespace Ssl {
 
+namespace {
+
+// Versions are unique across managers, so that a thread's cached tables are never mistaken for
+// those of another manager.
+uint64_t nextServerNameTablesVersion() {
+  static std::atomic<uint64_t> next_version{1};
+  return next_version++;
+}
+
+} // namespace
+
+ServerNameTable::ServerNameTable(const std::unordered_map<std::string, ServerContext*>& exact,
+                                 const std::unordered_map<std::string, ServerContext*>& wildcard) {
+  for (const auto& entry : exact) {
+    if (entry.first.empty()) {
+      default_ = entry.second;
+      continue;
+    }
+    names_.emplace_back(entry.first);
+    exact_.emplace(names_.back(), entry.second);
+  }
+  for (const auto& entry : wildcard) {
+    names_.emplace_back(entry.first.substr(1));
+    wildcard_.emplace(names_.back(), entry.second);
+  }
+}
+
+ServerContext* ServerNameTable::find(absl::string_view server_name) const {
+  if (!server_name.empty()) {
+    const auto ctx = exact_.find(server_name);
+    if (ctx != exact_.end()) {
+      return ctx->second;
+    }
+  }
+
+  // Match the wildcard domain by the suffix of the server name from its first dot.
+  const size_t pos = server_name.find('.');
+  if (pos != absl::string_view::npos && pos > 0 && pos < server_name.size() - 1) {
+    const auto ctx = wildcard_.find(server_name.substr(pos));
+    if (ctx != wildcard_.end()) {
+      return ctx->second;
+    }
+  }
+
+  return default_;
+}
+
+ContextManagerImpl::ContextManagerImpl(Runtime::Loader& runtime)
+    : runtime_(runtime), server_name_tables_(std::make_shared<ServerNameTables>()),
+      server_name_tables_version_(nextServerNameTablesVersion()) {}
+
 ContextManagerImpl::~ContextManagerImpl() { ASSERT(contexts_.empty()); }
 
 void ContextManagerImpl::releaseClientContext(ClientContext* context) {
@@ -49,6 +104,7 @@ void ContextManagerImpl::releaseServerContext(ServerContext* context,
       }
     }
   }
+  updateServerNameTable(listener_name);
 
   // context may not be found, in the case that a subclass of Context throws
   // in it's constructor. In that case the context did not get added, but
@@ -64,6 +120,21 @@ ClientContextPtr ContextManagerImpl::createSslClientContext(Stats::Scope& scope,
   return context;
 }
 
+PrivateKeyOffloadPool* ContextManagerImpl::privateKeyOffloadPool() {
+  std::unique_lock<std::mutex> lock(private_key_offload_pool_lock_);
+  if (!private_key_offload_pool_initialized_) {
+    private_key_offload_pool_initialized_ = true;
+    // More threads than CPUs would only take CPU time from the workers.
+    const uint64_t threads =
+        std::min<uint64_t>(runtime_.snapshot().getInteger("ssl.private_key_offload_threads", 0),
+                           std::max(1U, std::thread::hardware_concurrency()));
+    if (threads > 0) {
+      private_key_offload_pool_.reset(new PrivateKeyOffloadPool(threads));
+    }
+  }
+  return private_key_offload_pool_.get();
+}
+
 bool ContextManagerImpl::isWildcardServerName(const std::string& name) {
   return name.size() > 2 && name[0] == '*' && name[1] == '.';
 }
@@ -88,51 +159,54 @@ ServerContextPtr ContextManagerImpl::createSslServerContext(
       }
     }
   }
+  updateServerNameTable(listener_name);
 
   return context;
 }
 
-ServerContext* ContextManagerImpl::findSslServerContext(const std::string& listener_name,
-                                                        const std::string& server_name) const {
-  // Find Ssl::ServerContext to use. The algorithm for "www.example.com" is as follows:
-  // 1. Try exact match on domain, i.e. "www.example.com"
-  // 2. Try exact match on wildcard, i.e. "*.example.com"
-  // 3. Try "no SNI" match, i.e. ""
-  // 4. Return no context and reject connection.
-
-  // TODO(PiotrSikora): make this lockless.
-  std::shared_lock<std::shared_timed_mutex> lock(contexts_lock_);
-
-  // TODO(PiotrSikora): refactor and combine code with RouteMatcher::findVirtualHost().
-  const auto listener_map_exact = map_exact_.find(listener_name);
-  if (listener_map_exact != map_exact_.end()) {
-    const auto ctx = listener_map_exact->second.find(server_name);
-    if (ctx != listener_map_exact->second.end()) {
-      return ctx->second;
-    }
+void ContextManagerImpl::updateServerNameTable(const std::string& listener_name) {
+  // Called with contexts_lock_ held, which serializes the writers of server_name_tables_.
+  std::shared_ptr<ServerNameTables> tables =
+      std::make_shared<ServerNameTables>(*std::atomic_load(&server_name_tables_));
+  const auto& listener_map_exact = map_exact_[listener_name];
+  const auto& listener_map_wildcard = map_wildcard_[listener_name];
+  if (listener_map_exact.empty() && listener_map_wildcard.empty()) {
+    tables->erase(listener_name);
+  } else {
+    (*tables)[listener_name] =
+        std::make_shared<const ServerNameTable>(listener_map_exact, listener_map_wildcard);
   }
 
-  // Try to construct and match wildcard domain.
-  const size_t pos = server_name.find('.');
-  if (pos > 0 && pos < server_name.size() - 1) {
-    const std::string wildcard = '*' + server_name.substr(pos);
-    const auto listener_map_wildcard = map_wildcard_.find(listener_name);
-    if (listener_map_wildcard != map_wildcard_.end()) {
-      const auto ctx = listener_map_wildcard->second.find(wildcard);
-      if (ctx != listener_map_wildcard->second.end()) {
-        return ctx->second;
-      }
-    }
-  }
+  std::atomic_store(&server_name_tables_, ServerNameTablesConstSharedPtr(std::move(tables)));
+  server_name_tables_version_ = nextServerNameTablesVersion();
+}
 
-  if (listener_map_exact != map_exact_.end()) {
-    const auto ctx = listener_map_exact->second.find(EMPTY_STRING);
-    if (ctx != listener_map_exact->second.end()) {
-      return ctx->second;
-    }
+const ServerNameTables& ContextManagerImpl::serverNameTables() const {
+  // Each thread keeps the tables that it last saw. They are only loaded again, which takes the
+  // shared pointer's internal lock, when they have been replaced since.
+  struct CachedTables {
+    uint64_t version_{};
+    ServerNameTablesConstSharedPtr tables_;
+  };
+  static thread_local CachedTables cached;
+
+  const uint64_t version = server_name_tables_version_;
+  if (cached.version_ != version) {
+    cached.tables_ = std::atomic_load(&server_name_tables_);
+    cached.version_ = version;
   }
+  return *cached.tables_;
+}
 
-  return nullptr;
+ServerContext* ContextManagerImpl::findSslServerContext(const std::string& listener_name,
+                                                        const std::string& server_name) const {
+  // TODO(PiotrSikora): refactor and combine code with RouteMatcher::findVirtualHost().
+  const ServerNameTables& tables = serverNameTables();
+  const auto table = tables.find(listener_name);
+  if (table == tables.end()) {
+    return nullptr;
+  }
+  return table->second->find(server_name);
 }
 
 size_t ContextManagerImpl::daysUntilFirstCertExpires() const {
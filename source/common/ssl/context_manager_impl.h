@@ -1,26 +1,79 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <shared_mutex>
+#include <string>
 #include <unordered_map>
 
 #include "envoy/runtime/runtime.h"
 #include "envoy/ssl/context_manager.h"
 
+#include "common/common/hash.h"
+#include "common/ssl/private_key_offload.h"
+
+#include "absl/strings/string_view.h"
+
 namespace Envoy {
 namespace Ssl {
 
+/**
+ * The server contexts of a listener by server name. A table is immutable once built, so that
+ * handshakes can look up contexts without locks.
+ */
+class ServerNameTable {
+public:
+  /**
+   * @param exact supplies the contexts by exact server name, with the default context at "".
+   * @param wildcard supplies the contexts by wildcard server name, e.g. "*.example.com".
+   */
+  ServerNameTable(const std::unordered_map<std::string, ServerContext*>& exact,
+                  const std::unordered_map<std::string, ServerContext*>& wildcard);
+
+  /**
+   * Find the context for a server name. The algorithm for "www.example.com" is as follows:
+   * 1. Try exact match on domain, i.e. "www.example.com"
+   * 2. Try exact match on wildcard, i.e. "*.example.com"
+   * 3. Try "no SNI" match, i.e. ""
+   * 4. Return no context and reject connection.
+   * @param server_name supplies the server name.
+   * @return ServerContext* the context, or nullptr if there is none.
+   */
+  ServerContext* find(absl::string_view server_name) const;
+
+private:
+  struct StringViewHash {
+    size_t operator()(absl::string_view key) const { return HashUtil::xxHash64(key); }
+  };
+  typedef std::unordered_map<absl::string_view, ServerContext*, StringViewHash> ContextMap;
+
+  // Owns the names that the keys of the maps point into.
+  std::list<std::string> names_;
+  ContextMap exact_;
+  // Keyed by the suffix of the wildcard, i.e. ".example.com" for "*.example.com".
+  ContextMap wildcard_;
+  ServerContext* default_{};
+};
+
+typedef std::shared_ptr<const ServerNameTable> ServerNameTableConstSharedPtr;
+typedef std::unordered_map<std::string, ServerNameTableConstSharedPtr> ServerNameTables;
+typedef std::shared_ptr<const ServerNameTables> ServerNameTablesConstSharedPtr;
+
 /**
  * The SSL context manager has the following threading model:
  * Contexts can be allocated via any thread (through in practice they are only allocated on the main
  * thread). They can be released from any thread (and in practice are since cluster information can
  * be released from any thread). Context allocation/free is a very uncommon thing so we just do a
- * global lock to protect it all.
+ * global lock to protect it all. Lookups of server contexts by server name happen on every TLS
+ * handshake, so they read immutable ServerNameTables that are replaced as a whole on every change.
  */
 class ContextManagerImpl final : public ContextManager {
 public:
-  ContextManagerImpl(Runtime::Loader& runtime) : runtime_(runtime) {}
+  ContextManagerImpl(Runtime::Loader& runtime);
   ~ContextManagerImpl();
 
   /**
@@ -45,14 +98,35 @@ public:
   size_t daysUntilFirstCertExpires() const override;
   void iterateContexts(std::function<void(const Context&)> callback) override;
 
+  /**
+   * @return PrivateKeyOffloadPool* the pool that does the private key operations of server
+   *         contexts, or nullptr if they are done inline. The pool is created on first use with
+   *         the ssl.private_key_offload_threads runtime value threads, at most one per CPU, or not
+   *         at all if it is 0. The runtime value is only read then, i.e. when the first server
+   *         context is created at startup, so changing it later takes effect on restart.
+   */
+  PrivateKeyOffloadPool* privateKeyOffloadPool();
+
+  Runtime::Loader& runtime() { return runtime_; }
+
 private:
   static bool isWildcardServerName(const std::string& name);
+  void updateServerNameTable(const std::string& listener_name);
+  const ServerNameTables& serverNameTables() const;
 
   Runtime::Loader& runtime_;
+  std::mutex private_key_offload_pool_lock_;
+  bool private_key_offload_pool_initialized_{};
+  std::unique_ptr<PrivateKeyOffloadPool> private_key_offload_pool_;
   std::list<Context*> contexts_;
   mutable std::shared_timed_mutex contexts_lock_;
   std::unordered_map<std::string, std::unordered_map<std::string, ServerContext*>> map_exact_;
   std::unordered_map<std::string, std::unordered_map<std::string, ServerContext*>> map_wildcard_;
+  // Built from map_exact_ and map_wildcard_, and replaced with std::atomic_store() whenever they
+  // change. server_name_tables_version_ is a new version for every replacement, so that threads
+  // only go to the shared pointer when their cached copy of it is out of date.
+  ServerNameTablesConstSharedPtr server_name_tables_;
+  std::atomic<uint64_t> server_name_tables_version_;
 };
 
 } // namespace Ssl
@@ -0,0 +1,256 @@
+#include "common/ssl/private_key_offload.h"
+
+#include <cstring>
+
+#include "common/common/assert.h"
+#include "common/common/macros.h"
+
+#include "openssl/err.h"
+#include "openssl/evp.h"
+#include "openssl/rsa.h"
+
+namespace Envoy {
+namespace Ssl {
+
+PrivateKeyOffloadPool::PrivateKeyOffloadPool(uint32_t thread_count) {
+  ASSERT(thread_count > 0);
+  for (uint32_t i = 0; i < thread_count; i++) {
+    threads_.emplace_back(new Thread::Thread([this]() -> void { threadRoutine(); }));
+  }
+}
+
+PrivateKeyOffloadPool::~PrivateKeyOffloadPool() {
+  {
+    std::unique_lock<std::mutex> lock(lock_);
+    shutdown_ = true;
+  }
+  work_available_.notify_all();
+  for (const Thread::ThreadPtr& thread : threads_) {
+    thread->join();
+  }
+}
+
+void PrivateKeyOffloadPool::post(std::function<void()> work) {
+  {
+    std::unique_lock<std::mutex> lock(lock_);
+    work_.push_back(std::move(work));
+  }
+  work_available_.notify_one();
+}
+
+void PrivateKeyOffloadPool::threadRoutine() {
+  std::unique_lock<std::mutex> lock(lock_);
+  while (true) {
+    work_available_.wait(lock, [this]() -> bool { return shutdown_ || !work_.empty(); });
+    // The operations of connections that are gone at shutdown are cancelled, so any work that is
+    // left is dropped.
+    if (shutdown_) {
+      return;
+    }
+    std::function<void()> work = std::move(work_.front());
+    work_.pop_front();
+    lock.unlock();
+    work();
+    lock.lock();
+  }
+}
+
+const SSL_PRIVATE_KEY_METHOD& PrivateKeyOffloadPool::method() {
+  CONSTRUCT_ON_FIRST_USE(SSL_PRIVATE_KEY_METHOD, []() -> SSL_PRIVATE_KEY_METHOD {
+    SSL_PRIVATE_KEY_METHOD method{};
+    method.sign = PrivateKeyOffload::sign;
+    method.decrypt = PrivateKeyOffload::decrypt;
+    method.complete = PrivateKeyOffload::complete;
+    return method;
+  }());
+}
+
+/**
+ * An operation, which is shared by the connection and the pool thread doing it. Only the pool
+ * thread touches the output until the operation is posted back to the connection's dispatcher.
+ */
+struct PrivateKeyOffload::Operation {
+  enum class Type { Sign, Decrypt };
+
+  Operation(Type type, EVP_PKEY* key, uint16_t signature_algorithm, const uint8_t* in,
+            size_t in_len)
+      : type_(type), key_(key), signature_algorithm_(signature_algorithm), input_(in, in + in_len) {
+    EVP_PKEY_up_ref(key_.get());
+  }
+
+  void run() {
+    succeeded_ = type_ == Type::Sign ? runSign() : runDecrypt();
+    if (!succeeded_) {
+      // The handshake fails with an error of its own, so this thread's errors are only cleared.
+      ERR_clear_error();
+    }
+  }
+
+  bool runSign() {
+    bssl::ScopedEVP_MD_CTX ctx;
+    EVP_PKEY_CTX* pkey_ctx;
+    if (!EVP_DigestSignInit(ctx.get(), &pkey_ctx,
+                            SSL_get_signature_algorithm_digest(signature_algorithm_), nullptr,
+                            key_.get())) {
+      return false;
+    }
+    if (SSL_is_signature_algorithm_rsa_pss(signature_algorithm_) &&
+        (!EVP_PKEY_CTX_set_rsa_padding(pkey_ctx, RSA_PKCS1_PSS_PADDING) ||
+         !EVP_PKEY_CTX_set_rsa_pss_saltlen(pkey_ctx, -1))) {
+      return false;
+    }
+    size_t signature_len = 0;
+    if (!EVP_DigestSign(ctx.get(), nullptr, &signature_len, input_.data(), input_.size())) {
+      return false;
+    }
+    output_.resize(signature_len);
+    if (!EVP_DigestSign(ctx.get(), output_.data(), &signature_len, input_.data(),
+                        input_.size())) {
+      return false;
+    }
+    output_.resize(signature_len);
+    return true;
+  }
+
+  bool runDecrypt() {
+    RSA* rsa = EVP_PKEY_get0_RSA(key_.get());
+    if (rsa == nullptr) {
+      return false;
+    }
+    // BoringSSL does the padding check of the decrypted key exchange itself.
+    output_.resize(RSA_size(rsa));
+    size_t output_len = 0;
+    if (!RSA_decrypt(rsa, &output_len, output_.data(), output_.size(), input_.data(),
+                     input_.size(), RSA_NO_PADDING)) {
+      return false;
+    }
+    output_.resize(output_len);
+    return true;
+  }
+
+  const Type type_;
+  bssl::UniquePtr<EVP_PKEY> key_;
+  const uint16_t signature_algorithm_;
+  const std::vector<uint8_t> input_;
+  std::vector<uint8_t> output_;
+  bool succeeded_{};
+
+  // Set by the connection when it goes away before the operation completes. Guarded by lock_.
+  std::mutex lock_;
+  bool cancelled_{};
+};
+
+PrivateKeyOffload::PrivateKeyOffload(PrivateKeyOffloadPool& pool, SSL* ssl,
+                                     Event::Dispatcher& dispatcher, std::function<void()> resume,
+                                     Stats::Gauge& pending, Stats::Histogram& latency)
+    : pool_(pool), ssl_(ssl), dispatcher_(dispatcher), resume_(resume), pending_(pending),
+      latency_(latency) {
+  int rc = SSL_set_ex_data(ssl_, sslIndex(), this);
+  RELEASE_ASSERT(rc == 1);
+  UNREFERENCED_PARAMETER(rc);
+}
+
+PrivateKeyOffload::~PrivateKeyOffload() {
+  SSL_set_ex_data(ssl_, sslIndex(), nullptr);
+  if (operation_ != nullptr && !operation_complete_) {
+    std::unique_lock<std::mutex> lock(operation_->lock_);
+    operation_->cancelled_ = true;
+    pending_.dec();
+  }
+}
+
+int PrivateKeyOffload::sslIndex() {
+  CONSTRUCT_ON_FIRST_USE(int, []() -> int {
+    int ssl_index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    RELEASE_ASSERT(ssl_index >= 0);
+    return ssl_index;
+  }());
+}
+
+PrivateKeyOffload* PrivateKeyOffload::get(SSL* ssl) {
+  return static_cast<PrivateKeyOffload*>(SSL_get_ex_data(ssl, sslIndex()));
+}
+
+ssl_private_key_result_t PrivateKeyOffload::sign(SSL* ssl, uint8_t*, size_t*, size_t,
+                                                 uint16_t signature_algorithm, const uint8_t* in,
+                                                 size_t in_len) {
+  PrivateKeyOffload* offload = get(ssl);
+  EVP_PKEY* key = SSL_get_privatekey(ssl);
+  if (offload == nullptr || key == nullptr) {
+    return ssl_private_key_failure;
+  }
+  return offload->start(std::make_shared<Operation>(Operation::Type::Sign, key,
+                                                    signature_algorithm, in, in_len));
+}
+
+ssl_private_key_result_t PrivateKeyOffload::decrypt(SSL* ssl, uint8_t*, size_t*, size_t,
+                                                    const uint8_t* in, size_t in_len) {
+  PrivateKeyOffload* offload = get(ssl);
+  EVP_PKEY* key = SSL_get_privatekey(ssl);
+  if (offload == nullptr || key == nullptr) {
+    return ssl_private_key_failure;
+  }
+  return offload->start(
+      std::make_shared<Operation>(Operation::Type::Decrypt, key, 0, in, in_len));
+}
+
+ssl_private_key_result_t PrivateKeyOffload::complete(SSL* ssl, uint8_t* out, size_t* out_len,
+                                                     size_t max_out) {
+  PrivateKeyOffload* offload = get(ssl);
+  if (offload == nullptr) {
+    return ssl_private_key_failure;
+  }
+  return offload->finish(out, out_len, max_out);
+}
+
+ssl_private_key_result_t PrivateKeyOffload::start(OperationSharedPtr operation) {
+  ASSERT(operation_ == nullptr);
+  operation_ = operation;
+  operation_complete_ = false;
+  operation_timespan_.reset(new Stats::Timespan(latency_));
+  pending_.inc();
+
+  Event::Dispatcher& dispatcher = dispatcher_;
+  pool_.post([operation, &dispatcher, this]() -> void {
+    operation->run();
+    // The connection can't go away while it is posted to, as it cancels the operation on
+    // destruction under the same lock. If it is cancelled, this is never dereferenced.
+    std::unique_lock<std::mutex> lock(operation->lock_);
+    if (!operation->cancelled_) {
+      dispatcher.post([operation, this]() -> void {
+        {
+          std::unique_lock<std::mutex> cancel_lock(operation->lock_);
+          if (operation->cancelled_) {
+            return;
+          }
+        }
+        onComplete();
+      });
+    }
+  });
+  return ssl_private_key_retry;
+}
+
+void PrivateKeyOffload::onComplete() {
+  operation_complete_ = true;
+  pending_.dec();
+  operation_timespan_->complete();
+  resume_();
+}
+
+ssl_private_key_result_t PrivateKeyOffload::finish(uint8_t* out, size_t* out_len, size_t max_out) {
+  if (!operation_complete_) {
+    return ssl_private_key_retry;
+  }
+
+  OperationSharedPtr operation = std::move(operation_);
+  if (!operation->succeeded_ || operation->output_.size() > max_out) {
+    return ssl_private_key_failure;
+  }
+  memcpy(out, operation->output_.data(), operation->output_.size());
+  *out_len = operation->output_.size();
+  return ssl_private_key_success;
+}
+
+} // namespace Ssl
+} // namespace Envoy
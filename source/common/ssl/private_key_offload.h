@@ -0,0 +1,116 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/stats/stats.h"
+#include "envoy/stats/timespan.h"
+
+#include "common/common/thread.h"
+
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Ssl {
+
+/**
+ * A pool of threads that do the private key operations of TLS handshakes, i.e. the RSA or ECDSA
+ * signature of a server's key exchange and the RSA decryption of a client's key exchange. Each of
+ * these takes up to milliseconds of CPU, which on a worker stalls all of its other connections.
+ */
+class PrivateKeyOffloadPool {
+public:
+  PrivateKeyOffloadPool(uint32_t thread_count);
+  ~PrivateKeyOffloadPool();
+
+  /**
+   * Run work on one of the pool's threads.
+   * @param work supplies the work.
+   */
+  void post(std::function<void()> work);
+
+  /**
+   * @return size_t the number of threads in the pool.
+   */
+  size_t threadCount() const { return threads_.size(); }
+
+  /**
+   * @return const SSL_PRIVATE_KEY_METHOD& the private key method that hands the private key
+   *         operations of a connection to the pool of its PrivateKeyOffload.
+   */
+  static const SSL_PRIVATE_KEY_METHOD& method();
+
+private:
+  void threadRoutine();
+
+  std::mutex lock_;
+  std::condition_variable work_available_;
+  std::list<std::function<void()>> work_;
+  bool shutdown_{};
+  std::vector<Thread::ThreadPtr> threads_;
+};
+
+/**
+ * The private key operation of the handshake of a connection whose SSL_CTX uses
+ * PrivateKeyOffloadPool::method(). While the operation runs on the pool, the handshake returns
+ * SSL_ERROR_WANT_PRIVATE_KEY_OPERATION. When it completes, the resume callback is called on the
+ * connection's dispatcher, after which the next SSL_do_handshake() picks up the result.
+ */
+class PrivateKeyOffload {
+public:
+  /**
+   * @param pool supplies the pool that does the operation.
+   * @param ssl supplies the connection, which must outlive the PrivateKeyOffload.
+   * @param dispatcher supplies the dispatcher of the connection.
+   * @param resume supplies the callback that continues the handshake.
+   * @param pending supplies the gauge of the operations that are queued or running.
+   * @param latency supplies the histogram of the time from the start of an operation to its
+   *        result being back on the dispatcher.
+   */
+  PrivateKeyOffload(PrivateKeyOffloadPool& pool, SSL* ssl, Event::Dispatcher& dispatcher,
+                    std::function<void()> resume, Stats::Gauge& pending,
+                    Stats::Histogram& latency);
+  ~PrivateKeyOffload();
+
+private:
+  struct Operation;
+  typedef std::shared_ptr<Operation> OperationSharedPtr;
+
+  static PrivateKeyOffload* get(SSL* ssl);
+  static int sslIndex();
+  static ssl_private_key_result_t sign(SSL* ssl, uint8_t* out, size_t* out_len, size_t max_out,
+                                       uint16_t signature_algorithm, const uint8_t* in,
+                                       size_t in_len);
+  static ssl_private_key_result_t decrypt(SSL* ssl, uint8_t* out, size_t* out_len, size_t max_out,
+                                          const uint8_t* in, size_t in_len);
+  static ssl_private_key_result_t complete(SSL* ssl, uint8_t* out, size_t* out_len,
+                                           size_t max_out);
+
+  ssl_private_key_result_t start(OperationSharedPtr operation);
+  ssl_private_key_result_t finish(uint8_t* out, size_t* out_len, size_t max_out);
+  void onComplete();
+
+  PrivateKeyOffloadPool& pool_;
+  SSL* ssl_;
+  Event::Dispatcher& dispatcher_;
+  std::function<void()> resume_;
+  Stats::Gauge& pending_;
+  Stats::Histogram& latency_;
+  OperationSharedPtr operation_;
+  Stats::TimespanPtr operation_timespan_;
+  bool operation_complete_{};
+
+  friend class PrivateKeyOffloadPool;
+};
+
+typedef std::unique_ptr<PrivateKeyOffload> PrivateKeyOffloadPtr;
+
+} // namespace Ssl
+} // namespace Envoy
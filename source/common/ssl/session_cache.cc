@@ -0,0 +1,39 @@
+#include "common/ssl/session_cache.h"
+
+namespace Envoy {
+namespace Ssl {
+
+constexpr size_t ClientSessionCache::MAX_SESSIONS;
+
+SSL_SESSION* ClientSessionCache::get(uint64_t key) {
+  auto entry = index_.find(key);
+  if (entry == index_.end()) {
+    return nullptr;
+  }
+  sessions_.splice(sessions_.begin(), sessions_, entry->second);
+  return entry->second->second.get();
+}
+
+void ClientSessionCache::set(uint64_t key, bssl::UniquePtr<SSL_SESSION>&& session) {
+  auto entry = index_.find(key);
+  if (entry != index_.end()) {
+    entry->second->second = std::move(session);
+    sessions_.splice(sessions_.begin(), sessions_, entry->second);
+    return;
+  }
+
+  if (sessions_.size() == max_sessions_) {
+    index_.erase(sessions_.back().first);
+    sessions_.pop_back();
+  }
+  sessions_.emplace_front(key, std::move(session));
+  index_.emplace(key, sessions_.begin());
+}
+
+ClientSessionCache& ClientSessionCache::threadLocal() {
+  static thread_local ClientSessionCache cache(MAX_SESSIONS);
+  return cache;
+}
+
+} // namespace Ssl
+} // namespace Envoy
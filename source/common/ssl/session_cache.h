@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Ssl {
+
+/**
+ * A least recently used cache of the TLS sessions of client contexts, so that a new upstream
+ * connection can resume the session of an earlier one rather than do a full handshake. The key
+ * identifies a client context, and so a cluster and SNI, and the cache holds the newest session of
+ * each key. Sessions are stored and offered by the thread that does the handshakes, so each thread
+ * has a cache of its own and no locking is needed.
+ */
+class ClientSessionCache {
+public:
+  static constexpr size_t MAX_SESSIONS = 1024;
+
+  ClientSessionCache(size_t max_sessions) : max_sessions_(max_sessions) {}
+
+  /**
+   * @param key supplies the key of the session.
+   * @return SSL_SESSION* the session stored for key, which remains owned by the cache, or nullptr
+   *         if there is none.
+   */
+  SSL_SESSION* get(uint64_t key);
+
+  /**
+   * Store a session, replacing the session already stored for its key. If the cache is full, the
+   * least recently used session is evicted.
+   * @param key supplies the key of the session.
+   * @param session supplies the session.
+   */
+  void set(uint64_t key, bssl::UniquePtr<SSL_SESSION>&& session);
+
+  /**
+   * @return size_t the number of sessions in the cache.
+   */
+  size_t size() const { return sessions_.size(); }
+
+  /**
+   * @return ClientSessionCache& the cache of the calling thread.
+   */
+  static ClientSessionCache& threadLocal();
+
+private:
+  typedef std::list<std::pair<uint64_t, bssl::UniquePtr<SSL_SESSION>>> SessionList;
+
+  const size_t max_sessions_;
+  // Most recently used first.
+  SessionList sessions_;
+  std::unordered_map<uint64_t, SessionList::iterator> index_;
+};
+
+} // namespace Ssl
+} // namespace Envoy
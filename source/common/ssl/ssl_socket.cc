@@ -1,5 +1,7 @@
 #include "common/ssl/ssl_socket.h"
 
+#include <algorithm>
+
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
 #include "common/common/hex.h"
@@ -13,8 +15,13 @@ using Envoy::Network::PostIoAction;
 namespace Envoy {
 namespace Ssl {
 
+constexpr uint64_t SslSocket::SMALL_RECORD_SIZE;
+constexpr uint64_t SslSocket::MAX_RECORD_SIZE;
+
 SslSocket::SslSocket(Context& ctx, InitialState state)
-    : ctx_(dynamic_cast<Ssl::ContextImpl&>(ctx)), ssl_(ctx_.newSsl()) {
+    : ctx_(dynamic_cast<Ssl::ContextImpl&>(ctx)), ssl_(ctx_.newSsl()),
+      coalesce_writes_(ctx_.runtime().snapshot().getInteger("ssl.coalesce_writes", 1) != 0),
+      small_record_bytes_(ctx_.runtime().snapshot().getInteger("ssl.small_record_bytes", 0)) {
   SSL_set_mode(ssl_.get(), SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
   if (state == InitialState::Client) {
     SSL_set_connect_state(ssl_.get());
@@ -30,6 +37,16 @@ void SslSocket::setTransportSocketCallbacks(Network::TransportSocketCallbacks& c
 
   BIO* bio = BIO_new_socket(callbacks_->fd(), 0);
   SSL_set_bio(ssl_.get(), bio, bio);
+
+  PrivateKeyOffloadPool* private_key_offload_pool = ctx_.privateKeyOffloadPool();
+  if (private_key_offload_pool != nullptr) {
+    // A handshake that waits for a private key operation is continued by a read event, which
+    // calls doHandshake() again.
+    private_key_offload_.reset(new PrivateKeyOffload(
+        *private_key_offload_pool, ssl_.get(), callbacks_->connection().dispatcher(),
+        [this]() -> void { callbacks_->setReadBufferReady(); },
+        ctx_.stats().private_key_operations_pending_, ctx_.stats().private_key_operation_ms_));
+  }
 }
 
 Network::IoResult SslSocket::doRead(Buffer::Instance& read_buffer) {
@@ -105,6 +122,7 @@ PostIoAction SslSocket::doHandshake() {
     switch (err) {
     case SSL_ERROR_WANT_READ:
     case SSL_ERROR_WANT_WRITE:
+    case SSL_ERROR_WANT_PRIVATE_KEY_OPERATION:
       return PostIoAction::KeepOpen;
     default:
       drainErrorQueue();
@@ -145,6 +163,10 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer) {
     }
   }
 
+  if (coalesce_writes_) {
+    return writeRecords(write_buffer);
+  }
+
   uint64_t original_buffer_length = write_buffer.length();
   uint64_t total_bytes_written = 0;
   bool keep_writing = true;
@@ -198,6 +220,54 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer) {
   return {PostIoAction::KeepOpen, total_bytes_written};
 }
 
+uint64_t SslSocket::nextWriteSize(Buffer::Instance& write_buffer, uint64_t bytes_to_write) {
+  if (bytes_written_ < small_record_bytes_) {
+    return std::min(bytes_to_write, SMALL_RECORD_SIZE);
+  }
+
+  // A slice of at least a full record is written as is, and SSL_write() splits it into full
+  // records. Smaller slices are gathered into a full record.
+  Buffer::RawSlice slice;
+  if (write_buffer.getRawSlices(&slice, 1) == 1 && slice.len_ >= MAX_RECORD_SIZE) {
+    return slice.len_;
+  }
+  return std::min(bytes_to_write, MAX_RECORD_SIZE);
+}
+
+Network::IoResult SslSocket::writeRecords(Buffer::Instance& write_buffer) {
+  const uint64_t original_buffer_length = write_buffer.length();
+  uint64_t total_bytes_written = 0;
+  while (original_buffer_length != total_bytes_written) {
+    // SSL_write() requires that if a previous call returns SSL_ERROR_WANT_WRITE, we need to call
+    // it again with at least as many bytes. nextWriteSize() can only grow until something is
+    // written: the record size only changes with bytes_written_, we only move() into the write
+    // buffer, and linearize() only grows the first slice.
+    const uint64_t bytes_to_write =
+        nextWriteSize(write_buffer, original_buffer_length - total_bytes_written);
+    const void* data = write_buffer.linearize(bytes_to_write);
+    int rc = SSL_write(ssl_.get(), data, bytes_to_write);
+    ENVOY_CONN_LOG(trace, "ssl write returns: {}", callbacks_->connection(), rc);
+    if (rc <= 0) {
+      int err = SSL_get_error(ssl_.get(), rc);
+      switch (err) {
+      case SSL_ERROR_WANT_WRITE:
+        return {PostIoAction::KeepOpen, total_bytes_written};
+      case SSL_ERROR_WANT_READ:
+        // Renegotiation has started. We don't handle renegotiation so just fall through.
+      default:
+        drainErrorQueue();
+        return {PostIoAction::Close, total_bytes_written};
+      }
+    }
+
+    write_buffer.drain(rc);
+    total_bytes_written += rc;
+    bytes_written_ += rc;
+  }
+
+  return {PostIoAction::KeepOpen, total_bytes_written};
+}
+
 void SslSocket::onConnected() { ASSERT(!handshake_complete_); }
 
 bool SslSocket::peerCertificatePresented() const {
@@ -264,6 +334,10 @@ std::string SslSocket::getUriSanFromCertificate(X509* cert) {
 }
 
 void SslSocket::closeSocket(Network::ConnectionEvent) {
+  // Cancel a private key operation that is still pending, rather than leave it counted as pending
+  // until the connection is destroyed. Its result is of no use to a closed connection.
+  private_key_offload_.reset();
+
   if (handshake_complete_ &&
       callbacks_->connection().state() != Network::Connection::State::Closed) {
     // Attempt to send a shutdown before closing the socket. It's possible this won't go out if
@@ -7,6 +7,7 @@
 
 #include "common/common/logger.h"
 #include "common/ssl/context_impl.h"
+#include "common/ssl/private_key_offload.h"
 
 #include "openssl/ssl.h"
 
@@ -21,6 +22,17 @@ class SslSocket : public Network::TransportSocket,
 public:
   SslSocket(Context& ctx, InitialState state);
 
+  /**
+   * Size of the records that are written until the first small_record_bytes of the connection are
+   * written, which fit in a single TCP segment so that the peer can decrypt data as soon as the
+   * segment arrives.
+   */
+  static constexpr uint64_t SMALL_RECORD_SIZE = 1400;
+  /**
+   * Maximum size of the plaintext of a record (RFC 5246 section 6.2.1).
+   */
+  static constexpr uint64_t MAX_RECORD_SIZE = 16384;
+
   // Ssl::Connection
   bool peerCertificatePresented() const override;
   std::string uriSanLocalCertificate() override;
@@ -33,6 +45,7 @@ public:
   void setTransportSocketCallbacks(Network::TransportSocketCallbacks& callbacks) override;
   std::string protocol() const override;
   bool canFlushClose() override { return handshake_complete_; }
+  bool canSplice() const override { return false; }
   void closeSocket(Network::ConnectionEvent close_type) override;
   Network::IoResult doRead(Buffer::Instance& read_buffer) override;
   Network::IoResult doWrite(Buffer::Instance& write_buffer) override;
@@ -47,11 +60,19 @@ private:
   void drainErrorQueue();
   std::string getUriSanFromCertificate(X509* cert);
   std::string getSubjectFromCertificate(X509* cert) const;
+  Network::IoResult writeRecords(Buffer::Instance& write_buffer);
+  uint64_t nextWriteSize(Buffer::Instance& write_buffer, uint64_t bytes_to_write);
 
   Network::TransportSocketCallbacks* callbacks_{};
   ContextImpl& ctx_;
   bssl::UniquePtr<SSL> ssl_;
+  PrivateKeyOffloadPtr private_key_offload_;
   bool handshake_complete_{};
+  // Gather slices of the write buffer into full records, rather than write a record per slice.
+  const bool coalesce_writes_;
+  // Number of bytes at the start of the connection that are written in SMALL_RECORD_SIZE records.
+  const uint64_t small_record_bytes_;
+  uint64_t bytes_written_{};
 };
 
 class ClientSslSocketFactory : public Network::TransportSocketFactory {
@@ -0,0 +1,197 @@
+#include "common/stats/histogram_impl.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "common/common/assert.h"
+#include "common/common/macros.h"
+
+#include "fmt/format.h"
+
+namespace Envoy {
+namespace Stats {
+
+constexpr uint32_t HistogramBuckets::SUB_BUCKET_BITS;
+constexpr uint32_t HistogramBuckets::SUB_BUCKETS;
+constexpr uint32_t HistogramBuckets::NUM_GROUPS;
+constexpr uint32_t HistogramBuckets::NUM_BUCKETS;
+
+uint32_t HistogramBuckets::index(uint64_t value) {
+  if (value < SUB_BUCKETS) {
+    return value;
+  }
+  // The top SUB_BUCKET_BITS + 1 bits of the value select the bucket within its power of two.
+  const uint32_t shift = 63 - __builtin_clzll(value) - SUB_BUCKET_BITS;
+  return (shift + 1) * SUB_BUCKETS + (value >> shift) - SUB_BUCKETS;
+}
+
+uint64_t HistogramBuckets::lowerBound(uint32_t index) {
+  ASSERT(index < NUM_BUCKETS);
+  const uint32_t group = index / SUB_BUCKETS;
+  const uint64_t sub_bucket = index % SUB_BUCKETS;
+  if (group == 0) {
+    return sub_bucket;
+  }
+  return (SUB_BUCKETS + sub_bucket) << (group - 1);
+}
+
+uint64_t HistogramBuckets::width(uint32_t index) {
+  ASSERT(index < NUM_BUCKETS);
+  const uint32_t group = index / SUB_BUCKETS;
+  return group == 0 ? 1 : 1ULL << (group - 1);
+}
+
+HistogramStatisticsImpl::HistogramStatisticsImpl()
+    : computed_quantiles_(supportedQuantiles().size(), std::nan("")) {}
+
+void HistogramStatisticsImpl::refresh(const std::vector<uint64_t>& counts, uint64_t sum) {
+  sample_count_ = std::accumulate(counts.begin(), counts.end(), 0ULL);
+  sample_sum_ = sum;
+
+  const std::vector<double>& quantiles = supportedQuantiles();
+  if (sample_count_ == 0) {
+    std::fill(computed_quantiles_.begin(), computed_quantiles_.end(), std::nan(""));
+    return;
+  }
+
+  // Quantiles are in ascending order, so a single pass over the buckets finds all of them.
+  uint32_t bucket = 0;
+  uint64_t below = 0;
+  for (size_t i = 0; i < quantiles.size(); i++) {
+    const double rank = quantiles[i] * sample_count_;
+    while (counts[bucket] == 0 || below + counts[bucket] < rank) {
+      below += counts[bucket];
+      bucket++;
+      ASSERT(bucket < counts.size());
+    }
+    computed_quantiles_[i] = HistogramBuckets::lowerBound(bucket) +
+                             HistogramBuckets::width(bucket) * (rank - below) / counts[bucket];
+  }
+}
+
+std::string HistogramStatisticsImpl::summary() const {
+  const std::vector<double>& quantiles = supportedQuantiles();
+  std::string summary;
+  for (size_t i = 0; i < quantiles.size(); i++) {
+    if (i > 0) {
+      summary += ", ";
+    }
+    summary += fmt::format("P{:g}: {:g}", 100 * quantiles[i], computed_quantiles_[i]);
+  }
+  return summary;
+}
+
+const std::vector<double>& HistogramStatisticsImpl::supportedQuantiles() const {
+  CONSTRUCT_ON_FIRST_USE(std::vector<double>, {0.5, 0.9, 0.99, 0.999});
+}
+
+ThreadLocalHistogramImpl::ThreadLocalHistogramImpl(const std::string& name, Store& parent,
+                                                   std::string&& tag_extracted_name,
+                                                   std::vector<Tag>&& tags)
+    : MetricImpl(name, std::move(tag_extracted_name), std::move(tags)), parent_(parent) {}
+
+ThreadLocalHistogramImpl::~ThreadLocalHistogramImpl() {
+  for (std::atomic<BucketGroup*>& group : groups_) {
+    delete group.load();
+  }
+}
+
+void ThreadLocalHistogramImpl::record(uint64_t value) {
+  const uint32_t index = HistogramBuckets::index(value);
+  std::atomic<BucketGroup*>& group_ref = groups_[index / HistogramBuckets::SUB_BUCKETS];
+  BucketGroup* group = group_ref.load(std::memory_order_acquire);
+  if (group == nullptr) {
+    BucketGroup* new_group = new BucketGroup();
+    if (group_ref.compare_exchange_strong(group, new_group, std::memory_order_acq_rel)) {
+      group = new_group;
+    } else {
+      // Another writer allocated the group first. group now points to it.
+      delete new_group;
+    }
+  }
+  (*group)[index % HistogramBuckets::SUB_BUCKETS].fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+}
+
+void ThreadLocalHistogramImpl::recordValue(uint64_t value) {
+  record(value);
+  parent_.deliverHistogramToSinks(*this, value);
+}
+
+void ThreadLocalHistogramImpl::collect(std::vector<uint64_t>& counts, uint64_t& sum) {
+  for (uint32_t group_index = 0; group_index < HistogramBuckets::NUM_GROUPS; group_index++) {
+    BucketGroup* group = groups_[group_index].load(std::memory_order_acquire);
+    if (group == nullptr) {
+      continue;
+    }
+    for (uint32_t i = 0; i < HistogramBuckets::SUB_BUCKETS; i++) {
+      const uint64_t count = (*group)[i].exchange(0, std::memory_order_relaxed);
+      if (count > 0) {
+        const uint32_t index = group_index * HistogramBuckets::SUB_BUCKETS + i;
+        if (counts.size() <= index) {
+          counts.resize(index + 1);
+        }
+        counts[index] += count;
+      }
+    }
+  }
+  sum += sum_.exchange(0, std::memory_order_relaxed);
+}
+
+ParentHistogramImpl::ParentHistogramImpl(const std::string& name, Store& parent,
+                                         std::string&& tag_extracted_name,
+                                         std::vector<Tag>&& tags)
+    : MetricImpl(name, std::move(tag_extracted_name), std::move(tags)), parent_(parent),
+      unthreaded_(std::make_shared<ThreadLocalHistogramImpl>(
+          name, parent, std::string(tagExtractedName()), std::vector<Tag>(this->tags()))) {}
+
+ThreadLocalHistogramSharedPtr ParentHistogramImpl::createThreadLocal() {
+  ThreadLocalHistogramSharedPtr child = std::make_shared<ThreadLocalHistogramImpl>(
+      name(), parent_, std::string(tagExtractedName()), std::vector<Tag>(tags()));
+  std::unique_lock<std::mutex> lock(lock_);
+  children_.push_back(child);
+  return child;
+}
+
+void ParentHistogramImpl::recordValue(uint64_t value) {
+  unthreaded_->record(value);
+  parent_.deliverHistogramToSinks(*this, value);
+}
+
+void ParentHistogramImpl::merge() {
+  interval_counts_.clear();
+  uint64_t interval_sum = 0;
+  unthreaded_->collect(interval_counts_, interval_sum);
+  {
+    std::unique_lock<std::mutex> lock(lock_);
+    for (auto it = children_.begin(); it != children_.end();) {
+      // A child that is only referenced here can no longer be recorded into, so it is dropped
+      // once its last samples are collected. This must be checked before collecting, as the
+      // thread could otherwise record a sample and release the child in between.
+      const bool released = it->use_count() == 1;
+      (*it)->collect(interval_counts_, interval_sum);
+      if (released) {
+        it = children_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  if (cumulative_counts_.size() < interval_counts_.size()) {
+    cumulative_counts_.resize(interval_counts_.size());
+  }
+  for (size_t i = 0; i < interval_counts_.size(); i++) {
+    cumulative_counts_[i] += interval_counts_[i];
+  }
+  cumulative_sum_ += interval_sum;
+
+  interval_statistics_.refresh(interval_counts_, interval_sum);
+  cumulative_statistics_.refresh(cumulative_counts_, cumulative_sum_);
+}
+
+} // namespace Stats
+} // namespace Envoy
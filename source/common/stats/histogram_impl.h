@@ -0,0 +1,159 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "envoy/stats/stats.h"
+
+#include "common/stats/stats_impl.h"
+
+namespace Envoy {
+namespace Stats {
+
+/**
+ * Log-linear bucket layout used by the aggregating histograms. Values below SUB_BUCKETS each have
+ * a bucket of their own. Every larger power of two range is split into SUB_BUCKETS buckets of equal
+ * width, so a value is never more than 1/SUB_BUCKETS of itself away from the lower bound of its
+ * bucket. Buckets are grouped by power of two, with group 0 holding the values below SUB_BUCKETS.
+ */
+class HistogramBuckets {
+public:
+  static constexpr uint32_t SUB_BUCKET_BITS = 4;
+  static constexpr uint32_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+  static constexpr uint32_t NUM_GROUPS = 64 - SUB_BUCKET_BITS + 1;
+  static constexpr uint32_t NUM_BUCKETS = NUM_GROUPS * SUB_BUCKETS;
+
+  /**
+   * @return the index of the bucket that value falls in.
+   */
+  static uint32_t index(uint64_t value);
+
+  /**
+   * @return the smallest value in a bucket.
+   */
+  static uint64_t lowerBound(uint32_t index);
+
+  /**
+   * @return the number of distinct values in a bucket.
+   */
+  static uint64_t width(uint32_t index);
+};
+
+/**
+ * Quantiles computed from bucket counts, interpolating linearly within the bucket a quantile falls
+ * in.
+ */
+class HistogramStatisticsImpl : public HistogramStatistics {
+public:
+  HistogramStatisticsImpl();
+
+  /**
+   * Recompute the statistics.
+   * @param counts supplies the number of samples in each bucket, indexed as in HistogramBuckets.
+   *        Buckets past the end of the vector are empty.
+   * @param sum supplies the sum of the samples.
+   */
+  void refresh(const std::vector<uint64_t>& counts, uint64_t sum);
+
+  // Stats::HistogramStatistics
+  std::string summary() const override;
+  const std::vector<double>& supportedQuantiles() const override;
+  const std::vector<double>& computedQuantiles() const override { return computed_quantiles_; }
+  uint64_t sampleCount() const override { return sample_count_; }
+  uint64_t sampleSum() const override { return sample_sum_; }
+
+private:
+  std::vector<double> computed_quantiles_;
+  uint64_t sample_count_{};
+  uint64_t sample_sum_{};
+};
+
+/**
+ * Histogram that a single thread records into, in practice through its thread local stats cache.
+ * Samples are counted with relaxed atomic increments and moved out by the parent histogram from
+ * the main thread. Groups of buckets are allocated the first time a value falls into them, so a
+ * histogram only pays for the ranges it has seen. Recording is also safe from several threads at
+ * once, which the parent relies on before threading is initialized. Each sample is still delivered
+ * to the sinks individually as with HistogramImpl.
+ */
+class ThreadLocalHistogramImpl : public Histogram, public MetricImpl {
+public:
+  ThreadLocalHistogramImpl(const std::string& name, Store& parent,
+                           std::string&& tag_extracted_name, std::vector<Tag>&& tags);
+  ~ThreadLocalHistogramImpl();
+
+  /**
+   * Count a sample without delivering it to the sinks.
+   */
+  void record(uint64_t value);
+
+  // Stats::Histogram
+  void recordValue(uint64_t value) override;
+
+  /**
+   * Move the samples recorded since the last call into counts and sum. A sample recorded
+   * concurrently may have its count and its value collected by different calls.
+   * @param counts supplies the bucket counts to add to. It is grown as needed.
+   * @param sum supplies the sum of samples to add to.
+   */
+  void collect(std::vector<uint64_t>& counts, uint64_t& sum);
+
+private:
+  typedef std::array<std::atomic<uint64_t>, HistogramBuckets::SUB_BUCKETS> BucketGroup;
+
+  Store& parent_;
+  std::array<std::atomic<BucketGroup*>, HistogramBuckets::NUM_GROUPS> groups_{};
+  std::atomic<uint64_t> sum_{};
+};
+
+typedef std::shared_ptr<ThreadLocalHistogramImpl> ThreadLocalHistogramSharedPtr;
+
+/**
+ * ParentHistogram implementation that owns the thread local histograms of all threads. Samples
+ * recorded directly on the parent, which happens before threading is initialized and during
+ * shutdown, go into a thread local histogram of its own.
+ */
+class ParentHistogramImpl : public ParentHistogram, public MetricImpl {
+public:
+  ParentHistogramImpl(const std::string& name, Store& parent, std::string&& tag_extracted_name,
+                      std::vector<Tag>&& tags);
+
+  /**
+   * @return a new histogram for one thread to record into. The parent keeps merging it until
+   *         the caller releases it.
+   */
+  ThreadLocalHistogramSharedPtr createThreadLocal();
+
+  // Stats::Histogram
+  void recordValue(uint64_t value) override;
+
+  // Stats::ParentHistogram
+  void merge() override;
+  bool used() const override { return cumulative_statistics_.sampleCount() > 0; }
+  const HistogramStatistics& intervalStatistics() const override { return interval_statistics_; }
+  const HistogramStatistics& cumulativeStatistics() const override {
+    return cumulative_statistics_;
+  }
+
+private:
+  Store& parent_;
+  const ThreadLocalHistogramSharedPtr unthreaded_;
+  std::mutex lock_;
+  std::list<ThreadLocalHistogramSharedPtr> children_;
+  std::vector<uint64_t> interval_counts_;
+  std::vector<uint64_t> cumulative_counts_;
+  uint64_t cumulative_sum_{};
+  HistogramStatisticsImpl interval_statistics_;
+  HistogramStatisticsImpl cumulative_statistics_;
+};
+
+typedef std::shared_ptr<ParentHistogramImpl> ParentHistogramImplSharedPtr;
+
+} // namespace Stats
+} // namespace Envoy
@@ -387,6 +387,8 @@ public:
   // Stats::Store
   std::list<CounterSharedPtr> counters() const override { return counters_.toList(); }
   std::list<GaugeSharedPtr> gauges() const override { return gauges_.toList(); }
+  // Histograms of the isolated store deliver samples to sinks but do not aggregate them.
+  std::list<ParentHistogramSharedPtr> histograms() const override { return {}; }
 
 private:
   struct ScopeImpl : public Scope {
@@ -1,7 +1,10 @@
 #include "common/stats/statsd.h"
 
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
 #include <cstdint>
+#include <cstring>
 #include <string>
 
 #include "envoy/common/exception.h"
@@ -37,32 +40,118 @@ void Writer::write(const std::string& message) {
   ::send(fd_, message.c_str(), message.size(), MSG_DONTWAIT);
 }
 
+constexpr uint32_t Writer::MAX_DATAGRAMS_PER_SYSCALL;
+
+uint64_t Writer::writeDatagrams(const std::vector<absl::string_view>& datagrams) {
+  uint64_t sent = 0;
+  uint64_t next = 0;
+  while (next < datagrams.size()) {
+    const uint32_t batch = std::min<uint64_t>(datagrams.size() - next, MAX_DATAGRAMS_PER_SYSCALL);
+    iovecs_.resize(batch);
+    messages_.resize(batch);
+    for (uint32_t i = 0; i < batch; i++) {
+      iovecs_[i].iov_base = const_cast<char*>(datagrams[next + i].data());
+      iovecs_[i].iov_len = datagrams[next + i].size();
+      memset(&messages_[i], 0, sizeof(messages_[i]));
+      messages_[i].msg_hdr.msg_iov = &iovecs_[i];
+      messages_[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    const int rc = ::sendmmsg(fd_, messages_.data(), batch, MSG_DONTWAIT);
+    if (rc > 0) {
+      sent += rc;
+      next += rc;
+    } else if (rc == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      // The socket buffer is full. Drop the rest rather than block the calling thread.
+      break;
+    } else {
+      // Skip the datagram at the head of the batch, e.g. after a pending ICMP error.
+      next++;
+    }
+  }
+  return sent;
+}
+
+void DatagramBuffer::add(const std::string& line, uint64_t max_bytes_per_datagram) {
+  const uint64_t current_size = data_.size() - currentStart();
+  if (current_size > 0) {
+    if (current_size + 1 + line.size() > max_bytes_per_datagram) {
+      datagram_ends_.push_back(data_.size());
+    } else {
+      data_.push_back('\n');
+    }
+  }
+  data_.append(line);
+}
+
+void DatagramBuffer::flush(Writer& writer, Counter& sent, Counter& dropped) {
+  if (data_.size() > currentStart()) {
+    datagram_ends_.push_back(data_.size());
+  }
+
+  uint64_t start = 0;
+  for (uint64_t end : datagram_ends_) {
+    datagrams_.emplace_back(data_.data() + start, end - start);
+    start = end;
+  }
+
+  const uint64_t sent_datagrams = writer.writeDatagrams(datagrams_);
+  sent.add(sent_datagrams);
+  dropped.add(datagrams_.size() - sent_datagrams);
+
+  data_.clear();
+  datagram_ends_.clear();
+  datagrams_.clear();
+}
+
+constexpr std::chrono::milliseconds UdpStatsdSink::TIMER_FLUSH_INTERVAL;
+
 UdpStatsdSink::UdpStatsdSink(ThreadLocal::SlotAllocator& tls,
-                             Network::Address::InstanceConstSharedPtr address, const bool use_tag)
-    : tls_(tls.allocateSlot()), server_address_(std::move(address)), use_tag_(use_tag) {
-  tls_->set([this](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
-    return std::make_shared<Writer>(this->server_address_);
+                             Network::Address::InstanceConstSharedPtr address, const bool use_tag,
+                             Stats::Scope& scope, uint64_t max_bytes_per_datagram)
+    : tls_(tls.allocateSlot()), server_address_(std::move(address)), use_tag_(use_tag),
+      max_bytes_per_datagram_(max_bytes_per_datagram),
+      datagrams_sent_(scope.counter("statsd.datagrams_sent")),
+      datagrams_dropped_(scope.counter("statsd.datagrams_dropped")) {
+  tls_->set([this](Event::Dispatcher& dispatcher) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<TlsSink>(*this, std::make_shared<Writer>(this->server_address_),
+                                     dispatcher);
   });
 }
 
+UdpStatsdSink::UdpStatsdSink(ThreadLocal::SlotAllocator& tls,
+                             const std::shared_ptr<Writer>& writer, const bool use_tag,
+                             Stats::Scope& scope, uint64_t max_bytes_per_datagram)
+    : tls_(tls.allocateSlot()), use_tag_(use_tag),
+      max_bytes_per_datagram_(max_bytes_per_datagram),
+      datagrams_sent_(scope.counter("statsd.datagrams_sent")),
+      datagrams_dropped_(scope.counter("statsd.datagrams_dropped")) {
+  tls_->set(
+      [this, writer](Event::Dispatcher& dispatcher) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+        return std::make_shared<TlsSink>(*this, writer, dispatcher);
+      });
+}
+
 void UdpStatsdSink::flushCounter(const Counter& counter, uint64_t delta) {
   const std::string message(
       fmt::format("envoy.{}:{}|c{}", getName(counter), delta, buildTagStr(counter.tags())));
-  tls_->getTyped<Writer>().write(message);
+  tls_->getTyped<TlsSink>().write(message, false);
 }
 
 void UdpStatsdSink::flushGauge(const Gauge& gauge, uint64_t value) {
   const std::string message(
       fmt::format("envoy.{}:{}|g{}", getName(gauge), value, buildTagStr(gauge.tags())));
-  tls_->getTyped<Writer>().write(message);
+  tls_->getTyped<TlsSink>().write(message, false);
 }
 
+void UdpStatsdSink::endFlush() { tls_->getTyped<TlsSink>().flush(); }
+
 void UdpStatsdSink::onHistogramComplete(const Histogram& histogram, uint64_t value) {
   // For statsd histograms are all timers.
   const std::string message(fmt::format("envoy.{}:{}|ms{}", getName(histogram),
                                         std::chrono::milliseconds(value).count(),
                                         buildTagStr(histogram.tags())));
-  tls_->getTyped<Writer>().write(message);
+  tls_->getTyped<TlsSink>().write(message, true);
 }
 
 const std::string UdpStatsdSink::getName(const Metric& metric) {
@@ -86,6 +175,42 @@ const std::string UdpStatsdSink::buildTagStr(const std::vector<Tag>& tags) {
   return "|#" + StringUtil::join(tag_strings, ",");
 }
 
+UdpStatsdSink::TlsSink::TlsSink(UdpStatsdSink& parent, std::shared_ptr<Writer> writer,
+                                Event::Dispatcher& dispatcher)
+    : parent_(parent), writer_(std::move(writer)), dispatcher_(dispatcher),
+      datagrams_sent_(parent.datagrams_sent_), datagrams_dropped_(parent.datagrams_dropped_) {}
+
+UdpStatsdSink::TlsSink::~TlsSink() { flush(); }
+
+void UdpStatsdSink::TlsSink::write(const std::string& message, bool flush_when_full) {
+  if (parent_.max_bytes_per_datagram_ == 0) {
+    writer_->write(message);
+    return;
+  }
+
+  const bool was_empty = buffer_.empty();
+  buffer_.add(message, parent_.max_bytes_per_datagram_);
+  if (!flush_when_full) {
+    // Counters and gauges are sent together by endFlush().
+    return;
+  }
+
+  if (buffer_.completeDatagrams() >= MAX_BUFFERED_DATAGRAMS) {
+    flush();
+  } else if (was_empty) {
+    if (!flush_timer_) {
+      flush_timer_ = dispatcher_.createTimer([this]() -> void { flush(); });
+    }
+    flush_timer_->enableTimer(TIMER_FLUSH_INTERVAL);
+  }
+}
+
+void UdpStatsdSink::TlsSink::flush() {
+  if (!buffer_.empty()) {
+    buffer_.flush(*writer_, datagrams_sent_, datagrams_dropped_);
+  }
+}
+
 char TcpStatsdSink::STAT_PREFIX[] = "envoy.";
 
 TcpStatsdSink::TcpStatsdSink(const LocalInfo::LocalInfo& local_info,
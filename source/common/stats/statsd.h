@@ -1,9 +1,13 @@
 #pragma once
 
+#include <sys/socket.h>
+#include <sys/uio.h>
+
 #include <chrono>
 #include <cstdint>
 #include <string>
 
+#include "envoy/event/timer.h"
 #include "envoy/local_info/local_info.h"
 #include "envoy/network/connection.h"
 #include "envoy/stats/stats.h"
@@ -12,6 +16,8 @@
 
 #include "common/buffer/buffer_impl.h"
 
+#include "absl/strings/string_view.h"
+
 namespace Envoy {
 namespace Stats {
 namespace Statsd {
@@ -27,46 +33,126 @@ public:
   virtual ~Writer();
 
   virtual void write(const std::string& message);
+
+  /**
+   * Send each payload as its own datagram, using as few system calls as possible. This never
+   * blocks: datagrams the kernel does not accept are dropped.
+   * @param datagrams supplies the datagram payloads.
+   * @return the number of datagrams accepted by the kernel.
+   */
+  virtual uint64_t writeDatagrams(const std::vector<absl::string_view>& datagrams);
+
   // Called in unit test to validate address.
   int getFdForTests() const { return fd_; };
 
 private:
+  // Maximum number of datagrams passed to a single sendmmsg() call.
+  static constexpr uint32_t MAX_DATAGRAMS_PER_SYSCALL = 1024;
+
   int fd_;
+  // Scratch space for writeDatagrams(), kept to avoid reallocating on every flush.
+  std::vector<iovec> iovecs_;
+  std::vector<mmsghdr> messages_;
 };
 
 /**
- * Implementation of Sink that writes to a UDP statsd address.
+ * Packs newline separated statsd lines into datagram payloads of bounded size. All payloads share
+ * one backing string which keeps its capacity across flushes.
+ */
+class DatagramBuffer {
+public:
+  /**
+   * Append a line, starting a new datagram if it does not fit in the current one. A line longer
+   * than max_bytes_per_datagram is sent in a datagram of its own.
+   */
+  void add(const std::string& line, uint64_t max_bytes_per_datagram);
+
+  /**
+   * @return the number of datagrams which are full and waiting to be sent.
+   */
+  uint64_t completeDatagrams() const { return datagram_ends_.size(); }
+
+  bool empty() const { return data_.empty(); }
+
+  /**
+   * Send all buffered datagrams, including a partially filled one, and reset the buffer.
+   * @param sent supplies the counter of datagrams accepted by the writer.
+   * @param dropped supplies the counter of datagrams the writer could not send.
+   */
+  void flush(Writer& writer, Counter& sent, Counter& dropped);
+
+private:
+  uint64_t currentStart() const { return datagram_ends_.empty() ? 0 : datagram_ends_.back(); }
+
+  std::string data_;
+  // End offsets in data_ of each complete datagram.
+  std::vector<uint64_t> datagram_ends_;
+  std::vector<absl::string_view> datagrams_;
+};
+
+/**
+ * Implementation of Sink that writes to a UDP statsd address. If max_bytes_per_datagram is
+ * non-zero, metric lines are packed into datagrams of up to that many bytes. Counters and gauges
+ * are then sent at the end of each flush, and timers emitted on a thread are sent once a batch
+ * of datagrams is full or after TIMER_FLUSH_INTERVAL. Otherwise each metric is sent on its own.
  */
 class UdpStatsdSink : public Sink {
 public:
   UdpStatsdSink(ThreadLocal::SlotAllocator& tls, Network::Address::InstanceConstSharedPtr address,
-                const bool use_tag);
+                const bool use_tag, Stats::Scope& scope, uint64_t max_bytes_per_datagram = 0);
   // For testing.
   UdpStatsdSink(ThreadLocal::SlotAllocator& tls, const std::shared_ptr<Writer>& writer,
-                const bool use_tag)
-      : tls_(tls.allocateSlot()), use_tag_(use_tag) {
-    tls_->set(
-        [writer](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr { return writer; });
-  }
+                const bool use_tag, Stats::Scope& scope, uint64_t max_bytes_per_datagram = 0);
 
   // Stats::Sink
   void beginFlush() override {}
   void flushCounter(const Counter& counter, uint64_t delta) override;
   void flushGauge(const Gauge& gauge, uint64_t value) override;
-  void endFlush() override {}
+  // Every sample is already sent as a timer, which statsd aggregates itself.
+  void flushHistogram(const ParentHistogram&) override {}
+  void endFlush() override;
   void onHistogramComplete(const Histogram& histogram, uint64_t value) override;
 
   // Called in unit test to validate writer construction and address.
-  int getFdForTests() { return tls_->getTyped<Writer>().getFdForTests(); }
+  int getFdForTests() { return tls_->getTyped<TlsSink>().writer_->getFdForTests(); }
   bool getUseTagForTest() { return use_tag_; }
 
 private:
+  struct TlsSink : public ThreadLocal::ThreadLocalObject {
+    TlsSink(UdpStatsdSink& parent, std::shared_ptr<Writer> writer, Event::Dispatcher& dispatcher);
+    // Sends whatever is still buffered, e.g. timers waiting for the flush timer.
+    ~TlsSink();
+
+    void write(const std::string& message, bool flush_when_full);
+    void flush();
+
+    UdpStatsdSink& parent_;
+    const std::shared_ptr<Writer> writer_;
+    Event::Dispatcher& dispatcher_;
+    // Owned by the scope rather than parent_, which may already be gone when a slot removal posted
+    // to this thread destroys the sink.
+    Stats::Counter& datagrams_sent_;
+    Stats::Counter& datagrams_dropped_;
+    DatagramBuffer buffer_;
+    Event::TimerPtr flush_timer_;
+  };
+
+  // Number of complete datagrams a thread buffers before sending them without waiting for the
+  // flush timer.
+  static constexpr uint32_t MAX_BUFFERED_DATAGRAMS = 64;
+
+  // Upper bound on how long a thread holds on to buffered timers.
+  static constexpr std::chrono::milliseconds TIMER_FLUSH_INTERVAL{100};
+
   const std::string getName(const Metric& metric);
   const std::string buildTagStr(const std::vector<Tag>& tags);
 
   ThreadLocal::SlotPtr tls_;
   Network::Address::InstanceConstSharedPtr server_address_;
   const bool use_tag_;
+  const uint64_t max_bytes_per_datagram_;
+  Stats::Counter& datagrams_sent_;
+  Stats::Counter& datagrams_dropped_;
 };
 
 /**
@@ -89,6 +175,9 @@ public:
     tls_->getTyped<TlsSink>().flushGauge(gauge.name(), value);
   }
 
+  // Every sample is already sent as a timer, which statsd aggregates itself.
+  void flushHistogram(const ParentHistogram&) override {}
+
   void endFlush() override { tls_->getTyped<TlsSink>().endFlush(true); }
 
   void onHistogramComplete(const Histogram& histogram, uint64_t value) override {
@@ -11,6 +11,7 @@
 #include "common/http/headers.h"
 #include "common/http/utility.h"
 #include "common/request_info/utility.h"
+#include "common/runtime/key_registry.h"
 #include "common/runtime/uuid_util.h"
 
 #include "fmt/format.h"
@@ -18,6 +19,13 @@
 namespace Envoy {
 namespace Tracing {
 
+static const Runtime::Key RuntimeClientEnabled =
+    Runtime::KeyRegistry::intern("tracing.client_enabled");
+static const Runtime::Key RuntimeRandomSampling =
+    Runtime::KeyRegistry::intern("tracing.random_sampling");
+static const Runtime::Key RuntimeGlobalEnabled =
+    Runtime::KeyRegistry::intern("tracing.global_enabled");
+
 // TODO(mattklein123) PERF: Avoid string creations/copies in this entire file.
 static std::string buildResponseCode(const RequestInfo::RequestInfo& info) {
   return info.responseCode().valid() ? std::to_string(info.responseCode().value()) : "0";
@@ -57,16 +65,16 @@ void HttpTracerUtility::mutateHeaders(Http::HeaderMap& request_headers, Runtime:
   // Do not apply tracing transformations if we are currently tracing.
   if (UuidTraceStatus::NoTrace == UuidUtils::isTraceableUuid(x_request_id)) {
     if (request_headers.ClientTraceId() &&
-        runtime.snapshot().featureEnabled("tracing.client_enabled", 100)) {
+        runtime.snapshot().featureEnabled(RuntimeClientEnabled, 100)) {
       UuidUtils::setTraceableUuid(x_request_id, UuidTraceStatus::Client);
     } else if (request_headers.EnvoyForceTrace()) {
       UuidUtils::setTraceableUuid(x_request_id, UuidTraceStatus::Forced);
-    } else if (runtime.snapshot().featureEnabled("tracing.random_sampling", 10000, result, 10000)) {
+    } else if (runtime.snapshot().featureEnabled(RuntimeRandomSampling, 10000, result, 10000)) {
       UuidUtils::setTraceableUuid(x_request_id, UuidTraceStatus::Sampled);
     }
   }
 
-  if (!runtime.snapshot().featureEnabled("tracing.global_enabled", 100, result)) {
+  if (!runtime.snapshot().featureEnabled(RuntimeGlobalEnabled, 100, result)) {
     UuidUtils::setTraceableUuid(x_request_id, UuidTraceStatus::NoTrace);
   }
 
@@ -27,6 +27,7 @@
 #include "common/router/shadow_writer_impl.h"
 #include "common/upstream/cds_api_impl.h"
 #include "common/upstream/load_balancer_impl.h"
+#include "common/upstream/maglev_lb.h"
 #include "common/upstream/original_dst_cluster.h"
 #include "common/upstream/ring_hash_lb.h"
 #include "common/upstream/subset_lb.h"
@@ -445,6 +446,10 @@ void ClusterManagerImpl::loadCluster(const envoy::api::v2::Cluster& cluster, boo
     cluster_entry_it->second.thread_aware_lb_ = std::make_unique<RingHashLoadBalancer>(
         primary_cluster_reference.prioritySet(), primary_cluster_reference.info()->stats(),
         runtime_, random_, primary_cluster_reference.info()->lbRingHashConfig());
+  } else if (primary_cluster_reference.info()->lbType() == LoadBalancerType::Maglev) {
+    cluster_entry_it->second.thread_aware_lb_ = std::make_unique<MaglevLoadBalancer>(
+        primary_cluster_reference.prioritySet(), primary_cluster_reference.info()->stats(),
+        runtime_, random_);
   }
 
   cm_stats_.total_clusters_.set(primary_clusters_.size());
@@ -486,13 +491,12 @@ void ClusterManagerImpl::postThreadLocalClusterUpdate(
     const std::vector<HostSharedPtr>& hosts_removed) {
   const auto& host_set = primary_cluster.prioritySet().hostSetsPerPriority()[priority];
 
-  HostVectorConstSharedPtr hosts_copy(new std::vector<HostSharedPtr>(host_set->hosts()));
-  HostVectorConstSharedPtr healthy_hosts_copy(
-      new std::vector<HostSharedPtr>(host_set->healthyHosts()));
-  HostListsConstSharedPtr hosts_per_locality_copy(
-      new std::vector<std::vector<HostSharedPtr>>(host_set->hostsPerLocality()));
-  HostListsConstSharedPtr healthy_hosts_per_locality_copy(
-      new std::vector<std::vector<HostSharedPtr>>(host_set->healthyHostsPerLocality()));
+  // The host lists of a host set are immutable once built, so all of the workers share the lists
+  // of the update rather than each getting a copy.
+  HostVectorConstSharedPtr hosts_copy = host_set->hostsPtr();
+  HostVectorConstSharedPtr healthy_hosts_copy = host_set->healthyHostsPtr();
+  HostListsConstSharedPtr hosts_per_locality_copy = host_set->hostsPerLocalityPtr();
+  HostListsConstSharedPtr healthy_hosts_per_locality_copy = host_set->healthyHostsPerLocalityPtr();
 
   tls_->runOnAllThreads([
     this, name = primary_cluster.info()->name(), priority, hosts_copy, healthy_hosts_copy,
@@ -723,7 +727,8 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::ClusterEntry(
                                            parent.parent_.random_));
       break;
     }
-    case LoadBalancerType::RingHash: {
+    case LoadBalancerType::RingHash:
+    case LoadBalancerType::Maglev: {
       ASSERT(lb_factory_ != nullptr);
       lb_ = lb_factory_->create();
       break;
@@ -792,7 +797,7 @@ ProdClusterManagerFactory::allocateConnPool(Event::Dispatcher& dispatcher, HostC
   if (protocol == Http::Protocol::Http2 &&
       runtime_.snapshot().featureEnabled("upstream.use_http2", 100)) {
     return Http::ConnectionPool::InstancePtr{
-        new Http::Http2::ProdConnPoolImpl(dispatcher, host, priority)};
+        new Http::Http2::ProdConnPoolImpl(dispatcher, host, priority, runtime_)};
   } else {
     return Http::ConnectionPool::InstancePtr{
         new Http::Http1::ConnPoolImplProd(dispatcher, host, priority)};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <queue>
+#include <tuple>
+#include <vector>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Upstream {
+
+/**
+ * Earliest deadline first (EDF) scheduler, used for weighted round robin style picks in
+ * O(log n). Each entry is scheduled 1/weight after the current time, so over time an entry is
+ * picked in proportion to its weight. Entries with the same deadline are picked in the order they
+ * were added. See https://en.wikipedia.org/wiki/Earliest_deadline_first_scheduling.
+ */
+template <class C> class EdfScheduler {
+public:
+  /**
+   * Add an entry to the scheduler.
+   * @param weight supplies the weight of the entry. Must be positive.
+   * @param entry supplies the entry.
+   */
+  void add(double weight, std::shared_ptr<C> entry) {
+    ASSERT(weight > 0);
+    queue_.push({current_time_ + 1.0 / weight, order_offset_++, std::move(entry)});
+  }
+
+  /**
+   * Remove and return the entry with the earliest deadline, advancing the current time to its
+   * deadline. The caller is expected to add() the entry again, with its current weight, if it
+   * should keep being scheduled.
+   * @return std::shared_ptr<C> the picked entry, or nullptr if the scheduler is empty.
+   */
+  std::shared_ptr<C> pick() {
+    if (queue_.empty()) {
+      return nullptr;
+    }
+    const EdfEntry& top = queue_.top();
+    current_time_ = top.deadline_;
+    std::shared_ptr<C> entry = top.entry_;
+    queue_.pop();
+    return entry;
+  }
+
+  /**
+   * @return bool true if the scheduler has no entries.
+   */
+  bool empty() const { return queue_.empty(); }
+
+private:
+  struct EdfEntry {
+    double deadline_;
+    // Tie breaker for entries with the same deadline.
+    uint64_t order_offset_;
+    std::shared_ptr<C> entry_;
+
+    // std::priority_queue is a max heap, so order by the latest deadline first.
+    bool operator<(const EdfEntry& other) const {
+      return std::tie(deadline_, order_offset_) > std::tie(other.deadline_, other.order_offset_);
+    }
+  };
+
+  double current_time_{};
+  uint64_t order_offset_{};
+  std::priority_queue<EdfEntry> queue_;
+};
+
+} // namespace Upstream
+} // namespace Envoy
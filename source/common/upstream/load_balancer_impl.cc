@@ -1,5 +1,6 @@
 #include "common/upstream/load_balancer_impl.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -9,13 +10,17 @@
 #include "envoy/upstream/upstream.h"
 
 #include "common/common/assert.h"
+#include "common/runtime/key_registry.h"
 
 namespace Envoy {
 namespace Upstream {
 
-static const std::string RuntimeZoneEnabled = "upstream.zone_routing.enabled";
-static const std::string RuntimeMinClusterSize = "upstream.zone_routing.min_cluster_size";
-static const std::string RuntimePanicThreshold = "upstream.healthy_panic_threshold";
+static const Runtime::Key RuntimeZoneEnabled =
+    Runtime::KeyRegistry::intern("upstream.zone_routing.enabled");
+static const Runtime::Key RuntimeMinClusterSize =
+    Runtime::KeyRegistry::intern("upstream.zone_routing.min_cluster_size");
+static const Runtime::Key RuntimePanicThreshold =
+    Runtime::KeyRegistry::intern("upstream.healthy_panic_threshold");
 
 uint32_t LoadBalancerBase::choosePriority(uint64_t hash,
                                           const std::vector<uint32_t>& per_priority_load) {
@@ -280,8 +285,7 @@ void ZoneAwareLoadBalancerBase::calculateLocalityPercentage(
   }
 }
 
-const std::vector<HostSharedPtr>&
-ZoneAwareLoadBalancerBase::tryChooseLocalLocalityHosts(const HostSet& host_set) {
+uint32_t ZoneAwareLoadBalancerBase::tryChooseLocalLocalityHosts(const HostSet& host_set) {
   PerPriorityState& state = *per_priority_state_[host_set.priority()];
   ASSERT(state.locality_routing_state_ != LocalityRoutingState::NoLocalityRouting);
 
@@ -293,7 +297,7 @@ ZoneAwareLoadBalancerBase::tryChooseLocalLocalityHosts(const HostSet& host_set)
   // Try to push all of the requests to the same locality first.
   if (state.locality_routing_state_ == LocalityRoutingState::LocalityDirect) {
     stats_.lb_zone_routing_all_directly_.inc();
-    return host_set.healthyHostsPerLocality()[0];
+    return 0;
   }
 
   ASSERT(state.locality_routing_state_ == LocalityRoutingState::LocalityResidual);
@@ -302,7 +306,7 @@ ZoneAwareLoadBalancerBase::tryChooseLocalLocalityHosts(const HostSet& host_set)
   // push to the local locality, check if we can push to local locality on current iteration.
   if (random_.random() % 10000 < state.local_percent_to_route_) {
     stats_.lb_zone_routing_sampled_.inc();
-    return host_set.healthyHostsPerLocality()[0];
+    return 0;
   }
 
   // At this point we must route cross locality as we cannot route to the local locality.
@@ -312,7 +316,7 @@ ZoneAwareLoadBalancerBase::tryChooseLocalLocalityHosts(const HostSet& host_set)
   // locality percentages. In this case just select random locality.
   if (state.residual_capacity_[number_of_localities - 1] == 0) {
     stats_.lb_zone_no_capacity_left_.inc();
-    return host_set.healthyHostsPerLocality()[random_.random() % number_of_localities];
+    return random_.random() % number_of_localities;
   }
 
   // Random sampling to select specific locality for cross locality traffic based on the additional
@@ -321,112 +325,143 @@ ZoneAwareLoadBalancerBase::tryChooseLocalLocalityHosts(const HostSet& host_set)
 
   // This potentially can be optimized to be O(log(N)) where N is the number of localities.
   // Linear scan should be faster for smaller N, in most of the scenarios N will be small.
-  int i = 0;
+  uint32_t i = 0;
   while (threshold > state.residual_capacity_[i]) {
     i++;
   }
 
-  return host_set.healthyHostsPerLocality()[i];
+  return i;
 }
 
-const std::vector<HostSharedPtr>& ZoneAwareLoadBalancerBase::hostsToUse() {
+ZoneAwareLoadBalancerBase::HostsSource ZoneAwareLoadBalancerBase::hostSourceToUse() {
   const HostSet& host_set = chooseHostSet();
 
   // If the selected host set has insufficient healthy hosts, return all hosts.
   if (isGlobalPanic(host_set, runtime_)) {
     stats_.lb_healthy_panic_.inc();
-    return host_set.hosts();
+    return HostsSource(host_set.priority(), HostsSource::SourceType::AllHosts);
   }
 
   // If we've latched that we can't do priority-based routing, return healthy hosts for the selected
   // host set.
   if (per_priority_state_[host_set.priority()]->locality_routing_state_ ==
       LocalityRoutingState::NoLocalityRouting) {
-    return host_set.healthyHosts();
+    return HostsSource(host_set.priority(), HostsSource::SourceType::HealthyHosts);
   }
 
   // Determine if the load balancer should do zone based routing for this pick.
   if (!runtime_.snapshot().featureEnabled(RuntimeZoneEnabled, 100)) {
-    return host_set.healthyHosts();
+    return HostsSource(host_set.priority(), HostsSource::SourceType::HealthyHosts);
   }
 
   if (isGlobalPanic(localHostSet(), runtime_)) {
     stats_.lb_local_cluster_not_ok_.inc();
     // If the local Envoy instances are in global panic, do not do locality
     // based routing.
-    return host_set.healthyHosts();
+    return HostsSource(host_set.priority(), HostsSource::SourceType::HealthyHosts);
   }
 
-  return tryChooseLocalLocalityHosts(host_set);
+  return HostsSource(host_set.priority(), HostsSource::SourceType::LocalityHealthyHosts,
+                     tryChooseLocalLocalityHosts(host_set));
 }
 
-HostConstSharedPtr RoundRobinLoadBalancer::chooseHost(LoadBalancerContext*) {
-  const std::vector<HostSharedPtr>& hosts_to_use = hostsToUse();
-  if (hosts_to_use.empty()) {
-    return nullptr;
+const std::vector<HostSharedPtr>&
+ZoneAwareLoadBalancerBase::hostSourceToHosts(const HostsSource& hosts_source) const {
+  const HostSet& host_set = *priority_set_.hostSetsPerPriority()[hosts_source.priority_];
+  switch (hosts_source.source_type_) {
+  case HostsSource::SourceType::AllHosts:
+    return host_set.hosts();
+  case HostsSource::SourceType::HealthyHosts:
+    return host_set.healthyHosts();
+  case HostsSource::SourceType::LocalityHealthyHosts:
+    return host_set.healthyHostsPerLocality()[hosts_source.locality_index_];
   }
-
-  return hosts_to_use[rr_index_++ % hosts_to_use.size()];
+  NOT_REACHED;
 }
 
-LeastRequestLoadBalancer::LeastRequestLoadBalancer(const PrioritySet& priority_set,
-                                                   const PrioritySet* local_priority_set,
-                                                   ClusterStats& stats, Runtime::Loader& runtime,
-                                                   Runtime::RandomGenerator& random)
+EdfLoadBalancerBase::EdfLoadBalancerBase(const PrioritySet& priority_set,
+                                         const PrioritySet* local_priority_set,
+                                         ClusterStats& stats, Runtime::Loader& runtime,
+                                         Runtime::RandomGenerator& random)
     : ZoneAwareLoadBalancerBase(priority_set, local_priority_set, stats, runtime, random) {
-  priority_set.addMemberUpdateCb([this](uint32_t, const std::vector<HostSharedPtr>&,
-                                        const std::vector<HostSharedPtr>& hosts_removed) -> void {
-    if (last_host_) {
-      for (const HostSharedPtr& host : hosts_removed) {
-        if (host == last_host_) {
-          hits_left_ = 0;
-          last_host_.reset();
-
-          break;
-        }
-      }
-    }
+  for (const auto& host_set : priority_set_.hostSetsPerPriority()) {
+    refresh(host_set->priority());
+  }
+  priority_set_.addMemberUpdateCb([this](uint32_t priority, const std::vector<HostSharedPtr>&,
+                                         const std::vector<HostSharedPtr>&) -> void {
+    refresh(priority);
   });
 }
 
-HostConstSharedPtr LeastRequestLoadBalancer::chooseHost(LoadBalancerContext*) {
-  bool is_weight_imbalanced = stats_.max_host_weight_.value() != 1;
-  bool is_weight_enabled = runtime_.snapshot().getInteger("upstream.weight_enabled", 1UL) != 0;
+void EdfLoadBalancerBase::refresh(uint32_t priority) {
+  // Only the schedulers of the updated priority level are rebuilt. The number of localities may
+  // have changed, so drop all of them first.
+  for (auto it = scheduler_.begin(); it != scheduler_.end();) {
+    if (it->first.priority_ == priority) {
+      it = scheduler_.erase(it);
+    } else {
+      ++it;
+    }
+  }
 
-  if (is_weight_imbalanced && hits_left_ > 0 && is_weight_enabled) {
-    --hits_left_;
+  const HostSet& host_set = *priority_set_.hostSetsPerPriority()[priority];
+  refreshHostSource(HostsSource(priority, HostsSource::SourceType::AllHosts));
+  refreshHostSource(HostsSource(priority, HostsSource::SourceType::HealthyHosts));
+  for (uint32_t locality_index = 0; locality_index < host_set.healthyHostsPerLocality().size();
+       locality_index++) {
+    refreshHostSource(
+        HostsSource(priority, HostsSource::SourceType::LocalityHealthyHosts, locality_index));
+  }
+}
 
-    return last_host_;
-  } else {
-    // To avoid hit stale last_host_ when all hosts become weight balanced.
-    hits_left_ = 0;
-    last_host_.reset();
+void EdfLoadBalancerBase::refreshHostSource(const HostsSource& hosts_source) {
+  const std::vector<HostSharedPtr>& hosts = hostSourceToHosts(hosts_source);
+  const bool weights_equal =
+      std::all_of(hosts.begin(), hosts.end(), [&hosts](const HostSharedPtr& host) {
+        return host->weight() == hosts[0]->weight();
+      });
+  if (weights_equal) {
+    return;
+  }
+
+  EdfScheduler<const Host>& scheduler = scheduler_[hosts_source];
+  for (const HostSharedPtr& host : hosts) {
+    scheduler.add(host->weight(), host);
+  }
+}
+
+HostConstSharedPtr EdfLoadBalancerBase::chooseHost(LoadBalancerContext*) {
+  const HostsSource hosts_source = hostSourceToUse();
+  auto scheduler_it = scheduler_.find(hosts_source);
+  if (scheduler_it != scheduler_.end()) {
+    EdfScheduler<const Host>& scheduler = scheduler_it->second;
+    HostConstSharedPtr host = scheduler.pick();
+    ASSERT(host != nullptr);
+    scheduler.add(hostWeight(*host), host);
+    return host;
   }
 
-  const std::vector<HostSharedPtr>& hosts_to_use = hostsToUse();
+  const std::vector<HostSharedPtr>& hosts_to_use = hostSourceToHosts(hosts_source);
   if (hosts_to_use.empty()) {
     return nullptr;
   }
+  return unweightedHostPick(hosts_to_use, hosts_source);
+}
 
-  // Make weighed random if we have hosts with non 1 weights.
-  if (is_weight_imbalanced & is_weight_enabled) {
-    last_host_ = hosts_to_use[random_.random() % hosts_to_use.size()];
-    hits_left_ = last_host_->weight() - 1;
-
-    return last_host_;
+HostConstSharedPtr
+LeastRequestLoadBalancer::unweightedHostPick(const std::vector<HostSharedPtr>& hosts_to_use,
+                                             const HostsSource&) {
+  HostSharedPtr host1 = hosts_to_use[random_.random() % hosts_to_use.size()];
+  HostSharedPtr host2 = hosts_to_use[random_.random() % hosts_to_use.size()];
+  if (host1->stats().rq_active_.value() < host2->stats().rq_active_.value()) {
+    return host1;
   } else {
-    HostSharedPtr host1 = hosts_to_use[random_.random() % hosts_to_use.size()];
-    HostSharedPtr host2 = hosts_to_use[random_.random() % hosts_to_use.size()];
-    if (host1->stats().rq_active_.value() < host2->stats().rq_active_.value()) {
-      return host1;
-    } else {
-      return host2;
-    }
+    return host2;
   }
 }
 
 HostConstSharedPtr RandomLoadBalancer::chooseHost(LoadBalancerContext*) {
-  const std::vector<HostSharedPtr>& hosts_to_use = hostsToUse();
+  const std::vector<HostSharedPtr>& hosts_to_use = hostSourceToHosts(hostSourceToUse());
   if (hosts_to_use.empty()) {
     return nullptr;
   }
@@ -2,12 +2,15 @@
 
 #include <cstdint>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 #include "envoy/runtime/runtime.h"
 #include "envoy/upstream/load_balancer.h"
 #include "envoy/upstream/upstream.h"
 
+#include "common/upstream/edf_scheduler.h"
+
 #include "api/cds.pb.h"
 
 namespace Envoy {
@@ -69,9 +72,50 @@ protected:
   ~ZoneAwareLoadBalancerBase();
 
   /**
-   * Pick the host list to use, doing zone aware routing when the hosts are sufficiently healthy.
+   * Identifies one of the host lists of a host set that picks are made from.
    */
-  const std::vector<HostSharedPtr>& hostsToUse();
+  struct HostsSource {
+    enum class SourceType {
+      // All hosts of the host set, used in panic mode.
+      AllHosts,
+      // The healthy hosts of the host set.
+      HealthyHosts,
+      // The healthy hosts of one locality of the host set.
+      LocalityHealthyHosts
+    };
+
+    HostsSource() {}
+    HostsSource(uint32_t priority, SourceType source_type, uint32_t locality_index = 0)
+        : priority_(priority), source_type_(source_type), locality_index_(locality_index) {}
+
+    bool operator==(const HostsSource& other) const {
+      return priority_ == other.priority_ && source_type_ == other.source_type_ &&
+             locality_index_ == other.locality_index_;
+    }
+
+    uint32_t priority_{};
+    SourceType source_type_{SourceType::AllHosts};
+    // Only used for SourceType::LocalityHealthyHosts.
+    uint32_t locality_index_{};
+  };
+
+  struct HostsSourceHash {
+    size_t operator()(const HostsSource& hosts_source) const {
+      return (static_cast<size_t>(hosts_source.priority_) << 34) ^
+             (static_cast<size_t>(hosts_source.source_type_) << 32) ^
+             hosts_source.locality_index_;
+    }
+  };
+
+  /**
+   * Pick the host source to use, doing zone aware routing when the hosts are sufficiently healthy.
+   */
+  HostsSource hostSourceToUse();
+
+  /**
+   * @return the hosts of a host source.
+   */
+  const std::vector<HostSharedPtr>& hostSourceToHosts(const HostsSource& hosts_source) const;
 
 private:
   enum class LocalityRoutingState {
@@ -98,8 +142,9 @@ private:
   /**
    * Try to select upstream hosts from the same locality.
    * @param host_set the last host set returned by chooseHostSet()
+   * @return the index of the locality to route to in host_set.healthyHostsPerLocality().
    */
-  const std::vector<HostSharedPtr>& tryChooseLocalLocalityHosts(const HostSet& host_set);
+  uint32_t tryChooseLocalLocalityHosts(const HostSet& host_set);
 
   /**
    * @return (number of hosts in a given locality)/(total number of hosts) in ret param.
@@ -136,48 +181,89 @@ private:
   Common::CallbackHandle* local_priority_set_member_update_cb_handle_{};
 };
 
+/**
+ * Base class for load balancers that take host weights into account. When the hosts of a host
+ * source have different weights, picks are made by an EDF scheduler over the hosts in O(log n).
+ * The schedulers of a priority level are rebuilt whenever its host set changes. When all hosts
+ * have the same weight, picks are left to unweightedHostPick().
+ */
+class EdfLoadBalancerBase : public LoadBalancer, protected ZoneAwareLoadBalancerBase {
+public:
+  // Upstream::LoadBalancer
+  HostConstSharedPtr chooseHost(LoadBalancerContext* context) override;
+
+protected:
+  EdfLoadBalancerBase(const PrioritySet& priority_set, const PrioritySet* local_priority_set,
+                      ClusterStats& stats, Runtime::Loader& runtime,
+                      Runtime::RandomGenerator& random);
+
+private:
+  void refresh(uint32_t priority);
+  void refreshHostSource(const HostsSource& hosts_source);
+
+  /**
+   * @return the weight to schedule a host with after it has been picked.
+   */
+  virtual double hostWeight(const Host& host) PURE;
+
+  /**
+   * Pick a host when all hosts of a source have the same weight.
+   * @param hosts_to_use supplies the hosts of the source. Never empty.
+   */
+  virtual HostConstSharedPtr unweightedHostPick(const std::vector<HostSharedPtr>& hosts_to_use,
+                                                const HostsSource& hosts_source) PURE;
+
+  // Schedulers for the host sources whose hosts have different weights.
+  std::unordered_map<HostsSource, EdfScheduler<const Host>, HostsSourceHash> scheduler_;
+};
+
 /**
  * Implementation of LoadBalancer that performs RR selection across the hosts in the cluster.
+ * Hosts are picked in proportion to their weight.
  */
-class RoundRobinLoadBalancer : public LoadBalancer, ZoneAwareLoadBalancerBase {
+class RoundRobinLoadBalancer : public EdfLoadBalancerBase {
 public:
   RoundRobinLoadBalancer(const PrioritySet& priority_set, const PrioritySet* local_priority_set,
                          ClusterStats& stats, Runtime::Loader& runtime,
                          Runtime::RandomGenerator& random)
-      : ZoneAwareLoadBalancerBase(priority_set, local_priority_set, stats, runtime, random) {}
-
-  // Upstream::LoadBalancer
-  HostConstSharedPtr chooseHost(LoadBalancerContext* context) override;
+      : EdfLoadBalancerBase(priority_set, local_priority_set, stats, runtime, random) {}
 
 private:
+  // EdfLoadBalancerBase
+  double hostWeight(const Host& host) override { return host.weight(); }
+  HostConstSharedPtr unweightedHostPick(const std::vector<HostSharedPtr>& hosts_to_use,
+                                        const HostsSource&) override {
+    return hosts_to_use[rr_index_++ % hosts_to_use.size()];
+  }
+
   size_t rr_index_{};
 };
 
 /**
  * Weighted Least Request load balancer.
  *
- * In a normal setup when all hosts have the same weight of 1 it randomly picks up two healthy hosts
+ * In a normal setup when all hosts have the same weight it randomly picks up two healthy hosts
  * and compares number of active requests.
  * Technique is based on http://www.eecs.harvard.edu/~michaelm/postscripts/mythesis.pdf
  *
- * When any of the hosts have non 1 weight, apply random weighted balancing.
- * Randomly pickup the host and send 'weight' number of requests to it.
- * This technique is acceptable for load testing but
- * will not work well in situations where requests take a long time.
- * In that case a different algorithm using a full scan will be required.
+ * When hosts have different weights, hosts are picked by the EDF scheduler. A picked host is
+ * scheduled again with its weight divided by its number of active requests plus one, so that
+ * loaded hosts are picked less often than their weight alone would suggest.
  */
-class LeastRequestLoadBalancer : public LoadBalancer, ZoneAwareLoadBalancerBase {
+class LeastRequestLoadBalancer : public EdfLoadBalancerBase {
 public:
   LeastRequestLoadBalancer(const PrioritySet& priority_set, const PrioritySet* local_priority_set,
                            ClusterStats& stats, Runtime::Loader& runtime,
-                           Runtime::RandomGenerator& random);
-
-  // Upstream::LoadBalancer
-  HostConstSharedPtr chooseHost(LoadBalancerContext* context) override;
+                           Runtime::RandomGenerator& random)
+      : EdfLoadBalancerBase(priority_set, local_priority_set, stats, runtime, random) {}
 
 private:
-  HostSharedPtr last_host_;
-  uint32_t hits_left_{};
+  // EdfLoadBalancerBase
+  double hostWeight(const Host& host) override {
+    return static_cast<double>(host.weight()) / (host.stats().rq_active_.value() + 1);
+  }
+  HostConstSharedPtr unweightedHostPick(const std::vector<HostSharedPtr>& hosts_to_use,
+                                        const HostsSource& hosts_source) override;
 };
 
 /**
@@ -0,0 +1,80 @@
+#include "common/upstream/maglev_lb.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/common/assert.h"
+#include "common/common/hash.h"
+
+namespace Envoy {
+namespace Upstream {
+
+MaglevTable::MaglevTable(const std::vector<HostSharedPtr>& hosts, uint64_t table_size)
+    : table_size_(table_size) {
+  ENVOY_LOG(trace, "maglev: building table");
+  ASSERT(table_size_ > 1);
+  if (hosts.empty()) {
+    return;
+  }
+  RELEASE_ASSERT(hosts.size() <= table_size_);
+
+  // The offset and skip of a host define its permutation of the table: offset, offset + skip,
+  // offset + 2 * skip, ... modulo the table size. As the table size is prime, every permutation
+  // visits every entry.
+  std::vector<TableBuildEntry> build_entries;
+  build_entries.reserve(hosts.size());
+  hosts_.reserve(hosts.size());
+  uint32_t max_weight = 0;
+  for (const auto& host : hosts) {
+    const std::string& address_string = host->address()->asString();
+    build_entries.emplace_back(HashUtil::xxHash64(address_string) % table_size_,
+                               HashUtil::xxHash64(address_string, 1) % (table_size_ - 1) + 1,
+                               host->weight());
+    hosts_.push_back(host);
+    max_weight = std::max(max_weight, host->weight());
+  }
+
+  const uint32_t empty_entry = hosts_.size();
+  table_.assign(table_size_, empty_entry);
+  uint64_t filled = 0;
+  for (uint64_t iteration = 0; filled < table_size_; iteration++) {
+    for (uint32_t i = 0; i < build_entries.size() && filled < table_size_; i++) {
+      TableBuildEntry& entry = build_entries[i];
+      // A host of the largest weight claims an entry in every iteration, a host of half that
+      // weight in every other iteration, and so on.
+      if (entry.claimed_ * max_weight > iteration * entry.weight_) {
+        continue;
+      }
+
+      uint64_t position = (entry.offset_ + entry.skip_ * entry.next_) % table_size_;
+      while (table_[position] != empty_entry) {
+        entry.next_++;
+        position = (entry.offset_ + entry.skip_ * entry.next_) % table_size_;
+      }
+      table_[position] = i;
+      entry.next_++;
+      entry.claimed_++;
+      filled++;
+    }
+  }
+
+  ENVOY_LOG(debug, "maglev: table_size={} hosts={}", table_size_, hosts_.size());
+}
+
+HostConstSharedPtr MaglevTable::chooseHost(uint64_t hash) const {
+  if (table_.empty()) {
+    return nullptr;
+  }
+
+  return hosts_[table_[hash % table_size_]];
+}
+
+MaglevLoadBalancer::MaglevLoadBalancer(PrioritySet& priority_set, ClusterStats& stats,
+                                       Runtime::Loader& runtime, Runtime::RandomGenerator& random,
+                                       uint64_t table_size)
+    : ThreadAwareLoadBalancerBase(priority_set, stats, runtime, random), table_size_(table_size) {}
+
+} // namespace Upstream
+} // namespace Envoy
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "envoy/runtime/runtime.h"
+#include "envoy/upstream/load_balancer.h"
+
+#include "common/common/logger.h"
+#include "common/upstream/thread_aware_lb_impl.h"
+
+namespace Envoy {
+namespace Upstream {
+
+/**
+ * Lookup table for Maglev consistent hashing, as described in "Maglev: A Fast and Reliable
+ * Software Network Load Balancer" (Eisenbud et al., NSDI 2016). Each host has its own
+ * permutation of the entries of a table of prime size, and hosts take turns claiming the next
+ * entry of their permutation that is still free until the table is full. A pick is then a single
+ * table lookup, and a change to the host set only moves a small fraction of the entries to a
+ * different host. Hosts claim entries in proportion to their weight.
+ */
+class MaglevTable : public ThreadAwareLoadBalancerBase::HashingLoadBalancer,
+                    Logger::Loggable<Logger::Id::upstream> {
+public:
+  /**
+   * @param table_size supplies the number of table entries. Must be prime, and should be much
+   *        larger than the number of hosts for the hosts to get an even share of the keys.
+   */
+  MaglevTable(const std::vector<HostSharedPtr>& hosts, uint64_t table_size);
+
+  // ThreadAwareLoadBalancerBase::HashingLoadBalancer
+  HostConstSharedPtr chooseHost(uint64_t hash) const override;
+
+  // The table size used unless configured otherwise. This is the paper's choice for small
+  // clusters, about 100 entries per host for up to 650 hosts.
+  static const uint64_t DEFAULT_TABLE_SIZE = 65537;
+
+private:
+  struct TableBuildEntry {
+    TableBuildEntry(uint64_t offset, uint64_t skip, uint32_t weight)
+        : offset_(offset), skip_(skip), weight_(weight) {}
+
+    const uint64_t offset_;
+    const uint64_t skip_;
+    const uint32_t weight_;
+    // Position in the host's permutation of the next entry to try.
+    uint64_t next_{};
+    uint64_t claimed_{};
+  };
+
+  const uint64_t table_size_;
+  std::vector<HostConstSharedPtr> hosts_;
+  // Index into hosts_ for each table entry. Indices rather than host pointers keep the table small.
+  std::vector<uint32_t> table_;
+};
+
+/**
+ * Thread aware load balancer that picks hosts from a MaglevTable. Like the ring hash load
+ * balancer, a table is kept for healthy hosts and is used unless we are in panic mode, in which
+ * case the table of all hosts is used.
+ */
+class MaglevLoadBalancer : public ThreadAwareLoadBalancerBase {
+public:
+  MaglevLoadBalancer(PrioritySet& priority_set, ClusterStats& stats, Runtime::Loader& runtime,
+                     Runtime::RandomGenerator& random,
+                     uint64_t table_size = MaglevTable::DEFAULT_TABLE_SIZE);
+
+private:
+  // ThreadAwareLoadBalancerBase
+  HashingLoadBalancerConstSharedPtr
+  createLoadBalancer(const std::vector<HostSharedPtr>& hosts) override {
+    return std::make_shared<MaglevTable>(hosts, table_size_);
+  }
+
+  const uint64_t table_size_;
+};
+
+} // namespace Upstream
+} // namespace Envoy
@@ -9,6 +9,7 @@
 #include "envoy/upstream/resource_manager.h"
 
 #include "common/common/assert.h"
+#include "common/runtime/key_registry.h"
 
 namespace Envoy {
 namespace Upstream {
@@ -41,7 +42,7 @@ public:
 private:
   struct ResourceImpl : public Resource {
     ResourceImpl(uint64_t max, Runtime::Loader& runtime, const std::string& runtime_key)
-        : max_(max), runtime_(runtime), runtime_key_(runtime_key) {}
+        : max_(max), runtime_(runtime), runtime_key_(Runtime::KeyRegistry::intern(runtime_key)) {}
     ~ResourceImpl() { ASSERT(current_ == 0); }
 
     // Upstream::Resource
@@ -56,7 +57,7 @@ private:
     const uint64_t max_;
     std::atomic<uint64_t> current_{};
     Runtime::Loader& runtime_;
-    const std::string runtime_key_;
+    const Runtime::Key runtime_key_;
   };
 
   ResourceImpl connections_;
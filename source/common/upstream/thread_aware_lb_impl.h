@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <shared_mutex>
+#include <vector>
+
+#include "envoy/runtime/runtime.h"
+#include "envoy/upstream/load_balancer.h"
+
+#include "common/upstream/load_balancer_impl.h"
+
+namespace Envoy {
+namespace Upstream {
+
+/**
+ * Base class for thread aware load balancers that pick a host by hashing, such as ring hash and
+ * Maglev. On every host set update, a hashing load balancer is built for each priority level on
+ * the main thread and shared with the per-thread load balancers, which only look it up.
+ */
+class ThreadAwareLoadBalancerBase : public LoadBalancerBase, public ThreadAwareLoadBalancer {
+public:
+  /**
+   * Immutable lookup structure that maps a hash to a host, built from one host vector.
+   */
+  class HashingLoadBalancer {
+  public:
+    virtual ~HashingLoadBalancer() {}
+
+    /**
+     * @return the host for a hash, or nullptr if the structure was built without hosts.
+     */
+    virtual HostConstSharedPtr chooseHost(uint64_t hash) const PURE;
+  };
+  typedef std::shared_ptr<const HashingLoadBalancer> HashingLoadBalancerConstSharedPtr;
+
+  // Upstream::ThreadAwareLoadBalancer
+  LoadBalancerFactorySharedPtr factory() override { return factory_; }
+  void initialize() override;
+
+protected:
+  ThreadAwareLoadBalancerBase(PrioritySet& priority_set, ClusterStats& stats,
+                              Runtime::Loader& runtime, Runtime::RandomGenerator& random)
+      : LoadBalancerBase(priority_set, stats, runtime, random),
+        factory_(new LoadBalancerFactoryImpl(stats, random)) {}
+
+private:
+  struct PerPriorityState {
+    HashingLoadBalancerConstSharedPtr current_lb_;
+    bool global_panic_{};
+  };
+  typedef std::unique_ptr<PerPriorityState> PerPriorityStatePtr;
+
+  struct LoadBalancerImpl : public LoadBalancer {
+    LoadBalancerImpl(ClusterStats& stats, Runtime::RandomGenerator& random)
+        : stats_(stats), random_(random) {}
+
+    // Upstream::LoadBalancer
+    HostConstSharedPtr chooseHost(LoadBalancerContext* context) override;
+
+    ClusterStats& stats_;
+    Runtime::RandomGenerator& random_;
+    std::shared_ptr<std::vector<PerPriorityStatePtr>> per_priority_state_;
+    std::shared_ptr<std::vector<uint32_t>> per_priority_load_;
+  };
+
+  struct LoadBalancerFactoryImpl : public LoadBalancerFactory {
+    LoadBalancerFactoryImpl(ClusterStats& stats, Runtime::RandomGenerator& random)
+        : stats_(stats), random_(random) {}
+
+    // Upstream::LoadBalancerFactory
+    LoadBalancerPtr create() override;
+
+    ClusterStats& stats_;
+    Runtime::RandomGenerator& random_;
+    std::shared_timed_mutex mutex_;
+    // TOOD(mattklein123): Added GUARDED_BY(mutex_) to to the following variables. OSX clang
+    // seems to not like them with shared mutexes so we need to ifdef them out on OSX. I don't
+    // have time to do this right now.
+    std::shared_ptr<std::vector<PerPriorityStatePtr>> per_priority_state_;
+    // This is split out of PerPriorityState so LoadBalancerBase::ChoosePriorirty can be reused.
+    std::shared_ptr<std::vector<uint32_t>> per_priority_load_;
+  };
+
+  /**
+   * Build the lookup structure for a host vector. Called on the main thread.
+   */
+  virtual HashingLoadBalancerConstSharedPtr
+  createLoadBalancer(const std::vector<HostSharedPtr>& hosts) PURE;
+
+  void refresh();
+
+  std::shared_ptr<LoadBalancerFactoryImpl> factory_;
+};
+
+} // namespace Upstream
+} // namespace Envoy
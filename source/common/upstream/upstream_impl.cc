@@ -5,6 +5,7 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -108,7 +109,8 @@ ClusterInfoImpl::ClusterInfoImpl(const envoy::api::v2::Cluster& config,
       features_(parseFeatures(config)),
       http2_settings_(Http::Utility::parseHttp2Settings(config.http2_protocol_options())),
       resource_managers_(config, runtime, name_),
-      maintenance_mode_runtime_key_(fmt::format("upstream.maintenance_mode.{}", name_)),
+      maintenance_mode_runtime_key_(
+          Runtime::KeyRegistry::intern(fmt::format("upstream.maintenance_mode.{}", name_))),
       source_address_(getSourceAddress(config, source_address)),
       lb_ring_hash_config_(envoy::api::v2::Cluster::RingHashLbConfig(config.ring_hash_lb_config())),
       ssl_context_manager_(ssl_context_manager), added_via_api_(added_via_api),
@@ -142,7 +144,11 @@ ClusterInfoImpl::ClusterInfoImpl(const envoy::api::v2::Cluster& config,
     lb_type_ = LoadBalancerType::Random;
     break;
   case envoy::api::v2::Cluster::RING_HASH:
-    lb_type_ = LoadBalancerType::RingHash;
+    // The API has no Maglev lb_policy yet, so ring hash clusters opt into the Maglev LB, which
+    // hashes the same keys, through runtime. The key is only read when the cluster is created.
+    lb_type_ = runtime.snapshot().getInteger(fmt::format("upstream.use_maglev.{}", name_), 0) != 0
+                   ? LoadBalancerType::Maglev
+                   : LoadBalancerType::RingHash;
     break;
   case envoy::api::v2::Cluster::ORIGINAL_DST_LB:
     if (config.type() != envoy::api::v2::Cluster::ORIGINAL_DST) {
@@ -505,43 +511,48 @@ bool BaseDynamicClusterImpl::updateDynamicHostList(const std::vector<HostSharedP
                                                    std::vector<HostSharedPtr>& hosts_removed,
                                                    bool depend_on_hc) {
   uint64_t max_host_weight = 1;
+  // Weight changes of existing hosts also raise a change notification, so that load balancers
+  // which precompute per host weight state can rebuild it.
+  bool weight_changed = false;
 
   // Go through and see if the list we have is different from what we just got. If it is, we
-  // make a new host list and raise a change notification. This uses an N^2 search given that
-  // this does not happen very often and the list sizes should be small. We also check for
-  // duplicates here. It's possible for DNS to return the same address multiple times, and a bad
-  // SDS implementation could do the same thing.
+  // make a new host list and raise a change notification. The current hosts are indexed by address
+  // so that this is linear in the number of hosts, as EDS clusters can have many thousands of hosts
+  // and change often. We also check for duplicates here. It's possible for DNS to return the same
+  // address multiple times, and a bad SDS implementation could do the same thing.
+  std::unordered_map<std::string, size_t> current_host_indices;
+  current_host_indices.reserve(current_hosts.size());
+  for (size_t i = 0; i < current_hosts.size(); i++) {
+    current_host_indices.emplace(current_hosts[i]->address()->asString(), i);
+  }
+
   std::unordered_set<std::string> host_addresses;
+  host_addresses.reserve(new_hosts.size());
+  std::vector<bool> current_host_kept(current_hosts.size());
   std::vector<HostSharedPtr> final_hosts;
+  final_hosts.reserve(new_hosts.size());
   for (const HostSharedPtr& host : new_hosts) {
-    if (host_addresses.count(host->address()->asString())) {
+    const std::string& address = host->address()->asString();
+    if (!host_addresses.emplace(address).second) {
       continue;
     }
-    host_addresses.emplace(host->address()->asString());
 
-    bool found = false;
-    for (auto i = current_hosts.begin(); i != current_hosts.end();) {
-      // If we find a host matched based on address, we keep it. However we do change weight inline
-      // so do that here.
-      if (*(*i)->address() == *host->address()) {
-        if (host->weight() > max_host_weight) {
-          max_host_weight = host->weight();
-        }
-
-        (*i)->weight(host->weight());
-        final_hosts.push_back(*i);
-        i = current_hosts.erase(i);
-        found = true;
-      } else {
-        i++;
-      }
+    if (host->weight() > max_host_weight) {
+      max_host_weight = host->weight();
     }
 
-    if (!found) {
-      if (host->weight() > max_host_weight) {
-        max_host_weight = host->weight();
+    auto current_host_index = current_host_indices.find(address);
+    if (current_host_index != current_host_indices.end()) {
+      // If we find a host matched based on address, we keep it. However we do change weight inline
+      // so do that here.
+      const HostSharedPtr& current_host = current_hosts[current_host_index->second];
+      if (current_host->weight() != host->weight()) {
+        current_host->weight(host->weight());
+        weight_changed = true;
       }
-
+      final_hosts.push_back(current_host);
+      current_host_kept[current_host_index->second] = true;
+    } else {
       final_hosts.push_back(host);
       hosts_added.push_back(host);
 
@@ -553,33 +564,32 @@ bool BaseDynamicClusterImpl::updateDynamicHostList(const std::vector<HostSharedP
   }
 
   // If there are removed hosts, check to see if we should only delete if unhealthy.
-  if (!current_hosts.empty() && depend_on_hc) {
-    for (auto i = current_hosts.begin(); i != current_hosts.end();) {
-      if (!(*i)->healthFlagGet(Host::HealthFlag::FAILED_ACTIVE_HC)) {
-        if ((*i)->weight() > max_host_weight) {
-          max_host_weight = (*i)->weight();
-        }
+  std::vector<HostSharedPtr> removed_hosts;
+  for (size_t i = 0; i < current_hosts.size(); i++) {
+    if (current_host_kept[i]) {
+      continue;
+    }
 
-        final_hosts.push_back(*i);
-        i = current_hosts.erase(i);
-      } else {
-        i++;
+    const HostSharedPtr& current_host = current_hosts[i];
+    if (depend_on_hc && !current_host->healthFlagGet(Host::HealthFlag::FAILED_ACTIVE_HC)) {
+      if (current_host->weight() > max_host_weight) {
+        max_host_weight = current_host->weight();
       }
+
+      final_hosts.push_back(current_host);
+    } else {
+      removed_hosts.push_back(current_host);
     }
   }
 
   info_->stats().max_host_weight_.set(max_host_weight);
 
-  if (!hosts_added.empty() || !current_hosts.empty()) {
-    hosts_removed = std::move(current_hosts);
-    current_hosts = std::move(final_hosts);
-    return true;
-  } else {
-    // During the search we moved all of the hosts from hosts_ into final_hosts so just
-    // move them back.
-    current_hosts = std::move(final_hosts);
-    return false;
-  }
+  // The kept hosts are in the order of the new list, so the current list is replaced even if
+  // nothing changed.
+  const bool changed = !hosts_added.empty() || !removed_hosts.empty() || weight_changed;
+  hosts_removed = std::move(removed_hosts);
+  current_hosts = std::move(final_hosts);
+  return changed;
 }
 
 StrictDnsClusterImpl::StrictDnsClusterImpl(const envoy::api::v2::Cluster& cluster,
@@ -28,6 +28,7 @@
 #include "common/common/logger.h"
 #include "common/config/metadata.h"
 #include "common/config/well_known_names.h"
+#include "common/runtime/key_registry.h"
 #include "common/stats/stats_impl.h"
 #include "common/upstream/load_balancer_impl.h"
 #include "common/upstream/outlier_detection_impl.h"
@@ -213,6 +214,12 @@ public:
   const std::vector<std::vector<HostSharedPtr>>& healthyHostsPerLocality() const override {
     return *healthy_hosts_per_locality_;
   }
+  HostVectorConstSharedPtr hostsPtr() const override { return hosts_; }
+  HostVectorConstSharedPtr healthyHostsPtr() const override { return healthy_hosts_; }
+  HostListsConstSharedPtr hostsPerLocalityPtr() const override { return hosts_per_locality_; }
+  HostListsConstSharedPtr healthyHostsPerLocalityPtr() const override {
+    return healthy_hosts_per_locality_;
+  }
   uint32_t priority() const override { return priority_; }
 
 protected:
@@ -348,7 +355,7 @@ private:
   const uint64_t features_;
   const Http::Http2Settings http2_settings_;
   mutable ResourceManagers resource_managers_;
-  const std::string maintenance_mode_runtime_key_;
+  const Runtime::Key maintenance_mode_runtime_key_;
   const Network::Address::InstanceConstSharedPtr source_address_;
   LoadBalancerType lb_type_;
   Optional<envoy::api::v2::Cluster::RingHashLbConfig> lb_ring_hash_config_;
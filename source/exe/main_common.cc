@@ -55,13 +55,12 @@ int main_common(OptionsImpl& options) {
   }
 
   Thread::BasicLockable& log_lock = restarter->logLock();
-  Thread::BasicLockable& access_log_lock = restarter->accessLogLock();
   Stats::RawStatDataAllocator& stats_allocator = *restarter;
 #else
   std::unique_ptr<Server::HotRestartNopImpl> restarter;
   restarter.reset(new Server::HotRestartNopImpl());
 
-  Thread::MutexBasicLockable log_lock, access_log_lock;
+  Thread::MutexBasicLockable log_lock;
   Stats::HeapRawStatDataAllocator stats_allocator;
 #endif
 
@@ -85,7 +84,7 @@ int main_common(OptionsImpl& options) {
   Stats::ThreadLocalStoreImpl stats_store(stats_allocator);
   try {
     Server::InstanceImpl server(options, local_address, default_test_hooks, *restarter, stats_store,
-                                access_log_lock, component_factory, tls);
+                                component_factory, tls);
     server.run();
   } catch (const EnvoyException& e) {
     ares_library_cleanup();
@@ -41,6 +41,35 @@ std::string FileAccessLogFactory::name() const { return Config::AccessLogNames::
  */
 static Registry::RegisterFactory<FileAccessLogFactory, AccessLogInstanceFactory> register_;
 
+AccessLog::InstanceSharedPtr BinaryFileAccessLogFactory::createAccessLogInstance(
+    const Protobuf::Message& config, AccessLog::FilterPtr&& filter, FactoryContext& context) {
+  const auto& fal_config =
+      MessageUtil::downcastAndValidate<const envoy::api::v2::filter::accesslog::FileAccessLog&>(
+          config);
+  AccessLog::FormatterPtr formatter;
+  if (fal_config.format().empty()) {
+    formatter = AccessLog::AccessLogFormatUtils::defaultBinaryAccessLogFormatter();
+  } else {
+    formatter.reset(new AccessLog::BinaryFormatterImpl(fal_config.format()));
+  }
+  return AccessLog::InstanceSharedPtr{new AccessLog::FileAccessLog(
+      fal_config.path(), std::move(filter), std::move(formatter), context.accessLogManager())};
+}
+
+ProtobufTypes::MessagePtr BinaryFileAccessLogFactory::createEmptyConfigProto() {
+  return ProtobufTypes::MessagePtr{new envoy::api::v2::filter::accesslog::FileAccessLog()};
+}
+
+std::string BinaryFileAccessLogFactory::name() const {
+  return Config::AccessLogNames::get().BINARY_FILE;
+}
+
+/**
+ * Static registration for the binary file access log. @see RegisterFactory.
+ */
+static Registry::RegisterFactory<BinaryFileAccessLogFactory, AccessLogInstanceFactory>
+    register_binary_;
+
 } // namespace Configuration
 } // namespace Server
 } // namespace Envoy
@@ -22,6 +22,21 @@ public:
   std::string name() const override;
 };
 
+/**
+ * Config registration for the binary file access log, which takes the same config as the file
+ * access log but writes each line as a binary record. @see AccessLog::BinaryFormatterImpl.
+ */
+class BinaryFileAccessLogFactory : public AccessLogInstanceFactory {
+public:
+  AccessLog::InstanceSharedPtr createAccessLogInstance(const Protobuf::Message& config,
+                                                       AccessLog::FilterPtr&& filter,
+                                                       FactoryContext& context) override;
+
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override;
+
+  std::string name() const override;
+};
+
 } // namespace Configuration
 } // namespace Server
 } // namespace Envoy
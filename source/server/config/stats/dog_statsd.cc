@@ -22,8 +22,11 @@ Stats::SinkPtr DogStatsdSinkFactory::createStatsSink(const Protobuf::Message& co
   Network::Address::InstanceConstSharedPtr address =
       Network::Address::resolveProtoAddress(sink_config.address());
   ENVOY_LOG(debug, "dog_statsd UDP ip address: {}", address->asString());
-  return Stats::SinkPtr(
-      new Stats::Statsd::UdpStatsdSink(server.threadLocal(), std::move(address), true));
+  // 0 sends one datagram per metric.
+  const uint64_t max_bytes_per_datagram =
+      server.runtime().snapshot().getInteger("stats.dog_statsd.max_bytes_per_datagram", 0);
+  return Stats::SinkPtr(new Stats::Statsd::UdpStatsdSink(
+      server.threadLocal(), std::move(address), true, server.stats(), max_bytes_per_datagram));
 }
 
 ProtobufTypes::MessagePtr DogStatsdSinkFactory::createEmptyConfigProto() {
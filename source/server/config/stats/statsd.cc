@@ -25,8 +25,11 @@ Stats::SinkPtr StatsdSinkFactory::createStatsSink(const Protobuf::Message& confi
     Network::Address::InstanceConstSharedPtr address =
         Network::Address::resolveProtoAddress(statsd_sink.address());
     ENVOY_LOG(debug, "statsd UDP ip address: {}", address->asString());
-    return Stats::SinkPtr(
-        new Stats::Statsd::UdpStatsdSink(server.threadLocal(), std::move(address), false));
+    // 0 sends one datagram per metric.
+    const uint64_t max_bytes_per_datagram =
+        server.runtime().snapshot().getInteger("stats.statsd.max_bytes_per_datagram", 0);
+    return Stats::SinkPtr(new Stats::Statsd::UdpStatsdSink(
+        server.threadLocal(), std::move(address), false, server.stats(), max_bytes_per_datagram));
     break;
   }
   case envoy::api::v2::StatsdSink::kTcpClusterName:
@@ -17,12 +17,10 @@ namespace Server {
 
 bool validateConfig(Options& options, Network::Address::InstanceConstSharedPtr local_address,
                     ComponentFactory& component_factory) {
-  Thread::MutexBasicLockable access_log_lock;
   Stats::IsolatedStoreImpl stats_store;
 
   try {
-    ValidationInstance server(options, local_address, stats_store, access_log_lock,
-                              component_factory);
+    ValidationInstance server(options, local_address, stats_store, component_factory);
     std::cout << "configuration '" << options.configPath() << "' OK" << std::endl;
     server.shutdown();
     return true;
@@ -34,12 +32,11 @@ bool validateConfig(Options& options, Network::Address::InstanceConstSharedPtr l
 ValidationInstance::ValidationInstance(Options& options,
                                        Network::Address::InstanceConstSharedPtr local_address,
                                        Stats::IsolatedStoreImpl& store,
-                                       Thread::BasicLockable& access_log_lock,
                                        ComponentFactory& component_factory)
     : options_(options), stats_store_(store),
       api_(new Api::ValidationImpl(options.fileFlushIntervalMsec())),
       dispatcher_(api_->allocateDispatcher()), singleton_manager_(new Singleton::ManagerImpl()),
-      access_log_manager_(*api_, *dispatcher_, access_log_lock, store),
+      access_log_manager_(*api_, *dispatcher_, store),
       listener_manager_(*this, *this, *this) {
   try {
     initialize(options, local_address, component_factory);
@@ -52,8 +52,7 @@ class ValidationInstance : Logger::Loggable<Logger::Id::main>,
                            public WorkerFactory {
 public:
   ValidationInstance(Options& options, Network::Address::InstanceConstSharedPtr local_address,
-                     Stats::IsolatedStoreImpl& store, Thread::BasicLockable& access_log_lock,
-                     ComponentFactory& component_factory);
+                     Stats::IsolatedStoreImpl& store, ComponentFactory& component_factory);
 
   // Server::Instance
   Admin& admin() override { return admin_; }
@@ -100,6 +99,10 @@ public:
     // validation mock.
     return nullptr;
   }
+  Network::ListenSocketSharedPtr
+  createReusePortListenSocket(Network::Address::InstanceConstSharedPtr, uint32_t) override {
+    return nullptr;
+  }
   DrainManagerPtr createDrainManager(envoy::api::v2::Listener::DrainType) override {
     return nullptr;
   }
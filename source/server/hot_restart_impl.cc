@@ -25,7 +25,7 @@ namespace Server {
 
 // Increment this whenever there is a shared memory / RPC change that will prevent a hot restart
 // from working. Operations code can then cope with this and do a full restart.
-const uint64_t SharedMemory::VERSION = 9;
+const uint64_t SharedMemory::VERSION = 11;
 
 static SharedMemoryHashSetOptions sharedMemHashOptions(uint64_t max_stats) {
   SharedMemoryHashSetOptions hash_set_options;
@@ -117,8 +117,7 @@ std::string SharedMemory::version(size_t max_num_stats, size_t max_stat_name_len
 HotRestartImpl::HotRestartImpl(Options& options)
     : options_(options), stats_set_options_(sharedMemHashOptions(options.maxStats())),
       shmem_(SharedMemory::initialize(RawStatDataSet::numBytes(stats_set_options_), options)),
-      log_lock_(shmem_.log_lock_), access_log_lock_(shmem_.access_log_lock_),
-      stat_lock_(shmem_.stat_lock_), init_lock_(shmem_.init_lock_) {
+      log_lock_(shmem_.log_lock_), stat_lock_(shmem_.stat_lock_), init_lock_(shmem_.init_lock_) {
   {
     // We must hold the stat lock when attaching to an existing shared-memory segment
     // because it might be actively written to while we sanityCheck it.
@@ -221,7 +220,8 @@ void HotRestartImpl::drainParentListeners() {
   shmem_.flags_ &= ~SharedMemory::Flags::INITIALIZING;
 }
 
-int HotRestartImpl::duplicateParentListenSocket(const std::string& address) {
+int HotRestartImpl::duplicateParentListenSocket(const std::string& address,
+                                                uint32_t worker_index) {
   if (options_.restartEpoch() == 0 || parent_terminated_) {
     return -1;
   }
@@ -229,6 +229,7 @@ int HotRestartImpl::duplicateParentListenSocket(const std::string& address) {
   RpcGetListenSocketRequest rpc;
   ASSERT(address.length() < sizeof(rpc.address_));
   StringUtil::strlcpy(rpc.address_, address.c_str(), sizeof(rpc.address_));
+  rpc.worker_index_ = worker_index;
   sendMessage(parent_address_, rpc);
   RpcGetListenSocketReply* reply =
       receiveTypedRpc<RpcGetListenSocketReply, RpcMessageType::GetListenSocketReply>();
@@ -363,7 +364,11 @@ void HotRestartImpl::onGetListenSocket(RpcGetListenSocketRequest& rpc) {
       Network::Utility::resolveUrl(std::string(rpc.address_));
   for (const auto& listener : server_->listenerManager().listeners()) {
     if (*listener.get().socket().localAddress() == *addr) {
-      reply.fd_ = listener.get().socket().fd();
+      // Only listeners with a socket per worker have sockets for workers other than the first.
+      Network::ListenSocket& socket = listener.get().workerSocket(rpc.worker_index_);
+      if (rpc.worker_index_ == 0 || &socket != &listener.get().socket()) {
+        reply.fd_ = socket.fd();
+      }
       break;
     }
   }
@@ -61,6 +61,9 @@ private:
   uint64_t entry_size_;
   std::atomic<uint64_t> flags_;
   pthread_mutex_t log_lock_;
+  // No longer used, since access logs lock the file itself while flushing. Kept so that the
+  // shared memory layout does not change. A parent that still takes this lock does not exclude a
+  // child that flocks the file, so the change of lock needed a hot restart version bump anyway.
   pthread_mutex_t access_log_lock_;
   pthread_mutex_t stat_lock_;
   pthread_mutex_t init_lock_;
@@ -121,11 +124,10 @@ public:
   HotRestartImpl(Options& options);
 
   Thread::BasicLockable& logLock() { return log_lock_; }
-  Thread::BasicLockable& accessLogLock() { return access_log_lock_; }
 
   // Server::HotRestart
   void drainParentListeners() override;
-  int duplicateParentListenSocket(const std::string& address) override;
+  int duplicateParentListenSocket(const std::string& address, uint32_t worker_index) override;
   void getParentStats(GetParentStatsInfo& info) override;
   void initialize(Event::Dispatcher& dispatcher, Server::Instance& server) override;
   void shutdownParentAdmin(ShutdownParentAdminInfo& info) override;
@@ -168,6 +170,7 @@ private:
     RpcGetListenSocketRequest() : RpcBase(RpcMessageType::GetListenSocketRequest, sizeof(*this)) {}
 
     char address_[256]{0};
+    uint32_t worker_index_{0};
   } __attribute__((packed));
 
   struct RpcGetListenSocketReply : public RpcBase {
@@ -212,7 +215,6 @@ private:
   SharedMemory& shmem_;
   std::unique_ptr<RawStatDataSet> stats_set_;
   ProcessSharedMutex log_lock_;
-  ProcessSharedMutex access_log_lock_;
   ProcessSharedMutex stat_lock_;
   ProcessSharedMutex init_lock_;
   int my_domain_socket_{-1};
@@ -368,8 +368,8 @@ Http::Code AdminImpl::handlerServerInfo(const std::string&, Http::HeaderMap&,
 
 Http::Code AdminImpl::handlerStats(const std::string& url, Http::HeaderMap& response_headers,
                                    Buffer::Instance& response) {
-  // We currently don't support timers locally (only via statsd) so just group all the counters
-  // and gauges together, alpha sort them, and spit them out.
+  // Group all the counters and gauges together, alpha sort them, and spit them out. Histograms
+  // follow, summarized by their quantiles as of the last stats flush.
   Http::Code rc = Http::Code::OK;
   const Http::Utility::QueryParams params = Http::Utility::parseQueryString(url);
   std::map<std::string, uint64_t> all_stats;
@@ -386,6 +386,16 @@ Http::Code AdminImpl::handlerStats(const std::string& url, Http::HeaderMap& resp
     for (auto stat : all_stats) {
       response.add(fmt::format("{}: {}\n", stat.first, stat.second));
     }
+
+    std::map<std::string, std::string> all_histograms;
+    for (const Stats::ParentHistogramSharedPtr& histogram : server_.stats().histograms()) {
+      if (histogram->used()) {
+        all_histograms.emplace(histogram->name(), histogramSummary(*histogram));
+      }
+    }
+    for (auto histogram : all_histograms) {
+      response.add(fmt::format("{}: {}\n", histogram.first, histogram.second));
+    }
   } else {
     const std::string format_key = params.begin()->first;
     const std::string format_value = params.begin()->second;
@@ -405,6 +415,18 @@ Http::Code AdminImpl::handlerStats(const std::string& url, Http::HeaderMap& resp
   return rc;
 }
 
+std::string AdminImpl::histogramSummary(const Stats::ParentHistogram& histogram) {
+  const Stats::HistogramStatistics& interval = histogram.intervalStatistics();
+  const Stats::HistogramStatistics& cumulative = histogram.cumulativeStatistics();
+  std::vector<std::string> quantiles;
+  for (size_t i = 0; i < interval.supportedQuantiles().size(); i++) {
+    quantiles.push_back(fmt::format("P{:g}({:g},{:g})", 100 * interval.supportedQuantiles()[i],
+                                    interval.computedQuantiles()[i],
+                                    cumulative.computedQuantiles()[i]));
+  }
+  return StringUtil::join(quantiles, " ");
+}
+
 std::string PrometheusStatsFormatter::sanitizeName(const std::string& name) {
   std::string stats_name = name;
   std::replace(stats_name.begin(), stats_name.end(), '.', '_');
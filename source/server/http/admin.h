@@ -120,6 +120,10 @@ private:
                       const Upstream::Outlier::Detector* outlier_detector,
                       Buffer::Instance& response);
   static std::string statsAsJson(const std::map<std::string, uint64_t>& all_stats);
+  /**
+   * @return the quantiles of a histogram as "P50(interval,cumulative) P90(...)".
+   */
+  static std::string histogramSummary(const Stats::ParentHistogram& histogram);
   static std::string
   runtimeAsJson(const std::vector<std::pair<std::string, Runtime::Snapshot::Entry>>& entries);
   std::vector<const UrlHandler*> sortedHandlers() const;
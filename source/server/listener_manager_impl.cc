@@ -57,7 +57,7 @@ ProdListenerComponentFactory::createListenSocket(Network::Address::InstanceConst
   // TODO(mattklein123): UDS support.
   ASSERT(address->type() == Network::Address::Type::Ip);
   const std::string addr = fmt::format("tcp://{}", address->asString());
-  const int fd = server_.hotRestart().duplicateParentListenSocket(addr);
+  const int fd = server_.hotRestart().duplicateParentListenSocket(addr, 0);
   if (fd != -1) {
     ENVOY_LOG(debug, "obtained socket for address {} from parent", addr);
     return std::make_shared<Network::TcpListenSocket>(fd, address);
@@ -66,6 +66,21 @@ ProdListenerComponentFactory::createListenSocket(Network::Address::InstanceConst
   }
 }
 
+Network::ListenSocketSharedPtr ProdListenerComponentFactory::createReusePortListenSocket(
+    Network::Address::InstanceConstSharedPtr address, uint32_t worker_index) {
+  ASSERT(address->type() == Network::Address::Type::Ip);
+  // Taking over all of the parent's sockets keeps its SO_REUSEPORT group intact. Connections that
+  // the kernel has already queued on a socket would otherwise be reset when the parent exits.
+  const std::string addr = fmt::format("tcp://{}", address->asString());
+  const int fd = server_.hotRestart().duplicateParentListenSocket(addr, worker_index);
+  if (fd != -1) {
+    ENVOY_LOG(debug, "obtained socket for address {} worker {} from parent", addr, worker_index);
+    return std::make_shared<Network::TcpListenSocket>(fd, address);
+  } else {
+    return std::make_shared<Network::TcpListenSocket>(address, true, true);
+  }
+}
+
 DrainManagerPtr
 ProdListenerComponentFactory::createDrainManager(envoy::api::v2::Listener::DrainType drain_type) {
   return DrainManagerPtr{new DrainManagerImpl(server_, drain_type)};
@@ -84,6 +99,8 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, ListenerManag
       listener_scope_(
           parent_.server_.stats().createScope(fmt::format("listener.{}.", address_->asString()))),
       bind_to_port_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.deprecated_v1(), bind_to_port, true)),
+      reuse_port_(bind_to_port_ &&
+                  parent_.server_.runtime().snapshot().featureEnabled("listener.reuse_port", 0)),
       use_proxy_proto_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.filter_chains()[0], use_proxy_proto, false)),
       use_original_dst_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, use_original_dst, false)),
@@ -187,9 +204,28 @@ Init::Manager& ListenerImpl::initManager() {
   }
 }
 
-void ListenerImpl::setSocket(const Network::ListenSocketSharedPtr& socket) {
+void ListenerImpl::createSockets(uint32_t num_workers) {
   ASSERT(!socket_);
-  socket_ = socket;
+  if (!reuse_port_) {
+    socket_ = parent_.factory_.createListenSocket(address_, bind_to_port_);
+    return;
+  }
+
+  socket_ = parent_.factory_.createReusePortListenSocket(address_, 0);
+  worker_sockets_.push_back(socket_);
+  // If the configured port is 0, the other workers must bind to the port worker 0's socket got.
+  // Config validation creates no sockets.
+  const Network::Address::InstanceConstSharedPtr address =
+      socket_ ? socket_->localAddress() : address_;
+  for (uint32_t i = 1; i < num_workers; i++) {
+    worker_sockets_.push_back(parent_.factory_.createReusePortListenSocket(address, i));
+  }
+}
+
+void ListenerImpl::shareSockets(const ListenerImpl& other) {
+  ASSERT(!socket_);
+  socket_ = other.socket_;
+  worker_sockets_ = other.worker_sockets_;
 }
 
 ListenerManagerImpl::ListenerManagerImpl(Instance& server,
@@ -255,12 +291,12 @@ bool ListenerManagerImpl::addOrUpdateListener(const envoy::api::v2::Listener& co
     // In this case we can just replace inline.
     ASSERT(workers_started_);
     new_listener->debugLog("update warming listener");
-    new_listener->setSocket((*existing_warming_listener)->getSocket());
+    new_listener->shareSockets(**existing_warming_listener);
     *existing_warming_listener = std::move(new_listener);
   } else if (existing_active_listener != active_listeners_.end()) {
     // In this case we have no warming listener, so what we do depends on whether workers
     // have been started or not. Either way we get the socket from the existing listener.
-    new_listener->setSocket((*existing_active_listener)->getSocket());
+    new_listener->shareSockets(**existing_active_listener);
     if (workers_started_) {
       new_listener->debugLog("add warming listener");
       warming_listeners_.emplace_back(std::move(new_listener));
@@ -289,20 +325,16 @@ bool ListenerManagerImpl::addOrUpdateListener(const envoy::api::v2::Listener& co
     // to see if there is a listener that has a socket bound to the address we are configured for.
     // This is an edge case, but may happen if a listener is removed and then added back with a same
     // or different name and intended to listen on the same address. This should work and not fail.
-    Network::ListenSocketSharedPtr draining_listener_socket;
     auto existing_draining_listener = std::find_if(
         draining_listeners_.cbegin(), draining_listeners_.cend(),
         [&new_listener](const DrainingListener& listener) {
           return *new_listener->address() == *listener.listener_->socket().localAddress();
         });
     if (existing_draining_listener != draining_listeners_.cend()) {
-      draining_listener_socket = existing_draining_listener->listener_->getSocket();
+      new_listener->shareSockets(*existing_draining_listener->listener_);
+    } else {
+      new_listener->createSockets(workers_.size());
     }
-
-    new_listener->setSocket(
-        draining_listener_socket
-            ? draining_listener_socket
-            : factory_.createListenSocket(new_listener->address(), new_listener->bindToPort()));
     if (workers_started_) {
       new_listener->debugLog("add warming listener");
       warming_listeners_.emplace_back(std::move(new_listener));
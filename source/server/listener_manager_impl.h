@@ -39,6 +39,9 @@ public:
   }
   Network::ListenSocketSharedPtr
   createListenSocket(Network::Address::InstanceConstSharedPtr address, bool bind_to_port) override;
+  Network::ListenSocketSharedPtr
+  createReusePortListenSocket(Network::Address::InstanceConstSharedPtr address,
+                              uint32_t worker_index) override;
   DrainManagerPtr createDrainManager(envoy::api::v2::Listener::DrainType drain_type) override;
   uint64_t nextListenerTag() override { return next_listener_tag_++; }
 
@@ -190,15 +193,31 @@ public:
   }
 
   Network::Address::InstanceConstSharedPtr address() const { return address_; }
-  const Network::ListenSocketSharedPtr& getSocket() const { return socket_; }
   void debugLog(const std::string& message);
   void initialize();
   DrainManager& localDrainManager() const { return *local_drain_manager_; }
-  void setSocket(const Network::ListenSocketSharedPtr& socket);
+
+  /**
+   * Create the listener's sockets. If the listener.reuse_port runtime key is set, each worker gets
+   * its own SO_REUSEPORT socket, so that the kernel spreads new connections across workers rather
+   * than waking all of them for each connection on a single shared socket.
+   * @param num_workers supplies the number of workers.
+   */
+  void createSockets(uint32_t num_workers);
+
+  /**
+   * Share the sockets of another listener bound to the same address, whether or not that listener
+   * has a socket per worker.
+   * @param other supplies the listener to share the sockets of.
+   */
+  void shareSockets(const ListenerImpl& other);
 
   // Network::ListenerConfig
   Network::FilterChainFactory& filterChainFactory() override { return *this; }
   Network::ListenSocket& socket() override { return *socket_; }
+  Network::ListenSocket& workerSocket(uint32_t worker_index) override {
+    return worker_index < worker_sockets_.size() ? *worker_sockets_[worker_index] : *socket_;
+  }
   bool bindToPort() override { return bind_to_port_; }
   Ssl::ServerContext* defaultSslContext() override {
     return tls_contexts_.empty() ? nullptr : tls_contexts_[0].get();
@@ -242,10 +261,13 @@ private:
   ListenerManagerImpl& parent_;
   Network::Address::InstanceConstSharedPtr address_;
   Network::ListenSocketSharedPtr socket_;
+  // Empty unless the listener has a socket per worker, in which case socket_ is worker 0's.
+  std::vector<Network::ListenSocketSharedPtr> worker_sockets_;
   Stats::ScopePtr global_scope_;   // Stats with global named scope, but needed for LDS cleanup.
   Stats::ScopePtr listener_scope_; // Stats with listener named scope.
   std::vector<Ssl::ServerContextPtr> tls_contexts_;
   const bool bind_to_port_;
+  const bool reuse_port_;
   const bool use_proxy_proto_;
   const bool use_original_dst_;
   const uint32_t per_connection_buffer_limit_bytes_;
@@ -38,6 +38,8 @@ namespace Server {
   GAUGE(uptime)                                                                                    \
   GAUGE(memory_allocated)                                                                          \
   GAUGE(memory_heap_size)                                                                          \
+  GAUGE(memory_slab_allocations)                                                                   \
+  GAUGE(memory_slab_heap_allocations)                                                              \
   GAUGE(live)                                                                                      \
   GAUGE(parent_connections)                                                                        \
   GAUGE(total_connections)                                                                         \
@@ -79,13 +81,13 @@ public:
   static Runtime::LoaderPtr createRuntime(Instance& server, Server::Configuration::Initial& config);
 
   /**
-   * Helper for flushing counters and gauges to sinks. This takes care of calling beginFlush(),
-   * latching of counters and flushing, flushing of gauges, and calling endFlush(), on each sink.
+   * Helper for flushing counters, gauges and histograms to sinks. This takes care of calling
+   * beginFlush(), latching of counters and flushing, flushing of gauges, merging and flushing of
+   * histograms, and calling endFlush(), on each sink.
    * @param sinks supplies the list of sinks.
    * @param store supplies the store to flush.
    */
-  static void flushCountersAndGaugesToSinks(const std::list<Stats::SinkPtr>& sinks,
-                                            Stats::Store& store);
+  static void flushMetricsToSinks(const std::list<Stats::SinkPtr>& sinks, Stats::Store& store);
 
   /**
    * Load a bootstrap config from either v1 or v2 and perform validation.
@@ -124,8 +126,7 @@ public:
    */
   InstanceImpl(Options& options, Network::Address::InstanceConstSharedPtr local_address,
                TestHooks& hooks, HotRestart& restarter, Stats::StoreRoot& store,
-               Thread::BasicLockable& access_log_lock, ComponentFactory& component_factory,
-               ThreadLocal::Instance& tls);
+               ComponentFactory& component_factory, ThreadLocal::Instance& tls);
 
   ~InstanceImpl() override;
 
@@ -18,12 +18,15 @@ WorkerPtr ProdWorkerFactory::createWorker() {
   Event::DispatcherPtr dispatcher(api_.allocateDispatcher());
   return WorkerPtr{new WorkerImpl(
       tls_, hooks_, std::move(dispatcher),
-      Network::ConnectionHandlerPtr{new ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher)})};
+      Network::ConnectionHandlerPtr{new ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher)},
+      num_workers_++)};
 }
 
 WorkerImpl::WorkerImpl(ThreadLocal::Instance& tls, TestHooks& hooks,
-                       Event::DispatcherPtr&& dispatcher, Network::ConnectionHandlerPtr handler)
-    : tls_(tls), hooks_(hooks), dispatcher_(std::move(dispatcher)), handler_(std::move(handler)) {
+                       Event::DispatcherPtr&& dispatcher, Network::ConnectionHandlerPtr handler,
+                       uint32_t index)
+    : tls_(tls), hooks_(hooks), dispatcher_(std::move(dispatcher)), handler_(std::move(handler)),
+      index_(index) {
   tls_.registerThread(*dispatcher_, false);
 }
 
@@ -50,10 +53,10 @@ void WorkerImpl::addListenerWorker(Network::ListenerConfig& listener) {
                                                          listener.perConnectionBufferLimitBytes()};
   if (listener.defaultSslContext()) {
     handler_->addSslListener(listener.filterChainFactory(), *listener.defaultSslContext(),
-                             listener.socket(), listener.listenerScope(), listener.listenerTag(),
-                             listener_options);
+                             listener.workerSocket(index_), listener.listenerScope(),
+                             listener.listenerTag(), listener_options);
   } else {
-    handler_->addListener(listener.filterChainFactory(), listener.socket(),
+    handler_->addListener(listener.filterChainFactory(), listener.workerSocket(index_),
                           listener.listenerScope(), listener.listenerTag(), listener_options);
   }
 
@@ -30,6 +30,7 @@ private:
   ThreadLocal::Instance& tls_;
   Api::Api& api_;
   TestHooks& hooks_;
+  uint32_t num_workers_{};
 };
 
 /**
@@ -37,8 +38,12 @@ private:
  */
 class WorkerImpl : public Worker, Logger::Loggable<Logger::Id::main> {
 public:
+  /**
+   * @param index supplies the index of the worker, which selects its socket of listeners that
+   *        have a socket per worker.
+   */
   WorkerImpl(ThreadLocal::Instance& tls, TestHooks& hooks, Event::DispatcherPtr&& dispatcher,
-             Network::ConnectionHandlerPtr handler);
+             Network::ConnectionHandlerPtr handler, uint32_t index);
 
   // Server::Worker
   void addListener(Network::ListenerConfig& listener, AddListenerCompletion completion) override;
@@ -57,6 +62,7 @@ private:
   TestHooks& hooks_;
   Event::DispatcherPtr dispatcher_;
   Network::ConnectionHandlerPtr handler_;
+  const uint32_t index_;
   Thread::ThreadPtr thread_;
 };
 
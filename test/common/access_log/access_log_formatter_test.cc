@@ -258,6 +258,54 @@ TEST(AccessLogFormatterTest, CompositeFormatterSuccess) {
   }
 }
 
+TEST(AccessLogFormatterTest, CompositeFormatterAppends) {
+  RequestInfo::MockRequestInfo request_info;
+  Http::TestHeaderMapImpl request_header{{"first", "GET"}};
+  Http::TestHeaderMapImpl response_header;
+  FormatterImpl formatter("%REQ(FIRST)% %RESP(FIRST)%\n");
+
+  std::string output = "previous\n";
+  formatter.formatTo(request_header, response_header, request_info, output);
+  formatter.formatTo(request_header, response_header, request_info, output);
+  EXPECT_EQ("previous\nGET -\nGET -\n", output);
+}
+
+TEST(AccessLogFormatterTest, BinaryFormatter) {
+  NiceMock<RequestInfo::MockRequestInfo> request_info;
+  Http::TestHeaderMapImpl request_header{{"first", "GET"}, {"long", std::string(70000, 'a')}};
+  Http::TestHeaderMapImpl response_header{{"second", "PUT"}};
+
+  BinaryFormatterImpl formatter(
+      "[%REQ(FIRST)%] %RESP(SECOND)% %REQ(NONE)% %REQ(FIRST):1% %RESPONSE_CODE% %REQ(LONG)%\n");
+  EXPECT_EQ((std::vector<std::string>{"REQ(FIRST)", "RESP(SECOND)", "REQ(NONE)", "REQ(FIRST):1",
+                                      "RESPONSE_CODE", "REQ(LONG)"}),
+            formatter.fieldNames());
+
+  Optional<uint32_t> response_code{200};
+  EXPECT_CALL(request_info, responseCode()).WillRepeatedly(ReturnRef(response_code));
+
+  const std::string record = formatter.format(request_header, response_header, request_info);
+  EXPECT_EQ(4 + 6 * 2 + 3 + 3 + 1 + 1 + 3 + 65535, record.size());
+  EXPECT_EQ(std::string("\x03\x00GET", 5), record.substr(4, 5));
+
+  std::string log = record;
+  formatter.formatTo(request_header, Http::TestHeaderMapImpl{}, request_info, log);
+  const std::vector<std::vector<std::string>> decoded = BinaryFormatterImpl::decode(log);
+  ASSERT_EQ(2, decoded.size());
+  EXPECT_EQ((std::vector<std::string>{"GET", "PUT", "-", "G", "200", std::string(65535, 'a')}),
+            decoded[0]);
+  EXPECT_EQ((std::vector<std::string>{"GET", "-", "-", "G", "200", std::string(65535, 'a')}),
+            decoded[1]);
+
+  EXPECT_TRUE(BinaryFormatterImpl::decode("").empty());
+  EXPECT_THROW(BinaryFormatterImpl::decode(log.substr(0, 2)), EnvoyException);
+  EXPECT_THROW(BinaryFormatterImpl::decode(log.substr(0, record.size() - 1)), EnvoyException);
+  EXPECT_THROW(BinaryFormatterImpl::decode(std::string("\x01\x00\x00\x00\x00", 5)),
+               EnvoyException);
+  EXPECT_THROW(BinaryFormatterImpl::decode(std::string("\x02\x00\x00\x00\x01\x00", 6)),
+               EnvoyException);
+}
+
 TEST(AccessLogFormatterTest, ParserFailures) {
   AccessLogFormatParser parser;
 
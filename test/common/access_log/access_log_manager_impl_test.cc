@@ -20,15 +20,14 @@ namespace AccessLog {
 TEST(AccessLogManagerImpl, reopenAllFiles) {
   Api::MockApi api;
   Event::MockDispatcher dispatcher;
-  Thread::MutexBasicLockable lock;
   Stats::IsolatedStoreImpl stats_store;
 
   std::shared_ptr<Filesystem::MockFile> log1(new Filesystem::MockFile());
   std::shared_ptr<Filesystem::MockFile> log2(new Filesystem::MockFile());
-  AccessLogManagerImpl access_log_manager(api, dispatcher, lock, stats_store);
-  EXPECT_CALL(api, createFile("foo", _, _, _)).WillOnce(Return(log1));
+  AccessLogManagerImpl access_log_manager(api, dispatcher, stats_store);
+  EXPECT_CALL(api, createFile("foo", _, _)).WillOnce(Return(log1));
   access_log_manager.createAccessLog("foo");
-  EXPECT_CALL(api, createFile("bar", _, _, _)).WillOnce(Return(log2));
+  EXPECT_CALL(api, createFile("bar", _, _)).WillOnce(Return(log2));
   access_log_manager.createAccessLog("bar");
 
   // Make sure that getting the access log with the same name returns the same underlying file.
@@ -0,0 +1,85 @@
+#include <string>
+#include <vector>
+
+#include "common/common/regex_set.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+
+TEST(RegexSet, Empty) {
+  RegexSet set;
+  set.compile();
+  EXPECT_TRUE(set.empty());
+
+  std::vector<int> matches{1, 2};
+  EXPECT_TRUE(set.match("/foo", matches));
+  EXPECT_TRUE(matches.empty());
+}
+
+TEST(RegexSet, MatchesWholeInput) {
+  RegexSet set;
+  EXPECT_EQ(0, set.add("/foo/[0-9]+"));
+  EXPECT_EQ(1, set.add("/foo/.*"));
+  EXPECT_EQ(2, set.add("/bar"));
+  set.compile();
+  EXPECT_FALSE(set.empty());
+
+  std::vector<int> matches;
+  EXPECT_TRUE(set.match("/foo/123", matches));
+  EXPECT_EQ((std::vector<int>{0, 1}), matches);
+
+  // Matching nothing is not an error.
+  EXPECT_TRUE(set.match("/baz", matches));
+  EXPECT_TRUE(matches.empty());
+
+  set.match("/foo/abc", matches);
+  EXPECT_EQ((std::vector<int>{1}), matches);
+
+  set.match("/bar", matches);
+  EXPECT_EQ((std::vector<int>{2}), matches);
+
+  // Expressions are anchored at both ends.
+  set.match("/bar/", matches);
+  EXPECT_TRUE(matches.empty());
+  set.match("x/bar", matches);
+  EXPECT_TRUE(matches.empty());
+}
+
+TEST(RegexSet, RejectsUnsupportedExpressions) {
+  RegexSet set;
+  EXPECT_EQ(-1, set.add("/(a)\\1"));
+  EXPECT_EQ(-1, set.add("/foo(?=bar)"));
+  EXPECT_EQ(0, set.add("/baz"));
+  set.compile();
+
+  std::vector<int> matches;
+  set.match("/baz", matches);
+  EXPECT_EQ((std::vector<int>{0}), matches);
+}
+
+TEST(RegexSet, MatchesBytes) {
+  RegexSet set;
+  EXPECT_EQ(0, set.add("/.."));
+  set.compile();
+
+  // A two byte UTF-8 sequence counts as two characters, as it does for std::regex.
+  std::vector<int> matches;
+  set.match("/\xc3\xa9", matches);
+  EXPECT_EQ((std::vector<int>{0}), matches);
+}
+
+// The memory budget grows with the set, so large sets still compile and match.
+TEST(RegexSet, ManyExpressions) {
+  RegexSet set;
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_EQ(i, set.add(".*/" + std::to_string(i) + "/[a-z]+/.*"));
+  }
+  set.compile();
+
+  std::vector<int> matches;
+  EXPECT_TRUE(set.match("/x/17/abc/999/def/y", matches));
+  EXPECT_EQ((std::vector<int>{17, 999}), matches);
+}
+
+} // namespace Envoy
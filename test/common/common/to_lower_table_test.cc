@@ -1,3 +1,5 @@
+#include <string>
+
 #include "common/common/to_lower_table.h"
 
 #include "gtest/gtest.h"
@@ -27,4 +29,23 @@ TEST(ToLowerTableTest, All) {
     EXPECT_EQ(input, "\x90hello\x90");
   }
 }
+
+// Every byte value is converted at every position of strings both shorter and longer than the
+// 16 bytes that are converted at a time.
+TEST(ToLowerTableTest, AllBytesAllPositions) {
+  ToLowerTable table;
+
+  for (size_t length = 1; length < 40; length++) {
+    for (size_t c = 0; c < 256; c++) {
+      for (size_t position = 0; position < length; position++) {
+        std::string input(length, 'X');
+        input[position] = static_cast<char>(c);
+        table.toLowerCase(input);
+        std::string expected(length, 'x');
+        expected[position] = static_cast<char>((c >= 'A' && c <= 'Z') ? (c | 0x20) : c);
+        ASSERT_EQ(expected, input);
+      }
+    }
+  }
+}
 } // namespace Envoy
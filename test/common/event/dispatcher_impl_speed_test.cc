@@ -0,0 +1,130 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/common/thread.h"
+#include "common/event/dispatcher_impl.h"
+#include "common/event/libevent.h"
+#include "common/event/post_queue.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Event {
+
+static const uint32_t PostsPerThread = 10000;
+
+// Posts PostsPerThread callbacks from each of num_threads threads with post(), and waits until
+// all of them have run.
+static void postFromThreads(uint32_t num_threads,
+                            std::function<void(std::function<void()>)> post) {
+  std::mutex lock;
+  std::condition_variable done;
+  std::atomic<uint32_t> remaining{num_threads * PostsPerThread};
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < num_threads; i++) {
+    threads.emplace_back([&]() -> void {
+      for (uint32_t j = 0; j < PostsPerThread; j++) {
+        post([&]() -> void {
+          if (--remaining == 0) {
+            std::lock_guard<std::mutex> guard(lock);
+            done.notify_one();
+          }
+        });
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  std::unique_lock<std::mutex> guard(lock);
+  done.wait(guard, [&remaining]() -> bool { return remaining == 0; });
+}
+
+// Cross thread post throughput of a dispatcher running on its own thread.
+static void BM_DispatcherPost(benchmark::State& state) {
+  DispatcherImpl dispatcher;
+  Thread::Thread dispatcher_thread([&dispatcher]() -> void {
+    dispatcher.run(Dispatcher::RunType::Block);
+  });
+  while (state.KeepRunning()) {
+    postFromThreads(state.range(0), [&dispatcher](std::function<void()> callback) -> void {
+      dispatcher.post(callback);
+    });
+  }
+  dispatcher.exit();
+  dispatcher_thread.join();
+  state.SetItemsProcessed(state.iterations() * state.range(0) * PostsPerThread);
+}
+BENCHMARK(BM_DispatcherPost)->RangeMultiplier(2)->Range(1, 16)->UseRealTime();
+
+// The queues alone, drained by a spinning consumer thread, to separate the cost of the queue from
+// the cost of waking the event loop.
+static void BM_PostQueue(benchmark::State& state) {
+  PostQueue queue;
+  std::atomic<bool> stop{false};
+  std::thread consumer([&]() -> void {
+    while (!stop) {
+      queue.runAll();
+    }
+  });
+  while (state.KeepRunning()) {
+    postFromThreads(state.range(0),
+                    [&queue](std::function<void()> callback) -> void { queue.push(callback); });
+  }
+  stop = true;
+  consumer.join();
+  state.SetItemsProcessed(state.iterations() * state.range(0) * PostsPerThread);
+}
+BENCHMARK(BM_PostQueue)->RangeMultiplier(2)->Range(1, 16)->UseRealTime();
+
+// The mutex protected list that PostQueue replaces, for comparison.
+static void BM_MutexListQueue(benchmark::State& state) {
+  std::mutex lock;
+  std::list<std::function<void()>> callbacks;
+  std::atomic<bool> stop{false};
+  std::thread consumer([&]() -> void {
+    while (!stop) {
+      std::unique_lock<std::mutex> guard(lock);
+      while (!callbacks.empty()) {
+        std::function<void()> callback = callbacks.front();
+        callbacks.pop_front();
+        guard.unlock();
+        callback();
+        guard.lock();
+      }
+    }
+  });
+  while (state.KeepRunning()) {
+    postFromThreads(state.range(0), [&](std::function<void()> callback) -> void {
+      std::unique_lock<std::mutex> guard(lock);
+      callbacks.push_back(callback);
+    });
+  }
+  stop = true;
+  consumer.join();
+  state.SetItemsProcessed(state.iterations() * state.range(0) * PostsPerThread);
+}
+BENCHMARK(BM_MutexListQueue)->RangeMultiplier(2)->Range(1, 16)->UseRealTime();
+
+} // namespace Event
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  Envoy::Event::Libevent::Global::initialize();
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -1,6 +1,8 @@
 #include <condition_variable>
 #include <functional>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 #include "common/common/thread.h"
 #include "common/event/dispatcher_impl.h"
@@ -96,6 +98,38 @@ TEST_F(DispatcherImplTest, Post) {
   cv_.wait(lock, [this]() { return work_finished_; });
 }
 
+// Callbacks posted from several threads all run, each thread's in the order it posted them.
+TEST_F(DispatcherImplTest, PostFromManyThreads) {
+  const uint32_t num_threads = 4;
+  const uint32_t posts_per_thread = 1000;
+  std::vector<uint32_t> last_posted(num_threads);
+  uint32_t remaining = num_threads * posts_per_thread;
+  std::vector<std::thread> threads;
+  for (uint32_t thread = 0; thread < num_threads; thread++) {
+    threads.emplace_back([&, thread]() -> void {
+      for (uint32_t i = 1; i <= posts_per_thread; i++) {
+        dispatcher_->post([&, thread, i]() -> void {
+          EXPECT_EQ(i - 1, last_posted[thread]);
+          last_posted[thread] = i;
+          if (--remaining == 0) {
+            {
+              std::lock_guard<std::mutex> lock(mu_);
+              work_finished_ = true;
+            }
+            cv_.notify_one();
+          }
+        });
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  std::unique_lock<std::mutex> lock(mu_);
+  cv_.wait(lock, [this]() { return work_finished_; });
+}
+
 TEST_F(DispatcherImplTest, Timer) {
   TimerPtr timer;
   dispatcher_->post([this, &timer]() {
@@ -0,0 +1,103 @@
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "common/event/post_queue.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Event {
+
+TEST(PostQueueTest, RunInOrder) {
+  PostQueue queue;
+  std::vector<int> order;
+  EXPECT_EQ(0, queue.runAll());
+
+  EXPECT_TRUE(queue.push([&order]() -> void { order.push_back(1); }));
+  EXPECT_FALSE(queue.push([&order]() -> void { order.push_back(2); }));
+  EXPECT_FALSE(queue.push([&order]() -> void { order.push_back(3); }));
+  EXPECT_EQ(3, queue.runAll());
+  EXPECT_EQ((std::vector<int>{1, 2, 3}), order);
+
+  // The queue is empty again, so the next push must wake the consumer.
+  EXPECT_TRUE(queue.push([&order]() -> void { order.push_back(4); }));
+  EXPECT_EQ(1, queue.runAll());
+  EXPECT_EQ((std::vector<int>{1, 2, 3, 4}), order);
+}
+
+TEST(PostQueueTest, PushFromCallback) {
+  PostQueue queue;
+  bool inner_ran = false;
+  queue.push([&queue, &inner_ran]() -> void {
+    EXPECT_TRUE(queue.push([&inner_ran]() -> void { inner_ran = true; }));
+  });
+  EXPECT_EQ(1, queue.runAll());
+  EXPECT_FALSE(inner_ran);
+  EXPECT_EQ(1, queue.runAll());
+  EXPECT_TRUE(inner_ran);
+}
+
+TEST(PostQueueTest, DestroyWithPendingCallbacks) {
+  std::shared_ptr<int> value = std::make_shared<int>(0);
+  {
+    PostQueue queue;
+    queue.push([value]() -> void {});
+    EXPECT_EQ(2, value.use_count());
+  }
+  EXPECT_EQ(1, value.use_count());
+}
+
+TEST(PostQueueTest, ReleaseCallbacksThatRan) {
+  PostQueue queue;
+  std::shared_ptr<int> value = std::make_shared<int>(0);
+  queue.push([value]() -> void {});
+  EXPECT_EQ(1, queue.runAll());
+  // The node of the callback is kept for reuse, but the callback itself is gone.
+  EXPECT_EQ(1, value.use_count());
+
+  bool ran = false;
+  EXPECT_TRUE(queue.push([&ran]() -> void { ran = true; }));
+  EXPECT_EQ(1, queue.runAll());
+  EXPECT_TRUE(ran);
+}
+
+// Each producer's callbacks run in the order it pushed them, and none are lost or run twice.
+TEST(PostQueueTest, ConcurrentProducers) {
+  const uint32_t num_producers = 4;
+  const uint32_t callbacks_per_producer = 10000;
+  PostQueue queue;
+  std::vector<uint32_t> last_seen(num_producers);
+  std::atomic<uint32_t> wakeups{0};
+  std::vector<std::thread> producers;
+  for (uint32_t producer = 0; producer < num_producers; producer++) {
+    producers.emplace_back([&, producer]() -> void {
+      for (uint32_t i = 1; i <= callbacks_per_producer; i++) {
+        if (queue.push([&last_seen, producer, i]() -> void {
+              EXPECT_EQ(i - 1, last_seen[producer]);
+              last_seen[producer] = i;
+            })) {
+          wakeups++;
+        }
+      }
+    });
+  }
+
+  uint64_t run = 0;
+  while (run < num_producers * callbacks_per_producer) {
+    run += queue.runAll();
+  }
+  for (std::thread& producer : producers) {
+    producer.join();
+  }
+  EXPECT_EQ(0, queue.runAll());
+  EXPECT_GE(wakeups.load(), 1);
+  for (uint32_t producer = 0; producer < num_producers; producer++) {
+    EXPECT_EQ(callbacks_per_producer, last_seen[producer]);
+  }
+}
+
+} // namespace Event
+} // namespace Envoy
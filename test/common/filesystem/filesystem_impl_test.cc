@@ -1,3 +1,7 @@
+#include <sys/file.h>
+#include <sys/uio.h>
+
+#include <cerrno>
 #include <chrono>
 #include <string>
 
@@ -26,13 +30,24 @@ using testing::Throw;
 using testing::_;
 
 namespace Envoy {
+namespace {
+
+// Concatenates the buffers passed to writev().
+std::string iovecsToString(const iovec* iov, int num_iov) {
+  std::string result;
+  for (int i = 0; i < num_iov; i++) {
+    result.append(static_cast<const char*>(iov[i].iov_base), iov[i].iov_len);
+  }
+  return result;
+}
+
+} // namespace
 
 TEST(FileSystemImpl, BadFile) {
   Event::MockDispatcher dispatcher;
-  Thread::MutexBasicLockable lock;
   Stats::IsolatedStoreImpl store;
   EXPECT_CALL(dispatcher, createTimer_(_));
-  EXPECT_THROW(Filesystem::FileImpl("", dispatcher, lock, store, std::chrono::milliseconds(10000)),
+  EXPECT_THROW(Filesystem::FileImpl("", dispatcher, store, std::chrono::milliseconds(10000)),
                EnvoyException);
 }
 
@@ -81,22 +96,21 @@ TEST(FileSystemImpl, flushToLogFilePeriodically) {
   NiceMock<Event::MockDispatcher> dispatcher;
   NiceMock<Event::MockTimer>* timer = new NiceMock<Event::MockTimer>(&dispatcher);
 
-  Thread::MutexBasicLockable mutex;
   Stats::IsolatedStoreImpl stats_store;
   NiceMock<Api::MockOsSysCalls> os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
   EXPECT_CALL(os_sys_calls, open_(_, _, _)).WillOnce(Return(5));
-  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40));
+  Filesystem::FileImpl file("", dispatcher, stats_store, std::chrono::milliseconds(40));
 
   EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(40)));
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
+        std::string written = iovecsToString(iov, num_iov);
         EXPECT_EQ("test", written);
         EXPECT_EQ(5, fd);
 
-        return num_bytes;
+        return written.size();
       }));
 
   file.write("test");
@@ -108,13 +122,13 @@ TEST(FileSystemImpl, flushToLogFilePeriodically) {
     }
   }
 
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
+        std::string written = iovecsToString(iov, num_iov);
         EXPECT_EQ("test2", written);
         EXPECT_EQ(5, fd);
 
-        return num_bytes;
+        return written.size();
       }));
 
   // make sure timer is re-enabled on callback call
@@ -134,21 +148,22 @@ TEST(FileSystemImpl, flushToLogFileOnDemand) {
   NiceMock<Event::MockDispatcher> dispatcher;
   NiceMock<Event::MockTimer>* timer = new NiceMock<Event::MockTimer>(&dispatcher);
 
-  Thread::MutexBasicLockable mutex;
   Stats::IsolatedStoreImpl stats_store;
   NiceMock<Api::MockOsSysCalls> os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
   EXPECT_CALL(os_sys_calls, open_(_, _, _)).WillOnce(Return(5));
-  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40));
+  Filesystem::FileImpl file("", dispatcher, stats_store, std::chrono::milliseconds(40));
 
   EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(40)));
 
   // The first write to a given file will start the flush thread, which can flush
   // immediately (race on whether it will or not). So do a write and flush to
   // get that state out of the way, then test that small writes don't trigger a flush.
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int, const void*, size_t num_bytes) -> ssize_t { return num_bytes; }));
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillOnce(Invoke([](int, const iovec* iov, int num_iov) -> ssize_t {
+        return iovecsToString(iov, num_iov).size();
+      }));
   file.write("prime-it");
   file.flush();
   uint32_t expected_writes = 1;
@@ -157,13 +172,13 @@ TEST(FileSystemImpl, flushToLogFileOnDemand) {
     EXPECT_EQ(expected_writes, os_sys_calls.num_writes_);
   }
 
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
+        std::string written = iovecsToString(iov, num_iov);
         EXPECT_EQ("test", written);
         EXPECT_EQ(5, fd);
 
-        return num_bytes;
+        return written.size();
       }));
 
   file.write("test");
@@ -180,13 +195,13 @@ TEST(FileSystemImpl, flushToLogFileOnDemand) {
     EXPECT_EQ(expected_writes, os_sys_calls.num_writes_);
   }
 
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
+        std::string written = iovecsToString(iov, num_iov);
         EXPECT_EQ("test2", written);
         EXPECT_EQ(5, fd);
 
-        return num_bytes;
+        return written.size();
       }));
 
   // make sure timer is re-enabled on callback call
@@ -207,23 +222,22 @@ TEST(FileSystemImpl, reopenFile) {
   NiceMock<Event::MockDispatcher> dispatcher;
   NiceMock<Event::MockTimer>* timer = new NiceMock<Event::MockTimer>(&dispatcher);
 
-  Thread::MutexBasicLockable mutex;
   Stats::IsolatedStoreImpl stats_store;
   NiceMock<Api::MockOsSysCalls> os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
   Sequence sq;
   EXPECT_CALL(os_sys_calls, open_(_, _, _)).InSequence(sq).WillOnce(Return(5));
-  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40));
+  Filesystem::FileImpl file("", dispatcher, stats_store, std::chrono::milliseconds(40));
 
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
       .InSequence(sq)
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
+        std::string written = iovecsToString(iov, num_iov);
         EXPECT_EQ("before", written);
         EXPECT_EQ(5, fd);
 
-        return num_bytes;
+        return written.size();
       }));
 
   file.write("before");
@@ -239,14 +253,14 @@ TEST(FileSystemImpl, reopenFile) {
   EXPECT_CALL(os_sys_calls, close(5)).InSequence(sq);
   EXPECT_CALL(os_sys_calls, open_(_, _, _)).InSequence(sq).WillOnce(Return(10));
 
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
       .InSequence(sq)
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
+        std::string written = iovecsToString(iov, num_iov);
         EXPECT_EQ("reopened", written);
         EXPECT_EQ(10, fd);
 
-        return num_bytes;
+        return written.size();
       }));
 
   EXPECT_CALL(os_sys_calls, close(10)).InSequence(sq);
@@ -267,23 +281,21 @@ TEST(FilesystemImpl, reopenThrows) {
   NiceMock<Event::MockDispatcher> dispatcher;
   NiceMock<Event::MockTimer>* timer = new NiceMock<Event::MockTimer>(&dispatcher);
 
-  Thread::MutexBasicLockable mutex;
   Stats::IsolatedStoreImpl stats_store;
   NiceMock<Api::MockOsSysCalls> os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillRepeatedly(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillRepeatedly(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
         UNREFERENCED_PARAMETER(fd);
-        UNREFERENCED_PARAMETER(buffer);
 
-        return num_bytes;
+        return iovecsToString(iov, num_iov).size();
       }));
 
   Sequence sq;
   EXPECT_CALL(os_sys_calls, open_(_, _, _)).InSequence(sq).WillOnce(Return(5));
 
-  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40));
+  Filesystem::FileImpl file("", dispatcher, stats_store, std::chrono::milliseconds(40));
   EXPECT_CALL(os_sys_calls, close(5)).InSequence(sq);
   EXPECT_CALL(os_sys_calls, open_(_, _, _)).InSequence(sq).WillOnce(Return(-1));
 
@@ -314,22 +326,21 @@ TEST(FilesystemImpl, reopenThrows) {
 
 TEST(FilesystemImpl, bigDataChunkShouldBeFlushedWithoutTimer) {
   NiceMock<Event::MockDispatcher> dispatcher;
-  Thread::MutexBasicLockable mutex;
   Stats::IsolatedStoreImpl stats_store;
   NiceMock<Api::MockOsSysCalls> os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
-  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40));
+  Filesystem::FileImpl file("", dispatcher, stats_store, std::chrono::milliseconds(40));
 
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
         UNREFERENCED_PARAMETER(fd);
 
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
+        std::string written = iovecsToString(iov, num_iov);
         std::string expected("a");
         EXPECT_EQ(expected, written);
 
-        return num_bytes;
+        return written.size();
       }));
 
   file.write("a");
@@ -343,15 +354,15 @@ TEST(FilesystemImpl, bigDataChunkShouldBeFlushedWithoutTimer) {
 
   // First write happens without waiting on thread_flush_. Now make a big string and it should be
   // flushed even when timer is not enabled
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
         UNREFERENCED_PARAMETER(fd);
 
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
+        std::string written = iovecsToString(iov, num_iov);
         std::string expected(1024 * 64 + 1, 'b');
         EXPECT_EQ(expected, written);
 
-        return num_bytes;
+        return written.size();
       }));
 
   std::string big_string(1024 * 64 + 1, 'b');
@@ -364,4 +375,138 @@ TEST(FilesystemImpl, bigDataChunkShouldBeFlushedWithoutTimer) {
     }
   }
 }
+
+TEST(FilesystemImpl, writeLocksFile) {
+  NiceMock<Event::MockDispatcher> dispatcher;
+  Stats::IsolatedStoreImpl stats_store;
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+
+  EXPECT_CALL(os_sys_calls, open_(_, _, _)).WillOnce(Return(5));
+  Filesystem::FileImpl file("", dispatcher, stats_store, std::chrono::milliseconds(40));
+
+  InSequence s;
+  EXPECT_CALL(os_sys_calls, flock(5, LOCK_EX));
+  EXPECT_CALL(os_sys_calls, writev_(5, _, _))
+      .WillOnce(Invoke([](int, const iovec* iov, int num_iov) -> ssize_t {
+        std::string written = iovecsToString(iov, num_iov);
+        EXPECT_EQ("test", written);
+
+        return written.size();
+      }));
+  EXPECT_CALL(os_sys_calls, flock(5, LOCK_UN));
+
+  file.write("test");
+  file.flush();
+}
+
+TEST(FilesystemImpl, lockRetriesAndCountsFailures) {
+  NiceMock<Event::MockDispatcher> dispatcher;
+  Stats::IsolatedStoreImpl stats_store;
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+
+  EXPECT_CALL(os_sys_calls, open_(_, _, _)).WillOnce(Return(5));
+  Filesystem::FileImpl file("", dispatcher, stats_store, std::chrono::milliseconds(40));
+
+  InSequence s;
+  EXPECT_CALL(os_sys_calls, flock(5, LOCK_EX)).WillOnce(Invoke([](int, int) -> int {
+    errno = EINTR;
+    return -1;
+  }));
+  EXPECT_CALL(os_sys_calls, flock(5, LOCK_EX)).WillOnce(Return(0));
+  EXPECT_CALL(os_sys_calls, writev_(5, _, _))
+      .WillOnce(Invoke([](int, const iovec* iov, int num_iov) -> ssize_t {
+        return iovecsToString(iov, num_iov).size();
+      }));
+  EXPECT_CALL(os_sys_calls, flock(5, LOCK_UN)).WillOnce(Invoke([](int, int) -> int {
+    errno = EBADF;
+    return -1;
+  }));
+
+  file.write("test");
+  file.flush();
+
+  EXPECT_EQ(1UL, stats_store.counter("filesystem.lock_failed").value());
+  EXPECT_EQ(1UL, stats_store.counter("filesystem.write_completed").value());
+}
+
+TEST(FilesystemImpl, manySlicesAreWrittenInChunks) {
+  NiceMock<Event::MockDispatcher> dispatcher;
+  Stats::IsolatedStoreImpl stats_store;
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+
+  Filesystem::FileImpl file("", dispatcher, stats_store, std::chrono::milliseconds(40));
+
+  std::string written;
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillRepeatedly(Invoke([&written](int, const iovec* iov, int num_iov) -> ssize_t {
+        EXPECT_LE(num_iov, 256);
+        const std::string chunk = iovecsToString(iov, num_iov);
+        written += chunk;
+
+        return chunk.size();
+      }));
+
+  // Buffer slices hold at most a few KiB, so this much data spans more slices than a single
+  // writev() call accepts. The flush thread may also flush part of it concurrently, so only the
+  // concatenation of all writes is checked.
+  std::string expected;
+  for (uint32_t i = 0; i < 2000; i++) {
+    const std::string data(1000, 'a' + i % 26);
+    file.write(data);
+    expected += data;
+  }
+  file.flush();
+
+  EXPECT_EQ(expected, written);
+}
+
+TEST(FilesystemImpl, sharedFlushThread) {
+  NiceMock<Event::MockDispatcher> dispatcher;
+  NiceMock<Event::MockTimer>* timer1 = new NiceMock<Event::MockTimer>(&dispatcher);
+  NiceMock<Event::MockTimer>* timer2 = new NiceMock<Event::MockTimer>(&dispatcher);
+  Stats::IsolatedStoreImpl stats_store;
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+
+  Filesystem::SharedFlushThreadSharedPtr flush_thread =
+      std::make_shared<Filesystem::SharedFlushThread>();
+  EXPECT_CALL(os_sys_calls, open_(_, _, _)).WillOnce(Return(5)).WillOnce(Return(6));
+  Filesystem::FileImpl file1("", dispatcher, stats_store, std::chrono::milliseconds(40),
+                             flush_thread);
+  Filesystem::FileImpl file2("", dispatcher, stats_store, std::chrono::milliseconds(40),
+                             flush_thread);
+
+  EXPECT_CALL(os_sys_calls, writev_(5, _, _))
+      .WillOnce(Invoke([](int, const iovec* iov, int num_iov) -> ssize_t {
+        std::string written = iovecsToString(iov, num_iov);
+        EXPECT_EQ("test1", written);
+
+        return written.size();
+      }));
+  EXPECT_CALL(os_sys_calls, writev_(6, _, _))
+      .WillOnce(Invoke([](int, const iovec* iov, int num_iov) -> ssize_t {
+        std::string written = iovecsToString(iov, num_iov);
+        EXPECT_EQ("test2", written);
+
+        return written.size();
+      }));
+
+  // Neither write is large enough to be flushed right away, so both are flushed by the shared
+  // thread once the timers fire.
+  file1.write("test1");
+  file2.write("test2");
+  timer1->callback_();
+  timer2->callback_();
+
+  {
+    std::unique_lock<Thread::BasicLockable> lock(os_sys_calls.write_mutex_);
+    while (os_sys_calls.num_writes_ != 2) {
+      os_sys_calls.write_event_.wait(os_sys_calls.write_mutex_);
+    }
+  }
+}
+
 } // namespace Envoy
@@ -0,0 +1,110 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/filter/tcp_proxy.h"
+#include "common/network/cidr_range.h"
+#include "common/network/utility.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/server/mocks.h"
+
+#include "api/filter/network/tcp_proxy.pb.h"
+#include "fmt/format.h"
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Filter {
+
+// Builds route_count routes, each to a /24 of its own within 10.0.0.0/8 with a source IP list
+// and a destination port, followed by a catch all route, like an egress proxy's route table.
+static envoy::api::v2::filter::network::TcpProxy makeConfig(uint32_t route_count) {
+  envoy::api::v2::filter::network::TcpProxy config;
+  config.set_stat_prefix("name");
+  for (uint32_t i = 0; i < route_count; i++) {
+    auto* route = config.mutable_deprecated_v1()->mutable_routes()->Add();
+    route->set_cluster(fmt::format("cluster_{}", i));
+    auto* destination = route->mutable_destination_ip_list()->Add();
+    destination->set_address_prefix(fmt::format("10.{}.{}.0", (i >> 8) & 0xff, i & 0xff));
+    destination->mutable_prefix_len()->set_value(24);
+    auto* source = route->mutable_source_ip_list()->Add();
+    source->set_address_prefix("192.168.0.0");
+    source->mutable_prefix_len()->set_value(16);
+    route->set_destination_ports("443");
+  }
+  config.set_cluster("catch_all");
+  return config;
+}
+
+// Connections to the last configured route, which a linear scan reaches last, and to an address
+// no route but the catch all matches.
+static std::vector<std::unique_ptr<Network::MockConnection>> makeConnections(uint32_t route_count) {
+  std::vector<std::unique_ptr<Network::MockConnection>> connections;
+  const uint32_t last = route_count - 1;
+  for (const std::string& destination :
+       {fmt::format("10.{}.{}.1", (last >> 8) & 0xff, last & 0xff), std::string("11.0.0.1")}) {
+    connections.emplace_back(new testing::NiceMock<Network::MockConnection>());
+    connections.back()->local_address_ = Network::Utility::parseInternetAddress(destination, 443);
+    connections.back()->remote_address_ =
+        Network::Utility::parseInternetAddress("192.168.1.1", 50000);
+  }
+  return connections;
+}
+
+static void BM_TcpProxyRouteLookup(benchmark::State& state) {
+  testing::NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  TcpProxyConfig config(makeConfig(state.range(0)), factory_context);
+  std::vector<std::unique_ptr<Network::MockConnection>> connections =
+      makeConnections(state.range(0));
+  size_t i = 0;
+  size_t output_length = 0;
+  while (state.KeepRunning()) {
+    output_length += config.getRouteFromEntries(*connections[i++ % connections.size()]).size();
+  }
+  benchmark::DoNotOptimize(output_length);
+}
+BENCHMARK(BM_TcpProxyRouteLookup)->RangeMultiplier(8)->Range(8, 1 << 15);
+
+// The linear scan of IpList::contains() that the tries replace, for comparison.
+static void BM_TcpProxyRouteLinearScan(benchmark::State& state) {
+  const envoy::api::v2::filter::network::TcpProxy proto_config = makeConfig(state.range(0));
+  std::vector<std::pair<Network::Address::IpList, Network::Address::IpList>> routes;
+  for (const auto& route : proto_config.deprecated_v1().routes()) {
+    routes.emplace_back(Network::Address::IpList(route.destination_ip_list()),
+                        Network::Address::IpList(route.source_ip_list()));
+  }
+  std::vector<std::unique_ptr<Network::MockConnection>> connections =
+      makeConnections(state.range(0));
+  size_t i = 0;
+  size_t matches = 0;
+  while (state.KeepRunning()) {
+    Network::Connection& connection = *connections[i++ % connections.size()];
+    for (const auto& route : routes) {
+      if (route.first.contains(*connection.localAddress()) &&
+          route.second.contains(*connection.remoteAddress())) {
+        matches++;
+        break;
+      }
+    }
+  }
+  benchmark::DoNotOptimize(matches);
+}
+BENCHMARK(BM_TcpProxyRouteLinearScan)->RangeMultiplier(8)->Range(8, 1 << 15);
+
+} // namespace Filter
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
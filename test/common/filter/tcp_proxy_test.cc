@@ -23,6 +23,7 @@
 
 using testing::MatchesRegex;
 using testing::NiceMock;
+using testing::Ref;
 using testing::Return;
 using testing::ReturnPointee;
 using testing::ReturnRef;
@@ -307,6 +308,75 @@ TEST(TcpProxyConfigTest, Routes) {
   }
 }
 
+// Test that the first matching route wins regardless of how specific the matching ranges are.
+TEST(TcpProxyConfigTest, RouteOrder) {
+  std::string json = R"EOF(
+    {
+      "stat_prefix": "name",
+      "route_config": {
+        "routes": [
+          {
+            "destination_ip_list": [
+              "10.0.0.0/8"
+            ],
+            "source_ip_list": [
+              "20.0.0.0/8"
+            ],
+            "cluster": "broad_destination_with_source"
+          },
+          {
+            "destination_ip_list": [
+              "10.1.1.0/24"
+            ],
+            "destination_ports": "80",
+            "cluster": "narrow_destination_with_port"
+          },
+          {
+            "source_ip_list": [
+              "20.1.0.0/16"
+            ],
+            "cluster": "narrow_source"
+          },
+          {
+            "destination_ip_list": [
+              "10.1.0.0/16"
+            ],
+            "cluster": "narrow_destination"
+          },
+          {
+            "destination_ip_list": [
+              "10.1.0.0/16"
+            ],
+            "source_ip_list": [
+              "30.0.0.0/8"
+            ],
+            "cluster": "unreachable"
+          }
+        ]
+      }
+    }
+    )EOF";
+
+  Json::ObjectSharedPtr json_config = Json::Factory::loadFromString(json);
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context_;
+  TcpProxyConfig config_obj(constructTcpProxyConfigFromJson(*json_config, factory_context_));
+
+  const auto route = [&config_obj](const std::string& destination,
+                                   const std::string& source) -> std::string {
+    NiceMock<Network::MockConnection> connection;
+    connection.local_address_ = Network::Utility::parseInternetAddress(destination, 80);
+    connection.remote_address_ = Network::Utility::parseInternetAddress(source, 1000);
+    return config_obj.getRouteFromEntries(connection);
+  };
+
+  EXPECT_EQ("broad_destination_with_source", route("10.1.1.1", "20.1.1.1"));
+  EXPECT_EQ("narrow_destination_with_port", route("10.1.1.1", "30.1.1.1"));
+  EXPECT_EQ("narrow_source", route("11.0.0.1", "20.1.1.1"));
+  EXPECT_EQ("narrow_destination", route("10.1.2.1", "30.1.1.1"));
+  EXPECT_EQ("", route("10.2.0.1", "30.1.1.1"));
+  EXPECT_EQ("", route("::1", "::2"));
+}
+
 TEST(TcpProxyConfigTest, EmptyRouteConfig) {
   std::string json = R"EOF(
     {
@@ -819,6 +889,43 @@ TEST_F(TcpProxyTest, AccessLogBytesRxTxDuration) {
                   "bytesreceived=1 bytessent=2 datetime=[0-9-]+T[0-9:.]+Z nonzeronum=[1-9][0-9]*"));
 }
 
+// Test that both directions are spliced when enabled, and that spliced data is counted as it is
+// sent.
+TEST_F(TcpProxyTest, Splice) {
+  setup(1, accessLogConfig("bytesreceived=%BYTES_RECEIVED% bytessent=%BYTES_SENT%"));
+  ON_CALL(factory_context_.runtime_loader_.snapshot_, featureEnabled("tcp.name.splice_enabled", 0))
+      .WillByDefault(Return(true));
+
+  EXPECT_CALL(filter_callbacks_.connection_, spliceTo(Ref(*upstream_connections_.at(0))))
+      .WillOnce(Return(true));
+  EXPECT_CALL(*upstream_connections_.at(0), spliceTo(Ref(filter_callbacks_.connection_)))
+      .WillOnce(Return(true));
+  raiseEventUpstreamConnected(0);
+  EXPECT_EQ(1U, config_->stats().downstream_cx_splice_total_.value());
+
+  upstream_connections_.at(0)->raiseBytesSentCallbacks(3);
+  filter_callbacks_.connection_.raiseBytesSentCallbacks(5);
+  upstream_connections_.at(0)->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  filter_.reset();
+  EXPECT_EQ(access_log_data_, "bytesreceived=3 bytessent=5");
+}
+
+// Test that a direction that cannot be spliced keeps passing through the filter.
+TEST_F(TcpProxyTest, SpliceFallback) {
+  setup(1);
+  ON_CALL(factory_context_.runtime_loader_.snapshot_, featureEnabled("tcp.name.splice_enabled", 0))
+      .WillByDefault(Return(true));
+
+  EXPECT_CALL(filter_callbacks_.connection_, spliceTo(_)).WillOnce(Return(false));
+  EXPECT_CALL(*upstream_connections_.at(0), spliceTo(_)).WillOnce(Return(false));
+  raiseEventUpstreamConnected(0);
+  EXPECT_EQ(0U, config_->stats().downstream_cx_splice_total_.value());
+
+  Buffer::OwnedImpl buffer("hello");
+  EXPECT_CALL(*upstream_connections_.at(0), write(BufferEqual(&buffer)));
+  filter_->onData(buffer);
+}
+
 // Tests that upstream flush works properly with no idle timeout configured.
 TEST_F(TcpProxyTest, UpstreamFlushNoTimeout) {
   setup(1);
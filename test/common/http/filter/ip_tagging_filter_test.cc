@@ -2,6 +2,8 @@
 #include "common/http/filter/ip_tagging_filter.h"
 #include "common/http/header_map_impl.h"
 #include "common/http/headers.h"
+#include "common/network/address_impl.h"
+#include "common/stats/stats_impl.h"
 
 #include "test/mocks/http/mocks.h"
 #include "test/test_common/utility.h"
@@ -53,44 +55,172 @@ public:
     }
   )EOF";
 
+  const std::string nested_request_json = R"EOF(
+    {
+      "ip_tags" : [
+        {
+          "ip_tag_name" : "private",
+          "ip_list" : ["10.0.0.0/8", "fd00::/8"]
+        },
+        {
+          "ip_tag_name" : "office",
+          "ip_list" : ["10.1.0.0/16"]
+        },
+        {
+          "ip_tag_name" : "host",
+          "ip_list" : ["10.1.2.3", "fd00::1"]
+        }
+      ]
+    }
+  )EOF";
+
   void SetUpTest(const std::string json) {
     Json::ObjectSharedPtr config = Json::Factory::loadFromString(json);
-    config_.reset(new IpTaggingFilterConfig(*config));
+    config_.reset(new IpTaggingFilterConfig(*config, "prefix.", stats_));
     filter_.reset(new IpTaggingFilter(config_));
     filter_->setDecoderFilterCallbacks(filter_callbacks_);
   }
 
+  void setRemoteAddress(Network::Address::InstanceConstSharedPtr address) {
+    filter_callbacks_.request_info_.downstream_remote_address_ = address;
+  }
+
   ~IpTaggingFilterTest() { filter_->onDestroy(); }
 
   IpTaggingFilterConfigSharedPtr config_;
   std::unique_ptr<IpTaggingFilter> filter_;
   NiceMock<MockStreamDecoderFilterCallbacks> filter_callbacks_;
+  Stats::IsolatedStoreImpl stats_;
   TestHeaderMapImpl request_headers_;
   Buffer::OwnedImpl data_;
 };
 
 TEST_F(IpTaggingFilterTest, InternalRequest) {
   SetUpTest(internal_request_json);
+  setRemoteAddress(std::make_shared<Network::Address::Ipv4Instance>("1.2.3.4"));
+
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers_, false));
+  EXPECT_FALSE(request_headers_.has(Headers::get().EnvoyIpTags));
 
+  request_headers_.addCopy(Headers::get().EnvoyInternalRequest, "true");
   EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers_, false));
+  EXPECT_EQ("test_internal", request_headers_.get_(Headers::get().EnvoyIpTags));
   EXPECT_EQ(FilterDataStatus::Continue, filter_->decodeData(data_, false));
   EXPECT_EQ(FilterTrailersStatus::Continue, filter_->decodeTrailers(request_headers_));
+
+  EXPECT_EQ(1U, stats_.counter("prefix.ip_tagging.total").value());
+  EXPECT_EQ(1U, stats_.counter("prefix.ip_tagging.hit").value());
 }
 
 TEST_F(IpTaggingFilterTest, ExternalRequest) {
   SetUpTest(external_request_json);
+  setRemoteAddress(std::make_shared<Network::Address::Ipv4Instance>("1.2.3.4"));
 
   EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers_, false));
+  EXPECT_EQ("test_external", request_headers_.get_(Headers::get().EnvoyIpTags));
   EXPECT_EQ(FilterDataStatus::Continue, filter_->decodeData(data_, false));
   EXPECT_EQ(FilterTrailersStatus::Continue, filter_->decodeTrailers(request_headers_));
+
+  TestHeaderMapImpl internal_headers{{"x-envoy-internal", "true"}};
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(internal_headers, false));
+  EXPECT_FALSE(internal_headers.has(Headers::get().EnvoyIpTags));
 }
 
 TEST_F(IpTaggingFilterTest, BothRequest) {
   SetUpTest(both_request_json);
+  setRemoteAddress(std::make_shared<Network::Address::Ipv4Instance>("1.2.3.4"));
 
   EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers_, false));
+  EXPECT_EQ("test_both", request_headers_.get_(Headers::get().EnvoyIpTags));
   EXPECT_EQ(FilterDataStatus::Continue, filter_->decodeData(data_, false));
   EXPECT_EQ(FilterTrailersStatus::Continue, filter_->decodeTrailers(request_headers_));
+
+  TestHeaderMapImpl internal_headers{{"x-envoy-internal", "true"}};
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(internal_headers, false));
+  EXPECT_EQ("test_both", internal_headers.get_(Headers::get().EnvoyIpTags));
+}
+
+TEST_F(IpTaggingFilterTest, NoHit) {
+  SetUpTest(both_request_json);
+  setRemoteAddress(std::make_shared<Network::Address::Ipv4Instance>("1.2.3.5"));
+
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers_, false));
+  EXPECT_FALSE(request_headers_.has(Headers::get().EnvoyIpTags));
+  EXPECT_EQ(1U, stats_.counter("prefix.ip_tagging.no_hit").value());
+}
+
+TEST_F(IpTaggingFilterTest, NestedRanges) {
+  SetUpTest(nested_request_json);
+
+  setRemoteAddress(std::make_shared<Network::Address::Ipv4Instance>("10.1.2.3"));
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers_, false));
+  EXPECT_EQ("private,office,host", request_headers_.get_(Headers::get().EnvoyIpTags));
+
+  TestHeaderMapImpl office_headers;
+  setRemoteAddress(std::make_shared<Network::Address::Ipv4Instance>("10.1.200.3"));
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(office_headers, false));
+  EXPECT_EQ("private,office", office_headers.get_(Headers::get().EnvoyIpTags));
+
+  TestHeaderMapImpl private_headers;
+  setRemoteAddress(std::make_shared<Network::Address::Ipv4Instance>("10.2.0.1"));
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(private_headers, false));
+  EXPECT_EQ("private", private_headers.get_(Headers::get().EnvoyIpTags));
+
+  TestHeaderMapImpl ipv6_headers;
+  setRemoteAddress(std::make_shared<Network::Address::Ipv6Instance>("fd00::1"));
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(ipv6_headers, false));
+  EXPECT_EQ("private,host", ipv6_headers.get_(Headers::get().EnvoyIpTags));
+}
+
+TEST_F(IpTaggingFilterTest, AppendToExistingHeaderOnInternalRequest) {
+  SetUpTest(both_request_json);
+  setRemoteAddress(std::make_shared<Network::Address::Ipv4Instance>("1.2.3.4"));
+  TestHeaderMapImpl internal_headers{{"x-envoy-internal", "true"},
+                                     {"x-envoy-ip-tags", "upstream_tag"}};
+
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(internal_headers, false));
+  EXPECT_EQ("upstream_tag,test_both", internal_headers.get_(Headers::get().EnvoyIpTags));
+}
+
+TEST_F(IpTaggingFilterTest, ReplaceExistingHeaderOnExternalRequest) {
+  SetUpTest(both_request_json);
+  setRemoteAddress(std::make_shared<Network::Address::Ipv4Instance>("1.2.3.4"));
+  request_headers_.addCopy(Headers::get().EnvoyIpTags, "spoofed_tag");
+
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers_, false));
+  EXPECT_EQ("test_both", request_headers_.get_(Headers::get().EnvoyIpTags));
+
+  // A tag sent by an external client is dropped even when the address matches nothing.
+  TestHeaderMapImpl no_hit_headers{{"x-envoy-ip-tags", "spoofed_tag"}};
+  setRemoteAddress(std::make_shared<Network::Address::Ipv4Instance>("1.2.3.5"));
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(no_hit_headers, false));
+  EXPECT_FALSE(no_hit_headers.has(Headers::get().EnvoyIpTags));
+}
+
+TEST_F(IpTaggingFilterTest, PipeAddress) {
+  SetUpTest(both_request_json);
+  setRemoteAddress(std::make_shared<Network::Address::PipeInstance>("/foo"));
+
+  EXPECT_EQ(FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers_, false));
+  EXPECT_FALSE(request_headers_.has(Headers::get().EnvoyIpTags));
+}
+
+TEST(IpTaggingFilterConfigTest, InvalidCidr) {
+  const std::string json = R"EOF(
+    {
+      "ip_tags" : [
+        {
+          "ip_tag_name" : "bad",
+          "ip_list" : ["1.2.3.4/foo"]
+        }
+      ]
+    }
+  )EOF";
+
+  Stats::IsolatedStoreImpl stats;
+  Json::ObjectSharedPtr config = Json::Factory::loadFromString(json);
+  EXPECT_THROW_WITH_MESSAGE(IpTaggingFilterConfig(*config, "prefix.", stats), EnvoyException,
+                            "invalid ip/mask combo '1.2.3.4/foo' (format is <ip>/<# mask bits>)");
 }
 
 } // namespace Http
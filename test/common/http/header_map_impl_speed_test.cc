@@ -0,0 +1,139 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/http/header_map_impl.h"
+
+#include "fmt/format.h"
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Http {
+
+// A request with the usual inline headers, followed by count custom headers like those added for
+// tracing, auth and by applications.
+static std::vector<std::pair<std::string, std::string>> makeHeaders(uint32_t count) {
+  std::vector<std::pair<std::string, std::string>> headers{
+      {":method", "GET"},
+      {":path", "/some/path?with=query"},
+      {":authority", "www.example.com"},
+      {"user-agent", "curl/7.54.0"},
+      {"x-request-id", "2e4ab1e3-8c6f-4d8a-a0b2-4c2d5c8f7a11"}};
+  for (uint32_t i = 0; i < count; i++) {
+    headers.emplace_back(fmt::format("x-custom-header-{}", i), fmt::format("value-{}", i));
+  }
+  return headers;
+}
+
+// Populate a map with moves of copies of the received key and value, as the HTTP/1 codec does.
+static void populate(HeaderMapImpl& map,
+                     const std::vector<std::pair<std::string, std::string>>& headers) {
+  for (const auto& header : headers) {
+    HeaderString key;
+    key.setCopy(header.first.c_str(), header.first.size());
+    HeaderString value;
+    value.setCopy(header.second.c_str(), header.second.size());
+    map.addViaMove(std::move(key), std::move(value));
+  }
+}
+
+static void BM_HeaderMapPopulate(benchmark::State& state) {
+  const auto headers = makeHeaders(state.range(0));
+  while (state.KeepRunning()) {
+    HeaderMapImpl map;
+    populate(map, headers);
+    benchmark::DoNotOptimize(map.size());
+  }
+}
+BENCHMARK(BM_HeaderMapPopulate)->Arg(0)->Arg(10)->Arg(30)->Arg(60);
+
+// Populate a map by copying each key and value straight into it, as the HTTP/2 codec does.
+static void BM_HeaderMapPopulateViaCopy(benchmark::State& state) {
+  const auto headers = makeHeaders(state.range(0));
+  while (state.KeepRunning()) {
+    HeaderMapImpl map;
+    for (const auto& header : headers) {
+      map.addViaCopy(header.first.c_str(), header.first.size(), header.second.c_str(),
+                     header.second.size());
+    }
+    benchmark::DoNotOptimize(map.size());
+  }
+}
+BENCHMARK(BM_HeaderMapPopulateViaCopy)->Arg(0)->Arg(10)->Arg(30)->Arg(60);
+
+// Look up each custom header and one that is missing, as filters matching on headers do.
+static void BM_HeaderMapGet(benchmark::State& state) {
+  const auto headers = makeHeaders(state.range(0));
+  HeaderMapImpl map;
+  populate(map, headers);
+  std::vector<LowerCaseString> keys;
+  for (const auto& header : headers) {
+    keys.emplace_back(header.first);
+  }
+  keys.emplace_back("x-missing");
+  size_t i = 0;
+  size_t found = 0;
+  while (state.KeepRunning()) {
+    found += map.get(keys[i++ % keys.size()]) != nullptr;
+  }
+  benchmark::DoNotOptimize(found);
+}
+BENCHMARK(BM_HeaderMapGet)->Arg(0)->Arg(10)->Arg(30)->Arg(60);
+
+static void BM_HeaderMapCopy(benchmark::State& state) {
+  HeaderMapImpl map;
+  populate(map, makeHeaders(state.range(0)));
+  const HeaderMap& source = map;
+  while (state.KeepRunning()) {
+    HeaderMapImpl copy(source);
+    benchmark::DoNotOptimize(copy.size());
+  }
+}
+BENCHMARK(BM_HeaderMapCopy)->Arg(0)->Arg(10)->Arg(30)->Arg(60);
+
+static void BM_HeaderMapIterate(benchmark::State& state) {
+  HeaderMapImpl map;
+  populate(map, makeHeaders(state.range(0)));
+  size_t byte_size = 0;
+  while (state.KeepRunning()) {
+    map.iterate(
+        [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
+          *static_cast<size_t*>(context) += header.key().size() + header.value().size();
+          return HeaderMap::Iterate::Continue;
+        },
+        &byte_size);
+  }
+  benchmark::DoNotOptimize(byte_size);
+}
+BENCHMARK(BM_HeaderMapIterate)->Arg(0)->Arg(10)->Arg(30)->Arg(60);
+
+// Replace a custom header, as filters that rewrite headers do.
+static void BM_HeaderMapSetRemove(benchmark::State& state) {
+  HeaderMapImpl map;
+  populate(map, makeHeaders(state.range(0)));
+  const LowerCaseString key("x-rewritten");
+  const std::string value("value");
+  while (state.KeepRunning()) {
+    map.setReferenceKey(key, value);
+    map.remove(key);
+  }
+  benchmark::DoNotOptimize(map.size());
+}
+BENCHMARK(BM_HeaderMapSetRemove)->Arg(0)->Arg(10)->Arg(30)->Arg(60);
+
+} // namespace Http
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -1,4 +1,9 @@
+#include <algorithm>
+#include <list>
+#include <random>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/http/header_map_impl.h"
 
@@ -478,6 +483,31 @@ TEST(HeaderMapImplTest, AddCopy) {
   EXPECT_EQ(2UL, headers.get(lcKey3)->value().size());
 }
 
+TEST(HeaderMapImplTest, AddViaCopy) {
+  HeaderMapImpl headers;
+  // Neither the key nor the value are referenced once added.
+  std::string key("hello");
+  std::string value("world");
+  headers.addViaCopy(key.c_str(), key.size(), value.c_str(), value.size());
+  std::string content_type("content-type");
+  std::string html("text/html");
+  headers.addViaCopy(content_type.c_str(), content_type.size(), html.c_str(), html.size());
+  headers.addViaCopy(content_type.c_str(), content_type.size(), "blah", 4);
+  key.assign("xxxxx");
+  value.assign("xxxxx");
+  content_type.assign(content_type.size(), 'x');
+  html.assign(html.size(), 'x');
+
+  EXPECT_EQ(2UL, headers.size());
+  EXPECT_STREQ("world", headers.get(LowerCaseString("hello"))->value().c_str());
+  EXPECT_STREQ("hello", headers.get(LowerCaseString("hello"))->key().c_str());
+  EXPECT_STREQ("text/html", headers.ContentType()->value().c_str());
+  EXPECT_EQ(HeaderString::Type::Reference, headers.ContentType()->key().type());
+  EXPECT_EQ((HeaderMapImpl{{LowerCaseString("hello"), "world"},
+                           {Headers::get().ContentType, "text/html"}}),
+            headers);
+}
+
 TEST(HeaderMapImplTest, Equality) {
   TestHeaderMapImpl headers1;
   TestHeaderMapImpl headers2;
@@ -490,6 +520,39 @@ TEST(HeaderMapImplTest, Equality) {
   EXPECT_FALSE(headers1 == headers2);
 }
 
+TEST(HeaderMapImplTest, CopyAndMove) {
+  TestHeaderMapImpl headers{{":path", "/"}, {"hello", "world"}, {"hello", "again"}};
+
+  TestHeaderMapImpl copy(headers);
+  EXPECT_EQ(headers, copy);
+  EXPECT_STREQ("/", copy.Path()->value().c_str());
+  EXPECT_STREQ("world", copy.get(LowerCaseString("hello"))->value().c_str());
+  copy.remove(LowerCaseString("hello"));
+  EXPECT_EQ(1UL, copy.size());
+  EXPECT_EQ(3UL, headers.size());
+
+  TestHeaderMapImpl moved(std::move(copy));
+  EXPECT_EQ(0UL, copy.size());
+  EXPECT_EQ(nullptr, copy.Path());
+  EXPECT_STREQ("/", moved.Path()->value().c_str());
+
+  moved = headers;
+  EXPECT_EQ(headers, moved);
+  moved = TestHeaderMapImpl{{"foo", "bar"}};
+  EXPECT_EQ(nullptr, moved.Path());
+  EXPECT_STREQ("bar", moved.get(LowerCaseString("foo"))->value().c_str());
+
+  // Copies survive the reallocations of a vector.
+  std::vector<TestHeaderMapImpl> vector;
+  for (uint32_t i = 0; i < 10; i++) {
+    vector.push_back(headers);
+  }
+  for (const TestHeaderMapImpl& entry : vector) {
+    EXPECT_EQ(headers, entry);
+    EXPECT_STREQ("world", entry.get(LowerCaseString("hello"))->value().c_str());
+  }
+}
+
 TEST(HeaderMapImplTest, LargeCharInHeader) {
   HeaderMapImpl headers;
   LowerCaseString static_key("\x90hello");
@@ -571,5 +634,124 @@ TEST(HeaderMapImplTest, Lookup) {
     EXPECT_EQ(nullptr, entry);
   }
 }
+
+// Entries keep their addresses and the map keeps insertion order while headers come and go, and
+// all of them can be found through the index.
+TEST(HeaderMapImplTest, ManyHeaders) {
+  HeaderMapImpl headers;
+  std::vector<LowerCaseString> keys;
+  std::vector<const HeaderEntry*> entries;
+  for (uint32_t i = 0; i < 100; i++) {
+    keys.emplace_back("x-header-" + std::to_string(i));
+    headers.addCopy(keys.back(), std::to_string(i));
+    entries.push_back(headers.get(keys.back()));
+  }
+  headers.insertPath().value(std::string("/"));
+  EXPECT_EQ(101UL, headers.size());
+  for (uint32_t i = 0; i < keys.size(); i++) {
+    EXPECT_EQ(entries[i], headers.get(keys[i]));
+  }
+
+  for (uint32_t i = 0; i < keys.size(); i += 2) {
+    headers.remove(keys[i]);
+  }
+  headers.addCopy(keys[0], "again");
+  EXPECT_EQ(52UL, headers.size());
+  for (uint32_t i = 1; i < keys.size(); i += 2) {
+    EXPECT_EQ(entries[i], headers.get(keys[i]));
+    EXPECT_EQ(std::to_string(i), headers.get(keys[i])->value().c_str());
+  }
+  for (uint32_t i = 2; i < keys.size(); i += 2) {
+    EXPECT_EQ(nullptr, headers.get(keys[i]));
+  }
+
+  std::vector<std::string> order;
+  headers.iterate(
+      [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
+        static_cast<std::vector<std::string>*>(context)->push_back(header.key().c_str());
+        return HeaderMap::Iterate::Continue;
+      },
+      &order);
+  ASSERT_EQ(52UL, order.size());
+  EXPECT_EQ("x-header-1", order[0]);
+  EXPECT_EQ("x-header-99", order[49]);
+  EXPECT_EQ(":path", order[50]);
+  EXPECT_EQ("x-header-0", order[51]);
+  EXPECT_STREQ("again", headers.get(keys[0])->value().c_str());
+}
+
+// get() finds the first of several headers with the same key, and remove() removes all of them.
+// The legacy host header is stored as :authority, which get() doesn't match it to.
+TEST(HeaderMapImplTest, GetFirstOfDuplicates) {
+  HeaderMapImpl headers;
+  LowerCaseString key("hello");
+  headers.addCopy(key, "1");
+  headers.addCopy(LowerCaseString("other"), "2");
+  headers.addCopy(key, "3");
+  EXPECT_STREQ("1", headers.get(key)->value().c_str());
+  headers.remove(key);
+  EXPECT_EQ(nullptr, headers.get(key));
+  EXPECT_EQ(1UL, headers.size());
+
+  headers.addCopy(Headers::get().HostLegacy, "host");
+  EXPECT_EQ(nullptr, headers.get(Headers::get().HostLegacy));
+  EXPECT_STREQ("host", headers.get(Headers::get().Host)->value().c_str());
+}
+
+// Random adds and removes over a small set of keys agree with a list of all headers.
+TEST(HeaderMapImplTest, RandomAddRemove) {
+  std::mt19937 random(0);
+  std::vector<LowerCaseString> keys;
+  for (uint32_t i = 0; i < 40; i++) {
+    keys.emplace_back("x-" + std::to_string(i));
+  }
+  keys.push_back(Headers::get().ContentType);
+
+  HeaderMapImpl headers;
+  std::list<std::pair<std::string, std::string>> expected;
+  for (uint32_t i = 0; i < 2000; i++) {
+    const LowerCaseString& key = keys[random() % keys.size()];
+    if (random() % 3 == 0) {
+      headers.remove(key);
+      expected.remove_if([&key](const std::pair<std::string, std::string>& header) {
+        return header.first == key.get();
+      });
+    } else {
+      const std::string value = std::to_string(i);
+      const bool inline_exists = key == Headers::get().ContentType && headers.ContentType();
+      headers.addCopy(key, value);
+      if (!inline_exists) {
+        expected.emplace_back(key.get(), value);
+      }
+    }
+
+    ASSERT_EQ(expected.size(), headers.size());
+    for (const LowerCaseString& lookup_key : keys) {
+      auto first =
+          std::find_if(expected.begin(), expected.end(),
+                       [&lookup_key](const std::pair<std::string, std::string>& header) {
+                         return header.first == lookup_key.get();
+                       });
+      const HeaderEntry* entry = headers.get(lookup_key);
+      if (first == expected.end()) {
+        ASSERT_EQ(nullptr, entry);
+      } else {
+        ASSERT_NE(nullptr, entry);
+        ASSERT_EQ(first->second, entry->value().c_str());
+      }
+    }
+  }
+
+  std::list<std::pair<std::string, std::string>> actual;
+  headers.iterate(
+      [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
+        static_cast<std::list<std::pair<std::string, std::string>>*>(context)->emplace_back(
+            header.key().c_str(), header.value().c_str());
+        return HeaderMap::Iterate::Continue;
+      },
+      &actual);
+  EXPECT_EQ(expected, actual);
+}
+
 } // namespace Http
 } // namespace Envoy
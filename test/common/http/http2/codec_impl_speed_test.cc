@@ -0,0 +1,169 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/http2/codec_impl.h"
+#include "common/stats/stats_impl.h"
+
+#include "test/mocks/network/mocks.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+// A browser request with the headers, cookies and user agent that browsers send, and a typical
+// response to it.
+static const HeaderMapImpl& request() {
+  static const HeaderMapImpl* request = new HeaderMapImpl{
+      {Headers::get().Method, "GET"},
+      {Headers::get().Path, "/static/css/main.8f3a2c1d.css"},
+      {Headers::get().Scheme, "https"},
+      {Headers::get().Host, "www.example.com"},
+      {Headers::get().UserAgent, "Mozilla/5.0 (Macintosh; Intel Mac OS X 10_13_2) "
+                                 "AppleWebKit/537.36 (KHTML, like Gecko) Chrome/63.0.3239.132 "
+                                 "Safari/537.36"},
+      {LowerCaseString("accept"), "text/css,*/*;q=0.1"},
+      {LowerCaseString("referer"), "https://www.example.com/products/shoes?color=blue&size=10"},
+      {LowerCaseString("accept-encoding"), "gzip, deflate, br"},
+      {LowerCaseString("accept-language"), "en-US,en;q=0.9,de;q=0.8"},
+      {Headers::get().Cookie, "_ga=GA1.2.1234567890.1514764800"},
+      {Headers::get().Cookie, "session_id=6f1ed002ab5595859014ebf0951522d9"},
+      {LowerCaseString("if-none-match"), "\"5a7c1f2e-3b8d\""},
+      {Headers::get().ForwardedFor, "203.0.113.195, 70.41.3.18"},
+      {Headers::get().RequestId, "2e4ab1e3-8c6f-4d8a-a0b2-4c2d5c8f7a11"},
+      {LowerCaseString("x-b3-traceid"), "463ac35c9f6413ad48485a3953bb6124"},
+      {LowerCaseString("x-b3-spanid"), "a2fb4a1d1a96d312"},
+      {LowerCaseString("x-b3-sampled"), "1"}};
+  return *request;
+}
+
+static const HeaderMapImpl& response() {
+  static const HeaderMapImpl* response = new HeaderMapImpl{
+      {Headers::get().Status, "200"},
+      {Headers::get().ContentType, "text/css"},
+      {LowerCaseString("cache-control"), "public, max-age=31536000"},
+      {LowerCaseString("etag"), "\"5a7c1f2e-3b8d\""},
+      {LowerCaseString("last-modified"), "Thu, 08 Feb 2018 10:21:34 GMT"},
+      {Headers::get().Date, "Mon, 12 Feb 2018 17:02:51 GMT"},
+      {Headers::get().EnvoyUpstreamServiceTime, "3"},
+      {Headers::get().Server, "envoy"}};
+  return *response;
+}
+
+/**
+ * Both ends of an HTTP/2 connection, whose codecs write straight into each other.
+ */
+class CodecPair : public ServerConnectionCallbacks {
+public:
+  /**
+   * Decoder for either end, which answers requests with the response.
+   */
+  class Decoder : public StreamDecoder {
+  public:
+    // Http::StreamDecoder
+    void decodeHeaders(HeaderMapPtr&& headers, bool) override {
+      headers_ += headers->size();
+      if (encoder_ != nullptr) {
+        encoder_->encodeHeaders(response(), true);
+      }
+    }
+    void decodeData(Buffer::Instance&, bool) override {}
+    void decodeTrailers(HeaderMapPtr&&) override {}
+
+    StreamEncoder* encoder_{};
+    uint64_t headers_{};
+  };
+
+  CodecPair()
+      : client_(client_connection_, *this, stats_store_, Http2Settings()),
+        server_(server_connection_, *this, stats_store_, Http2Settings()) {
+    ON_CALL(client_connection_, write(testing::_))
+        .WillByDefault(testing::Invoke(
+            [this](Buffer::Instance& data) -> void { deliver(data, server_buffer_); }));
+    ON_CALL(server_connection_, write(testing::_))
+        .WillByDefault(testing::Invoke(
+            [this](Buffer::Instance& data) -> void { deliver(data, client_buffer_); }));
+  }
+
+  void exchange() {
+    client_.newStream(response_decoder_).encodeHeaders(request(), true);
+    // Closed streams are deferred deleted, which the mock dispatcher leaves to its owner.
+    client_connection_.dispatcher_.to_delete_.clear();
+    server_connection_.dispatcher_.to_delete_.clear();
+  }
+
+  uint64_t headers() const { return request_decoder_.headers_ + response_decoder_.headers_; }
+
+  // Http::ConnectionCallbacks
+  void onGoAway() override {}
+
+  // Http::ServerConnectionCallbacks
+  StreamDecoder& newStream(StreamEncoder& response_encoder) override {
+    request_decoder_.encoder_ = &response_encoder;
+    return request_decoder_;
+  }
+
+private:
+  // A codec writes while it dispatches, so data for a codec that is already dispatching is queued
+  // until its current dispatch returns.
+  void deliver(Buffer::Instance& data, Buffer::Instance& buffer) {
+    buffer.move(data);
+    if (dispatching_) {
+      return;
+    }
+    dispatching_ = true;
+    while (client_buffer_.length() > 0 || server_buffer_.length() > 0) {
+      if (server_buffer_.length() > 0) {
+        server_.dispatch(server_buffer_);
+      }
+      if (client_buffer_.length() > 0) {
+        client_.dispatch(client_buffer_);
+      }
+    }
+    dispatching_ = false;
+  }
+
+  Stats::IsolatedStoreImpl stats_store_;
+  testing::NiceMock<Network::MockConnection> client_connection_;
+  testing::NiceMock<Network::MockConnection> server_connection_;
+  ClientConnectionImpl client_;
+  ServerConnectionImpl server_;
+  Buffer::OwnedImpl client_buffer_;
+  Buffer::OwnedImpl server_buffer_;
+  Decoder request_decoder_;
+  Decoder response_decoder_;
+  bool dispatching_{};
+};
+
+// Send a request from the client and a response from the server, each as a HEADERS frame that is
+// HPACK encoded on one end and decoded into a header map on the other.
+static void BM_Http2RequestResponseHeaders(benchmark::State& state) {
+  CodecPair codecs;
+  while (state.KeepRunning()) {
+    codecs.exchange();
+  }
+  benchmark::DoNotOptimize(codecs.headers());
+}
+BENCHMARK(BM_Http2RequestResponseHeaders);
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -1,5 +1,7 @@
+#include <chrono>
 #include <cstdint>
 #include <memory>
+#include <thread>
 #include <vector>
 
 #include "common/http/http2/conn_pool.h"
@@ -19,6 +21,7 @@
 #include "gtest/gtest.h"
 
 using testing::DoAll;
+using testing::Ge;
 using testing::InSequence;
 using testing::Invoke;
 using testing::NiceMock;
@@ -46,8 +49,12 @@ public:
   MOCK_METHOD1(createCodecClient_, CodecClient*(Upstream::Host::CreateConnectionData& data));
 
   uint32_t maxTotalStreams() override { return max_streams_; }
+  uint32_t maxActiveClients() override { return max_active_clients_; }
+  uint32_t clientStreamThreshold() override { return client_stream_threshold_; }
 
   uint32_t max_streams_{std::numeric_limits<uint32_t>::max()};
+  uint32_t max_active_clients_{1};
+  uint32_t client_stream_threshold_{};
 };
 
 class Http2ConnPoolImplTest : public testing::Test {
@@ -141,15 +148,16 @@ TEST_F(Http2ConnPoolImplTest, DrainConnections) {
   r2.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
   expectClientConnect(1);
 
-  // This will move primary to draining and destroy draining.
+  // This will move the active client to draining alongside the other draining client.
   pool_.drainConnections();
-  EXPECT_CALL(*this, onClientDestroy());
-  dispatcher_.clearDeferredDeleteList();
 
-  // This will destroy draining.
+  // This will destroy both draining clients.
   test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
   EXPECT_CALL(*this, onClientDestroy());
   dispatcher_.clearDeferredDeleteList();
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_CALL(*this, onClientDestroy());
+  dispatcher_.clearDeferredDeleteList();
 }
 
 TEST_F(Http2ConnPoolImplTest, VerifyConnectionTimingStats) {
@@ -171,6 +179,40 @@ TEST_F(Http2ConnPoolImplTest, VerifyConnectionTimingStats) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+/**
+ * Verify that each client records its own connect time when several connect at once.
+ */
+TEST_F(Http2ConnPoolImplTest, VerifyConcurrentConnectionTimingStats) {
+  pool_.max_active_clients_ = 2;
+  pool_.client_stream_threshold_ = 1;
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  // Client 0 is busy with r1, so a second client starts connecting before the first is done.
+  expectClientCreate();
+  ActiveTestRequest r2(*this, 1);
+
+  // Client 0 has been connecting since before client 1 was created.
+  EXPECT_CALL(cluster_->stats_store_,
+              deliverHistogramToSinks(Property(&Stats::Metric::name, "upstream_cx_connect_ms"),
+                                      Ge(20U)));
+  expectClientConnect(0);
+  EXPECT_CALL(cluster_->stats_store_,
+              deliverHistogramToSinks(Property(&Stats::Metric::name, "upstream_cx_connect_ms"), _));
+  expectClientConnect(1);
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_total_.value());
+
+  EXPECT_CALL(cluster_->stats_store_,
+              deliverHistogramToSinks(Property(&Stats::Metric::name, "upstream_cx_length_ms"), _))
+      .Times(2);
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_CALL(*this, onClientDestroy()).Times(2);
+  dispatcher_.clearDeferredDeleteList();
+}
+
 /**
  * Test that buffer limits are set.
  */
@@ -442,6 +484,74 @@ TEST_F(Http2ConnPoolImplTest, GoAway) {
   EXPECT_EQ(1U, cluster_->stats_.upstream_cx_close_notify_.value());
 }
 
+/**
+ * Verify that a client with stream threshold active streams gets a sibling, and that streams go to
+ * the least loaded client.
+ */
+TEST_F(Http2ConnPoolImplTest, MultipleClientsStreamThreshold) {
+  InSequence s;
+  pool_.max_active_clients_ = 2;
+  pool_.client_stream_threshold_ = 2;
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0);
+  expectClientConnect(0);
+  ActiveTestRequest r2(*this, 0);
+
+  // Client 0 is busy, so a second client takes the stream.
+  expectClientCreate();
+  ActiveTestRequest r3(*this, 1);
+  expectClientConnect(1);
+  ActiveTestRequest r4(*this, 1);
+
+  // Client 0 is no longer busy once r1 completes.
+  EXPECT_CALL(r1.inner_encoder_, encodeHeaders(_, true));
+  r1.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  EXPECT_CALL(r1.decoder_, decodeHeaders_(_, true));
+  r1.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+  ActiveTestRequest r5(*this, 0);
+
+  // Both clients are busy, and no more are allowed, so the first of the least loaded takes it.
+  ActiveTestRequest r6(*this, 0);
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_total_.value());
+
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_CALL(*this, onClientDestroy()).Times(2);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Verify that a client above its write buffer high watermark gets a sibling.
+ */
+TEST_F(Http2ConnPoolImplTest, MultipleClientsWatermark) {
+  InSequence s;
+  pool_.max_active_clients_ = 2;
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0);
+  expectClientConnect(0);
+
+  test_clients_[0].connection_->runHighWatermarkCallbacks();
+  expectClientCreate();
+  ActiveTestRequest r2(*this, 1);
+  expectClientConnect(1);
+
+  // Client 0 takes streams again once it is below its low watermark.
+  test_clients_[0].connection_->runLowWatermarkCallbacks();
+  ActiveTestRequest r3(*this, 0);
+
+  // Draining waits for the streams of both clients.
+  ReadyWatcher drained;
+  pool_.drainConnections();
+  pool_.addDrainedCallback([&]() -> void { drained.ready(); });
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_CALL(drained, ready());
+  test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_CALL(*this, onClientDestroy()).Times(2);
+  dispatcher_.clearDeferredDeleteList();
+}
+
 } // namespace Http2
 } // namespace Http
 } // namespace Envoy
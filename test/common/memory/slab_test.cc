@@ -0,0 +1,137 @@
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "common/memory/slab.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Memory {
+
+TEST(SlabTest, ReuseFreedBlock) {
+  const uint64_t allocations = Slab::totalAllocations();
+  const uint64_t heap_allocations = Slab::totalHeapAllocations();
+
+  void* block1 = Slab::allocate(100);
+  Slab::free(block1, 100);
+  // Sizes that round up to the same block size share a free list.
+  void* block2 = Slab::allocate(120);
+  EXPECT_EQ(block1, block2);
+  void* block3 = Slab::allocate(120);
+  EXPECT_NE(block2, block3);
+  Slab::free(block2, 120);
+  Slab::free(block3, 120);
+
+  EXPECT_EQ(allocations + 3, Slab::totalAllocations());
+  EXPECT_LE(heap_allocations + 1, Slab::totalHeapAllocations());
+  EXPECT_GE(heap_allocations + 2, Slab::totalHeapAllocations());
+}
+
+TEST(SlabTest, LargeBlock) {
+  const uint64_t heap_allocations = Slab::totalHeapAllocations();
+  void* block1 = Slab::allocate(Slab::MAX_BLOCK_SIZE + 1);
+  Slab::free(block1, Slab::MAX_BLOCK_SIZE + 1);
+  void* block2 = Slab::allocate(Slab::MAX_BLOCK_SIZE + 1);
+  Slab::free(block2, Slab::MAX_BLOCK_SIZE + 1);
+  EXPECT_EQ(heap_allocations + 2, Slab::totalHeapAllocations());
+}
+
+TEST(SlabTest, MaxCachedBlocks) {
+  std::vector<void*> blocks;
+  for (uint32_t i = 0; i < Slab::MAX_CACHED_BLOCKS + 1; i++) {
+    blocks.push_back(Slab::allocate(1000));
+  }
+  for (void* block : blocks) {
+    Slab::free(block, 1000);
+  }
+
+  // Only MAX_CACHED_BLOCKS blocks were kept.
+  const uint64_t heap_allocations = Slab::totalHeapAllocations();
+  for (void*& block : blocks) {
+    block = Slab::allocate(1000);
+  }
+  EXPECT_EQ(heap_allocations + 1, Slab::totalHeapAllocations());
+  for (void* block : blocks) {
+    Slab::free(block, 1000);
+  }
+}
+
+// A thread's counts outlive it, and blocks allocated by one thread can be freed by another.
+TEST(SlabTest, Threads) {
+  const uint64_t allocations = Slab::totalAllocations();
+  void* block = nullptr;
+  std::thread thread([&block]() -> void { block = Slab::allocate(200); });
+  thread.join();
+  EXPECT_EQ(allocations + 1, Slab::totalAllocations());
+
+  Slab::free(block, 200);
+  EXPECT_EQ(block, Slab::allocate(200));
+  Slab::free(block, 200);
+}
+
+namespace {
+
+// Allocates a block from its destructor. Constructed before its thread's cache, it is destroyed
+// after the cache, so the block comes straight from the heap.
+class LateAllocator {
+public:
+  ~LateAllocator() { *block_ = Slab::allocate(40); }
+
+  void** block_{};
+};
+
+} // namespace
+
+// A block that is allocated after the thread's cache is gone is still the size of the free list
+// blocks that it may be freed onto.
+TEST(SlabTest, AllocateAfterThreadCache) {
+  void* block = nullptr;
+  std::thread thread([&block]() -> void {
+    static thread_local LateAllocator allocator;
+    allocator.block_ = &block;
+    Slab::free(Slab::allocate(40), 40);
+  });
+  thread.join();
+  ASSERT_NE(nullptr, block);
+
+  Slab::free(block, 40);
+  void* reused = Slab::allocate(64);
+  EXPECT_EQ(block, reused);
+  memset(reused, 0, 64);
+  Slab::free(reused, 64);
+}
+
+namespace {
+
+class Base : public SlabAllocated {
+public:
+  virtual ~Base() {}
+
+  uint64_t value_{};
+};
+
+class Derived : public Base {
+public:
+  char padding_[500];
+};
+
+} // namespace
+
+TEST(SlabTest, SlabAllocated) {
+  const uint64_t allocations = Slab::totalAllocations();
+  Base* derived = new Derived();
+  delete derived;
+  // The derived object's block went back to the free list for its own size.
+  void* block = Slab::allocate(sizeof(Derived));
+  EXPECT_EQ(static_cast<void*>(derived), block);
+  Slab::free(block, sizeof(Derived));
+
+  std::unique_ptr<Base> base(new Base());
+  EXPECT_EQ(allocations + 3, Slab::totalAllocations());
+}
+
+} // namespace Memory
+} // namespace Envoy
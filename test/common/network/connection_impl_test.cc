@@ -1,3 +1,5 @@
+#include <sys/socket.h>
+
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -31,6 +33,7 @@ using testing::DoAll;
 using testing::InSequence;
 using testing::Invoke;
 using testing::InvokeWithoutArgs;
+using testing::NiceMock;
 using testing::Return;
 using testing::SaveArg;
 using testing::Sequence;
@@ -155,6 +158,38 @@ public:
         }));
   }
 
+  // Connect a second client to the listener, which the server side of the first connection can be
+  // spliced to, so that data written by the first client is read by splice_receiver_.
+  void connectSpliceDestination() {
+    splice_destination_ = dispatcher_->createClientConnection(
+        socket_.localAddress(), source_address_, Network::Test::createRawBufferSocket());
+    splice_destination_->addConnectionCallbacks(splice_destination_callbacks_);
+    splice_destination_->connect();
+    splice_receiver_filter_.reset(new NiceMock<MockReadFilter>());
+    int expected_callbacks = 2;
+    EXPECT_CALL(listener_callbacks_, onNewConnection_(_))
+        .WillOnce(Invoke([&](Network::ConnectionPtr& conn) -> void {
+          splice_receiver_ = std::move(conn);
+          splice_receiver_->addReadFilter(splice_receiver_filter_);
+          if (--expected_callbacks == 0) {
+            dispatcher_->exit();
+          }
+        }));
+    EXPECT_CALL(splice_destination_callbacks_, onEvent(ConnectionEvent::Connected))
+        .WillOnce(Invoke([&](Network::ConnectionEvent) -> void {
+          if (--expected_callbacks == 0) {
+            dispatcher_->exit();
+          }
+        }));
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+  }
+
+  void disconnectSpliceDestination() {
+    EXPECT_CALL(splice_destination_callbacks_, onEvent(ConnectionEvent::LocalClose));
+    splice_destination_->close(ConnectionCloseType::NoFlush);
+    splice_receiver_->close(ConnectionCloseType::NoFlush);
+  }
+
 protected:
   Event::DispatcherPtr dispatcher_;
   Stats::IsolatedStoreImpl stats_store_;
@@ -169,6 +204,10 @@ protected:
   std::shared_ptr<MockReadFilter> read_filter_;
   MockWatermarkBuffer* client_write_buffer_ = nullptr;
   Address::InstanceConstSharedPtr source_address_;
+  Network::ClientConnectionPtr splice_destination_;
+  StrictMock<MockConnectionCallbacks> splice_destination_callbacks_;
+  Network::ConnectionPtr splice_receiver_;
+  std::shared_ptr<MockReadFilter> splice_receiver_filter_;
 };
 
 INSTANTIATE_TEST_CASE_P(IpVersions, ConnectionImplTest,
@@ -268,6 +307,106 @@ TEST_P(ConnectionImplTest, ConnectionStats) {
   dispatcher_->run(Event::Dispatcher::RunType::Block);
 }
 
+#ifdef __linux__
+// Data read from a connection that is spliced to another connection is sent by the other connection
+// without passing through either connection's filters, and is still accounted for in the stats.
+TEST_P(ConnectionImplTest, Splice) {
+  setUpBasicConnection();
+  connect();
+  connectSpliceDestination();
+  ClientConnectionPtr& destination = splice_destination_;
+
+  server_connection_->setConnectionStats({stats_store_.counter("source.rx_total"),
+                                          stats_store_.gauge("source.rx_buffered"),
+                                          stats_store_.counter("source.tx_total"),
+                                          stats_store_.gauge("source.tx_buffered"), nullptr});
+  destination->setConnectionStats({stats_store_.counter("destination.rx_total"),
+                                   stats_store_.gauge("destination.rx_buffered"),
+                                   stats_store_.counter("destination.tx_total"),
+                                   stats_store_.gauge("destination.tx_buffered"), nullptr});
+  uint64_t bytes_sent = 0;
+  destination->addBytesSentCallback([&](uint64_t bytes) -> void { bytes_sent += bytes; });
+
+  EXPECT_FALSE(server_connection_->spliceTo(*server_connection_));
+  EXPECT_TRUE(server_connection_->spliceTo(*destination));
+  EXPECT_FALSE(server_connection_->spliceTo(*destination));
+
+  const std::string payload(256 * 1024, 'a');
+  std::string received;
+  EXPECT_CALL(*read_filter_, onData(_)).Times(0);
+  EXPECT_CALL(*splice_receiver_filter_, onData(_))
+      .WillRepeatedly(Invoke([&](Buffer::Instance& data) -> FilterStatus {
+        received += TestUtility::bufferToString(data);
+        data.drain(data.length());
+        if (received.size() == payload.size()) {
+          dispatcher_->exit();
+        }
+        return FilterStatus::StopIteration;
+      }));
+
+  Buffer::OwnedImpl data(payload);
+  client_connection_->write(data);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  EXPECT_EQ(payload, received);
+  EXPECT_EQ(payload.size(), bytes_sent);
+  EXPECT_EQ(payload.size(), stats_store_.counter("source.rx_total").value());
+  EXPECT_EQ(0, stats_store_.gauge("source.rx_buffered").value());
+  EXPECT_EQ(payload.size(), stats_store_.counter("destination.tx_total").value());
+  EXPECT_EQ(0, stats_store_.gauge("destination.tx_buffered").value());
+
+  disconnectSpliceDestination();
+  disconnect(true);
+}
+
+// Data that arrives in many small segments while the destination is blocked fills up all of the
+// pipe's buffers before the pipe is full. The source reads the rest once the destination drains
+// the pipe.
+TEST_P(ConnectionImplTest, SpliceManySmallWrites) {
+  setUpBasicConnection();
+  connect();
+  connectSpliceDestination();
+  EXPECT_TRUE(server_connection_->spliceTo(*splice_destination_));
+
+  // Block the destination with small socket buffers and a receiver that doesn't read.
+  const int buffer_size = 4096;
+  ConnectionImpl& destination = dynamic_cast<ConnectionImpl&>(*splice_destination_);
+  ConnectionImpl& receiver = dynamic_cast<ConnectionImpl&>(*splice_receiver_);
+  EXPECT_EQ(0, setsockopt(destination.fd(), SOL_SOCKET, SO_SNDBUF, &buffer_size,
+                          sizeof(buffer_size)));
+  EXPECT_EQ(0,
+            setsockopt(receiver.fd(), SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size)));
+  splice_receiver_->readDisable(true);
+
+  // Each write goes out as a segment of its own.
+  const uint32_t writes = 2000;
+  client_connection_->noDelay(true);
+  for (uint32_t i = 0; i < writes; i++) {
+    Buffer::OwnedImpl data("a");
+    client_connection_->write(data);
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+
+  uint64_t received = 0;
+  EXPECT_CALL(*read_filter_, onData(_)).Times(0);
+  EXPECT_CALL(*splice_receiver_filter_, onData(_))
+      .WillRepeatedly(Invoke([&](Buffer::Instance& data) -> FilterStatus {
+        received += data.length();
+        data.drain(data.length());
+        if (received == writes) {
+          dispatcher_->exit();
+        }
+        return FilterStatus::StopIteration;
+      }));
+  splice_receiver_->readDisable(false);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_EQ(writes, received);
+
+  disconnectSpliceDestination();
+  disconnect(true);
+}
+#endif
+
 // Ensure the new counter logic in ReadDisable avoids tripping asserts in ReadDisable guarding
 // against actual enabling twice in a row.
 TEST_P(ConnectionImplTest, ReadDisable) {
@@ -0,0 +1,103 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/network/address_impl.h"
+#include "common/network/cidr_range.h"
+#include "common/network/lc_trie.h"
+#include "common/network/utility.h"
+
+#include "fmt/format.h"
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Network {
+
+// Builds a trie of prefix_count random IPv4 prefixes between /8 and /32, a tenth of which are
+// nested inside 10.0.0.0/8, and fills addresses with a lookup set of configured and random
+// addresses.
+static std::unique_ptr<LcTrie::LcTrie>
+buildTrie(uint32_t prefix_count, std::vector<Address::InstanceConstSharedPtr>& addresses) {
+  std::mt19937 random(prefix_count);
+  std::vector<std::pair<std::string, std::vector<Address::CidrRange>>> tag_data(16);
+  for (uint32_t i = 0; i < tag_data.size(); i++) {
+    tag_data[i].first = fmt::format("tag_{}", i);
+  }
+
+  for (uint32_t i = 0; i < prefix_count; i++) {
+    const uint32_t first_octet = i % 10 == 0 ? 10 : random() % 256;
+    const std::string address =
+        fmt::format("{}.{}.{}.{}", first_octet, random() % 256, random() % 256, random() % 256);
+    tag_data[i % tag_data.size()].second.push_back(
+        Address::CidrRange::create(address, 8 + random() % 25));
+    if (addresses.size() < 1024) {
+      addresses.push_back(Utility::parseInternetAddress(address));
+      addresses.push_back(Utility::parseInternetAddress(fmt::format(
+          "{}.{}.{}.{}", random() % 256, random() % 256, random() % 256, random() % 256)));
+    }
+  }
+
+  return std::unique_ptr<LcTrie::LcTrie>(new LcTrie::LcTrie(tag_data));
+}
+
+static void BM_LcTrieLookup(benchmark::State& state) {
+  std::vector<Address::InstanceConstSharedPtr> addresses;
+  std::unique_ptr<LcTrie::LcTrie> trie = buildTrie(state.range(0), addresses);
+  size_t i = 0;
+  size_t output_length = 0;
+  while (state.KeepRunning()) {
+    output_length += trie->getTags(*addresses[i++ % addresses.size()]).size();
+  }
+  benchmark::DoNotOptimize(output_length);
+}
+BENCHMARK(BM_LcTrieLookup)->RangeMultiplier(8)->Range(8, 1 << 18);
+
+// The linear scan that the trie replaces, for comparison.
+static void BM_LinearScanLookup(benchmark::State& state) {
+  std::vector<Address::InstanceConstSharedPtr> addresses;
+  std::mt19937 random(state.range(0));
+  std::vector<Address::CidrRange> ranges;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    ranges.push_back(Address::CidrRange::create(
+        fmt::format("{}.{}.{}.{}", random() % 256, random() % 256, random() % 256, random() % 256),
+        8 + random() % 25));
+    if (addresses.size() < 1024) {
+      addresses.push_back(Utility::parseInternetAddress(fmt::format(
+          "{}.{}.{}.{}", random() % 256, random() % 256, random() % 256, random() % 256)));
+    }
+  }
+  size_t i = 0;
+  size_t hits = 0;
+  while (state.KeepRunning()) {
+    const Address::Instance& address = *addresses[i++ % addresses.size()];
+    for (const Address::CidrRange& range : ranges) {
+      hits += range.isInRange(address);
+    }
+  }
+  benchmark::DoNotOptimize(hits);
+}
+BENCHMARK(BM_LinearScanLookup)->RangeMultiplier(8)->Range(8, 1 << 12);
+
+static void BM_LcTrieBuild(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    std::vector<Address::InstanceConstSharedPtr> addresses;
+    benchmark::DoNotOptimize(buildTrie(state.range(0), addresses));
+  }
+}
+BENCHMARK(BM_LcTrieBuild)->RangeMultiplier(8)->Range(8, 1 << 18)->Unit(benchmark::kMillisecond);
+
+} // namespace Network
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
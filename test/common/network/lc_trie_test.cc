@@ -0,0 +1,158 @@
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/utility.h"
+#include "common/network/address_impl.h"
+#include "common/network/cidr_range.h"
+#include "common/network/lc_trie.h"
+#include "common/network/utility.h"
+
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Network {
+namespace LcTrie {
+
+class LcTrieTest : public testing::Test {
+public:
+  void setup(const std::vector<std::pair<std::string, std::vector<std::string>>>& tags,
+             double fill_factor = 0.5, uint32_t root_branching_factor = 0) {
+    std::vector<std::pair<std::string, std::vector<Address::CidrRange>>> tag_data;
+    for (const auto& tag : tags) {
+      std::vector<Address::CidrRange> ranges;
+      for (const std::string& range : tag.second) {
+        ranges.push_back(Address::CidrRange::create(range));
+      }
+      tag_data.emplace_back(tag.first, ranges);
+    }
+    trie_.reset(new LcTrie(tag_data, fill_factor, root_branching_factor));
+  }
+
+  const std::string& tags(const std::string& address) {
+    return trie_->getTags(*Utility::parseInternetAddress(address));
+  }
+
+  std::unique_ptr<LcTrie> trie_;
+};
+
+TEST_F(LcTrieTest, Empty) {
+  setup({});
+  EXPECT_EQ("", tags("1.2.3.4"));
+  EXPECT_EQ("", tags("::1"));
+}
+
+TEST_F(LcTrieTest, Ipv4) {
+  setup({{"tag_a", {"10.0.0.0/8"}},
+         {"tag_b", {"192.168.0.0/16", "172.16.0.0/12"}},
+         {"tag_c", {"1.2.3.4/32"}},
+         {"tag_d", {"0.0.0.0/0"}}});
+
+  EXPECT_EQ("tag_a,tag_d", tags("10.255.1.1"));
+  EXPECT_EQ("tag_b,tag_d", tags("192.168.5.6"));
+  EXPECT_EQ("tag_b,tag_d", tags("172.31.255.255"));
+  EXPECT_EQ("tag_d", tags("172.32.0.0"));
+  EXPECT_EQ("tag_c,tag_d", tags("1.2.3.4"));
+  EXPECT_EQ("tag_d", tags("1.2.3.5"));
+  EXPECT_EQ("", tags("::1"));
+}
+
+TEST_F(LcTrieTest, Ipv6) {
+  setup({{"tag_a", {"2001:db8::/32"}}, {"tag_b", {"2001:db8:0:1::/64"}}, {"tag_c", {"::1/128"}}});
+
+  EXPECT_EQ("tag_a", tags("2001:db8:ffff::1"));
+  EXPECT_EQ("tag_a,tag_b", tags("2001:db8:0:1::8"));
+  EXPECT_EQ("tag_c", tags("::1"));
+  EXPECT_EQ("", tags("::2"));
+  EXPECT_EQ("", tags("2001:db9::"));
+  EXPECT_EQ("", tags("1.2.3.4"));
+}
+
+TEST_F(LcTrieTest, NestedAndDuplicateRanges) {
+  setup({{"outer", {"10.0.0.0/8"}},
+         {"middle", {"10.1.0.0/16", "10.0.0.0/8"}},
+         {"inner", {"10.1.1.0/24"}},
+         {"sibling", {"10.2.0.0/16"}}});
+
+  EXPECT_EQ("outer,middle,inner", tags("10.1.1.1"));
+  EXPECT_EQ("outer,middle", tags("10.1.2.1"));
+  EXPECT_EQ("outer,middle,sibling", tags("10.2.2.2"));
+  EXPECT_EQ("outer,middle", tags("10.3.0.0"));
+  EXPECT_EQ("", tags("11.0.0.0"));
+}
+
+TEST_F(LcTrieTest, TagIndexes) {
+  setup({{"outer", {"10.0.0.0/8"}}, {"unused", {}}, {"inner", {"10.1.0.0/16"}}});
+
+  const auto tag_indexes = [this](const std::string& address) -> std::vector<uint32_t> {
+    return trie_->getTagIndexes(*Utility::parseInternetAddress(address));
+  };
+  EXPECT_EQ((std::vector<uint32_t>{0, 2}), tag_indexes("10.1.1.1"));
+  EXPECT_EQ((std::vector<uint32_t>{0}), tag_indexes("10.2.1.1"));
+  EXPECT_EQ((std::vector<uint32_t>{}), tag_indexes("11.0.0.0"));
+  EXPECT_EQ((std::vector<uint32_t>{}), tag_indexes("::1"));
+}
+
+TEST_F(LcTrieTest, BadFillFactor) {
+  EXPECT_THROW(setup({}, 0.0), EnvoyException);
+  EXPECT_THROW(setup({}, 1.5), EnvoyException);
+}
+
+// Compares the trie against a linear scan of CidrRange::isInRange() for random tables, across
+// fill factors and root branching factors.
+TEST_F(LcTrieTest, RandomizedAgainstLinearScan) {
+  std::mt19937 random(1);
+  for (double fill_factor : {0.25, 0.5, 1.0}) {
+    for (uint32_t root_branching_factor : {0U, 4U, 16U}) {
+      std::vector<std::pair<std::string, std::vector<std::string>>> tag_config;
+      std::vector<std::pair<uint32_t, Address::CidrRange>> ranges;
+      for (uint32_t tag = 0; tag < 8; tag++) {
+        tag_config.emplace_back(fmt::format("tag_{}", tag), std::vector<std::string>());
+        for (uint32_t i = 0; i < 200; i++) {
+          // Cluster the ranges into 10.0.0.0/12 and 2001:db8::/44 so that they nest.
+          std::string range;
+          if (random() % 2 == 0) {
+            range = fmt::format("10.{}.{}.{}/{}", random() % 16, random() % 256, random() % 256,
+                                8 + random() % 25);
+          } else {
+            range = fmt::format("2001:db8:{:x}:{:x}::/{}", random() % 16, random() % 65536,
+                                24 + random() % 57);
+          }
+          tag_config.back().second.push_back(range);
+          ranges.emplace_back(tag, Address::CidrRange::create(range));
+        }
+      }
+      setup(tag_config, fill_factor, root_branching_factor);
+
+      for (uint32_t i = 0; i < 2000; i++) {
+        const std::string address_string =
+            random() % 2 == 0
+                ? fmt::format("10.{}.{}.{}", random() % 16, random() % 256, random() % 256)
+                : fmt::format("2001:db8:{:x}:{:x}::{:x}", random() % 16, random() % 65536,
+                              random() % 65536);
+        Address::InstanceConstSharedPtr address = Utility::parseInternetAddress(address_string);
+        std::vector<bool> hit(tag_config.size());
+        for (const auto& range : ranges) {
+          if (range.second.isInRange(*address)) {
+            hit[range.first] = true;
+          }
+        }
+        std::vector<std::string> expected;
+        for (uint32_t tag = 0; tag < hit.size(); tag++) {
+          if (hit[tag]) {
+            expected.push_back(tag_config[tag].first);
+          }
+        }
+        EXPECT_EQ(StringUtil::join(expected, ","), trie_->getTags(*address)) << address_string;
+      }
+    }
+  }
+}
+
+} // namespace LcTrie
+} // namespace Network
+} // namespace Envoy
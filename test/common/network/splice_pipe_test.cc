@@ -0,0 +1,99 @@
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "common/network/splice_pipe.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Network {
+
+#ifdef __linux__
+class SplicePipeTest : public testing::Test {
+public:
+  SplicePipeTest() {
+    EXPECT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, source_));
+    EXPECT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, destination_));
+  }
+
+  ~SplicePipeTest() {
+    for (int fd : {source_[0], source_[1], destination_[0], destination_[1]}) {
+      ::close(fd);
+    }
+  }
+
+  int source_[2];
+  int destination_[2];
+};
+
+TEST_F(SplicePipeTest, FillAndDrain) {
+  SplicePipePtr pipe = SplicePipe::create(0);
+  ASSERT_NE(nullptr, pipe);
+
+  // Nothing to read yet.
+  EXPECT_EQ(-1, pipe->fill(source_[1]));
+  EXPECT_EQ(EAGAIN, errno);
+
+  const std::string data("hello world");
+  EXPECT_EQ(data.size(), ::write(source_[0], data.data(), data.size()));
+  EXPECT_EQ(data.size(), pipe->fill(source_[1]));
+  EXPECT_EQ(data.size(), pipe->length());
+  EXPECT_FALSE(pipe->full());
+
+  EXPECT_EQ(data.size(), pipe->drain(destination_[0]));
+  EXPECT_EQ(0, pipe->length());
+  char buffer[64];
+  EXPECT_EQ(data.size(), ::read(destination_[1], buffer, sizeof(buffer)));
+  EXPECT_EQ(data, std::string(buffer, data.size()));
+
+  // The peer closing the socket reads as 0, as with read(2).
+  ::shutdown(source_[0], SHUT_WR);
+  EXPECT_EQ(0, pipe->fill(source_[1]));
+}
+
+// The pipe stops taking data once it reaches its capacity.
+TEST_F(SplicePipeTest, Full) {
+  SplicePipePtr pipe = SplicePipe::create(4096);
+  ASSERT_NE(nullptr, pipe);
+
+  const std::string data(16384, 'a');
+  EXPECT_EQ(data.size(), ::write(source_[0], data.data(), data.size()));
+  while (!pipe->full()) {
+    EXPECT_LT(0, pipe->fill(source_[1]));
+  }
+  EXPECT_GE(data.size(), pipe->length());
+
+  const uint64_t length = pipe->length();
+  EXPECT_EQ(length, pipe->drain(destination_[0]));
+  EXPECT_FALSE(pipe->full());
+}
+// Each small write takes a pipe buffer of its own, so the pipe runs out of buffers while it still
+// has room, and only takes more data once it is drained.
+TEST_F(SplicePipeTest, ManySmallWrites) {
+  SplicePipePtr pipe = SplicePipe::create(0);
+  ASSERT_NE(nullptr, pipe);
+
+  const uint32_t writes = 100;
+  for (uint32_t i = 0; i < writes; i++) {
+    EXPECT_EQ(1, ::write(source_[0], "a", 1));
+  }
+  while (pipe->fill(source_[1]) > 0) {
+  }
+  EXPECT_EQ(EAGAIN, errno);
+  EXPECT_TRUE(pipe->fillBlocked());
+  EXPECT_FALSE(pipe->full());
+  EXPECT_GT(writes, pipe->length());
+
+  const uint64_t length = pipe->length();
+  EXPECT_EQ(length, pipe->drain(destination_[0]));
+  EXPECT_LT(0, pipe->fill(source_[1]));
+  EXPECT_FALSE(pipe->fillBlocked());
+}
+#else
+TEST(SplicePipeTest, Unsupported) { EXPECT_EQ(nullptr, SplicePipe::create(0)); }
+#endif
+
+} // namespace Network
+} // namespace Envoy
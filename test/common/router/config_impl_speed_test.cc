@@ -0,0 +1,295 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management. When built with tcmalloc, each
+// benchmark also reports the number of heap allocations per lookup as allocs_per_lookup.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/router/config_impl.h"
+#include "common/stats/stats_impl.h"
+
+#include "test/mocks/runtime/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "api/rds.pb.h"
+#include "fmt/format.h"
+#include "testing/base/public/benchmark.h"
+
+#ifdef TCMALLOC
+#include "gperftools/malloc_hook.h"
+#endif
+
+namespace Envoy {
+namespace Router {
+
+// Counts the heap allocations made while it is alive. Only available with tcmalloc.
+class AllocationCounter {
+public:
+#ifdef TCMALLOC
+  AllocationCounter() {
+    count_ = 0;
+    MallocHook::AddNewHook(&onNew);
+  }
+  ~AllocationCounter() { MallocHook::RemoveNewHook(&onNew); }
+
+  void report(benchmark::State& state) {
+    state.counters["allocs_per_lookup"] = static_cast<double>(count_) / state.iterations();
+  }
+
+private:
+  static void onNew(const void*, size_t) { count_++; }
+
+  static uint64_t count_;
+#else
+  void report(benchmark::State&) {}
+#endif
+};
+
+#ifdef TCMALLOC
+uint64_t AllocationCounter::count_;
+#endif
+
+// Looks up routes for requests in a round robin fashion until the benchmark is done, and reports
+// the allocations made by the lookups.
+static void routeLookups(benchmark::State& state, const ConfigImpl& config,
+                         const std::vector<Http::TestHeaderMapImpl>& requests) {
+  size_t i = 0;
+  size_t matched = 0;
+  AllocationCounter allocations;
+  while (state.KeepRunning()) {
+    matched += config.route(requests[i++ % requests.size()], 0) != nullptr;
+  }
+  allocations.report(state);
+  benchmark::DoNotOptimize(matched);
+}
+
+// Builds a single virtual host with route_count regex routes. If std_regex_only is set, every
+// expression ends in an empty lookahead, which std::regex accepts but RE2 does not, so each route
+// falls back to being matched on its own with std::regex as all regex routes were before RE2.
+static envoy::api::v2::RouteConfiguration buildRegexRouteConfig(uint32_t route_count,
+                                                                bool std_regex_only) {
+  envoy::api::v2::RouteConfiguration route_config;
+  envoy::api::v2::VirtualHost* virtual_host = route_config.add_virtual_hosts();
+  virtual_host->set_name("regex");
+  virtual_host->add_domains("*");
+  for (uint32_t i = 0; i < route_count; i++) {
+    envoy::api::v2::Route* route = virtual_host->add_routes();
+    route->mutable_match()->set_regex(
+        fmt::format("/api/v[0-9]+/service{}/[a-z]+/[0-9]+{}", i, std_regex_only ? "(?=)" : ""));
+    route->mutable_route()->set_cluster(fmt::format("cluster{}", i));
+  }
+  return route_config;
+}
+
+static void regexRouteLookup(benchmark::State& state, bool std_regex_only) {
+  const uint32_t route_count = state.range(0);
+  testing::NiceMock<Runtime::MockLoader> runtime;
+  testing::NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(buildRegexRouteConfig(route_count, std_regex_only), runtime, cm, stats, false);
+
+  // Half of the requests match the last route, the other half match no route at all.
+  std::vector<Http::TestHeaderMapImpl> requests;
+  requests.push_back(Http::TestHeaderMapImpl{
+      {":authority", "www.lyft.com"},
+      {":path", fmt::format("/api/v1/service{}/users/1234?foo=bar", route_count - 1)},
+      {":method", "GET"}});
+  requests.push_back(Http::TestHeaderMapImpl{{":authority", "www.lyft.com"},
+                                             {":path", "/api/v1/unknown/users/1234"},
+                                             {":method", "GET"}});
+
+  routeLookups(state, config, requests);
+}
+
+static void BM_RegexSetRouteLookup(benchmark::State& state) { regexRouteLookup(state, false); }
+BENCHMARK(BM_RegexSetRouteLookup)->RangeMultiplier(4)->Range(1, 1024);
+
+static void BM_StdRegexRouteLookup(benchmark::State& state) { regexRouteLookup(state, true); }
+BENCHMARK(BM_StdRegexRouteLookup)->RangeMultiplier(4)->Range(1, 1024);
+
+// Builds a single virtual host with route_count routes in the shape of a large service mesh
+// configuration: for every service an exact health check path, a header matched canary prefix and
+// a plain prefix, followed by a catch-all route.
+static envoy::api::v2::RouteConfiguration buildLargeRouteConfig(uint32_t route_count) {
+  envoy::api::v2::RouteConfiguration route_config;
+  envoy::api::v2::VirtualHost* virtual_host = route_config.add_virtual_hosts();
+  virtual_host->set_name("large");
+  virtual_host->add_domains("*");
+  for (uint32_t i = 0; i < route_count / 3; i++) {
+    envoy::api::v2::Route* health_route = virtual_host->add_routes();
+    health_route->mutable_match()->set_path(fmt::format("/service{}/healthcheck", i));
+    health_route->mutable_route()->set_cluster(fmt::format("health{}", i));
+
+    envoy::api::v2::Route* canary_route = virtual_host->add_routes();
+    canary_route->mutable_match()->set_prefix(fmt::format("/service{}/", i));
+    envoy::api::v2::HeaderMatcher* header = canary_route->mutable_match()->add_headers();
+    header->set_name("x-canary");
+    header->set_value("true");
+    canary_route->mutable_route()->set_cluster(fmt::format("canary{}", i));
+
+    envoy::api::v2::Route* route = virtual_host->add_routes();
+    route->mutable_match()->set_prefix(fmt::format("/service{}/", i));
+    route->mutable_route()->set_cluster(fmt::format("service{}", i));
+  }
+  envoy::api::v2::Route* catch_all = virtual_host->add_routes();
+  catch_all->mutable_match()->set_prefix("/");
+  catch_all->mutable_route()->set_cluster("default");
+  return route_config;
+}
+
+// Measures route() latency against a large virtual host, for requests spread over all services.
+static void BM_LargeVirtualHostRouteLookup(benchmark::State& state) {
+  const uint32_t route_count = state.range(0);
+  testing::NiceMock<Runtime::MockLoader> runtime;
+  testing::NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(buildLargeRouteConfig(route_count), runtime, cm, stats, false);
+
+  std::vector<Http::TestHeaderMapImpl> requests;
+  for (uint32_t i = 0; i < 1024; i++) {
+    const uint32_t service = (i * 7919) % (route_count / 3);
+    requests.push_back(Http::TestHeaderMapImpl{
+        {":authority", "www.lyft.com"},
+        {":path", i % 4 == 0 ? fmt::format("/service{}/healthcheck", service)
+                             : fmt::format("/service{}/users/{}?limit=10", service, i)},
+        {":method", "GET"}});
+  }
+
+  routeLookups(state, config, requests);
+}
+BENCHMARK(BM_LargeVirtualHostRouteLookup)->RangeMultiplier(4)->Range(3, 3 << 10);
+
+// Builds vhost_count virtual hosts with an exact domain, vhost_count virtual hosts with a wildcard
+// suffix domain and a default virtual host. The wildcard suffixes have min(vhost_count,
+// suffix_lengths) distinct lengths, which is what findWildcardVirtualHost() iterates over.
+static envoy::api::v2::RouteConfiguration buildVirtualHostConfig(uint32_t vhost_count,
+                                                                 uint32_t suffix_lengths) {
+  envoy::api::v2::RouteConfiguration route_config;
+  for (uint32_t i = 0; i < vhost_count; i++) {
+    envoy::api::v2::VirtualHost* exact = route_config.add_virtual_hosts();
+    exact->set_name(fmt::format("exact{}", i));
+    exact->add_domains(fmt::format("service{}.example.com", i));
+    envoy::api::v2::Route* exact_route = exact->add_routes();
+    exact_route->mutable_match()->set_prefix("/");
+    exact_route->mutable_route()->set_cluster(fmt::format("exact{}", i));
+
+    envoy::api::v2::VirtualHost* wildcard = route_config.add_virtual_hosts();
+    wildcard->set_name(fmt::format("wildcard{}", i));
+    wildcard->add_domains(
+        fmt::format("*.{}{:06}.example.com", std::string(i % suffix_lengths, 'z'), i));
+    envoy::api::v2::Route* wildcard_route = wildcard->add_routes();
+    wildcard_route->mutable_match()->set_prefix("/");
+    wildcard_route->mutable_route()->set_cluster(fmt::format("wildcard{}", i));
+  }
+  envoy::api::v2::VirtualHost* default_vhost = route_config.add_virtual_hosts();
+  default_vhost->set_name("default");
+  default_vhost->add_domains("*");
+  envoy::api::v2::Route* default_route = default_vhost->add_routes();
+  default_route->mutable_match()->set_prefix("/");
+  default_route->mutable_route()->set_cluster("default");
+  return route_config;
+}
+
+// Measures virtual host selection, with a third of the requests each going to an exact domain, a
+// wildcard domain and the default virtual host.
+static void virtualHostLookup(benchmark::State& state, uint32_t vhost_count,
+                              uint32_t suffix_lengths) {
+  testing::NiceMock<Runtime::MockLoader> runtime;
+  testing::NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(buildVirtualHostConfig(vhost_count, suffix_lengths), runtime, cm, stats, false);
+
+  std::vector<Http::TestHeaderMapImpl> requests;
+  for (uint32_t i = 0; i < 1023; i++) {
+    const uint32_t vhost = (i * 7919) % vhost_count;
+    std::string authority;
+    switch (i % 3) {
+    case 0:
+      authority = fmt::format("service{}.example.com", vhost);
+      break;
+    case 1:
+      authority = fmt::format("api.{}{:06}.example.com", std::string(vhost % suffix_lengths, 'z'),
+                              vhost);
+      break;
+    default:
+      authority = fmt::format("unknown{}.example.org", vhost);
+      break;
+    }
+    requests.push_back(
+        Http::TestHeaderMapImpl{{":authority", authority}, {":path", "/"}, {":method", "GET"}});
+  }
+
+  routeLookups(state, config, requests);
+}
+
+// Grows the number of virtual hosts, with a fixed number of distinct wildcard suffix lengths.
+static void BM_VirtualHostLookup(benchmark::State& state) {
+  virtualHostLookup(state, state.range(0), 4);
+}
+BENCHMARK(BM_VirtualHostLookup)->RangeMultiplier(4)->Range(1, 4096);
+
+// Grows the number of distinct wildcard suffix lengths, with one virtual host per length. This is
+// what the choice of container for wildcard_virtual_host_suffixes_ was based on.
+static void BM_WildcardSuffixLengths(benchmark::State& state) {
+  virtualHostLookup(state, state.range(0), state.range(0));
+}
+BENCHMARK(BM_WildcardSuffixLengths)->DenseRange(1, 8)->Arg(16)->Arg(64);
+
+// Builds a single virtual host with route_count routes that all match any path, each with an
+// exact, a regex and a presence header matcher. Only the last route's headers match the requests
+// of BM_HeaderMatcherRouteLookup, so every route's header matchers are evaluated.
+static envoy::api::v2::RouteConfiguration buildHeaderRouteConfig(uint32_t route_count) {
+  envoy::api::v2::RouteConfiguration route_config;
+  envoy::api::v2::VirtualHost* virtual_host = route_config.add_virtual_hosts();
+  virtual_host->set_name("headers");
+  virtual_host->add_domains("*");
+  for (uint32_t i = 0; i < route_count; i++) {
+    envoy::api::v2::Route* route = virtual_host->add_routes();
+    route->mutable_match()->set_prefix("/");
+    envoy::api::v2::HeaderMatcher* presence = route->mutable_match()->add_headers();
+    presence->set_name("x-tenant");
+    envoy::api::v2::HeaderMatcher* regex = route->mutable_match()->add_headers();
+    regex->set_name("x-version");
+    regex->set_value("v[0-9]+");
+    regex->mutable_regex()->set_value(true);
+    envoy::api::v2::HeaderMatcher* exact = route->mutable_match()->add_headers();
+    exact->set_name("x-shard");
+    exact->set_value(fmt::format("shard{}", i));
+    route->mutable_route()->set_cluster(fmt::format("shard{}", i));
+  }
+  return route_config;
+}
+
+static void BM_HeaderMatcherRouteLookup(benchmark::State& state) {
+  const uint32_t route_count = state.range(0);
+  testing::NiceMock<Runtime::MockLoader> runtime;
+  testing::NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(buildHeaderRouteConfig(route_count), runtime, cm, stats, false);
+
+  std::vector<Http::TestHeaderMapImpl> requests;
+  requests.push_back(Http::TestHeaderMapImpl{{":authority", "www.lyft.com"},
+                                             {":path", "/users/1234"},
+                                             {":method", "GET"},
+                                             {"x-tenant", "lyft"},
+                                             {"x-version", "v2"},
+                                             {"x-shard", fmt::format("shard{}", route_count - 1)}});
+
+  routeLookups(state, config, requests);
+}
+BENCHMARK(BM_HeaderMatcherRouteLookup)->RangeMultiplier(4)->Range(1, 1024);
+
+} // namespace Router
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -12,6 +12,7 @@
 #include "common/json/json_loader.h"
 #include "common/network/address_impl.h"
 #include "common/router/config_impl.h"
+#include "common/stats/stats_impl.h"
 
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/upstream/mocks.h"
@@ -221,8 +222,9 @@ TEST(RouteMatcherTest, TestRoutes) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
   NiceMock<Envoy::RequestInfo::MockRequestInfo> request_info;
-  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, stats, true);
 
   // Base routing testing.
   EXPECT_EQ("instant-server",
@@ -500,15 +502,167 @@ virtual_hosts:
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
   NiceMock<Envoy::RequestInfo::MockRequestInfo> request_info;
 
   EXPECT_THROW_WITH_REGEX(
-      ConfigImpl(parseRouteConfigurationFromV2Yaml(invalid_route), runtime, cm, true),
+      ConfigImpl(parseRouteConfigurationFromV2Yaml(invalid_route), runtime, cm, stats, true),
       EnvoyException, "Invalid regex '/\\(\\+invalid\\)':");
 
-  EXPECT_THROW_WITH_REGEX(
-      ConfigImpl(parseRouteConfigurationFromV2Yaml(invalid_virtual_cluster), runtime, cm, true),
-      EnvoyException, "Invalid regex '\\^/\\(\\+invalid\\)':");
+  EXPECT_THROW_WITH_REGEX(ConfigImpl(parseRouteConfigurationFromV2Yaml(invalid_virtual_cluster),
+                                     runtime, cm, stats, true),
+                          EnvoyException, "Invalid regex '\\^/\\(\\+invalid\\)':");
+}
+
+// Regex routes are matched together through a RegexSet, but the first matching route in
+// configuration order must still win, including over interleaved prefix routes, routes with
+// additional header conditions, and expressions that RE2 cannot compile.
+TEST(RouteMatcherTest, TestRegexRoutesMatchedInOrder) {
+  std::string yaml = R"EOF(
+virtual_hosts:
+  - name: regex
+    domains: ["*"]
+    routes:
+      - match:
+          regex: "/api/v[0-9]+/.*"
+          headers:
+            - name: x-canary
+              value: "true"
+        route: { cluster: "canary" }
+      - match: { regex: "/api/v1/users/[0-9]+" }
+        route: { cluster: "users" }
+      - match: { prefix: "/api/v1/users" }
+        route: { cluster: "users_prefix" }
+      - match: { regex: "/(a+)/\\1" }
+        route: { cluster: "backreference" }
+      - match: { regex: "/api/.*" }
+        route: { cluster: "api" }
+      - match: { regex: "/static/.*\\.(css|js)" }
+        route: { cluster: "static" }
+    virtual_clusters:
+      - pattern: "^/api/v1/users/\\d+$"
+        method: GET
+        name: "get_user"
+      - pattern: "^/(a+)/\\1$"
+        name: "backreference"
+      - pattern: "^/api/.*"
+        name: "api"
+  )EOF";
+
+  NiceMock<Runtime::MockLoader> runtime;
+  NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), runtime, cm, stats, true);
+
+  EXPECT_EQ("users",
+            config.route(genHeaders("www.lyft.com", "/api/v1/users/123", "GET"), 0)
+                ->routeEntry()
+                ->clusterName());
+  EXPECT_EQ("users",
+            config.route(genHeaders("www.lyft.com", "/api/v1/users/123?foo=bar", "GET"), 0)
+                ->routeEntry()
+                ->clusterName());
+  EXPECT_EQ("users_prefix",
+            config.route(genHeaders("www.lyft.com", "/api/v1/users/abc", "GET"), 0)
+                ->routeEntry()
+                ->clusterName());
+  EXPECT_EQ("api", config.route(genHeaders("www.lyft.com", "/api/v2/users/123", "GET"), 0)
+                       ->routeEntry()
+                       ->clusterName());
+  EXPECT_EQ("static", config.route(genHeaders("www.lyft.com", "/static/app.js", "GET"), 0)
+                          ->routeEntry()
+                          ->clusterName());
+  EXPECT_EQ("backreference", config.route(genHeaders("www.lyft.com", "/aa/aa", "GET"), 0)
+                                 ->routeEntry()
+                                 ->clusterName());
+  EXPECT_EQ(nullptr, config.route(genHeaders("www.lyft.com", "/aa/a", "GET"), 0));
+  EXPECT_EQ(nullptr, config.route(genHeaders("www.lyft.com", "/static/app.png", "GET"), 0));
+
+  {
+    Http::TestHeaderMapImpl headers = genHeaders("www.lyft.com", "/api/v1/users/123", "GET");
+    headers.addCopy("x-canary", "true");
+    EXPECT_EQ("canary", config.route(headers, 0)->routeEntry()->clusterName());
+  }
+
+  {
+    Http::TestHeaderMapImpl headers = genHeaders("www.lyft.com", "/api/v1/users/123", "GET");
+    EXPECT_EQ("get_user", config.route(headers, 0)->routeEntry()->virtualCluster(headers)->name());
+  }
+  {
+    Http::TestHeaderMapImpl headers = genHeaders("www.lyft.com", "/api/v1/users/123", "POST");
+    EXPECT_EQ("api", config.route(headers, 0)->routeEntry()->virtualCluster(headers)->name());
+  }
+  {
+    Http::TestHeaderMapImpl headers = genHeaders("www.lyft.com", "/aa/aa", "GET");
+    EXPECT_EQ("backreference",
+              config.route(headers, 0)->routeEntry()->virtualCluster(headers)->name());
+  }
+  {
+    Http::TestHeaderMapImpl headers = genHeaders("www.lyft.com", "/static/app.js", "GET");
+    EXPECT_EQ("other", config.route(headers, 0)->routeEntry()->virtualCluster(headers)->name());
+  }
+
+  // Every lookup above was answered by the RE2 sets.
+  EXPECT_EQ(0U, stats.counter("regex_set_fallback").value());
+}
+
+// Prefix and path routes are looked up through a radix tree. Routes whose path matches but
+// whose other constraints do not must fall through to the next candidate in configuration order.
+TEST(RouteMatcherTest, TestIndexedRoutesMatchedInOrder) {
+  std::string yaml = R"EOF(
+virtual_hosts:
+  - name: indexed
+    domains: ["*"]
+    routes:
+      - match:
+          prefix: "/api"
+          headers:
+            - name: x-canary
+              value: "true"
+        route: { cluster: "canary" }
+      - match:
+          path: "/api/v1/users"
+          query_parameters:
+            - name: debug
+        route: { cluster: "users_debug" }
+      - match: { path: "/api/v1/users" }
+        route: { cluster: "users" }
+      - match: { prefix: "/API/V1", case_sensitive: false }
+        route: { cluster: "v1" }
+      - match: { prefix: "/api" }
+        route: { cluster: "api" }
+      - match: { prefix: "/" }
+        route: { cluster: "default" }
+  )EOF";
+
+  NiceMock<Runtime::MockLoader> runtime;
+  NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), runtime, cm, stats, true);
+
+  EXPECT_EQ("users", config.route(genHeaders("www.lyft.com", "/api/v1/users", "GET"), 0)
+                         ->routeEntry()
+                         ->clusterName());
+  EXPECT_EQ("users_debug",
+            config.route(genHeaders("www.lyft.com", "/api/v1/users?debug", "GET"), 0)
+                ->routeEntry()
+                ->clusterName());
+  EXPECT_EQ("v1", config.route(genHeaders("www.lyft.com", "/api/v1/users/", "GET"), 0)
+                      ->routeEntry()
+                      ->clusterName());
+  EXPECT_EQ("v1", config.route(genHeaders("www.lyft.com", "/Api/V1", "GET"), 0)
+                      ->routeEntry()
+                      ->clusterName());
+  EXPECT_EQ("api", config.route(genHeaders("www.lyft.com", "/api/v2", "GET"), 0)
+                       ->routeEntry()
+                       ->clusterName());
+  EXPECT_EQ("default", config.route(genHeaders("www.lyft.com", "/Api/v2", "GET"), 0)
+                           ->routeEntry()
+                           ->clusterName());
+
+  Http::TestHeaderMapImpl headers = genHeaders("www.lyft.com", "/api/v1/users", "GET");
+  headers.addCopy("x-canary", "true");
+  EXPECT_EQ("canary", config.route(headers, 0)->routeEntry()->clusterName());
 }
 
 // Validates behavior of request_headers_to_add at router, vhost, and route levels.
@@ -597,9 +751,10 @@ TEST(RouteMatcherTest, TestAddRemoveRequestHeaders) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
   NiceMock<Envoy::RequestInfo::MockRequestInfo> request_info;
 
-  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, stats, true);
 
   // Request header manipulation testing.
   {
@@ -687,11 +842,12 @@ request_headers_to_add:
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
   NiceMock<Envoy::RequestInfo::MockRequestInfo> request_info;
 
   envoy::api::v2::RouteConfiguration route_config = parseRouteConfigurationFromV2Yaml(yaml);
 
-  ConfigImpl config(route_config, runtime, cm, true);
+  ConfigImpl config(route_config, runtime, cm, stats, true);
 
   // Request header manipulation testing.
   {
@@ -786,9 +942,10 @@ response_headers_to_remove: ["x-global-remove"]
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
   NiceMock<Envoy::RequestInfo::MockRequestInfo> request_info;
 
-  ConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), runtime, cm, true);
+  ConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), runtime, cm, stats, true);
 
   // Response header manipulation testing.
   {
@@ -865,7 +1022,8 @@ TEST(RouteMatcherTest, Priority) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, stats, true);
 
   EXPECT_EQ(Upstream::ResourcePriority::High,
             config.route(genHeaders("www.lyft.com", "/foo", "GET"), 0)->routeEntry()->priority());
@@ -895,7 +1053,8 @@ TEST(RouteMatcherTest, NoHostRewriteAndAutoRewrite) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true),
+  Stats::IsolatedStoreImpl stats;
+  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, true),
                EnvoyException);
 }
 
@@ -920,7 +1079,8 @@ TEST(RouteMatcherTest, NoRedirectAndWebSocket) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true),
+  Stats::IsolatedStoreImpl stats;
+  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, true),
                EnvoyException);
 }
 
@@ -980,7 +1140,8 @@ TEST(RouteMatcherTest, HeaderMatchedRouting) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, stats, true);
 
   {
     EXPECT_EQ("local_service_without_headers",
@@ -1061,12 +1222,13 @@ virtual_hosts:
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
 
-  EXPECT_NO_THROW(
-      ConfigImpl(parseRouteConfigurationFromV2Yaml(value_with_regex_chars), runtime, cm, true));
+  EXPECT_NO_THROW(ConfigImpl(parseRouteConfigurationFromV2Yaml(value_with_regex_chars), runtime,
+                             cm, stats, true));
 
   EXPECT_THROW_WITH_REGEX(
-      ConfigImpl(parseRouteConfigurationFromV2Yaml(invalid_regex), runtime, cm, true),
+      ConfigImpl(parseRouteConfigurationFromV2Yaml(invalid_regex), runtime, cm, stats, true),
       EnvoyException, "Invalid regex");
 }
 
@@ -1112,7 +1274,8 @@ TEST(RouteMatcherTest, QueryParamMatchedRouting) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, stats, true);
 
   {
     Http::TestHeaderMapImpl headers = genHeaders("example.com", "/", "GET");
@@ -1194,12 +1357,13 @@ virtual_hosts:
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
 
-  EXPECT_NO_THROW(
-      ConfigImpl(parseRouteConfigurationFromV2Yaml(value_with_regex_chars), runtime, cm, true));
+  EXPECT_NO_THROW(ConfigImpl(parseRouteConfigurationFromV2Yaml(value_with_regex_chars), runtime,
+                             cm, stats, true));
 
   EXPECT_THROW_WITH_REGEX(
-      ConfigImpl(parseRouteConfigurationFromV2Yaml(invalid_regex), runtime, cm, true),
+      ConfigImpl(parseRouteConfigurationFromV2Yaml(invalid_regex), runtime, cm, stats, true),
       EnvoyException, "Invalid regex");
 }
 
@@ -1244,13 +1408,15 @@ public:
 
   ConfigImpl& config() {
     if (config_ == nullptr) {
-      config_ = std::unique_ptr<ConfigImpl>{new ConfigImpl(route_config_, runtime_, cm_, true)};
+      config_ = std::unique_ptr<ConfigImpl>{
+          new ConfigImpl(route_config_, runtime_, cm_, stats_, true)};
     }
     return *config_;
   }
 
   NiceMock<Runtime::MockLoader> runtime_;
   NiceMock<Upstream::MockClusterManager> cm_;
+  Stats::IsolatedStoreImpl stats_;
   envoy::api::v2::RouteConfiguration route_config_;
   HashPolicy::AddCookieCallback add_cookie_nop_;
 
@@ -1487,6 +1653,7 @@ TEST_F(RouterMatcherHashPolicyTest, HashMultiple) {
 TEST_F(RouterMatcherHashPolicyTest, InvalidHashPolicies) {
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
   {
     auto hash_policy = firstRouteHashPolicy();
     EXPECT_EQ(envoy::api::v2::RouteAction::HashPolicy::POLICY_SPECIFIER_NOT_SET,
@@ -1529,8 +1696,9 @@ TEST(RouteMatcherTest, ClusterHeader) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
   NiceMock<Envoy::RequestInfo::MockRequestInfo> request_info;
-  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, stats, true);
 
   EXPECT_EQ(
       "some_cluster",
@@ -1585,7 +1753,8 @@ TEST(RouteMatcherTest, ContentType) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, stats, true);
 
   {
     EXPECT_EQ("local_service",
@@ -1633,11 +1802,12 @@ TEST(RouteMatcherTest, Runtime) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
   Runtime::MockSnapshot snapshot;
 
   ON_CALL(runtime, snapshot()).WillByDefault(ReturnRef(snapshot));
 
-  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, stats, true);
 
   EXPECT_CALL(snapshot, featureEnabled("some_key", 50, 10)).WillOnce(Return(true));
   EXPECT_EQ("something_else",
@@ -1671,10 +1841,11 @@ TEST(RouteMatcherTest, ShadowClusterNotFound) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
   EXPECT_CALL(cm, get("www2")).WillRepeatedly(Return(&cm.thread_local_cluster_));
   EXPECT_CALL(cm, get("some_cluster")).WillRepeatedly(Return(nullptr));
 
-  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true),
+  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, true),
                EnvoyException);
 }
 
@@ -1698,9 +1869,10 @@ TEST(RouteMatcherTest, ClusterNotFound) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
   EXPECT_CALL(cm, get("www2")).WillRepeatedly(Return(nullptr));
 
-  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true),
+  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, true),
                EnvoyException);
 }
 
@@ -1724,9 +1896,10 @@ TEST(RouteMatcherTest, ClusterNotFoundNotChecking) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
   EXPECT_CALL(cm, get("www2")).WillRepeatedly(Return(nullptr));
 
-  ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, false);
+  ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, false);
 }
 
 TEST(RouteMatcherTest, ClusterNotFoundNotCheckingViaConfig) {
@@ -1750,9 +1923,10 @@ TEST(RouteMatcherTest, ClusterNotFoundNotCheckingViaConfig) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
   EXPECT_CALL(cm, get("www2")).WillRepeatedly(Return(nullptr));
 
-  ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true);
+  ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, true);
 }
 
 TEST(RouteMatchTest, ClusterNotFoundResponseCode) {
@@ -1768,7 +1942,8 @@ virtual_hosts:
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  ConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), runtime, cm, false);
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), runtime, cm, stats, false);
 
   Http::TestHeaderMapImpl headers = genHeaders("www.lyft.com", "/", "GET");
 
@@ -1791,7 +1966,8 @@ virtual_hosts:
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  ConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), runtime, cm, false);
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), runtime, cm, stats, false);
 
   Http::TestHeaderMapImpl headers = genHeaders("www.lyft.com", "/", "GET");
 
@@ -1814,7 +1990,8 @@ virtual_hosts:
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  ConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), runtime, cm, false);
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), runtime, cm, stats, false);
 
   Http::TestHeaderMapImpl headers = genHeaders("www.lyft.com", "/", "GET");
 
@@ -1858,7 +2035,8 @@ TEST(RouteMatcherTest, Shadow) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, stats, true);
 
   EXPECT_EQ("some_cluster", config.route(genHeaders("www.lyft.com", "/foo", "GET"), 0)
                                 ->routeEntry()
@@ -1867,7 +2045,8 @@ TEST(RouteMatcherTest, Shadow) {
   EXPECT_EQ("", config.route(genHeaders("www.lyft.com", "/foo", "GET"), 0)
                     ->routeEntry()
                     ->shadowPolicy()
-                    .runtimeKey());
+                    .runtimeKey()
+                    .name());
 
   EXPECT_EQ("some_cluster2", config.route(genHeaders("www.lyft.com", "/bar", "GET"), 0)
                                  ->routeEntry()
@@ -1876,7 +2055,8 @@ TEST(RouteMatcherTest, Shadow) {
   EXPECT_EQ("foo", config.route(genHeaders("www.lyft.com", "/bar", "GET"), 0)
                        ->routeEntry()
                        ->shadowPolicy()
-                       .runtimeKey());
+                       .runtimeKey()
+                       .name());
 
   EXPECT_EQ("", config.route(genHeaders("www.lyft.com", "/baz", "GET"), 0)
                     ->routeEntry()
@@ -1885,7 +2065,8 @@ TEST(RouteMatcherTest, Shadow) {
   EXPECT_EQ("", config.route(genHeaders("www.lyft.com", "/baz", "GET"), 0)
                     ->routeEntry()
                     ->shadowPolicy()
-                    .runtimeKey());
+                    .runtimeKey()
+                    .name());
 }
 
 TEST(RouteMatcherTest, Retry) {
@@ -1924,7 +2105,8 @@ TEST(RouteMatcherTest, Retry) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, stats, true);
 
   EXPECT_EQ(std::chrono::milliseconds(0),
             config.route(genHeaders("www.lyft.com", "/foo", "GET"), 0)
@@ -2008,7 +2190,8 @@ TEST(RouteMatcherTest, GrpcRetry) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, stats, true);
 
   EXPECT_EQ(std::chrono::milliseconds(0),
             config.route(genHeaders("www.lyft.com", "/foo", "GET"), 0)
@@ -2090,7 +2273,8 @@ TEST(RouteMatcherTest, TestBadDefaultConfig) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  EXPECT_THROW(ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true),
+  Stats::IsolatedStoreImpl stats;
+  EXPECT_THROW(ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, stats, true),
                EnvoyException);
 }
 
@@ -2124,7 +2308,8 @@ TEST(RouteMatcherTest, TestDuplicateDomainConfig) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  EXPECT_THROW(ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true),
+  Stats::IsolatedStoreImpl stats;
+  EXPECT_THROW(ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, stats, true),
                EnvoyException);
 }
 
@@ -2277,11 +2462,12 @@ virtual_hosts:
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
 
-  ConfigImpl v1_json_config(parseRouteConfigurationFromJson(v1_json), runtime, cm, true);
+  ConfigImpl v1_json_config(parseRouteConfigurationFromJson(v1_json), runtime, cm, stats, true);
   testConfig(v1_json_config);
 
-  ConfigImpl v2_yaml_config(parseRouteConfigurationFromV2Yaml(v2_yaml), runtime, cm, true);
+  ConfigImpl v2_yaml_config(parseRouteConfigurationFromV2Yaml(v2_yaml), runtime, cm, stats, true);
   testConfig(v2_yaml_config, true);
 }
 
@@ -2315,7 +2501,8 @@ TEST(RouteMatcherTest, ExclusiveRouteEntryOrDirectResponseEntry) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, stats, true);
 
   {
     Http::TestHeaderMapImpl headers = genRedirectHeaders("www.lyft.com", "/foo", true, true);
@@ -2362,7 +2549,8 @@ TEST(RouteMatcherTest, ExclusiveWeightedClustersEntryOrDirectResponseEntry) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, stats, true);
 
   {
     Http::TestHeaderMapImpl headers = genRedirectHeaders("www.lyft.com", "/foo", true, true);
@@ -2421,7 +2609,8 @@ TEST(RouteMatcherTest, WeightedClusters) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, stats, true);
 
   {
     Http::TestHeaderMapImpl headers = genRedirectHeaders("www1.lyft.com", "/foo", true, true);
@@ -2510,7 +2699,8 @@ TEST(RouteMatcherTest, ExclusiveWeightedClustersOrClusterConfig) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true),
+  Stats::IsolatedStoreImpl stats;
+  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, true),
                EnvoyException);
 }
 
@@ -2536,7 +2726,8 @@ TEST(RouteMatcherTest, WeightedClustersMissingClusterList) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true),
+  Stats::IsolatedStoreImpl stats;
+  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, true),
                EnvoyException);
 }
 
@@ -2563,7 +2754,8 @@ TEST(RouteMatcherTest, WeightedClustersEmptyClustersList) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true),
+  Stats::IsolatedStoreImpl stats;
+  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, true),
                EnvoyException);
 }
 
@@ -2593,7 +2785,8 @@ TEST(RouteMatcherTest, WeightedClustersSumOFWeightsNotEqualToMax) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true),
+  Stats::IsolatedStoreImpl stats;
+  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, true),
                EnvoyException);
 }
 
@@ -2623,7 +2816,8 @@ TEST(RouteMatcherTest, TestWeightedClusterWithMissingWeights) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true),
+  Stats::IsolatedStoreImpl stats;
+  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, true),
                EnvoyException);
 }
 
@@ -2653,11 +2847,12 @@ TEST(RouteMatcherTest, TestWeightedClusterInvalidClusterName) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
   EXPECT_CALL(cm, get("cluster1")).WillRepeatedly(Return(&cm.thread_local_cluster_));
   EXPECT_CALL(cm, get("cluster2")).WillRepeatedly(Return(&cm.thread_local_cluster_));
   EXPECT_CALL(cm, get("cluster3-invalid")).WillRepeatedly(Return(nullptr));
 
-  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true),
+  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, true),
                EnvoyException);
 }
 
@@ -2689,8 +2884,9 @@ TEST(BadHttpRouteConfigurationsTest, BadRouteConfig) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
 
-  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true),
+  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, true),
                EnvoyException);
 }
 
@@ -2717,8 +2913,9 @@ TEST(BadHttpRouteConfigurationsTest, BadVirtualHostConfig) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
 
-  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true),
+  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, true),
                EnvoyException);
 }
 
@@ -2743,8 +2940,9 @@ TEST(BadHttpRouteConfigurationsTest, BadRouteEntryConfig) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
 
-  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true),
+  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, true),
                EnvoyException);
 }
 
@@ -2769,9 +2967,11 @@ TEST(BadHttpRouteConfigurationsTest, BadRouteEntryConfigPrefixAndPath) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
 
-  EXPECT_THROW_WITH_MESSAGE(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true),
-                            EnvoyException, "routes must specify one of prefix/path/regex");
+  EXPECT_THROW_WITH_MESSAGE(
+      ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, true), EnvoyException,
+      "routes must specify one of prefix/path/regex");
 }
 
 TEST(BadHttpRouteConfigurationsTest, BadRouteEntryConfigPrefixAndRegex) {
@@ -2795,9 +2995,11 @@ TEST(BadHttpRouteConfigurationsTest, BadRouteEntryConfigPrefixAndRegex) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
 
-  EXPECT_THROW_WITH_MESSAGE(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true),
-                            EnvoyException, "routes must specify one of prefix/path/regex");
+  EXPECT_THROW_WITH_MESSAGE(
+      ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, true), EnvoyException,
+      "routes must specify one of prefix/path/regex");
 }
 
 TEST(BadHttpRouteConfigurationsTest, BadRouteEntryConfigPathAndRegex) {
@@ -2821,9 +3023,11 @@ TEST(BadHttpRouteConfigurationsTest, BadRouteEntryConfigPathAndRegex) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
 
-  EXPECT_THROW_WITH_MESSAGE(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true),
-                            EnvoyException, "routes must specify one of prefix/path/regex");
+  EXPECT_THROW_WITH_MESSAGE(
+      ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, true), EnvoyException,
+      "routes must specify one of prefix/path/regex");
   ;
 }
 
@@ -2849,9 +3053,11 @@ TEST(BadHttpRouteConfigurationsTest, BadRouteEntryConfigPrefixAndPathAndRegex) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
 
-  EXPECT_THROW_WITH_MESSAGE(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true),
-                            EnvoyException, "routes must specify one of prefix/path/regex");
+  EXPECT_THROW_WITH_MESSAGE(
+      ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, true), EnvoyException,
+      "routes must specify one of prefix/path/regex");
 }
 
 TEST(BadHttpRouteConfigurationsTest, BadRouteEntryConfigMissingPathSpecifier) {
@@ -2873,9 +3079,11 @@ TEST(BadHttpRouteConfigurationsTest, BadRouteEntryConfigMissingPathSpecifier) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
 
-  EXPECT_THROW_WITH_MESSAGE(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true),
-                            EnvoyException, "routes must specify one of prefix/path/regex");
+  EXPECT_THROW_WITH_MESSAGE(
+      ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, true), EnvoyException,
+      "routes must specify one of prefix/path/regex");
 }
 
 TEST(BadHttpRouteConfigurationsTest, BadRouteEntryConfigNoRedirectNoClusters) {
@@ -2897,9 +3105,10 @@ TEST(BadHttpRouteConfigurationsTest, BadRouteEntryConfigNoRedirectNoClusters) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
 
   EXPECT_THROW_WITH_MESSAGE(
-      ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true), EnvoyException,
+      ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, true), EnvoyException,
       "routes must have redirect or one of cluster/cluster_header/weighted_clusters")
 }
 
@@ -2927,7 +3136,8 @@ TEST(RouteMatcherTest, TestOpaqueConfig) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, stats, true);
 
   const std::multimap<std::string, std::string>& opaque_config =
       config.route(genHeaders("api.lyft.com", "/api", "GET"), 0)->routeEntry()->opaqueConfig();
@@ -2956,10 +3166,11 @@ TEST(RoutePropertyTest, excludeVHRateLimits) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
   Http::TestHeaderMapImpl headers = genHeaders("www.lyft.com", "/foo", "GET");
   std::unique_ptr<ConfigImpl> config_ptr;
 
-  config_ptr.reset(new ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true));
+  config_ptr.reset(new ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, true));
   EXPECT_TRUE(config_ptr->route(headers, 0)->routeEntry()->includeVirtualHostRateLimits());
 
   json = R"EOF(
@@ -2988,7 +3199,7 @@ TEST(RoutePropertyTest, excludeVHRateLimits) {
   }
   )EOF";
 
-  config_ptr.reset(new ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true));
+  config_ptr.reset(new ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, true));
   EXPECT_FALSE(config_ptr->route(headers, 0)->routeEntry()->includeVirtualHostRateLimits());
 
   json = R"EOF(
@@ -3018,7 +3229,7 @@ TEST(RoutePropertyTest, excludeVHRateLimits) {
   }
   )EOF";
 
-  config_ptr.reset(new ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true));
+  config_ptr.reset(new ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, true));
   EXPECT_TRUE(config_ptr->route(headers, 0)->routeEntry()->includeVirtualHostRateLimits());
 }
 
@@ -3050,7 +3261,8 @@ TEST(RoutePropertyTest, TestVHostCorsConfig) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, stats, true);
 
   const Router::CorsPolicy* cors_policy =
       config.route(genHeaders("api.lyft.com", "/api", "GET"), 0)
@@ -3095,7 +3307,8 @@ TEST(RoutePropertyTest, TestRouteCorsConfig) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, stats, true);
 
   const Router::CorsPolicy* cors_policy =
       config.route(genHeaders("api.lyft.com", "/api", "GET"), 0)->routeEntry()->corsPolicy();
@@ -3133,8 +3346,9 @@ TEST(RoutePropertyTest, TestBadCorsConfig) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
 
-  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, true),
+  EXPECT_THROW(ConfigImpl(parseRouteConfigurationFromJson(json), runtime, cm, stats, true),
                EnvoyException);
 }
 
@@ -3165,7 +3379,8 @@ TEST(RouterMatcherTest, Decorator) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, stats, true);
 
   {
     Http::TestHeaderMapImpl headers = genHeaders("www.lyft.com", "/foo", "GET");
@@ -3225,8 +3440,9 @@ TEST(CustomRequestHeadersTest, AddNewHeader) {
   )EOF";
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
   NiceMock<Envoy::RequestInfo::MockRequestInfo> request_info;
-  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true);
+  ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, stats, true);
   Http::TestHeaderMapImpl headers = genHeaders("www.lyft.com", "/new_endpoint/foo", "GET");
   const RouteEntry* route = config.route(headers, 0)->routeEntry();
   route->finalizeRequestHeaders(headers, request_info);
@@ -3277,9 +3493,11 @@ TEST(CustomRequestHeadersTest, CustomHeaderWrongFormat) {
   )EOF";
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
+  Stats::IsolatedStoreImpl stats;
   NiceMock<Envoy::RequestInfo::MockRequestInfo> request_info;
   EXPECT_THROW_WITH_MESSAGE(
-      ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, true), EnvoyException,
+      ConfigImpl config(parseRouteConfigurationFromJson(json), runtime, cm, stats, true),
+      EnvoyException,
       "Incorrect header configuration. Expected variable format %<variable_name>%, actual format "
       "%CLIENT_IP");
 }
@@ -3421,7 +3639,8 @@ TEST(RouteEntryMetadataMatchTest, ParsesMetadata) {
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  ConfigImpl config(route_config, runtime, cm, true);
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(route_config, runtime, cm, stats, true);
 
   {
     Http::TestHeaderMapImpl headers = genRedirectHeaders("www.lyft.com", "/both", true, true);
@@ -3504,7 +3723,8 @@ virtual_hosts:
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  ConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), runtime, cm, true);
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), runtime, cm, stats, true);
 
   EXPECT_EQ(nullptr, config.route(genRedirectHeaders("www.foo.com", "/foo", true, true), 0));
 
@@ -3531,7 +3751,8 @@ virtual_hosts:
 
   NiceMock<Runtime::MockLoader> runtime;
   NiceMock<Upstream::MockClusterManager> cm;
-  ConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), runtime, cm, true);
+  Stats::IsolatedStoreImpl stats;
+  ConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), runtime, cm, stats, true);
 
   auto* route_entry = config.route(genHeaders("www.foo.com", "/", "GET"), 0)->routeEntry();
 
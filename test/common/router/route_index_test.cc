@@ -0,0 +1,136 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/router/route_index.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Router {
+
+class RouteIndexTest : public testing::Test {
+public:
+  std::vector<uint32_t> find(const std::string& path) {
+    std::vector<uint32_t> positions;
+    EXPECT_TRUE(index_.find(path, positions));
+    return positions;
+  }
+
+  RouteIndex index_;
+};
+
+TEST_F(RouteIndexTest, Empty) {
+  index_.compile();
+  EXPECT_EQ(std::vector<uint32_t>{}, find("/"));
+  EXPECT_EQ(std::vector<uint32_t>{}, find(""));
+}
+
+TEST_F(RouteIndexTest, Prefixes) {
+  index_.addPrefix("/api/v1", true, 0);
+  index_.addPrefix("/api/v2", true, 1);
+  index_.addPrefix("/api", true, 2);
+  index_.addPrefix("/", true, 3);
+  index_.addPrefix("", true, 4);
+  index_.addPrefix("/api/v1", true, 5);
+  index_.compile();
+
+  EXPECT_EQ((std::vector<uint32_t>{0, 2, 3, 4, 5}), find("/api/v1/users"));
+  EXPECT_EQ((std::vector<uint32_t>{1, 2, 3, 4}), find("/api/v2"));
+  EXPECT_EQ((std::vector<uint32_t>{2, 3, 4}), find("/api/v"));
+  EXPECT_EQ((std::vector<uint32_t>{2, 3, 4}), find("/api?v1"));
+  EXPECT_EQ((std::vector<uint32_t>{3, 4}), find("/ap"));
+  EXPECT_EQ((std::vector<uint32_t>{4}), find("api"));
+  EXPECT_EQ((std::vector<uint32_t>{4}), find(""));
+  EXPECT_TRUE(index_.pathMatched(0));
+}
+
+TEST_F(RouteIndexTest, PrefixesIncludeQueryString) {
+  index_.addPrefix("/foo?bar", true, 0);
+  index_.compile();
+
+  EXPECT_EQ((std::vector<uint32_t>{0}), find("/foo?bar=baz"));
+  EXPECT_EQ((std::vector<uint32_t>{}), find("/foo?baz"));
+}
+
+TEST_F(RouteIndexTest, Paths) {
+  index_.addPath("/foo", true, 0);
+  index_.addPath("/foo/bar", true, 1);
+  index_.addPath("/fo", true, 2);
+  index_.addPath("/foo?bar", true, 3);
+  index_.compile();
+
+  EXPECT_EQ((std::vector<uint32_t>{0}), find("/foo"));
+  EXPECT_EQ((std::vector<uint32_t>{0}), find("/foo?bar"));
+  EXPECT_EQ((std::vector<uint32_t>{1}), find("/foo/bar?baz=1"));
+  EXPECT_EQ((std::vector<uint32_t>{2}), find("/fo"));
+  EXPECT_EQ((std::vector<uint32_t>{}), find("/foo/"));
+  EXPECT_EQ((std::vector<uint32_t>{}), find("/f"));
+}
+
+TEST_F(RouteIndexTest, CaseInsensitive) {
+  index_.addPrefix("/API", false, 0);
+  index_.addPath("/Foo", false, 1);
+  index_.addPrefix("/api", true, 2);
+  index_.compile();
+
+  EXPECT_EQ((std::vector<uint32_t>{0, 2}), find("/api/v1"));
+  EXPECT_EQ((std::vector<uint32_t>{0}), find("/aPi/v1"));
+  EXPECT_EQ((std::vector<uint32_t>{1}), find("/FOO?Bar"));
+  EXPECT_EQ((std::vector<uint32_t>{}), find("/FOOD"));
+}
+
+TEST_F(RouteIndexTest, Regexes) {
+  index_.addPrefix("/users", true, 0);
+  index_.addRegex("/users/[0-9]+", 1);
+  index_.addRegex("/(a+)/\\1", 2);
+  index_.addPath("/users/123", true, 3);
+  index_.addRegex("/users/.*", 4);
+  index_.compile();
+
+  EXPECT_EQ((std::vector<uint32_t>{0, 1, 2, 3, 4}), find("/users/123?foo=bar"));
+  EXPECT_EQ((std::vector<uint32_t>{0, 2, 4}), find("/users/abc"));
+  EXPECT_EQ((std::vector<uint32_t>{2}), find("/other"));
+
+  EXPECT_TRUE(index_.pathMatched(1));
+  EXPECT_FALSE(index_.pathMatched(2));
+  EXPECT_TRUE(index_.pathMatched(3));
+}
+
+TEST_F(RouteIndexTest, SplitEdges) {
+  index_.addPath("/abcdef", true, 0);
+  index_.addPath("/abc", true, 1);
+  index_.addPath("/abxyz", true, 2);
+  index_.addPrefix("/ab", true, 3);
+  index_.addPath("/b", true, 4);
+  index_.compile();
+
+  EXPECT_EQ((std::vector<uint32_t>{0, 3}), find("/abcdef"));
+  EXPECT_EQ((std::vector<uint32_t>{1, 3}), find("/abc"));
+  EXPECT_EQ((std::vector<uint32_t>{2, 3}), find("/abxyz"));
+  EXPECT_EQ((std::vector<uint32_t>{3}), find("/abcd"));
+  EXPECT_EQ((std::vector<uint32_t>{4}), find("/b"));
+  EXPECT_EQ((std::vector<uint32_t>{}), find("/a"));
+}
+
+TEST_F(RouteIndexTest, ReusesPositions) {
+  index_.addPrefix("/", true, 0);
+  index_.addPrefix("/API", false, 1);
+  index_.addRegex("/api/.*", 2);
+  index_.compile();
+
+  // Lookups with no more candidates than the vector holds don't reallocate it.
+  std::vector<uint32_t> positions;
+  positions.reserve(3);
+  const uint32_t* data = positions.data();
+  index_.find("/Api/v1", positions);
+  EXPECT_EQ((std::vector<uint32_t>{0, 1}), positions);
+  index_.find("/api/v1", positions);
+  EXPECT_EQ((std::vector<uint32_t>{0, 1, 2}), positions);
+  index_.find("/other", positions);
+  EXPECT_EQ((std::vector<uint32_t>{0}), positions);
+  EXPECT_EQ(data, positions.data());
+}
+
+} // namespace Router
+} // namespace Envoy
@@ -8,6 +8,7 @@
 #include "common/network/address_impl.h"
 #include "common/router/config_impl.h"
 #include "common/router/router_ratelimit.h"
+#include "common/stats/stats_impl.h"
 
 #include "test/mocks/http/mocks.h"
 #include "test/mocks/ratelimit/mocks.h"
@@ -103,12 +104,13 @@ public:
     envoy::api::v2::RouteConfiguration route_config;
     auto json_object_ptr = Json::Factory::loadFromString(json);
     Envoy::Config::RdsJson::translateRouteConfiguration(*json_object_ptr, route_config);
-    config_.reset(new ConfigImpl(route_config, runtime_, cm_, true));
+    config_.reset(new ConfigImpl(route_config, runtime_, cm_, stats_, true));
   }
 
   std::unique_ptr<ConfigImpl> config_;
   NiceMock<Runtime::MockLoader> runtime_;
   NiceMock<Upstream::MockClusterManager> cm_;
+  Stats::IsolatedStoreImpl stats_;
   Http::TestHeaderMapImpl header_;
   const RouteEntry* route_;
   Network::Address::Ipv4Instance default_remote_address_{"10.0.0.1"};
@@ -1435,7 +1435,7 @@ TEST_F(RouterTest, RetryUpstreamGrpcCancelled) {
 
 TEST_F(RouterTest, Shadow) {
   callbacks_.route_->route_entry_.shadow_policy_.cluster_ = "foo";
-  callbacks_.route_->route_entry_.shadow_policy_.runtime_key_ = "bar";
+  callbacks_.route_->route_entry_.shadow_policy_.runtime_key_ = Runtime::Key("bar");
   ON_CALL(callbacks_, streamId()).WillByDefault(Return(43));
 
   NiceMock<Http::MockStreamEncoder> encoder;
@@ -1684,7 +1684,7 @@ TEST(RouterFilterUtilityTest, shouldShadow) {
   {
     TestShadowPolicy policy;
     policy.cluster_ = "cluster";
-    policy.runtime_key_ = "foo";
+    policy.runtime_key_ = Runtime::Key("foo");
     NiceMock<Runtime::MockLoader> runtime;
     EXPECT_CALL(runtime.snapshot_, featureEnabled("foo", 0, 5, 10000)).WillOnce(Return(false));
     EXPECT_FALSE(FilterUtility::shouldShadow(policy, runtime, 5));
@@ -1692,7 +1692,7 @@ TEST(RouterFilterUtilityTest, shouldShadow) {
   {
     TestShadowPolicy policy;
     policy.cluster_ = "cluster";
-    policy.runtime_key_ = "foo";
+    policy.runtime_key_ = Runtime::Key("foo");
     NiceMock<Runtime::MockLoader> runtime;
     EXPECT_CALL(runtime.snapshot_, featureEnabled("foo", 0, 5, 10000)).WillOnce(Return(true));
     EXPECT_TRUE(FilterUtility::shouldShadow(policy, runtime, 5));
@@ -1,6 +1,7 @@
 #include <memory>
 #include <string>
 
+#include "common/runtime/key_registry.h"
 #include "common/runtime/runtime_impl.h"
 #include "common/stats/stats_impl.h"
 
@@ -134,6 +135,48 @@ TEST_F(RuntimeImplTest, All) {
   EXPECT_EQ("hello override", loader->snapshot().get("file1"));
 }
 
+TEST_F(RuntimeImplTest, InternedKeys) {
+  const Key file3 = KeyRegistry::intern("file3");
+  setup();
+  run("test/common/runtime/test_data/current", "envoy_override");
+
+  EXPECT_EQ(2UL, loader->snapshot().getInteger(file3, 1));
+
+  // Keys interned after the snapshot was loaded are resolved when they are first looked up.
+  const Key file4 = KeyRegistry::intern("file4");
+  const Key invalid = KeyRegistry::intern("invalid");
+  EXPECT_EQ(123UL, loader->snapshot().getInteger(file4, 1));
+  EXPECT_EQ(1UL, loader->snapshot().getInteger(invalid, 1));
+
+  // Keys that were not interned are looked up by name.
+  EXPECT_EQ(2UL, loader->snapshot().getInteger(Key("file3"), 1));
+
+  // Feature enablement.
+  EXPECT_CALL(generator, random()).WillOnce(Return(1));
+  EXPECT_TRUE(loader->snapshot().featureEnabled(file3, 1));
+
+  EXPECT_CALL(generator, random()).WillOnce(Return(2));
+  EXPECT_FALSE(loader->snapshot().featureEnabled(file3, 1));
+
+  EXPECT_TRUE(loader->snapshot().featureEnabled(file3, 1, 1));
+  EXPECT_FALSE(loader->snapshot().featureEnabled(file3, 1, 3));
+
+  EXPECT_FALSE(loader->snapshot().featureEnabled(file4, 1, 200, 300));
+  EXPECT_TRUE(loader->snapshot().featureEnabled(file4, 1, 122, 300));
+  EXPECT_FALSE(loader->snapshot().featureEnabled(invalid, 0));
+
+  // A key that is given the index of a released key is not resolved to the released key's entry.
+  uint32_t index;
+  {
+    const Key file1 = KeyRegistry::intern("file1");
+    index = file1.index();
+    EXPECT_EQ(0UL, loader->snapshot().getInteger(file1, 0));
+  }
+  const Key file5 = KeyRegistry::intern("file5");
+  EXPECT_EQ(index, file5.index());
+  EXPECT_EQ(123UL, loader->snapshot().getInteger(file5, 0));
+}
+
 TEST_F(RuntimeImplTest, GetAll) {
   setup();
   run("test/common/runtime/test_data/current", "envoy_override");
@@ -186,8 +229,44 @@ TEST(NullRuntimeImplTest, All) {
   EXPECT_EQ(1UL, loader.snapshot().getInteger("foo", 1));
   EXPECT_CALL(generator, random()).WillOnce(Return(49));
   EXPECT_TRUE(loader.snapshot().featureEnabled("foo", 50));
+  EXPECT_EQ(1UL, loader.snapshot().getInteger(KeyRegistry::intern("foo"), 1));
   EXPECT_TRUE(loader.snapshot().getAll().empty());
 }
 
+TEST(KeyRegistryTest, Intern) {
+  const uint32_t size = KeyRegistry::size();
+  const Key first = KeyRegistry::intern("key_registry_test.first");
+  const Key second = KeyRegistry::intern("key_registry_test.second");
+  EXPECT_EQ("key_registry_test.first", first.name());
+  EXPECT_NE(first.index(), second.index());
+  EXPECT_NE(0UL, first.generation());
+  EXPECT_EQ(first.index(), KeyRegistry::intern("key_registry_test.first").index());
+  EXPECT_EQ(first.generation(), KeyRegistry::intern("key_registry_test.first").generation());
+  EXPECT_EQ(size + 2, KeyRegistry::size());
+}
+
+TEST(KeyRegistryTest, Release) {
+  const uint32_t size = KeyRegistry::size();
+  uint32_t index;
+  uint64_t generation;
+  {
+    const Key key = KeyRegistry::intern("key_registry_test.released");
+    const Key copy = key;
+    {
+      // Interning the name again holds on to the index independently.
+      const Key again = KeyRegistry::intern("key_registry_test.released");
+    }
+    index = key.index();
+    generation = key.generation();
+    EXPECT_EQ(size + 1, KeyRegistry::size());
+  }
+  EXPECT_EQ(size, KeyRegistry::size());
+
+  // The index is reused for the next new name, with a new generation.
+  const Key other = KeyRegistry::intern("key_registry_test.other");
+  EXPECT_EQ(index, other.index());
+  EXPECT_NE(generation, other.generation());
+}
+
 } // namespace Runtime
 } // namespace Envoy
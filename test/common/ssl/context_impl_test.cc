@@ -1,17 +1,24 @@
+#include <algorithm>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "common/json/json_loader.h"
 #include "common/ssl/context_config_impl.h"
 #include "common/ssl/context_impl.h"
+#include "common/ssl/context_manager_impl.h"
+#include "common/ssl/private_key_offload.h"
 #include "common/stats/stats_impl.h"
 
 #include "test/common/ssl/ssl_certs_test.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/test_common/environment.h"
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+using testing::Return;
+
 namespace Envoy {
 namespace Ssl {
 
@@ -168,6 +175,53 @@ TEST_F(SslContextImplTest, TestNoCert) {
   EXPECT_EQ("", context->getCertChainInformation());
 }
 
+TEST_F(SslContextImplTest, PrivateKeyOffloadThreadsAtMostCpus) {
+  Runtime::MockLoader runtime;
+  EXPECT_CALL(runtime.snapshot_, getInteger("ssl.private_key_offload_threads", 0))
+      .WillOnce(Return(100000));
+  ContextManagerImpl manager(runtime);
+
+  PrivateKeyOffloadPool* pool = manager.privateKeyOffloadPool();
+  ASSERT_NE(nullptr, pool);
+  EXPECT_EQ(std::max(1U, std::thread::hardware_concurrency()), pool->threadCount());
+  // The runtime value is only read once.
+  EXPECT_EQ(pool, manager.privateKeyOffloadPool());
+}
+
+TEST_F(SslContextImplTest, FindServerContextByServerName) {
+  Json::ObjectSharedPtr loader = TestEnvironment::jsonLoadFromString(R"EOF(
+  {
+    "cert_chain_file": "{{ test_tmpdir }}/unittestcert.pem",
+    "private_key_file": "{{ test_tmpdir }}/unittestkey.pem"
+  }
+  )EOF");
+  ServerContextConfigImpl cfg(*loader);
+  Runtime::MockLoader runtime;
+  ContextManagerImpl manager(runtime);
+  Stats::IsolatedStoreImpl store;
+
+  ServerContextPtr default_ctx(manager.createSslServerContext("listener", {}, store, cfg, true));
+  ServerContextPtr exact_ctx(
+      manager.createSslServerContext("listener", {"www.example.com"}, store, cfg, true));
+  ServerContextPtr wildcard_ctx(
+      manager.createSslServerContext("listener", {"*.example.com"}, store, cfg, true));
+
+  EXPECT_EQ(exact_ctx.get(), manager.findSslServerContext("listener", "www.example.com"));
+  EXPECT_EQ(wildcard_ctx.get(), manager.findSslServerContext("listener", "api.example.com"));
+  EXPECT_EQ(default_ctx.get(), manager.findSslServerContext("listener", "example.com"));
+  EXPECT_EQ(default_ctx.get(), manager.findSslServerContext("listener", ".example.com"));
+  EXPECT_EQ(default_ctx.get(), manager.findSslServerContext("listener", "www.example.org"));
+  EXPECT_EQ(default_ctx.get(), manager.findSslServerContext("listener", ""));
+  EXPECT_EQ(nullptr, manager.findSslServerContext("other_listener", "www.example.com"));
+
+  exact_ctx.reset();
+  EXPECT_EQ(wildcard_ctx.get(), manager.findSslServerContext("listener", "www.example.com"));
+  wildcard_ctx.reset();
+  EXPECT_EQ(default_ctx.get(), manager.findSslServerContext("listener", "www.example.com"));
+  default_ctx.reset();
+  EXPECT_EQ(nullptr, manager.findSslServerContext("listener", "www.example.com"));
+}
+
 class SslServerContextImplTicketTest : public SslContextImplTest {
 public:
   static void loadConfig(ServerContextConfigImpl& cfg) {
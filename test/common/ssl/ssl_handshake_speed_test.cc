@@ -0,0 +1,212 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common/common/assert.h"
+#include "common/common/macros.h"
+#include "common/event/dispatcher_impl.h"
+#include "common/ssl/context_config_impl.h"
+#include "common/ssl/context_impl.h"
+#include "common/ssl/context_manager_impl.h"
+#include "common/ssl/private_key_offload.h"
+#include "common/stats/stats_impl.h"
+
+#include "test/mocks/runtime/mocks.h"
+
+#include "api/sds.pb.h"
+#include "openssl/ssl.h"
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Ssl {
+
+/**
+ * A client and a server context, whose connections handshake with each other in memory. This
+ * should be run from the runfiles directory, e.g. with bazel run, so that the certificates are
+ * found.
+ */
+class HandshakeTester {
+public:
+  /**
+   * A client and a server connection, connected by a BIO pair.
+   */
+  class Handshake {
+  public:
+    Handshake(HandshakeTester& tester, bool resume)
+        : client_(dynamic_cast<ContextImpl&>(*tester.client_context_).newSsl()),
+          server_(dynamic_cast<ContextImpl&>(*tester.server_context_).newSsl()) {
+      if (!resume) {
+        SSL_set_session(client_.get(), nullptr);
+      }
+
+      BIO* client_bio;
+      BIO* server_bio;
+      int rc = BIO_new_bio_pair(&client_bio, 0, &server_bio, 0);
+      RELEASE_ASSERT(rc == 1);
+      SSL_set_bio(client_.get(), client_bio, client_bio);
+      SSL_set_bio(server_.get(), server_bio, server_bio);
+      SSL_set_connect_state(client_.get());
+      SSL_set_accept_state(server_.get());
+
+      ContextImpl& server_context = dynamic_cast<ContextImpl&>(*tester.server_context_);
+      if (server_context.privateKeyOffloadPool() != nullptr) {
+        offload_.reset(new PrivateKeyOffload(*server_context.privateKeyOffloadPool(),
+                                             server_.get(), tester.dispatcher_, []() -> void {},
+                                             server_context.stats().private_key_operations_pending_,
+                                             server_context.stats().private_key_operation_ms_));
+      }
+    }
+
+    /**
+     * Run both ends of the handshake until they are done or wait.
+     * @return bool whether the handshake is done.
+     */
+    bool step() {
+      client_done_ = client_done_ || step(client_.get());
+      server_done_ = server_done_ || step(server_.get());
+      return done();
+    }
+
+    bool done() const { return client_done_ && server_done_; }
+    bool resumed() const { return SSL_session_reused(client_.get()); }
+
+  private:
+    static bool step(SSL* ssl) {
+      const int rc = SSL_do_handshake(ssl);
+      if (rc == 1) {
+        return true;
+      }
+      const int err = SSL_get_error(ssl, rc);
+      RELEASE_ASSERT(err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_PRIVATE_KEY_OPERATION);
+      UNREFERENCED_PARAMETER(err);
+      return false;
+    }
+
+    bssl::UniquePtr<SSL> client_;
+    bssl::UniquePtr<SSL> server_;
+    PrivateKeyOffloadPtr offload_;
+    bool client_done_{};
+    bool server_done_{};
+  };
+
+  /**
+   * @param offload_threads supplies the number of threads of the private key offload pool, or 0
+   *        for private key operations inline.
+   */
+  HandshakeTester(uint32_t offload_threads = 0) {
+    ON_CALL(runtime_.snapshot_, getInteger("ssl.private_key_offload_threads", testing::_))
+        .WillByDefault(testing::Return(offload_threads));
+    manager_.reset(new ContextManagerImpl(runtime_));
+
+    envoy::api::v2::DownstreamTlsContext server_config;
+    auto* certificate = server_config.mutable_common_tls_context()->add_tls_certificates();
+    certificate->mutable_certificate_chain()->set_filename(
+        "test/common/ssl/test_data/san_dns_cert.pem");
+    certificate->mutable_private_key()->set_filename("test/common/ssl/test_data/san_dns_key.pem");
+    server_config.mutable_session_ticket_keys()->add_keys()->set_filename(
+        "test/common/ssl/test_data/ticket_key_a");
+    ServerContextConfigImpl server_context_config(server_config);
+    server_context_ =
+        manager_->createSslServerContext("server", {}, stats_store_, server_context_config, false);
+
+    ClientContextConfigImpl client_context_config((envoy::api::v2::UpstreamTlsContext()));
+    client_context_ = manager_->createSslClientContext(stats_store_, client_context_config);
+  }
+
+  /**
+   * Handshake a new client connection with a new server connection.
+   * @param resume supplies whether the client offers the session of its previous connection.
+   * @return bool whether the session was resumed.
+   */
+  bool handshake(bool resume) {
+    Handshake handshake(*this, resume);
+    while (!handshake.step()) {
+      dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+    }
+    return handshake.resumed();
+  }
+
+  Event::Dispatcher& dispatcher() { return dispatcher_; }
+
+private:
+  Stats::IsolatedStoreImpl stats_store_;
+  testing::NiceMock<Runtime::MockLoader> runtime_;
+  Event::DispatcherImpl dispatcher_;
+  std::unique_ptr<ContextManagerImpl> manager_;
+  ServerContextPtr server_context_;
+  ClientContextPtr client_context_;
+};
+
+// A full handshake for every connection.
+static void BM_HandshakeFull(benchmark::State& state) {
+  HandshakeTester tester;
+  uint64_t resumed = 0;
+  while (state.KeepRunning()) {
+    resumed += tester.handshake(false);
+  }
+  RELEASE_ASSERT(resumed == 0);
+}
+BENCHMARK(BM_HandshakeFull)->Unit(benchmark::kMicrosecond);
+
+// Connections that resume the session of the previous connection from the session cache.
+static void BM_HandshakeResumed(benchmark::State& state) {
+  HandshakeTester tester;
+  tester.handshake(true);
+  uint64_t resumed = 0;
+  while (state.KeepRunning()) {
+    resumed += tester.handshake(true);
+  }
+  RELEASE_ASSERT(resumed == state.iterations());
+}
+BENCHMARK(BM_HandshakeResumed)->Unit(benchmark::kMicrosecond);
+
+// A storm of STORM_SIZE concurrent full handshakes on one worker, with the private key operations
+// inline and on offload pools of 1, 2 and 4 threads. max_stall_us is the longest that a step of
+// one handshake kept the worker from the others.
+static void BM_HandshakeStorm(benchmark::State& state) {
+  const uint32_t STORM_SIZE = 64;
+  HandshakeTester tester(state.range(0));
+  std::chrono::nanoseconds max_stall{};
+  while (state.KeepRunning()) {
+    std::vector<std::unique_ptr<HandshakeTester::Handshake>> handshakes;
+    for (uint32_t i = 0; i < STORM_SIZE; i++) {
+      handshakes.emplace_back(new HandshakeTester::Handshake(tester, false));
+    }
+    uint32_t remaining = STORM_SIZE;
+    while (remaining > 0) {
+      for (const auto& handshake : handshakes) {
+        if (handshake->done()) {
+          continue;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        remaining -= handshake->step();
+        max_stall = std::max<std::chrono::nanoseconds>(max_stall,
+                                                       std::chrono::steady_clock::now() - start);
+      }
+      tester.dispatcher().run(Event::Dispatcher::RunType::NonBlock);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * STORM_SIZE);
+  state.counters["max_stall_us"] =
+      std::chrono::duration_cast<std::chrono::microseconds>(max_stall).count();
+}
+BENCHMARK(BM_HandshakeStorm)->Arg(0)->Arg(1)->Arg(2)->Arg(4)->UseRealTime()->Unit(
+    benchmark::kMillisecond);
+
+} // namespace Ssl
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -1,6 +1,8 @@
 #include <cstdint>
+#include <future>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "common/buffer/buffer_impl.h"
 #include "common/common/empty_string.h"
@@ -11,6 +13,7 @@
 #include "common/network/utility.h"
 #include "common/ssl/context_config_impl.h"
 #include "common/ssl/context_impl.h"
+#include "common/ssl/private_key_offload.h"
 #include "common/ssl/ssl_socket.h"
 #include "common/stats/stats_impl.h"
 
@@ -30,6 +33,8 @@
 
 using testing::Invoke;
 using testing::NiceMock;
+using testing::Property;
+using testing::Return;
 using testing::ReturnRef;
 using testing::StrictMock;
 using testing::_;
@@ -1200,6 +1205,252 @@ TEST_P(SslSocketTest, ClientAuthCrossListenerSessionResumption) {
   EXPECT_EQ(0UL, stats_store.counter("ssl.session_reused").value());
 }
 
+// Validate that the connections of a client context resume the session of its earlier connection
+// without being given it.
+TEST_P(SslSocketTest, ClientSessionCacheResumption) {
+  Stats::IsolatedStoreImpl server_stats_store;
+  Stats::IsolatedStoreImpl client_stats_store;
+  Runtime::MockLoader runtime;
+  ContextManagerImpl manager(runtime);
+
+  std::string server_ctx_json = R"EOF(
+  {
+    "cert_chain_file": "{{ test_tmpdir }}/unittestcert.pem",
+    "private_key_file": "{{ test_tmpdir }}/unittestkey.pem",
+    "session_ticket_key_paths": ["{{ test_rundir }}/test/common/ssl/test_data/ticket_key_a"]
+  }
+  )EOF";
+  Json::ObjectSharedPtr server_ctx_loader = TestEnvironment::jsonLoadFromString(server_ctx_json);
+  ServerContextConfigImpl server_ctx_config(*server_ctx_loader);
+  ServerContextPtr server_ctx(
+      manager.createSslServerContext("server", {}, server_stats_store, server_ctx_config, false));
+
+  Event::DispatcherImpl dispatcher;
+  Network::TcpListenSocket socket(Network::Test::getCanonicalLoopbackAddress(GetParam()), true);
+  NiceMock<Network::MockListenerCallbacks> callbacks;
+  Network::MockConnectionHandler connection_handler;
+  Network::ListenerPtr listener = dispatcher.createSslListener(
+      connection_handler, *server_ctx, socket, callbacks, server_stats_store,
+      Network::ListenerOptions::listenerOptionsWithBindToPort());
+
+  Json::ObjectSharedPtr client_ctx_loader = TestEnvironment::jsonLoadFromString("{}");
+  ClientContextConfigImpl client_ctx_config(*client_ctx_loader);
+  ClientSslSocketFactory ssl_socket_factory(client_ctx_config, manager, client_stats_store);
+
+  for (uint64_t i = 1; i <= 2; i++) {
+    Network::ClientConnectionPtr client_connection = dispatcher.createClientConnection(
+        socket.localAddress(), Network::Address::InstanceConstSharedPtr(),
+        ssl_socket_factory.createTransportSocket());
+    Network::MockConnectionCallbacks client_connection_callbacks;
+    client_connection->addConnectionCallbacks(client_connection_callbacks);
+    client_connection->connect();
+
+    Network::ConnectionPtr server_connection;
+    Network::MockConnectionCallbacks server_connection_callbacks;
+    EXPECT_CALL(callbacks, onNewConnection_(_))
+        .WillOnce(Invoke([&](Network::ConnectionPtr& conn) -> void {
+          server_connection = std::move(conn);
+          server_connection->addConnectionCallbacks(server_connection_callbacks);
+        }));
+
+    // Wait until both ends have finished the handshake.
+    unsigned connect_count = 0;
+    auto stop_second_time = [&]() {
+      if (++connect_count == 2) {
+        client_connection->close(Network::ConnectionCloseType::NoFlush);
+        server_connection->close(Network::ConnectionCloseType::NoFlush);
+        dispatcher.exit();
+      }
+    };
+    EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::Connected))
+        .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { stop_second_time(); }));
+    EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::Connected))
+        .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { stop_second_time(); }));
+    EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+    EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+
+    dispatcher.run(Event::Dispatcher::RunType::Block);
+
+    EXPECT_EQ(i, client_stats_store.counter("ssl.handshake").value());
+    EXPECT_EQ(i - 1, client_stats_store.counter("ssl.session_reused").value());
+    EXPECT_EQ(i - 1, server_stats_store.counter("ssl.session_reused").value());
+  }
+
+  EXPECT_EQ(1UL, client_stats_store.counter("ssl.session_cache_miss").value());
+  EXPECT_EQ(1UL, client_stats_store.counter("ssl.session_cache_hit").value());
+}
+
+namespace {
+
+// Connect with a client to a server whose private key operations are done by the offload pool.
+void testPrivateKeyOffload(const std::string& client_ctx_json,
+                           const Network::Address::IpVersion ip_version) {
+  Stats::MockIsolatedStatsStore server_stats_store;
+  Stats::IsolatedStoreImpl client_stats_store;
+  Runtime::MockLoader runtime;
+  EXPECT_CALL(runtime.snapshot_, getInteger("ssl.private_key_offload_threads", 0))
+      .WillOnce(Return(2));
+  ContextManagerImpl manager(runtime);
+
+  std::string server_ctx_json = R"EOF(
+  {
+    "cert_chain_file": "{{ test_tmpdir }}/unittestcert.pem",
+    "private_key_file": "{{ test_tmpdir }}/unittestkey.pem"
+  }
+  )EOF";
+  Json::ObjectSharedPtr server_ctx_loader = TestEnvironment::jsonLoadFromString(server_ctx_json);
+  ServerContextConfigImpl server_ctx_config(*server_ctx_loader);
+  ServerContextPtr server_ctx(
+      manager.createSslServerContext("server", {}, server_stats_store, server_ctx_config, false));
+  ASSERT_NE(nullptr, dynamic_cast<ContextImpl&>(*server_ctx).privateKeyOffloadPool());
+
+  Event::DispatcherImpl dispatcher;
+  Network::TcpListenSocket socket(Network::Test::getCanonicalLoopbackAddress(ip_version), true);
+  NiceMock<Network::MockListenerCallbacks> callbacks;
+  Network::MockConnectionHandler connection_handler;
+  Network::ListenerPtr listener = dispatcher.createSslListener(
+      connection_handler, *server_ctx, socket, callbacks, server_stats_store,
+      Network::ListenerOptions::listenerOptionsWithBindToPort());
+
+  Json::ObjectSharedPtr client_ctx_loader = TestEnvironment::jsonLoadFromString(client_ctx_json);
+  ClientContextConfigImpl client_ctx_config(*client_ctx_loader);
+  ClientSslSocketFactory ssl_socket_factory(client_ctx_config, manager, client_stats_store);
+  Network::ClientConnectionPtr client_connection = dispatcher.createClientConnection(
+      socket.localAddress(), Network::Address::InstanceConstSharedPtr(),
+      ssl_socket_factory.createTransportSocket());
+  Network::MockConnectionCallbacks client_connection_callbacks;
+  client_connection->addConnectionCallbacks(client_connection_callbacks);
+  client_connection->connect();
+
+  Network::ConnectionPtr server_connection;
+  Network::MockConnectionCallbacks server_connection_callbacks;
+  EXPECT_CALL(callbacks, onNewConnection_(_))
+      .WillOnce(Invoke([&](Network::ConnectionPtr& conn) -> void {
+        server_connection = std::move(conn);
+        server_connection->addConnectionCallbacks(server_connection_callbacks);
+      }));
+
+  // The handshake of the server waits for the private key operation on the pool.
+  EXPECT_CALL(server_stats_store,
+              deliverHistogramToSinks(
+                  Property(&Stats::Metric::name, "ssl.private_key_operation_ms"), _));
+
+  unsigned connect_count = 0;
+  auto stop_second_time = [&]() {
+    if (++connect_count == 2) {
+      client_connection->close(Network::ConnectionCloseType::NoFlush);
+      server_connection->close(Network::ConnectionCloseType::NoFlush);
+      dispatcher.exit();
+    }
+  };
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::Connected))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { stop_second_time(); }));
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::Connected))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { stop_second_time(); }));
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+
+  dispatcher.run(Event::Dispatcher::RunType::Block);
+
+  EXPECT_EQ(1UL, server_stats_store.counter("ssl.handshake").value());
+  EXPECT_EQ(0UL, server_stats_store.gauge("ssl.private_key_operations_pending").value());
+}
+
+} // namespace
+
+// Validate that the signature of an ECDHE key exchange is done by the offload pool.
+TEST_P(SslSocketTest, PrivateKeyOffloadSign) {
+  std::string client_ctx_json = R"EOF(
+  {
+    "cipher_suites": "ECDHE-RSA-AES128-GCM-SHA256"
+  }
+  )EOF";
+  testPrivateKeyOffload(client_ctx_json, GetParam());
+}
+
+// Validate that the decryption of an RSA key exchange is done by the offload pool.
+TEST_P(SslSocketTest, PrivateKeyOffloadDecrypt) {
+  std::string client_ctx_json = R"EOF(
+  {
+    "cipher_suites": "AES128-SHA"
+  }
+  )EOF";
+  testPrivateKeyOffload(client_ctx_json, GetParam());
+}
+
+// Validate that a private key operation that is still pending when the server connection closes is
+// cancelled and no longer counted as pending.
+TEST_P(SslSocketTest, PrivateKeyOffloadCloseWhilePending) {
+  Stats::IsolatedStoreImpl server_stats_store;
+  Stats::IsolatedStoreImpl client_stats_store;
+  Runtime::MockLoader runtime;
+  EXPECT_CALL(runtime.snapshot_, getInteger("ssl.private_key_offload_threads", 0))
+      .WillOnce(Return(1));
+  ContextManagerImpl manager(runtime);
+
+  std::string server_ctx_json = R"EOF(
+  {
+    "cert_chain_file": "{{ test_tmpdir }}/unittestcert.pem",
+    "private_key_file": "{{ test_tmpdir }}/unittestkey.pem"
+  }
+  )EOF";
+  Json::ObjectSharedPtr server_ctx_loader = TestEnvironment::jsonLoadFromString(server_ctx_json);
+  ServerContextConfigImpl server_ctx_config(*server_ctx_loader);
+  ServerContextPtr server_ctx(
+      manager.createSslServerContext("server", {}, server_stats_store, server_ctx_config, false));
+  PrivateKeyOffloadPool* pool = dynamic_cast<ContextImpl&>(*server_ctx).privateKeyOffloadPool();
+  ASSERT_NE(nullptr, pool);
+
+  // Keep the only thread of the pool busy, so that the operation of the handshake stays queued.
+  std::promise<void> unblock_pool;
+  std::shared_future<void> pool_unblocked = unblock_pool.get_future().share();
+  pool->post([pool_unblocked]() -> void { pool_unblocked.wait(); });
+
+  Event::DispatcherImpl dispatcher;
+  Network::TcpListenSocket socket(Network::Test::getCanonicalLoopbackAddress(GetParam()), true);
+  NiceMock<Network::MockListenerCallbacks> callbacks;
+  Network::MockConnectionHandler connection_handler;
+  Network::ListenerPtr listener = dispatcher.createSslListener(
+      connection_handler, *server_ctx, socket, callbacks, server_stats_store,
+      Network::ListenerOptions::listenerOptionsWithBindToPort());
+
+  Json::ObjectSharedPtr client_ctx_loader = TestEnvironment::jsonLoadFromString("{}");
+  ClientContextConfigImpl client_ctx_config(*client_ctx_loader);
+  ClientSslSocketFactory ssl_socket_factory(client_ctx_config, manager, client_stats_store);
+  Network::ClientConnectionPtr client_connection = dispatcher.createClientConnection(
+      socket.localAddress(), Network::Address::InstanceConstSharedPtr(),
+      ssl_socket_factory.createTransportSocket());
+  NiceMock<Network::MockConnectionCallbacks> client_connection_callbacks;
+  client_connection->addConnectionCallbacks(client_connection_callbacks);
+  client_connection->connect();
+
+  Network::ConnectionPtr server_connection;
+  Network::MockConnectionCallbacks server_connection_callbacks;
+  EXPECT_CALL(callbacks, onNewConnection_(_))
+      .WillOnce(Invoke([&](Network::ConnectionPtr& conn) -> void {
+        server_connection = std::move(conn);
+        server_connection->addConnectionCallbacks(server_connection_callbacks);
+      }));
+
+  Stats::Gauge& pending = server_stats_store.gauge("ssl.private_key_operations_pending");
+  while (pending.value() == 0) {
+    dispatcher.run(Event::Dispatcher::RunType::NonBlock);
+  }
+
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+  server_connection->close(Network::ConnectionCloseType::NoFlush);
+  EXPECT_EQ(0UL, pending.value());
+
+  // The cancelled operation is still run by the pool, but its result is not posted back.
+  unblock_pool.set_value();
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::RemoteClose))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { dispatcher.exit(); }));
+  dispatcher.run(Event::Dispatcher::RunType::Block);
+
+  EXPECT_EQ(0UL, pending.value());
+  EXPECT_EQ(0UL, server_stats_store.counter("ssl.handshake").value());
+}
+
 TEST_P(SslSocketTest, SslError) {
   Stats::IsolatedStoreImpl stats_store;
   Runtime::MockLoader runtime;
@@ -1899,6 +2150,64 @@ public:
     EXPECT_EQ(0UL, stats_store_.counter("ssl.connection_error").value());
   }
 
+  // Writes num_writes buffers of write_size bytes at once, and checks the sizes of the plaintext of
+  // the records that the server receives.
+  void recordSizeTest(uint64_t coalesce_writes, uint64_t small_record_bytes, uint32_t write_size,
+                      uint32_t num_writes, const std::vector<size_t>& expected_record_sizes) {
+    ON_CALL(runtime_.snapshot_, getInteger("ssl.coalesce_writes", _))
+        .WillByDefault(Return(coalesce_writes));
+    ON_CALL(runtime_.snapshot_, getInteger("ssl.small_record_bytes", _))
+        .WillByDefault(Return(small_record_bytes));
+    initialize(0);
+
+    std::vector<size_t> record_sizes;
+    EXPECT_CALL(listener_callbacks_, onNewConnection_(_))
+        .WillOnce(Invoke([&](Network::ConnectionPtr& conn) -> void {
+          server_connection_ = std::move(conn);
+          server_connection_->addConnectionCallbacks(server_callbacks_);
+          server_connection_->addReadFilter(read_filter_);
+          SSL* ssl = dynamic_cast<SslSocket*>(server_connection_->ssl())->rawSslForTest();
+          SSL_set_msg_callback(ssl, [](int write_p, int, int content_type, const void* buf,
+                                       size_t len, SSL* ssl, void* arg) -> void {
+            const uint8_t* header = static_cast<const uint8_t*>(buf);
+            if (write_p || content_type != SSL3_RT_HEADER || len != SSL3_RT_HEADER_LENGTH ||
+                header[0] != SSL3_RT_APPLICATION_DATA) {
+              return;
+            }
+            const size_t record_length = (header[3] << 8) | header[4];
+            static_cast<std::vector<size_t>*>(arg)->push_back(
+                record_length + SSL3_RT_HEADER_LENGTH - SSL_max_seal_overhead(ssl));
+          });
+          SSL_set_msg_callback_arg(ssl, &record_sizes);
+        }));
+
+    EXPECT_CALL(client_callbacks_, onEvent(Network::ConnectionEvent::Connected))
+        .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { dispatcher_->exit(); }));
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+    uint64_t filter_seen = 0;
+    EXPECT_CALL(*read_filter_, onNewConnection());
+    EXPECT_CALL(*read_filter_, onData(_))
+        .WillRepeatedly(Invoke([&](Buffer::Instance& data) -> Network::FilterStatus {
+          filter_seen += data.length();
+          data.drain(data.length());
+          if (filter_seen == write_size * num_writes) {
+            server_connection_->close(Network::ConnectionCloseType::FlushWrite);
+          }
+          return Network::FilterStatus::StopIteration;
+        }));
+    EXPECT_CALL(client_callbacks_, onEvent(Network::ConnectionEvent::RemoteClose))
+        .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { dispatcher_->exit(); }));
+
+    for (uint32_t i = 0; i < num_writes; i++) {
+      Buffer::OwnedImpl data(std::string(write_size, 'a'));
+      client_connection_->write(data);
+    }
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+    EXPECT_EQ(expected_record_sizes, record_sizes);
+  }
+
   void singleWriteTest(uint32_t read_buffer_limit, uint32_t bytes_to_write) {
     MockWatermarkBuffer* client_write_buffer = nullptr;
     MockBufferFactory* factory = new StrictMock<MockBufferFactory>;
@@ -2019,6 +2328,22 @@ TEST_P(SslReadBufferLimitTest, WritesSmallerThanBufferLimit) { singleWriteTest(5
 
 TEST_P(SslReadBufferLimitTest, WritesLargerThanBufferLimit) { singleWriteTest(1024, 5 * 1024); }
 
+TEST_P(SslReadBufferLimitTest, SmallWritesPerSliceRecords) {
+  recordSizeTest(0, 0, 1000, 64, std::vector<size_t>(64, 1000));
+}
+
+TEST_P(SslReadBufferLimitTest, SmallWritesCoalescedIntoFullRecords) {
+  recordSizeTest(1, 0, 1000, 64, {16384, 16384, 16384, 14848});
+}
+
+TEST_P(SslReadBufferLimitTest, LargeWriteInFullRecords) {
+  recordSizeTest(1, 0, 40000, 1, {16384, 16384, 7232});
+}
+
+TEST_P(SslReadBufferLimitTest, SmallRecordsAtConnectionStart) {
+  recordSizeTest(1, 4000, 1000, 64, {1400, 1400, 1400, 16384, 16384, 16384, 10648});
+}
+
 TEST_P(SslReadBufferLimitTest, TestBind) {
   std::string address_string = TestUtility::getIpv4Loopback();
   if (GetParam() == Network::Address::IpVersion::v4) {
@@ -0,0 +1,190 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/ssl/context_config_impl.h"
+#include "common/ssl/context_impl.h"
+#include "common/ssl/context_manager_impl.h"
+#include "common/ssl/ssl_socket.h"
+#include "common/stats/stats_impl.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/runtime/mocks.h"
+
+#include "api/sds.pb.h"
+#include "openssl/ssl.h"
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Ssl {
+
+/**
+ * A client SslSocket and a server SSL on the two ends of a socket pair. The server reads everything
+ * that the client socket writes. This should be run from the runfiles directory, e.g. with bazel
+ * run, so that the certificates are found.
+ */
+class WriteTester : public Network::TransportSocketCallbacks {
+public:
+  /**
+   * @param coalesce_writes supplies whether the client socket gathers slices into full records,
+   *        rather than writes a record per slice.
+   */
+  WriteTester(bool coalesce_writes) : manager_(runtime_) {
+    ON_CALL(runtime_.snapshot_, getInteger("ssl.coalesce_writes", testing::_))
+        .WillByDefault(testing::Return(coalesce_writes));
+
+    envoy::api::v2::DownstreamTlsContext server_config;
+    auto* certificate = server_config.mutable_common_tls_context()->add_tls_certificates();
+    certificate->mutable_certificate_chain()->set_filename(
+        "test/common/ssl/test_data/san_dns_cert.pem");
+    certificate->mutable_private_key()->set_filename("test/common/ssl/test_data/san_dns_key.pem");
+    ServerContextConfigImpl server_context_config(server_config);
+    server_context_ =
+        manager_.createSslServerContext("server", {}, stats_store_, server_context_config, false);
+
+    ClientContextConfigImpl client_context_config((envoy::api::v2::UpstreamTlsContext()));
+    client_context_ = manager_.createSslClientContext(stats_store_, client_context_config);
+
+    int rc = socketpair(AF_UNIX, SOCK_STREAM, 0, fds_);
+    RELEASE_ASSERT(rc == 0);
+    for (int fd : fds_) {
+      rc = fcntl(fd, F_SETFL, O_NONBLOCK);
+      RELEASE_ASSERT(rc == 0);
+    }
+    UNREFERENCED_PARAMETER(rc);
+
+    client_.reset(new SslSocket(*client_context_, InitialState::Client));
+    client_->setTransportSocketCallbacks(*this);
+    server_ = dynamic_cast<ContextImpl&>(*server_context_).newSsl();
+    SSL_set_fd(server_.get(), fds_[1]);
+    SSL_set_accept_state(server_.get());
+    SSL_set_msg_callback(server_.get(), recordCallback);
+    SSL_set_msg_callback_arg(server_.get(), this);
+
+    Buffer::OwnedImpl empty;
+    bool server_connected = false;
+    while (!connected_ || !server_connected) {
+      RELEASE_ASSERT(client_->doWrite(empty).action_ == Network::PostIoAction::KeepOpen);
+      server_connected = server_connected || SSL_do_handshake(server_.get()) == 1;
+    }
+    records_ = 0;
+  }
+
+  ~WriteTester() {
+    client_.reset();
+    server_.reset();
+    close(fds_[0]);
+    close(fds_[1]);
+  }
+
+  /**
+   * Write all of data with the client socket, and read it on the server.
+   */
+  void write(Buffer::Instance& data) {
+    while (data.length() > 0) {
+      RELEASE_ASSERT(client_->doWrite(data).action_ == Network::PostIoAction::KeepOpen);
+      while (SSL_read(server_.get(), read_buffer_, sizeof(read_buffer_)) > 0) {
+      }
+    }
+  }
+
+  // The number of application data records that the server received.
+  uint64_t records() const { return records_; }
+
+  // Network::TransportSocketCallbacks
+  int fd() override { return fds_[0]; }
+  Network::Connection& connection() override { return connection_; }
+  bool shouldDrainReadBuffer() override { return false; }
+  void setReadBufferReady() override {}
+  void raiseEvent(Network::ConnectionEvent event) override {
+    connected_ = connected_ || event == Network::ConnectionEvent::Connected;
+  }
+
+private:
+  static void recordCallback(int write_p, int, int content_type, const void* buf, size_t len,
+                             SSL*, void* arg) {
+    if (!write_p && content_type == SSL3_RT_HEADER && len == SSL3_RT_HEADER_LENGTH &&
+        static_cast<const uint8_t*>(buf)[0] == SSL3_RT_APPLICATION_DATA) {
+      static_cast<WriteTester*>(arg)->records_++;
+    }
+  }
+
+  Stats::IsolatedStoreImpl stats_store_;
+  testing::NiceMock<Runtime::MockLoader> runtime_;
+  testing::NiceMock<Network::MockConnection> connection_;
+  ContextManagerImpl manager_;
+  ServerContextPtr server_context_;
+  ClientContextPtr client_context_;
+  int fds_[2];
+  std::unique_ptr<SslSocket> client_;
+  bssl::UniquePtr<SSL> server_;
+  bool connected_{};
+  uint64_t records_{};
+  uint8_t read_buffer_[65536];
+};
+
+// Fill data with num_slices slices of slice_size bytes, as a write buffer that filters moved
+// several small buffers into.
+static void addSlices(Buffer::Instance& data, uint32_t num_slices, uint32_t slice_size) {
+  for (uint32_t i = 0; i < num_slices; i++) {
+    Buffer::OwnedImpl slice(std::string(slice_size, 'a'));
+    data.move(slice);
+  }
+}
+
+// Many small responses, each of a 512 byte head and 8 body slices of 256 bytes, written one
+// response at a time. The first argument is whether the slices are coalesced into full records.
+static void BM_WriteSmallResponses(benchmark::State& state) {
+  WriteTester tester(state.range(0));
+  while (state.KeepRunning()) {
+    Buffer::OwnedImpl data;
+    addSlices(data, 1, 512);
+    addSlices(data, 8, 256);
+    tester.write(data);
+  }
+  state.SetBytesProcessed(state.iterations() * (512 + 8 * 256));
+  state.counters["records_per_write"] = static_cast<double>(tester.records()) / state.iterations();
+}
+BENCHMARK(BM_WriteSmallResponses)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// A bulk transfer of 1MB that was read into slices of the second argument bytes. The first
+// argument is whether the slices are coalesced into full records.
+static void BM_WriteBulk(benchmark::State& state) {
+  const uint32_t BULK_SIZE = 1024 * 1024;
+  WriteTester tester(state.range(0));
+  while (state.KeepRunning()) {
+    Buffer::OwnedImpl data;
+    addSlices(data, BULK_SIZE / state.range(1), state.range(1));
+    tester.write(data);
+  }
+  state.SetBytesProcessed(state.iterations() * BULK_SIZE);
+  state.counters["records_per_write"] = static_cast<double>(tester.records()) / state.iterations();
+}
+BENCHMARK(BM_WriteBulk)
+    ->Args({0, 4096})
+    ->Args({1, 4096})
+    ->Args({0, 16384})
+    ->Args({1, 16384})
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace Ssl
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -1,4 +1,5 @@
 #include "common/stats/grpc_metrics_service_impl.h"
+#include "common/stats/histogram_impl.h"
 
 #include "test/mocks/grpc/mocks.h"
 #include "test/mocks/local_info/mocks.h"
@@ -10,6 +11,7 @@ using testing::InSequence;
 using testing::Invoke;
 using testing::NiceMock;
 using testing::Return;
+using testing::ReturnRef;
 using testing::_;
 
 namespace Envoy {
@@ -142,6 +144,41 @@ TEST(MetricsServiceSinkTest, CheckStatsCount) {
   EXPECT_EQ(1, (*streamer_).metric_count);
 }
 
+TEST(MetricsServiceSinkTest, FlushHistogram) {
+  std::shared_ptr<MockGrpcMetricsStreamer> streamer_{new MockGrpcMetricsStreamer()};
+
+  MetricsServiceSink sink(streamer_);
+
+  sink.beginFlush();
+
+  // Ten samples of value 7.
+  HistogramStatisticsImpl statistics;
+  std::vector<uint64_t> counts(8);
+  counts[7] = 10;
+  statistics.refresh(counts, 70);
+
+  NiceMock<MockParentHistogram> histogram;
+  histogram.name_ = "test_histogram";
+  ON_CALL(histogram, cumulativeStatistics()).WillByDefault(ReturnRef(statistics));
+  sink.flushHistogram(histogram);
+
+  EXPECT_CALL(*streamer_, send(_))
+      .WillOnce(Invoke([](envoy::api::v2::StreamMetricsMessage& message) {
+        ASSERT_EQ(1, message.envoy_metrics_size());
+        const io::prometheus::client::MetricFamily& metrics_family = message.envoy_metrics(0);
+        EXPECT_EQ("test_histogram", metrics_family.name());
+        EXPECT_EQ(io::prometheus::client::MetricType::SUMMARY, metrics_family.type());
+        const io::prometheus::client::Summary& summary = metrics_family.metric(0).summary();
+        EXPECT_EQ(10, summary.sample_count());
+        EXPECT_EQ(70, summary.sample_sum());
+        ASSERT_EQ(4, summary.quantile_size());
+        EXPECT_EQ(0.5, summary.quantile(0).quantile());
+        EXPECT_EQ(7.5, summary.quantile(0).value());
+        EXPECT_EQ(0.999, summary.quantile(3).quantile());
+      }));
+  sink.endFlush();
+}
+
 } // namespace Metrics
 } // namespace Stats
 } // namespace Envoy
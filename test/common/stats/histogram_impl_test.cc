@@ -0,0 +1,180 @@
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "common/stats/histogram_impl.h"
+
+#include "test/mocks/stats/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::Ref;
+
+namespace Envoy {
+namespace Stats {
+
+TEST(HistogramBucketsTest, SmallValuesAreExact) {
+  for (uint64_t value = 0; value < HistogramBuckets::SUB_BUCKETS * 2; value++) {
+    const uint32_t index = HistogramBuckets::index(value);
+    EXPECT_EQ(value, HistogramBuckets::lowerBound(index));
+    EXPECT_EQ(1, HistogramBuckets::width(index));
+  }
+}
+
+TEST(HistogramBucketsTest, Bounds) {
+  for (uint32_t index = 0; index < HistogramBuckets::NUM_BUCKETS; index++) {
+    const uint64_t lower = HistogramBuckets::lowerBound(index);
+    const uint64_t last = lower + (HistogramBuckets::width(index) - 1);
+    EXPECT_EQ(index, HistogramBuckets::index(lower));
+    EXPECT_EQ(index, HistogramBuckets::index(last));
+    // No bucket is wider than 1/SUB_BUCKETS of its lower bound.
+    EXPECT_LE(HistogramBuckets::width(index) * HistogramBuckets::SUB_BUCKETS,
+              std::max<uint64_t>(lower, HistogramBuckets::SUB_BUCKETS));
+  }
+  EXPECT_EQ(HistogramBuckets::NUM_BUCKETS - 1, HistogramBuckets::index(UINT64_MAX));
+  EXPECT_EQ(32, HistogramBuckets::lowerBound(HistogramBuckets::index(33)));
+  EXPECT_EQ(992, HistogramBuckets::lowerBound(HistogramBuckets::index(1000)));
+  EXPECT_EQ(1024, HistogramBuckets::lowerBound(HistogramBuckets::index(1087)));
+}
+
+class HistogramStatisticsImplTest : public testing::Test {
+public:
+  void record(uint64_t value) {
+    const uint32_t index = HistogramBuckets::index(value);
+    if (counts_.size() <= index) {
+      counts_.resize(index + 1);
+    }
+    counts_[index]++;
+    sum_ += value;
+  }
+
+  std::vector<uint64_t> counts_;
+  uint64_t sum_{};
+  HistogramStatisticsImpl statistics_;
+};
+
+TEST_F(HistogramStatisticsImplTest, Empty) {
+  statistics_.refresh(counts_, sum_);
+  EXPECT_EQ(0, statistics_.sampleCount());
+  EXPECT_EQ(0, statistics_.sampleSum());
+  EXPECT_EQ((std::vector<double>{0.5, 0.9, 0.99, 0.999}), statistics_.supportedQuantiles());
+  for (double value : statistics_.computedQuantiles()) {
+    EXPECT_TRUE(std::isnan(value));
+  }
+  EXPECT_EQ("P50: nan, P90: nan, P99: nan, P99.9: nan", statistics_.summary());
+}
+
+TEST_F(HistogramStatisticsImplTest, SingleValue) {
+  for (uint32_t i = 0; i < 10; i++) {
+    record(7);
+  }
+  statistics_.refresh(counts_, sum_);
+  EXPECT_EQ(10, statistics_.sampleCount());
+  EXPECT_EQ(70, statistics_.sampleSum());
+  const std::vector<double> expected{7.5, 7.9, 7.99, 7.999};
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_DOUBLE_EQ(expected[i], statistics_.computedQuantiles()[i]);
+  }
+  EXPECT_EQ("P50: 7.5, P90: 7.9, P99: 7.99, P99.9: 7.999", statistics_.summary());
+}
+
+TEST_F(HistogramStatisticsImplTest, Uniform) {
+  for (uint64_t value = 1; value <= 100000; value++) {
+    record(value);
+  }
+  statistics_.refresh(counts_, sum_);
+  EXPECT_EQ(100000, statistics_.sampleCount());
+  EXPECT_EQ(5000050000, statistics_.sampleSum());
+
+  const std::vector<double> expected{50000, 90000, 99000, 99900};
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_NEAR(expected[i], statistics_.computedQuantiles()[i],
+                expected[i] / HistogramBuckets::SUB_BUCKETS);
+  }
+}
+
+class HistogramImplTest : public testing::Test {
+public:
+  HistogramImplTest() : parent_("h", store_, "h", {}) {}
+
+  NiceMock<MockStore> store_;
+  ParentHistogramImpl parent_;
+};
+
+TEST_F(HistogramImplTest, DeliverToSinks) {
+  ThreadLocalHistogramSharedPtr child = parent_.createThreadLocal();
+  EXPECT_EQ("h", child->name());
+  EXPECT_CALL(store_, deliverHistogramToSinks(Ref(*child), 5));
+  child->recordValue(5);
+  EXPECT_CALL(store_, deliverHistogramToSinks(Ref(parent_), 6));
+  parent_.recordValue(6);
+}
+
+TEST_F(HistogramImplTest, Merge) {
+  EXPECT_FALSE(parent_.used());
+  parent_.merge();
+  EXPECT_FALSE(parent_.used());
+  EXPECT_EQ(0, parent_.intervalStatistics().sampleCount());
+
+  ThreadLocalHistogramSharedPtr child1 = parent_.createThreadLocal();
+  ThreadLocalHistogramSharedPtr child2 = parent_.createThreadLocal();
+  child1->recordValue(1);
+  child2->recordValue(3);
+  parent_.recordValue(2);
+  parent_.merge();
+  EXPECT_TRUE(parent_.used());
+  EXPECT_EQ(3, parent_.intervalStatistics().sampleCount());
+  EXPECT_EQ(6, parent_.intervalStatistics().sampleSum());
+  EXPECT_EQ(2.5, parent_.intervalStatistics().computedQuantiles()[0]);
+  EXPECT_EQ(3, parent_.cumulativeStatistics().sampleCount());
+
+  // Samples recorded by a child that has since been released are still merged.
+  child2->recordValue(10);
+  child2.reset();
+  parent_.merge();
+  EXPECT_EQ(1, parent_.intervalStatistics().sampleCount());
+  EXPECT_EQ(10, parent_.intervalStatistics().sampleSum());
+  EXPECT_EQ(4, parent_.cumulativeStatistics().sampleCount());
+  EXPECT_EQ(16, parent_.cumulativeStatistics().sampleSum());
+
+  parent_.merge();
+  EXPECT_TRUE(parent_.used());
+  EXPECT_EQ(0, parent_.intervalStatistics().sampleCount());
+  EXPECT_TRUE(std::isnan(parent_.intervalStatistics().computedQuantiles()[0]));
+  EXPECT_EQ(4, parent_.cumulativeStatistics().sampleCount());
+}
+
+// Merging while other threads record neither loses nor double counts samples.
+TEST_F(HistogramImplTest, ConcurrentMerge) {
+  const uint32_t num_threads = 4;
+  const uint32_t samples_per_thread = 10000;
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < num_threads; i++) {
+    threads.emplace_back([this, i]() -> void {
+      ThreadLocalHistogramSharedPtr child = parent_.createThreadLocal();
+      for (uint32_t value = 0; value < samples_per_thread; value++) {
+        child->recordValue(value);
+        // The unthreaded histogram may be shared by several threads.
+        parent_.recordValue(i);
+      }
+    });
+  }
+
+  uint64_t merged = 0;
+  while (merged < 2 * num_threads * samples_per_thread) {
+    parent_.merge();
+    merged += parent_.intervalStatistics().sampleCount();
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  parent_.merge();
+  EXPECT_EQ(0, parent_.intervalStatistics().sampleCount());
+  EXPECT_EQ(2 * num_threads * samples_per_thread, parent_.cumulativeStatistics().sampleCount());
+}
+
+} // namespace Stats
+} // namespace Envoy
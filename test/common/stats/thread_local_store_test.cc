@@ -106,6 +106,8 @@ TEST_F(StatsThreadLocalStoreTest, NoTls) {
   h1.recordValue(200);
   EXPECT_CALL(sink_, onHistogramComplete(Ref(h1), 100));
   store_->deliverHistogramToSinks(h1, 100);
+  EXPECT_EQ(1UL, store_->histograms().size());
+  EXPECT_EQ(&h1, store_->histograms().front().get());
 
   EXPECT_EQ(2UL, store_->counters().size());
   EXPECT_EQ(&c1, store_->counters().front().get());
@@ -132,8 +134,19 @@ TEST_F(StatsThreadLocalStoreTest, Tls) {
   Gauge& g1 = store_->gauge("g1");
   EXPECT_EQ(&g1, &store_->gauge("g1"));
 
+  // Each thread records into its own histogram, which the parent in the central cache merges.
   Histogram& h1 = store_->histogram("h1");
   EXPECT_EQ(&h1, &store_->histogram("h1"));
+  EXPECT_CALL(sink_, onHistogramComplete(Ref(h1), 200));
+  h1.recordValue(200);
+  EXPECT_EQ(1UL, store_->histograms().size());
+  ParentHistogramSharedPtr parent_h1 = store_->histograms().front();
+  EXPECT_NE(&h1, parent_h1.get());
+  EXPECT_EQ("h1", parent_h1->name());
+  parent_h1->merge();
+  EXPECT_TRUE(parent_h1->used());
+  EXPECT_EQ(1UL, parent_h1->intervalStatistics().sampleCount());
+  EXPECT_EQ(200UL, parent_h1->intervalStatistics().sampleSum());
 
   EXPECT_EQ(2UL, store_->counters().size());
   EXPECT_EQ(&c1, store_->counters().front().get());
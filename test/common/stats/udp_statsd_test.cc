@@ -2,8 +2,10 @@
 
 #include "common/network/address_impl.h"
 #include "common/network/utility.h"
+#include "common/stats/stats_impl.h"
 #include "common/stats/statsd.h"
 
+#include "test/mocks/event/mocks.h"
 #include "test/mocks/stats/mocks.h"
 #include "test/mocks/thread_local/mocks.h"
 #include "test/test_common/environment.h"
@@ -14,6 +16,7 @@
 #include "spdlog/spdlog.h"
 
 using testing::NiceMock;
+using testing::_;
 
 namespace Envoy {
 namespace Stats {
@@ -22,6 +25,23 @@ namespace Statsd {
 class MockWriter : public Writer {
 public:
   MOCK_METHOD1(write, void(const std::string& message));
+  MOCK_METHOD1(writeDatagrams, uint64_t(const std::vector<absl::string_view>& datagrams));
+};
+
+// Records datagrams passed to writeDatagrams(), accepting at most accept_ of each batch.
+class RecordingWriter : public Writer {
+public:
+  uint64_t writeDatagrams(const std::vector<absl::string_view>& datagrams) override {
+    for (absl::string_view datagram : datagrams) {
+      datagrams_.emplace_back(datagram.data(), datagram.size());
+    }
+    calls_++;
+    return std::min<uint64_t>(accept_, datagrams.size());
+  }
+
+  std::vector<std::string> datagrams_;
+  uint64_t calls_{};
+  uint64_t accept_{UINT64_MAX};
 };
 
 class UdpStatsdSinkTest : public testing::TestWithParam<Network::Address::IpVersion> {};
@@ -30,11 +50,12 @@ INSTANTIATE_TEST_CASE_P(IpVersions, UdpStatsdSinkTest,
 
 TEST_P(UdpStatsdSinkTest, InitWithIpAddress) {
   NiceMock<ThreadLocal::MockInstance> tls_;
+  IsolatedStoreImpl stats_store;
   // UDP statsd server address.
   Network::Address::InstanceConstSharedPtr server_address =
       Network::Utility::parseInternetAddressAndPort(
           fmt::format("{}:8125", Network::Test::getLoopbackAddressUrlString(GetParam())));
-  UdpStatsdSink sink(tls_, server_address, false);
+  UdpStatsdSink sink(tls_, server_address, false, stats_store);
   int fd = sink.getFdForTests();
   EXPECT_NE(fd, -1);
 
@@ -67,11 +88,12 @@ INSTANTIATE_TEST_CASE_P(IpVersions, UdpStatsdSinkWithTagsTest,
 
 TEST_P(UdpStatsdSinkWithTagsTest, InitWithIpAddress) {
   NiceMock<ThreadLocal::MockInstance> tls_;
+  IsolatedStoreImpl stats_store;
   // UDP statsd server address.
   Network::Address::InstanceConstSharedPtr server_address =
       Network::Utility::parseInternetAddressAndPort(
           fmt::format("{}:8125", Network::Test::getLoopbackAddressUrlString(GetParam())));
-  UdpStatsdSink sink(tls_, server_address, true);
+  UdpStatsdSink sink(tls_, server_address, true, stats_store);
   int fd = sink.getFdForTests();
   EXPECT_NE(fd, -1);
 
@@ -106,7 +128,8 @@ TEST_P(UdpStatsdSinkWithTagsTest, InitWithIpAddress) {
 TEST(UdpStatsdSinkTest, CheckActualStats) {
   auto writer_ptr = std::make_shared<NiceMock<MockWriter>>();
   NiceMock<ThreadLocal::MockInstance> tls_;
-  UdpStatsdSink sink(tls_, writer_ptr, false);
+  IsolatedStoreImpl stats_store;
+  UdpStatsdSink sink(tls_, writer_ptr, false, stats_store);
 
   NiceMock<MockCounter> counter;
   counter.name_ = "test_counter";
@@ -132,7 +155,8 @@ TEST(UdpStatsdSinkTest, CheckActualStats) {
 TEST(UdpStatsdSinkWithTagsTest, CheckActualStats) {
   auto writer_ptr = std::make_shared<NiceMock<MockWriter>>();
   NiceMock<ThreadLocal::MockInstance> tls_;
-  UdpStatsdSink sink(tls_, writer_ptr, true);
+  IsolatedStoreImpl stats_store;
+  UdpStatsdSink sink(tls_, writer_ptr, true, stats_store);
 
   std::vector<Tag> tags = {Tag{"key1", "value1"}, Tag{"key2", "value2"}};
   NiceMock<MockCounter> counter;
@@ -159,6 +183,161 @@ TEST(UdpStatsdSinkWithTagsTest, CheckActualStats) {
   tls_.shutdownThread();
 }
 
+TEST(DatagramBufferTest, PacksLinesUpToLimit) {
+  RecordingWriter writer;
+  IsolatedStoreImpl stats_store;
+  Counter& sent = stats_store.counter("sent");
+  Counter& dropped = stats_store.counter("dropped");
+  DatagramBuffer buffer;
+  EXPECT_TRUE(buffer.empty());
+
+  // "aaaa\nbbbb" is 9 bytes; a third line would need 14.
+  buffer.add("aaaa", 10);
+  buffer.add("bbbb", 10);
+  EXPECT_EQ(0U, buffer.completeDatagrams());
+  buffer.add("cccc", 10);
+  EXPECT_EQ(1U, buffer.completeDatagrams());
+  // Longer than the limit, so sent on its own.
+  buffer.add("dddddddddddd", 10);
+  EXPECT_EQ(2U, buffer.completeDatagrams());
+  buffer.add("e", 10);
+
+  buffer.flush(writer, sent, dropped);
+  EXPECT_EQ(std::vector<std::string>({"aaaa\nbbbb", "cccc", "dddddddddddd", "e"}),
+            writer.datagrams_);
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_EQ(4U, sent.value());
+  EXPECT_EQ(0U, dropped.value());
+
+  writer.datagrams_.clear();
+  writer.accept_ = 1;
+  buffer.add("f", 10);
+  buffer.add("g", 10);
+  buffer.add("hhhhhhhhh", 10);
+  buffer.flush(writer, sent, dropped);
+  EXPECT_EQ(std::vector<std::string>({"f\ng", "hhhhhhhhh"}), writer.datagrams_);
+  EXPECT_EQ(5U, sent.value());
+  EXPECT_EQ(1U, dropped.value());
+}
+
+TEST(UdpStatsdSinkTest, BufferedFlush) {
+  auto writer_ptr = std::make_shared<RecordingWriter>();
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  IsolatedStoreImpl stats_store;
+  UdpStatsdSink sink(tls_, writer_ptr, false, stats_store, 48);
+
+  NiceMock<MockCounter> counter;
+  counter.name_ = "test_counter";
+  NiceMock<MockGauge> gauge;
+  gauge.name_ = "test_gauge";
+
+  sink.beginFlush();
+  sink.flushCounter(counter, 1);
+  sink.flushGauge(gauge, 2);
+  sink.flushCounter(counter, 3);
+  EXPECT_EQ(0U, writer_ptr->calls_);
+  sink.endFlush();
+
+  EXPECT_EQ(1U, writer_ptr->calls_);
+  EXPECT_EQ(std::vector<std::string>({"envoy.test_counter:1|c\nenvoy.test_gauge:2|g",
+                                      "envoy.test_counter:3|c"}),
+            writer_ptr->datagrams_);
+  EXPECT_EQ(2U, stats_store.counter("statsd.datagrams_sent").value());
+  EXPECT_EQ(0U, stats_store.counter("statsd.datagrams_dropped").value());
+
+  tls_.shutdownThread();
+}
+
+TEST(UdpStatsdSinkTest, BufferedTimers) {
+  auto writer_ptr = std::make_shared<RecordingWriter>();
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  IsolatedStoreImpl stats_store;
+  Event::MockTimer* timer = new Event::MockTimer(&tls_.dispatcher_);
+  UdpStatsdSink sink(tls_, writer_ptr, false, stats_store, 1024);
+
+  NiceMock<MockHistogram> histogram;
+  histogram.name_ = "test_timer";
+
+  // The flush timer is only armed by the first buffered timer.
+  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(100)));
+  sink.onHistogramComplete(histogram, 5);
+  sink.onHistogramComplete(histogram, 6);
+  EXPECT_EQ(0U, writer_ptr->calls_);
+
+  timer->callback_();
+  EXPECT_EQ(std::vector<std::string>({"envoy.test_timer:5|ms\nenvoy.test_timer:6|ms"}),
+            writer_ptr->datagrams_);
+
+  // Nothing buffered, nothing written.
+  timer->callback_();
+  EXPECT_EQ(1U, writer_ptr->calls_);
+
+  tls_.shutdownThread();
+}
+
+TEST(UdpStatsdSinkTest, BufferedTimersFlushOnDestruction) {
+  auto writer_ptr = std::make_shared<RecordingWriter>();
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  IsolatedStoreImpl stats_store;
+  new NiceMock<Event::MockTimer>(&tls_.dispatcher_);
+  UdpStatsdSink sink(tls_, writer_ptr, false, stats_store, 1024);
+
+  NiceMock<MockHistogram> histogram;
+  histogram.name_ = "test_timer";
+
+  // The timer never fires, so the buffered timer is sent when the thread's sink goes away.
+  sink.onHistogramComplete(histogram, 5);
+  EXPECT_EQ(0U, writer_ptr->calls_);
+
+  tls_.shutdownThread();
+  EXPECT_EQ(std::vector<std::string>({"envoy.test_timer:5|ms"}), writer_ptr->datagrams_);
+  EXPECT_EQ(1U, stats_store.counter("statsd.datagrams_sent").value());
+}
+
+TEST(UdpStatsdSinkTest, BufferedTimersFlushWhenFull) {
+  auto writer_ptr = std::make_shared<RecordingWriter>();
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  IsolatedStoreImpl stats_store;
+  Event::MockTimer* timer = new Event::MockTimer(&tls_.dispatcher_);
+  UdpStatsdSink sink(tls_, writer_ptr, false, stats_store, 1);
+
+  NiceMock<MockHistogram> histogram;
+  histogram.name_ = "test_timer";
+
+  EXPECT_CALL(*timer, enableTimer(_));
+  // With a 1 byte limit every timer gets its own datagram, and the 64th complete datagram
+  // triggers a write.
+  for (uint32_t i = 0; i < 65; i++) {
+    sink.onHistogramComplete(histogram, i);
+  }
+  EXPECT_EQ(1U, writer_ptr->calls_);
+  EXPECT_EQ(65U, writer_ptr->datagrams_.size());
+
+  tls_.shutdownThread();
+}
+
+TEST_P(UdpStatsdSinkTest, WriteDatagrams) {
+  // Bind a local UDP server for the writer to send to.
+  Network::Address::InstanceConstSharedPtr server_address =
+      Network::Test::getCanonicalLoopbackAddress(GetParam());
+  const int server_fd = server_address->socket(Network::Address::SocketType::Datagram);
+  ASSERT_NE(-1, server_fd);
+  ASSERT_EQ(0, server_address->bind(server_fd));
+  server_address = Network::Address::addressFromFd(server_fd);
+
+  Writer writer(server_address);
+  const std::vector<std::string> payloads = {"envoy.a:1|c\nenvoy.b:2|g", "envoy.c:3|ms"};
+  EXPECT_EQ(2U, writer.writeDatagrams({payloads[0], payloads[1]}));
+
+  char buffer[128];
+  for (const std::string& payload : payloads) {
+    const ssize_t received = ::recv(server_fd, buffer, sizeof(buffer), 0);
+    ASSERT_EQ(static_cast<ssize_t>(payload.size()), received);
+    EXPECT_EQ(payload, std::string(buffer, received));
+  }
+  ::close(server_fd);
+}
+
 } // namespace Statsd
 } // namespace Stats
 } // namespace Envoy
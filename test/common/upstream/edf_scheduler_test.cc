@@ -0,0 +1,79 @@
+#include <memory>
+#include <vector>
+
+#include "common/upstream/edf_scheduler.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Upstream {
+
+TEST(EdfSchedulerTest, Empty) {
+  EdfScheduler<uint32_t> sched;
+  EXPECT_TRUE(sched.empty());
+  EXPECT_EQ(nullptr, sched.pick());
+}
+
+// Entries with the same weight are picked in the order they were added.
+TEST(EdfSchedulerTest, Unweighted) {
+  EdfScheduler<uint32_t> sched;
+  constexpr uint32_t num_entries = 128;
+  std::shared_ptr<uint32_t> entries[num_entries];
+
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    entries[i] = std::make_shared<uint32_t>(i);
+    sched.add(1, entries[i]);
+  }
+
+  for (uint32_t rounds = 0; rounds < 128; ++rounds) {
+    for (uint32_t i = 0; i < num_entries; ++i) {
+      auto peek = sched.pick();
+      EXPECT_EQ(i, *peek);
+      sched.add(1, peek);
+    }
+  }
+}
+
+// Entries are picked in proportion to their weight.
+TEST(EdfSchedulerTest, Weighted) {
+  EdfScheduler<uint32_t> sched;
+  constexpr uint32_t num_entries = 128;
+  std::shared_ptr<uint32_t> entries[num_entries];
+  uint32_t pick_count[num_entries];
+
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    entries[i] = std::make_shared<uint32_t>(i);
+    sched.add(i + 1, entries[i]);
+    pick_count[i] = 0;
+  }
+
+  for (uint32_t i = 0; i < (num_entries * (1 + num_entries)) / 2; ++i) {
+    auto peek = sched.pick();
+    ++pick_count[*peek];
+    sched.add(*peek + 1, peek);
+  }
+
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    EXPECT_NEAR(i + 1, pick_count[i], 1);
+  }
+}
+
+// An entry that is not added back after a pick is no longer scheduled.
+TEST(EdfSchedulerTest, Expired) {
+  EdfScheduler<uint32_t> sched;
+  auto first_entry = std::make_shared<uint32_t>(37);
+  auto second_entry = std::make_shared<uint32_t>(41);
+
+  sched.add(2, first_entry);
+  sched.add(1, second_entry);
+
+  EXPECT_EQ(37, *sched.pick());
+  auto peek = sched.pick();
+  EXPECT_EQ(41, *peek);
+  sched.add(1, peek);
+  EXPECT_EQ(41, *sched.pick());
+  EXPECT_TRUE(sched.empty());
+}
+
+} // namespace Upstream
+} // namespace Envoy
@@ -0,0 +1,110 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <cstdint>
+#include <memory>
+
+#include "common/upstream/eds.h"
+
+#include "test/common/upstream/utility.h"
+#include "test/mocks/local_info/mocks.h"
+#include "test/mocks/runtime/mocks.h"
+#include "test/mocks/ssl/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+
+#include "api/eds.pb.h"
+#include "fmt/format.h"
+#include "testing/base/public/benchmark.h"
+
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Upstream {
+
+class EdsSpeedTest {
+public:
+  EdsSpeedTest() {
+    envoy::api::v2::ConfigSource eds_config;
+    eds_config.mutable_api_config_source()->add_cluster_names("eds");
+    eds_config.mutable_api_config_source()->mutable_refresh_delay()->set_seconds(1);
+    eds_cluster_ = parseSdsClusterFromJson(R"EOF(
+    {
+      "name": "name",
+      "connect_timeout_ms": 250,
+      "type": "sds",
+      "lb_type": "round_robin",
+      "service_name": "fare"
+    }
+    )EOF",
+                                           eds_config);
+    Upstream::ClusterManager::ClusterInfoMap cluster_map;
+    NiceMock<Upstream::MockCluster> cluster;
+    cluster_map.emplace("eds", cluster);
+    ON_CALL(cm_, clusters()).WillByDefault(Return(cluster_map));
+    cluster_.reset(new EdsClusterImpl(eds_cluster_, runtime_, stats_, ssl_context_manager_,
+                                      local_info_, cm_, dispatcher_, random_, false));
+    cluster_->initialize([] {});
+  }
+
+  // Updates the cluster with host_count endpoints, the first of which is on port first_port.
+  void update(uint32_t first_port, uint32_t host_count) {
+    Protobuf::RepeatedPtrField<envoy::api::v2::ClusterLoadAssignment> resources;
+    auto* cluster_load_assignment = resources.Add();
+    cluster_load_assignment->set_cluster_name("fare");
+    auto* endpoints = cluster_load_assignment->add_endpoints();
+    for (uint32_t i = 0; i < host_count; i++) {
+      const uint32_t port = first_port + i;
+      auto* socket_address = endpoints->add_lb_endpoints()
+                                 ->mutable_endpoint()
+                                 ->mutable_address()
+                                 ->mutable_socket_address();
+      socket_address->set_address(fmt::format("10.{}.{}.1", (port >> 8) & 0xff, port & 0xff));
+      socket_address->set_port_value(port);
+    }
+    cluster_->onConfigUpdate(resources);
+  }
+
+  uint64_t hostCount() const {
+    return cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size();
+  }
+
+private:
+  Stats::IsolatedStoreImpl stats_;
+  Ssl::MockContextManager ssl_context_manager_;
+  envoy::api::v2::Cluster eds_cluster_;
+  NiceMock<MockClusterManager> cm_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  std::shared_ptr<EdsClusterImpl> cluster_;
+  NiceMock<Runtime::MockRandomGenerator> random_;
+  NiceMock<Runtime::MockLoader> runtime_;
+  NiceMock<LocalInfo::MockLocalInfo> local_info_;
+};
+
+// Each update replaces a tenth of the endpoints of a cluster, as a rolling deploy of a large
+// service does. The time includes building the update, which is linear in the endpoint count.
+static void BM_EdsChurn(benchmark::State& state) {
+  const uint32_t host_count = state.range(0);
+  EdsSpeedTest test;
+  test.update(0, host_count);
+  uint32_t first_port = 0;
+  while (state.KeepRunning()) {
+    first_port = (first_port + host_count / 10) % 20000;
+    test.update(first_port, host_count);
+  }
+  benchmark::DoNotOptimize(test.hostCount());
+}
+BENCHMARK(BM_EdsChurn)->RangeMultiplier(4)->Range(64, 1 << 14)->Unit(benchmark::kMicrosecond);
+
+} // namespace Upstream
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -188,6 +188,89 @@ TEST_F(EdsTest, EndpointMetadata) {
   EXPECT_TRUE(hosts[1]->canary());
 }
 
+// Validate that a weight change of an existing endpoint raises a membership update, so that load
+// balancers rebuild their weighted state.
+TEST_F(EdsTest, EndpointWeightChangeCausesUpdate) {
+  Protobuf::RepeatedPtrField<envoy::api::v2::ClusterLoadAssignment> resources;
+  auto* cluster_load_assignment = resources.Add();
+  cluster_load_assignment->set_cluster_name("fare");
+  auto* endpoint = cluster_load_assignment->add_endpoints()->add_lb_endpoints();
+  endpoint->mutable_endpoint()->mutable_address()->mutable_socket_address()->set_address("1.2.3.4");
+  endpoint->mutable_endpoint()->mutable_address()->mutable_socket_address()->set_port_value(80);
+  endpoint->mutable_load_balancing_weight()->set_value(30);
+
+  cluster_->initialize([] {});
+  VERBOSE_EXPECT_NO_THROW(cluster_->onConfigUpdate(resources));
+
+  uint32_t member_updates = 0;
+  cluster_->prioritySet().addMemberUpdateCb(
+      [&member_updates](uint32_t, const std::vector<HostSharedPtr>&,
+                        const std::vector<HostSharedPtr>&) -> void { member_updates++; });
+
+  // An identical update changes nothing.
+  VERBOSE_EXPECT_NO_THROW(cluster_->onConfigUpdate(resources));
+  EXPECT_EQ(0U, member_updates);
+
+  endpoint->mutable_load_balancing_weight()->set_value(31);
+  VERBOSE_EXPECT_NO_THROW(cluster_->onConfigUpdate(resources));
+  EXPECT_EQ(1U, member_updates);
+  EXPECT_EQ(31U, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[0]->weight());
+}
+
+// Validate that an update which adds, removes and repeats endpoints keeps the existing hosts, and
+// reports only the hosts that came and went.
+TEST_F(EdsTest, EndpointChurn) {
+  Protobuf::RepeatedPtrField<envoy::api::v2::ClusterLoadAssignment> resources;
+  auto* cluster_load_assignment = resources.Add();
+  cluster_load_assignment->set_cluster_name("fare");
+  auto set_endpoints = [cluster_load_assignment](uint32_t first_port, uint32_t last_port) {
+    cluster_load_assignment->clear_endpoints();
+    auto* endpoints = cluster_load_assignment->add_endpoints();
+    for (uint32_t port = first_port; port <= last_port; port++) {
+      auto* socket_address = endpoints->add_lb_endpoints()
+                                 ->mutable_endpoint()
+                                 ->mutable_address()
+                                 ->mutable_socket_address();
+      socket_address->set_address("1.2.3.4");
+      socket_address->set_port_value(port);
+    }
+  };
+
+  set_endpoints(1000, 1999);
+  cluster_->initialize([] {});
+  VERBOSE_EXPECT_NO_THROW(cluster_->onConfigUpdate(resources));
+  const auto& hosts = cluster_->prioritySet().hostSetsPerPriority()[0]->hosts();
+  ASSERT_EQ(1000UL, hosts.size());
+  const HostSharedPtr kept_host = hosts[500];
+
+  uint32_t added = 0;
+  uint32_t removed = 0;
+  cluster_->prioritySet().addMemberUpdateCb(
+      [&added, &removed](uint32_t, const std::vector<HostSharedPtr>& hosts_added,
+                         const std::vector<HostSharedPtr>& hosts_removed) -> void {
+        added += hosts_added.size();
+        removed += hosts_removed.size();
+      });
+
+  // Shift the endpoints by 250 ports, and repeat the last one.
+  set_endpoints(1250, 2249);
+  auto* socket_address = cluster_load_assignment->mutable_endpoints(0)
+                             ->add_lb_endpoints()
+                             ->mutable_endpoint()
+                             ->mutable_address()
+                             ->mutable_socket_address();
+  socket_address->set_address("1.2.3.4");
+  socket_address->set_port_value(2249);
+  VERBOSE_EXPECT_NO_THROW(cluster_->onConfigUpdate(resources));
+
+  const auto& new_hosts = cluster_->prioritySet().hostSetsPerPriority()[0]->hosts();
+  ASSERT_EQ(1000UL, new_hosts.size());
+  EXPECT_EQ(250U, added);
+  EXPECT_EQ(250U, removed);
+  EXPECT_EQ(kept_host, new_hosts[250]);
+  EXPECT_EQ("1.2.3.4:2249", new_hosts.back()->address()->asString());
+}
+
 // Validate that onConfigUpdate() updates the endpoint locality.
 TEST_F(EdsTest, EndpointLocality) {
   Protobuf::RepeatedPtrField<envoy::api::v2::ClusterLoadAssignment> resources;
@@ -0,0 +1,206 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "common/upstream/maglev_lb.h"
+#include "common/upstream/ring_hash_lb.h"
+#include "common/upstream/upstream_impl.h"
+
+#include "test/common/upstream/utility.h"
+#include "test/mocks/runtime/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+
+#include "fmt/format.h"
+#include "testing/base/public/benchmark.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Upstream {
+
+class TestLoadBalancerContext : public LoadBalancerContext {
+public:
+  TestLoadBalancerContext(uint64_t hash_key) : hash_key_(hash_key) {}
+
+  // Upstream::LoadBalancerContext
+  Optional<uint64_t> computeHashKey() override { return hash_key_; }
+  const Router::MetadataMatchCriteria* metadataMatchCriteria() const override { return nullptr; }
+  const Network::Connection* downstreamConnection() const override { return nullptr; }
+
+  Optional<uint64_t> hash_key_;
+};
+
+class BaseTester {
+public:
+  BaseTester(uint64_t num_hosts) : stats_(ClusterInfoImpl::generateStats(stats_store_)) {
+    for (uint64_t i = 0; i < num_hosts; i++) {
+      hosts_.push_back(makeTestHost(
+          info_, fmt::format("tcp://10.{}.{}.{}:6379", i / 65536, (i / 256) % 256, i % 256)));
+    }
+    updateHosts(hosts_);
+
+    config_.value(envoy::api::v2::Cluster::RingHashLbConfig());
+    config_.value().mutable_deprecated_v1()->mutable_use_std_hash()->set_value(false);
+  }
+
+  void updateHosts(const std::vector<HostSharedPtr>& hosts) {
+    HostVectorConstSharedPtr updated_hosts{new std::vector<HostSharedPtr>(hosts)};
+    priority_set_.getOrCreateHostSet(0).updateHosts(
+        updated_hosts, updated_hosts, std::make_shared<std::vector<std::vector<HostSharedPtr>>>(),
+        std::make_shared<std::vector<std::vector<HostSharedPtr>>>(), {}, {});
+  }
+
+  std::unique_ptr<ThreadAwareLoadBalancer> createRingHash(uint64_t min_ring_size) {
+    config_.value().mutable_minimum_ring_size()->set_value(min_ring_size);
+    std::unique_ptr<ThreadAwareLoadBalancer> lb{
+        new RingHashLoadBalancer(priority_set_, stats_, runtime_, random_, config_)};
+    lb->initialize();
+    return lb;
+  }
+
+  std::unique_ptr<ThreadAwareLoadBalancer> createMaglev() {
+    std::unique_ptr<ThreadAwareLoadBalancer> lb{
+        new MaglevLoadBalancer(priority_set_, stats_, runtime_, random_)};
+    lb->initialize();
+    return lb;
+  }
+
+  std::vector<HostSharedPtr> hosts_;
+  PrioritySetImpl priority_set_;
+  std::shared_ptr<MockClusterInfo> info_{new NiceMock<MockClusterInfo>()};
+  Stats::IsolatedStoreImpl stats_store_;
+  ClusterStats stats_;
+  Optional<envoy::api::v2::Cluster::RingHashLbConfig> config_;
+  NiceMock<Runtime::MockLoader> runtime_;
+  NiceMock<Runtime::MockRandomGenerator> random_;
+};
+
+// Chooses a host for each of a fixed set of random hash keys.
+static void chooseHosts(benchmark::State& state, ThreadAwareLoadBalancer& thread_aware_lb) {
+  LoadBalancerPtr lb = thread_aware_lb.factory()->create();
+  std::mt19937_64 random(state.range(0));
+  std::vector<TestLoadBalancerContext> contexts;
+  for (uint64_t i = 0; i < 1024; i++) {
+    contexts.emplace_back(random());
+  }
+
+  size_t i = 0;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(lb->chooseHost(&contexts[i++ % contexts.size()]));
+  }
+}
+
+// Reports the percentage of keys that move to a different host when one host is removed, on
+// top of the keys owned by the removed host which must move. Ideally this is zero.
+static void reportRemapped(benchmark::State& state, BaseTester& tester,
+                           ThreadAwareLoadBalancer& thread_aware_lb) {
+  const uint64_t num_keys = 100000;
+  std::mt19937_64 random(state.range(0));
+  std::vector<uint64_t> keys;
+  for (uint64_t i = 0; i < num_keys; i++) {
+    keys.push_back(random());
+  }
+
+  LoadBalancerPtr lb = thread_aware_lb.factory()->create();
+  std::vector<HostConstSharedPtr> before;
+  for (uint64_t key : keys) {
+    TestLoadBalancerContext context(key);
+    before.push_back(lb->chooseHost(&context));
+  }
+
+  const HostSharedPtr removed = tester.hosts_[tester.hosts_.size() / 2];
+  std::vector<HostSharedPtr> remaining = tester.hosts_;
+  remaining.erase(remaining.begin() + remaining.size() / 2);
+  tester.updateHosts(remaining);
+
+  lb = thread_aware_lb.factory()->create();
+  uint64_t remapped = 0;
+  for (uint64_t i = 0; i < num_keys; i++) {
+    TestLoadBalancerContext context(keys[i]);
+    if (before[i] != removed && before[i] != lb->chooseHost(&context)) {
+      remapped++;
+    }
+  }
+  state.SetLabel(fmt::format("{:.3f}% remapped", 100.0 * remapped / num_keys));
+}
+
+static void BM_RingHashLoadBalancerBuildRing(benchmark::State& state) {
+  BaseTester tester(state.range(0));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(tester.createRingHash(state.range(1)));
+  }
+}
+BENCHMARK(BM_RingHashLoadBalancerBuildRing)
+    ->Args({100, 1024})
+    ->Args({100, 65536})
+    ->Args({1000, 65536})
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_MaglevLoadBalancerBuildTable(benchmark::State& state) {
+  BaseTester tester(state.range(0));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(tester.createMaglev());
+  }
+}
+BENCHMARK(BM_MaglevLoadBalancerBuildTable)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_RingHashLoadBalancerChooseHost(benchmark::State& state) {
+  BaseTester tester(state.range(0));
+  std::unique_ptr<ThreadAwareLoadBalancer> lb = tester.createRingHash(state.range(1));
+  chooseHosts(state, *lb);
+}
+BENCHMARK(BM_RingHashLoadBalancerChooseHost)
+    ->Args({100, 1024})
+    ->Args({100, 65536})
+    ->Args({1000, 65536});
+
+static void BM_MaglevLoadBalancerChooseHost(benchmark::State& state) {
+  BaseTester tester(state.range(0));
+  std::unique_ptr<ThreadAwareLoadBalancer> lb = tester.createMaglev();
+  chooseHosts(state, *lb);
+}
+BENCHMARK(BM_MaglevLoadBalancerChooseHost)->Arg(100)->Arg(1000);
+
+static void BM_RingHashLoadBalancerHostLoss(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    BaseTester tester(state.range(0));
+    std::unique_ptr<ThreadAwareLoadBalancer> lb = tester.createRingHash(state.range(1));
+    state.ResumeTiming();
+    reportRemapped(state, tester, *lb);
+  }
+}
+BENCHMARK(BM_RingHashLoadBalancerHostLoss)
+    ->Args({100, 1024})
+    ->Args({100, 65536})
+    ->Unit(benchmark::kMillisecond);
+
+static void BM_MaglevLoadBalancerHostLoss(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    BaseTester tester(state.range(0));
+    std::unique_ptr<ThreadAwareLoadBalancer> lb = tester.createMaglev();
+    state.ResumeTiming();
+    reportRemapped(state, tester, *lb);
+  }
+}
+BENCHMARK(BM_MaglevLoadBalancerHostLoss)->Arg(100)->Unit(benchmark::kMillisecond);
+
+} // namespace Upstream
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
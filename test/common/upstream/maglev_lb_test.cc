@@ -0,0 +1,221 @@
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "envoy/router/router.h"
+
+#include "common/network/utility.h"
+#include "common/upstream/maglev_lb.h"
+#include "common/upstream/upstream_impl.h"
+
+#include "test/common/upstream/utility.h"
+#include "test/mocks/runtime/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+
+#include "fmt/format.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Upstream {
+
+class TestLoadBalancerContext : public LoadBalancerContext {
+public:
+  TestLoadBalancerContext(uint64_t hash_key) : hash_key_(hash_key) {}
+
+  // Upstream::LoadBalancerContext
+  Optional<uint64_t> computeHashKey() override { return hash_key_; }
+  const Router::MetadataMatchCriteria* metadataMatchCriteria() const override { return nullptr; }
+  const Network::Connection* downstreamConnection() const override { return nullptr; }
+
+  Optional<uint64_t> hash_key_;
+};
+
+class MaglevLoadBalancerTest : public ::testing::TestWithParam<bool> {
+public:
+  MaglevLoadBalancerTest() : stats_(ClusterInfoImpl::generateStats(stats_store_)) {}
+
+  void init(uint64_t table_size) {
+    lb_.reset(new MaglevLoadBalancer(priority_set_, stats_, runtime_, random_, table_size));
+    lb_->initialize();
+  }
+
+  // Run all tests aginst both priority 0 and priority 1 host sets, to ensure the load balancer
+  // has equivalent functionality for failover host sets.
+  MockHostSet& hostSet() { return GetParam() ? host_set_ : failover_host_set_; }
+
+  NiceMock<MockPrioritySet> priority_set_;
+  MockHostSet& host_set_ = *priority_set_.getMockHostSet(0);
+  MockHostSet& failover_host_set_ = *priority_set_.getMockHostSet(1);
+  std::shared_ptr<MockClusterInfo> info_{new NiceMock<MockClusterInfo>()};
+  Stats::IsolatedStoreImpl stats_store_;
+  ClusterStats stats_;
+  NiceMock<Runtime::MockLoader> runtime_;
+  NiceMock<Runtime::MockRandomGenerator> random_;
+  std::unique_ptr<MaglevLoadBalancer> lb_;
+};
+
+// For tests which don't need to be run in both primary and failover modes.
+typedef MaglevLoadBalancerTest MaglevFailoverTest;
+
+INSTANTIATE_TEST_CASE_P(MaglevPrimaryOrFailover, MaglevLoadBalancerTest,
+                        ::testing::Values(true, false));
+INSTANTIATE_TEST_CASE_P(MaglevPrimaryOrFailover, MaglevFailoverTest, ::testing::Values(true));
+
+TEST_P(MaglevLoadBalancerTest, NoHost) {
+  init(7);
+  EXPECT_EQ(nullptr, lb_->factory()->create()->chooseHost(nullptr));
+};
+
+TEST_P(MaglevLoadBalancerTest, Basic) {
+  hostSet().hosts_ = {
+      makeTestHost(info_, "tcp://127.0.0.1:90"), makeTestHost(info_, "tcp://127.0.0.1:91"),
+      makeTestHost(info_, "tcp://127.0.0.1:92"), makeTestHost(info_, "tcp://127.0.0.1:93"),
+      makeTestHost(info_, "tcp://127.0.0.1:94"), makeTestHost(info_, "tcp://127.0.0.1:95")};
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  hostSet().runCallbacks({}, {});
+  init(7);
+
+  // maglev table:
+  // entry | port
+  // ------------
+  // 0     | :92
+  // 1     | :94
+  // 2     | :90
+  // 3     | :91
+  // 4     | :95
+  // 5     | :90
+  // 6     | :93
+
+  LoadBalancerPtr lb = lb_->factory()->create();
+  const std::vector<uint32_t> expected{2, 4, 0, 1, 5, 0, 3};
+  for (uint64_t i = 0; i < 2 * expected.size(); i++) {
+    TestLoadBalancerContext context(i);
+    EXPECT_EQ(hostSet().hosts_[expected[i % expected.size()]], lb->chooseHost(&context));
+  }
+  {
+    EXPECT_CALL(random_, random()).WillOnce(Return(6));
+    EXPECT_EQ(hostSet().hosts_[3], lb->chooseHost(nullptr));
+  }
+  EXPECT_EQ(0UL, stats_.lb_healthy_panic_.value());
+
+  hostSet().healthy_hosts_.clear();
+  hostSet().runCallbacks({}, {});
+  lb = lb_->factory()->create();
+  {
+    TestLoadBalancerContext context(0);
+    if (GetParam() == 1) {
+      EXPECT_EQ(hostSet().hosts_[2], lb->chooseHost(&context));
+    } else {
+      // When all hosts are unhealthy, the default behavior of the load balancer is to send
+      // traffic to P=0. In this case, P=0 has no backends so it returns nullptr.
+      EXPECT_EQ(nullptr, lb->chooseHost(&context));
+    }
+  }
+  EXPECT_EQ(1UL, stats_.lb_healthy_panic_.value());
+}
+
+// Ensure if all the hosts with priority 0 unhealthy, the next priority hosts are used.
+TEST_P(MaglevFailoverTest, BasicFailover) {
+  host_set_.hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80")};
+  failover_host_set_.healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:82")};
+  failover_host_set_.hosts_ = failover_host_set_.healthy_hosts_;
+  init(7);
+
+  LoadBalancerPtr lb = lb_->factory()->create();
+  EXPECT_EQ(failover_host_set_.healthy_hosts_[0], lb->chooseHost(nullptr));
+
+  // Add a healthy host at P=0 and it will be chosen.
+  host_set_.healthy_hosts_ = host_set_.hosts_;
+  host_set_.runCallbacks({}, {});
+  lb = lb_->factory()->create();
+  EXPECT_EQ(host_set_.healthy_hosts_[0], lb->chooseHost(nullptr));
+
+  // Remove the healthy host and ensure we fail back over to the failover_host_set_
+  host_set_.healthy_hosts_ = {};
+  host_set_.runCallbacks({}, {});
+  lb = lb_->factory()->create();
+  EXPECT_EQ(failover_host_set_.healthy_hosts_[0], lb->chooseHost(nullptr));
+}
+
+// Hosts claim table entries in proportion to their weight.
+TEST_P(MaglevLoadBalancerTest, Weighted) {
+  hostSet().hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:90", 1),
+                      makeTestHost(info_, "tcp://127.0.0.1:91", 2)};
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  hostSet().runCallbacks({}, {});
+  init(7);
+
+  // maglev table:
+  // entry | port
+  // ------------
+  // 0     | :91
+  // 1     | :91
+  // 2     | :90
+  // 3     | :91
+  // 4     | :90
+  // 5     | :91
+  // 6     | :90
+
+  LoadBalancerPtr lb = lb_->factory()->create();
+  const std::vector<uint32_t> expected{1, 1, 0, 1, 0, 1, 0};
+  for (uint64_t i = 0; i < expected.size(); i++) {
+    TestLoadBalancerContext context(i);
+    EXPECT_EQ(hostSet().hosts_[expected[i]], lb->chooseHost(&context));
+  }
+}
+
+class MaglevTableTest : public testing::Test {
+public:
+  std::vector<HostSharedPtr> makeHosts(uint32_t num_hosts) {
+    std::vector<HostSharedPtr> hosts;
+    for (uint32_t i = 0; i < num_hosts; i++) {
+      hosts.push_back(makeTestHost(info_, fmt::format("tcp://10.0.0.{}:80", i)));
+    }
+    return hosts;
+  }
+
+  std::shared_ptr<MockClusterInfo> info_{new NiceMock<MockClusterInfo>()};
+};
+
+// With equal weights, every host owns either the floor or the ceiling of its share of the table.
+TEST_F(MaglevTableTest, EvenSpread) {
+  const std::vector<HostSharedPtr> hosts = makeHosts(100);
+  MaglevTable table(hosts, MaglevTable::DEFAULT_TABLE_SIZE);
+
+  std::unordered_map<HostConstSharedPtr, uint64_t> entries;
+  for (uint64_t i = 0; i < MaglevTable::DEFAULT_TABLE_SIZE; i++) {
+    entries[table.chooseHost(i)]++;
+  }
+  EXPECT_EQ(hosts.size(), entries.size());
+  for (const auto& entry : entries) {
+    EXPECT_GE(entry.second, MaglevTable::DEFAULT_TABLE_SIZE / hosts.size());
+    EXPECT_LE(entry.second, MaglevTable::DEFAULT_TABLE_SIZE / hosts.size() + 1);
+  }
+}
+
+// Removing a host moves the entries it owned, and only a small number of other entries.
+TEST_F(MaglevTableTest, MinimalDisruption) {
+  std::vector<HostSharedPtr> hosts = makeHosts(100);
+  MaglevTable before(hosts, MaglevTable::DEFAULT_TABLE_SIZE);
+  const HostSharedPtr removed = hosts[50];
+  hosts.erase(hosts.begin() + 50);
+  MaglevTable after(hosts, MaglevTable::DEFAULT_TABLE_SIZE);
+
+  uint64_t moved = 0;
+  for (uint64_t i = 0; i < MaglevTable::DEFAULT_TABLE_SIZE; i++) {
+    HostConstSharedPtr old_host = before.chooseHost(i);
+    HostConstSharedPtr new_host = after.chooseHost(i);
+    EXPECT_NE(removed, new_host);
+    if (old_host != removed && old_host != new_host) {
+      moved++;
+    }
+  }
+  EXPECT_LT(moved, MaglevTable::DEFAULT_TABLE_SIZE / 100);
+}
+
+} // namespace Upstream
+} // namespace Envoy
@@ -47,6 +47,7 @@ public:
   std::chrono::milliseconds fileFlushIntervalMsec() override {
     return std::chrono::milliseconds(50);
   }
+  bool fileFlushSharedThread() override { return false; }
   Mode mode() const override { return Mode::Serve; }
   const std::string& serviceClusterName() override { return service_cluster_name_; }
   const std::string& serviceNodeName() override { return service_node_name_; }
@@ -162,6 +163,10 @@ public:
     std::unique_lock<std::mutex> lock(lock_);
     return store_.gauges();
   }
+  std::list<ParentHistogramSharedPtr> histograms() const override {
+    std::unique_lock<std::mutex> lock(lock_);
+    return store_.histograms();
+  }
 
   // Stats::StoreRoot
   void addSink(Sink&) override {}
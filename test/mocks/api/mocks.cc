@@ -9,7 +9,7 @@ using testing::_;
 namespace Envoy {
 namespace Api {
 
-MockApi::MockApi() { ON_CALL(*this, createFile(_, _, _, _)).WillByDefault(Return(file_)); }
+MockApi::MockApi() { ON_CALL(*this, createFile(_, _, _)).WillByDefault(Return(file_)); }
 
 MockApi::~MockApi() {}
 
@@ -37,5 +37,15 @@ ssize_t MockOsSysCalls::write(int fd, const void* buffer, size_t num_bytes) {
   return result;
 }
 
+ssize_t MockOsSysCalls::writev(int fd, const iovec* iovec, int num_iovec) {
+  std::unique_lock<Thread::BasicLockable> lock(write_mutex_);
+
+  ssize_t result = writev_(fd, iovec, num_iovec);
+  num_writes_++;
+  write_event_.notify_one();
+
+  return result;
+}
+
 } // namespace Api
 } // namespace Envoy
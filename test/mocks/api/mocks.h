@@ -27,9 +27,9 @@ public:
   }
 
   MOCK_METHOD0(allocateDispatcher_, Event::Dispatcher*());
-  MOCK_METHOD4(createFile,
+  MOCK_METHOD3(createFile,
                Filesystem::FileSharedPtr(const std::string& path, Event::Dispatcher& dispatcher,
-                                         Thread::BasicLockable& lock, Stats::Store& stats_store));
+                                         Stats::Store& stats_store));
   MOCK_METHOD1(fileExists, bool(const std::string& path));
   MOCK_METHOD1(fileReadToEnd, std::string(const std::string& path));
 
@@ -43,11 +43,14 @@ public:
 
   // Api::OsSysCalls
   ssize_t write(int fd, const void* buffer, size_t num_bytes) override;
+  ssize_t writev(int fd, const iovec* iovec, int num_iovec) override;
   int open(const std::string& full_path, int flags, int mode) override;
   MOCK_METHOD3(bind, int(int sockfd, const sockaddr* addr, socklen_t addrlen));
   MOCK_METHOD1(close, int(int));
   MOCK_METHOD3(open_, int(const std::string& full_path, int flags, int mode));
   MOCK_METHOD3(write_, ssize_t(int, const void*, size_t));
+  MOCK_METHOD3(writev_, ssize_t(int, const iovec*, int));
+  MOCK_METHOD2(flock, int(int fd, int operation));
   MOCK_METHOD3(shmOpen, int(const char*, int, mode_t));
   MOCK_METHOD1(shmUnlink, int(const char*));
   MOCK_METHOD2(ftruncate, int(int fd, off_t length));
@@ -80,6 +80,7 @@ public:
   MOCK_CONST_METHOD0(bufferLimit, uint32_t());
   MOCK_CONST_METHOD0(usingOriginalDst, bool());
   MOCK_CONST_METHOD0(aboveHighWatermark, bool());
+  MOCK_METHOD1(spliceTo, bool(Connection& destination));
 };
 
 /**
@@ -117,6 +118,7 @@ public:
   MOCK_CONST_METHOD0(bufferLimit, uint32_t());
   MOCK_CONST_METHOD0(usingOriginalDst, bool());
   MOCK_CONST_METHOD0(aboveHighWatermark, bool());
+  MOCK_METHOD1(spliceTo, bool(Connection& destination));
 
   // Network::ClientConnection
   MOCK_METHOD0(connect, void());
@@ -235,6 +237,7 @@ public:
 
   MOCK_METHOD0(filterChainFactory, FilterChainFactory&());
   MOCK_METHOD0(socket, ListenSocket&());
+  MOCK_METHOD1(workerSocket, ListenSocket&(uint32_t worker_index));
   MOCK_METHOD0(defaultSslContext, Ssl::ServerContext*());
   MOCK_METHOD0(useProxyProto, bool());
   MOCK_METHOD0(bindToPort, bool());
@@ -309,6 +312,7 @@ public:
   MOCK_METHOD1(setTransportSocketCallbacks, void(TransportSocketCallbacks& callbacks));
   MOCK_CONST_METHOD0(protocol, std::string());
   MOCK_METHOD0(canFlushClose, bool());
+  MOCK_CONST_METHOD0(canSplice, bool());
   MOCK_METHOD1(closeSocket, void(Network::ConnectionEvent event));
   MOCK_METHOD1(doRead, IoResult(Buffer::Instance& buffer));
   MOCK_METHOD1(doWrite, IoResult(Buffer::Instance& buffer));
@@ -120,10 +120,10 @@ class TestShadowPolicy : public ShadowPolicy {
 public:
   // Router::ShadowPolicy
   const std::string& cluster() const override { return cluster_; }
-  const std::string& runtimeKey() const override { return runtime_key_; }
+  const Runtime::Key& runtimeKey() const override { return runtime_key_; }
 
   std::string cluster_;
-  std::string runtime_key_;
+  Runtime::Key runtime_key_{""};
 };
 
 class MockShadowWriter : public ShadowWriter {
@@ -35,6 +35,23 @@ public:
   MOCK_CONST_METHOD1(get, const std::string&(const std::string& key));
   MOCK_CONST_METHOD2(getInteger, uint64_t(const std::string& key, uint64_t default_value));
   MOCK_CONST_METHOD0(getAll, const std::unordered_map<std::string, const Snapshot::Entry>&());
+
+  // Lookups of interned keys are forwarded to the mocks above by key name, so that expectations
+  // do not depend on whether the code under test interns its keys.
+  bool featureEnabled(const Key& key, uint64_t default_value) const override {
+    return featureEnabled(key.name(), default_value);
+  }
+  bool featureEnabled(const Key& key, uint64_t default_value,
+                      uint64_t random_value) const override {
+    return featureEnabled(key.name(), default_value, random_value);
+  }
+  bool featureEnabled(const Key& key, uint64_t default_value, uint64_t random_value,
+                      uint16_t num_buckets) const override {
+    return featureEnabled(key.name(), default_value, random_value, num_buckets);
+  }
+  uint64_t getInteger(const Key& key, uint64_t default_value) const override {
+    return getInteger(key.name(), default_value);
+  }
 };
 
 class MockLoader : public Loader {
@@ -53,6 +53,7 @@ MockHotRestart::~MockHotRestart() {}
 MockListenerComponentFactory::MockListenerComponentFactory()
     : socket_(std::make_shared<NiceMock<Network::MockListenSocket>>()) {
   ON_CALL(*this, createListenSocket(_, _)).WillByDefault(Return(socket_));
+  ON_CALL(*this, createReusePortListenSocket(_, _)).WillByDefault(Return(socket_));
 }
 MockListenerComponentFactory::~MockListenerComponentFactory() {}
 
@@ -36,6 +36,12 @@ MockHistogram::MockHistogram() {
 }
 MockHistogram::~MockHistogram() {}
 
+MockParentHistogram::MockParentHistogram() {
+  ON_CALL(*this, tagExtractedName()).WillByDefault(ReturnRef(name_));
+  ON_CALL(*this, tags()).WillByDefault(ReturnRef(tags_));
+}
+MockParentHistogram::~MockParentHistogram() {}
+
 MockSink::MockSink() {}
 MockSink::~MockSink() {}
 
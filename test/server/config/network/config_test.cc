@@ -516,6 +516,28 @@ TEST(AccessLogConfigTest, FileAccessLogTest) {
   EXPECT_NE(nullptr, dynamic_cast<AccessLog::FileAccessLog*>(instance.get()));
 }
 
+TEST(AccessLogConfigTest, BinaryFileAccessLogTest) {
+  auto factory = Registry::FactoryRegistry<AccessLogInstanceFactory>::getFactory(
+      Config::AccessLogNames::get().BINARY_FILE);
+  ASSERT_NE(nullptr, factory);
+
+  ProtobufTypes::MessagePtr message = factory->createEmptyConfigProto();
+  ASSERT_NE(nullptr, message);
+
+  envoy::api::v2::filter::accesslog::FileAccessLog file_access_log;
+  file_access_log.set_path("/dev/null");
+  file_access_log.set_format("%START_TIME% %REQ(:PATH)%");
+  MessageUtil::jsonConvert(file_access_log, *message);
+
+  AccessLog::FilterPtr filter;
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+
+  AccessLog::InstanceSharedPtr instance =
+      factory->createAccessLogInstance(*message, std::move(filter), context);
+  EXPECT_NE(nullptr, instance);
+  EXPECT_NE(nullptr, dynamic_cast<AccessLog::FileAccessLog*>(instance.get()));
+}
+
 // Test that a minimal TcpProxy v2 config works.
 TEST(TcpProxyConfigTest, TcpProxyConfigTest) {
   NiceMock<MockFactoryContext> context;
@@ -7,11 +7,13 @@
 #include "common/http/message_impl.h"
 #include "common/json/json_loader.h"
 #include "common/profiler/profiler.h"
+#include "common/stats/histogram_impl.h"
 
 #include "server/http/admin.h"
 
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/server/mocks.h"
+#include "test/mocks/stats/mocks.h"
 #include "test/test_common/environment.h"
 #include "test/test_common/network_utility.h"
 #include "test/test_common/printers.h"
@@ -202,6 +204,29 @@ TEST_P(AdminInstanceTest, HelpUsesFormForMutations) {
   EXPECT_NE(-1, response.search(stats_href.data(), stats_href.size(), 0));
 }
 
+TEST_P(AdminInstanceTest, StatsHistograms) {
+  Http::HeaderMapImpl header_map;
+  Buffer::OwnedImpl response;
+
+  NiceMock<Stats::MockStore> store;
+  auto used = std::make_shared<Stats::ParentHistogramImpl>("used", store, "used",
+                                                           std::vector<Stats::Tag>());
+  auto unused = std::make_shared<Stats::ParentHistogramImpl>("unused", store, "unused",
+                                                             std::vector<Stats::Tag>());
+  used->recordValue(7);
+  used->merge();
+  used->merge();
+  unused->merge();
+  ON_CALL(store, histograms())
+      .WillByDefault(testing::Return(std::list<Stats::ParentHistogramSharedPtr>{used, unused}));
+  ON_CALL(server_, stats()).WillByDefault(testing::ReturnRef(store));
+
+  // The last interval had no samples.
+  EXPECT_EQ(Http::Code::OK, admin_.runCallback("/stats", header_map, response));
+  EXPECT_EQ("used: P50(nan,7.5) P90(nan,7.9) P99(nan,7.99) P99.9(nan,7.999)\n",
+            TestUtility::bufferToString(response));
+}
+
 TEST_P(AdminInstanceTest, Runtime) {
   Http::HeaderMapImpl header_map;
   Buffer::OwnedImpl response;
@@ -540,6 +540,61 @@ TEST_F(ListenerManagerImplTest, AddDrainingListener) {
   EXPECT_CALL(*listener_foo2, onDestroy());
 }
 
+// With the listener.reuse_port runtime key enabled, each worker gets a socket of its own, and a
+// listener that replaces another takes over all of them.
+TEST_F(ListenerManagerImplTest, ReusePortSockets) {
+  InSequence s;
+
+  EXPECT_CALL(*worker_, start(_));
+  manager_->startWorkers(guard_dog_);
+
+  const std::string listener_foo_json = R"EOF(
+  {
+    "name": "foo",
+    "address": "tcp://127.0.0.1:1234",
+    "filters": []
+  }
+  )EOF";
+
+  ON_CALL(server_.runtime_loader_.snapshot_, featureEnabled("listener.reuse_port", 0))
+      .WillByDefault(Return(true));
+  ListenerHandle* listener_foo = expectListenerCreate(false);
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _)).Times(0);
+  EXPECT_CALL(listener_factory_, createReusePortListenSocket(_, 0));
+  EXPECT_CALL(*worker_, addListener(_, _));
+  EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromJson(listener_foo_json), true));
+  worker_->callAddCompletion(true);
+  checkStats(1, 0, 0, 0, 1, 0);
+  EXPECT_EQ(listener_factory_.socket_.get(), &manager_->listeners()[0].get().workerSocket(0));
+
+  // Update foo. The new listener shares the sockets of the old one.
+  const std::string listener_foo_update1_json = R"EOF(
+  {
+    "name": "foo",
+    "address": "tcp://127.0.0.1:1234",
+    "filters": [
+      { "type" : "read", "name" : "fake", "config" : {} }
+    ]
+  }
+  )EOF";
+
+  ListenerHandle* listener_foo_update1 = expectListenerCreate(false);
+  EXPECT_CALL(*worker_, addListener(_, _));
+  EXPECT_CALL(*worker_, stopListener(_));
+  EXPECT_CALL(*listener_foo->drain_manager_, startDrainSequence(_));
+  EXPECT_TRUE(
+      manager_->addOrUpdateListener(parseListenerFromJson(listener_foo_update1_json), true));
+  worker_->callAddCompletion(true);
+  EXPECT_EQ(listener_factory_.socket_.get(), &manager_->listeners()[0].get().workerSocket(0));
+
+  EXPECT_CALL(*worker_, removeListener(_, _));
+  listener_foo->drain_manager_->drain_sequence_completion_();
+  EXPECT_CALL(*listener_foo, onDestroy());
+  worker_->callRemovalCompletion();
+
+  EXPECT_CALL(*listener_foo_update1, onDestroy());
+}
+
 TEST_F(ListenerManagerImplTest, CantBindSocket) {
   InSequence s;
 
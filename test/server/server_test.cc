@@ -13,7 +13,9 @@
 
 using testing::HasSubstr;
 using testing::InSequence;
+using testing::NiceMock;
 using testing::Property;
+using testing::Return;
 using testing::SaveArg;
 using testing::StrictMock;
 using testing::_;
@@ -35,7 +37,32 @@ TEST(ServerInstanceUtil, flushHelper) {
 
   std::list<Stats::SinkPtr> sinks;
   sinks.emplace_back(std::move(sink));
-  InstanceUtil::flushCountersAndGaugesToSinks(sinks, store);
+  InstanceUtil::flushMetricsToSinks(sinks, store);
+}
+
+TEST(ServerInstanceUtil, flushHistograms) {
+  InSequence s;
+
+  NiceMock<Stats::MockStore> store;
+  auto used = std::make_shared<NiceMock<Stats::MockParentHistogram>>();
+  used->name_ = "used";
+  auto unused = std::make_shared<NiceMock<Stats::MockParentHistogram>>();
+  unused->name_ = "unused";
+  ON_CALL(store, histograms())
+      .WillByDefault(Return(std::list<Stats::ParentHistogramSharedPtr>{used, unused}));
+
+  std::unique_ptr<Stats::MockSink> sink(new StrictMock<Stats::MockSink>());
+  EXPECT_CALL(*sink, beginFlush());
+  EXPECT_CALL(*used, merge());
+  EXPECT_CALL(*used, used()).WillOnce(Return(true));
+  EXPECT_CALL(*sink, flushHistogram(Property(&Stats::Metric::name, "used")));
+  EXPECT_CALL(*unused, merge());
+  EXPECT_CALL(*unused, used()).WillOnce(Return(false));
+  EXPECT_CALL(*sink, endFlush());
+
+  std::list<Stats::SinkPtr> sinks;
+  sinks.emplace_back(std::move(sink));
+  InstanceUtil::flushMetricsToSinks(sinks, store);
 }
 
 class RunHelperTest : public testing::Test {
@@ -102,7 +129,7 @@ protected:
     server_.reset(new InstanceImpl(
         options_,
         Network::Address::InstanceConstSharedPtr(new Network::Address::Ipv4Instance("127.0.0.1")),
-        hooks_, restart_, stats_store_, fakelock_, component_factory_, thread_local_));
+        hooks_, restart_, stats_store_, component_factory_, thread_local_));
 
     EXPECT_TRUE(server_->api().fileExists("/dev/null"));
   }
@@ -121,7 +148,6 @@ protected:
   testing::NiceMock<MockHotRestart> restart_;
   ThreadLocal::InstanceImpl thread_local_;
   Stats::TestIsolatedStoreImpl stats_store_;
-  Thread::MutexBasicLockable fakelock_;
   TestComponentFactory component_factory_;
   std::unique_ptr<InstanceImpl> server_;
 };
@@ -230,7 +256,7 @@ TEST_P(ServerInstanceImplTest, NoOptionsPassed) {
       server_.reset(new InstanceImpl(
           options_,
           Network::Address::InstanceConstSharedPtr(new Network::Address::Ipv4Instance("127.0.0.1")),
-          hooks_, restart_, stats_store_, fakelock_, component_factory_, thread_local_)),
+          hooks_, restart_, stats_store_, component_factory_, thread_local_)),
       EnvoyException, "unable to read file: ")
 }
 } // namespace Server
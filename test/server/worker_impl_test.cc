@@ -33,7 +33,7 @@ public:
   NiceMock<MockGuardDog> guard_dog_;
   DefaultTestHooks hooks_;
   WorkerImpl worker_{tls_, hooks_, Event::DispatcherPtr{dispatcher_},
-                     Network::ConnectionHandlerPtr{handler_}};
+                     Network::ConnectionHandlerPtr{handler_}, 0};
   Event::TimerPtr no_exit_timer_ = dispatcher_->createTimer([]() -> void {});
 };
 
@@ -48,16 +48,19 @@ RouterCheckTool RouterCheckTool::create(const std::string& router_config_json) {
   std::unique_ptr<NiceMock<Runtime::MockLoader>> runtime(new NiceMock<Runtime::MockLoader>());
   std::unique_ptr<NiceMock<Upstream::MockClusterManager>> cm(
       new NiceMock<Upstream::MockClusterManager>());
+  std::unique_ptr<Stats::IsolatedStoreImpl> stats(new Stats::IsolatedStoreImpl());
   std::unique_ptr<Router::ConfigImpl> config(
-      new Router::ConfigImpl(route_config, *runtime, *cm, false));
+      new Router::ConfigImpl(route_config, *runtime, *cm, *stats, false));
 
-  return RouterCheckTool(std::move(runtime), std::move(cm), std::move(config));
+  return RouterCheckTool(std::move(runtime), std::move(cm), std::move(stats), std::move(config));
 }
 
 RouterCheckTool::RouterCheckTool(std::unique_ptr<NiceMock<Runtime::MockLoader>> runtime,
                                  std::unique_ptr<NiceMock<Upstream::MockClusterManager>> cm,
+                                 std::unique_ptr<Stats::IsolatedStoreImpl> stats,
                                  std::unique_ptr<Router::ConfigImpl> config)
-    : runtime_(std::move(runtime)), cm_(std::move(cm)), config_(std::move(config)) {}
+    : runtime_(std::move(runtime)), cm_(std::move(cm)), stats_(std::move(stats)),
+      config_(std::move(config)) {}
 
 bool RouterCheckTool::compareEntriesInJson(const std::string& expected_route_json) {
   Json::ObjectSharedPtr loader = Json::Factory::loadFromFile(expected_route_json);
@@ -9,6 +9,7 @@
 #include "common/http/headers.h"
 #include "common/json/json_loader.h"
 #include "common/router/config_impl.h"
+#include "common/stats/stats_impl.h"
 
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/upstream/mocks.h"
@@ -66,6 +67,7 @@ public:
 private:
   RouterCheckTool(std::unique_ptr<NiceMock<Runtime::MockLoader>> runtime,
                   std::unique_ptr<NiceMock<Upstream::MockClusterManager>> cm,
+                  std::unique_ptr<Stats::IsolatedStoreImpl> stats,
                   std::unique_ptr<Router::ConfigImpl> config);
   bool compareCluster(ToolConfig& tool_config, const std::string& expected);
   bool compareVirtualCluster(ToolConfig& tool_config, const std::string& expected);
@@ -92,6 +94,7 @@ private:
   // TODO(hennna): Switch away from mocks following work done by @rlazarus in github issue #499.
   std::unique_ptr<NiceMock<Runtime::MockLoader>> runtime_;
   std::unique_ptr<NiceMock<Upstream::MockClusterManager>> cm_;
+  std::unique_ptr<Stats::IsolatedStoreImpl> stats_;
   std::unique_ptr<Router::ConfigImpl> config_;
 };
 } // namespace Envoy